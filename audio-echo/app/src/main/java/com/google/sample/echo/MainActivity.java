@@ -143,7 +143,11 @@ public class MainActivity extends Activity {
             status_view.setText("Failed to create Audio Player");
             return;
         }
-        if(!NativeFastPlayer.createAudioDecoder(rintTonePath.getBytes())) {
+        // uncompressed ringtones in the fast path format play straight
+        // from the mapped file, everything else goes through the decoder
+        boolean fileSource = rintTonePath.toLowerCase().endsWith(".wav") &&
+                NativeFastPlayer.createFileSource(rintTonePath.getBytes());
+        if(!fileSource && !NativeFastPlayer.createAudioDecoder(rintTonePath.getBytes())) {
             NativeFastPlayer.deleteSLBufferQueueAudioPlayer();
             status_view.setText("Failed to create Audio Recorder");
             return;
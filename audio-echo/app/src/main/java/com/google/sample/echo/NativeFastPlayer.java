@@ -25,6 +25,14 @@ public class NativeFastPlayer {
     public static native void deleteAudioRecorder();
     public static native boolean createAudioDecoder(byte[] uri);
     public static native void deleteAudioDecoder();
+    public static native boolean createFileSource(byte[] path);
+    public static native void deleteFileSource();
+    public static native boolean createCaptureWriter(byte[] path);
+    public static native void deleteCaptureWriter();
+    public static native void setMixGain(int input, float gain);
+    public static native boolean setEffectParam(int node, int param, float value);
+    public static native int calibrateFramesPerBuf(int windowMs);
+    public static native int getCalibrationResult(int[] result);
     public static native void startPlay();
     public static native void stopPlay();
 }
@@ -18,11 +18,13 @@
 #ifndef NATIVE_AUDIO_AUDIO_COMMON_H
 #define NATIVE_AUDIO_AUDIO_COMMON_H
 
+#include <time.h>
 #include <SLES/OpenSLES_Android.h>
 
 #include "android_debug.h"
 #include "debug_utils.h"
 #include "buf_manager.h"
+#include "audio_stats.h"
 
 /*
  * Audio Sample Controls...
@@ -31,6 +33,8 @@
 
 /*
  * Sample Buffer Controls...
+ *   PLAY_KICKSTART_BUFFER_COUNT is the most the JitterController
+ *   ( jitter_controller.h ) will buffer before starting the player
  */
 #define RECORD_DEVICE_KICKSTART_BUF_COUNT   2
 #define PLAY_KICKSTART_BUFFER_COUNT         12
@@ -49,13 +53,13 @@ extern void ConvertToSLSampleFormat(SLAndroidDataFormat_PCM_EX *pFormat,
                                     SampleFormat* format);
 
 /*
- * GetSystemTicks(void):  return the time in micro sec
+ * GetSystemTicks(void):  return the monotonic time in micro sec
  */
 __inline__ uint64_t GetSystemTicks(void) {
-    struct timeval Time;
-    gettimeofday( &Time, NULL );
+    struct timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
 
-    return (static_cast<uint64_t>(1000000) * Time.tv_sec + Time.tv_usec);
+    return (static_cast<uint64_t>(1000000) * Time.tv_sec + Time.tv_nsec / 1000);
 }
 
 #define SLASSERT(x)   do {\
@@ -71,11 +75,23 @@ __inline__ uint64_t GetSystemTicks(void) {
 #define ENGINE_SERVICE_CONTINUE_DECODING  3
 #define ENGINE_SERVICE_RESTART_DECODING  4
 #define ENGINE_SERVICE_DECODING_FINISHED  5
+#define ENGINE_SERVICE_MSG_GET_LATENCY_STATS  6   // pData: LatencyStats*
+#define ENGINE_SERVICE_MSG_GET_JITTER_STATS   7   // pData: JitterStats*
+#define ENGINE_SERVICE_MSG_GET_DECODER_FLOW_STATS 8   // pData: DecoderFlowStats*
+#define ENGINE_SERVICE_MSG_GET_THREAD_STATS   9   // pData: ThreadSchedStats[THREAD_ROLE_COUNT]
+#define ENGINE_SERVICE_MSG_GET_EFFECT_STATS   10  // pData: EffectNodeStats[EFFECT_MAX_NODES]
+#define ENGINE_SERVICE_MSG_GET_AEC_STATS      11  // pData: AecStats*
+#define ENGINE_SERVICE_MSG_GET_CAPTURE_STATS  12  // pData: CaptureStats*
 typedef bool (*ENGINE_CALLBACK)(void* pCTX, uint32_t msg, void* pData);
 
 /*
- * flag to enable file dumping
+ * flag to enable file dumping: audio callbacks then emit TRACE() events
+ * into the binary trace file ( decode with tools/trace_decoder )
  */
 //#define ENABLE_LOG  1
+#define TRACE_FILE_NAME  "/sdcard/data/audio_trace"
+
+// after ENABLE_LOG so TRACE() picks up the flag
+#include "trace_ring.h"
 
 #endif //NATIVE_AUDIO_AUDIO_COMMON_H
@@ -0,0 +1,302 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include "audio_kernels.h"
+#include "audio_converter.h"
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static bool isFloatFormat(SampleFormat *format) {
+    return format->representation_ == SL_ANDROID_PCM_REPRESENTATION_FLOAT ||
+           format->pcmFormat_ == SL_PCMSAMPLEFORMAT_FIXED_32;
+}
+
+AudioConverter::AudioConverter(SampleFormat *dstFormat) :
+    configured_(false), interp_(1), decim_(1), phase_(0),
+    filter_(nullptr), droppedFrames_(0) {
+    assert(dstFormat);
+    dst_ = *dstFormat;
+    memset(&src_, 0, sizeof(src_));
+
+    dstChannels_  = dst_.channels_ > 1 ? SRC_MAX_CHANNELS : 1;
+    dstFloat_     = isFloatFormat(&dst_);
+    dstFrameSize_ = dstChannels_ * (dstFloat_ ? sizeof(float) : sizeof(int16_t));
+
+    // one spare frame: engine buffers carry one for the JitterController
+    maxFrames_ = dst_.framesPerBuf_ + 1;
+    // a block of 16 bit mono input could hold this many frames
+    uint32_t maxInFrames = maxFrames_ * dstFrameSize_ / sizeof(int16_t);
+    if (maxInFrames > maxFrames_) {
+        maxFrames_ = maxInFrames;
+    }
+    fifoCap_ = maxFrames_ * SRC_FIFO_BLOCKS + SRC_TAPS_PER_PHASE;
+    for (int ch = 0; ch < SRC_MAX_CHANNELS; ch++) {
+        fifo_[ch] = new float[fifoCap_];
+    }
+    scratch_ = new float[maxFrames_ * SRC_MAX_CHANNELS];
+    Reset();
+}
+
+AudioConverter::~AudioConverter() {
+    for (int ch = 0; ch < SRC_MAX_CHANNELS; ch++) {
+        delete [] fifo_[ch];
+    }
+    delete [] scratch_;
+    delete [] filter_;
+}
+
+void AudioConverter::Reset(void) {
+    // prime the history so the first filter window is all zeros
+    for (int ch = 0; ch < SRC_MAX_CHANNELS; ch++) {
+        memset(fifo_[ch], 0, sizeof(float) * SRC_TAPS_PER_PHASE);
+    }
+    fifoFrames_ = (interp_ == decim_) ? 0 : SRC_TAPS_PER_PHASE - 1;
+    fifoPos_    = 0;
+    phase_      = 0;
+}
+
+/*
+ * SetSourceFormat(): format the decoder really produces. Returns false
+ * ( and leaves the data untouched from then on ) when it can't convert.
+ */
+bool AudioConverter::SetSourceFormat(SampleFormat *srcFormat) {
+    assert(srcFormat);
+    src_ = *srcFormat;
+    configured_ = false;
+
+    srcFloat_ = isFloatFormat(&src_);
+    if (!srcFloat_ && src_.pcmFormat_ != SL_PCMSAMPLEFORMAT_FIXED_16) {
+        LOGE("====AudioConverter: %d bit source is not supported", src_.pcmFormat_);
+        return false;
+    }
+    srcChannels_  = src_.channels_ ? src_.channels_ : 1;
+    srcFrameSize_ = srcChannels_ * (srcFloat_ ? sizeof(float) : sizeof(int16_t));
+
+    uint32_t srcRate = src_.sampleRate_ / 1000;     // milliHz --> Hz
+    uint32_t dstRate = dst_.sampleRate_ / 1000;
+    if (!srcRate || !dstRate) {
+        return false;
+    }
+    uint32_t div = gcd(srcRate, dstRate);
+    if (dstRate / div > SRC_MAX_PHASES) {
+        LOGE("====AudioConverter: %d -> %d Hz is not supported", srcRate, dstRate);
+        return false;
+    }
+    interp_ = dstRate / div;
+    decim_  = srcRate / div;
+    if (interp_ != decim_) {
+        buildFilter();
+    }
+    Reset();
+    configured_ = true;
+    LOGI("AudioConverter: %d Hz/%d ch/%s --> %d Hz/%d ch/%s", srcRate,
+         srcChannels_, srcFloat_ ? "float" : "int16", dstRate, dstChannels_,
+         dstFloat_ ? "float" : "int16");
+    return true;
+}
+
+/*
+ * buildFilter(): Blackman windowed sinc prototype at L times the input
+ * rate, cut off below the lower of the two Nyquist frequencies, split
+ * into L phases. Each phase is stored time reversed so it lines up with
+ * the oldest-first input window for dotProduct().
+ */
+void AudioConverter::buildFilter(void) {
+    delete [] filter_;
+    uint32_t length = interp_ * SRC_TAPS_PER_PHASE;
+    filter_ = new float[length];
+
+    double cutoff = 0.5 * 0.95 / (interp_ > decim_ ? interp_ : decim_);
+    double center = (length - 1) * 0.5;
+    for (uint32_t k = 0; k < length; k++) {
+        double x = k - center;
+        double sinc = (x == 0.0) ? 2.0 * cutoff :
+                      sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * k / (length - 1)) +
+                        0.08 * cos(4.0 * M_PI * k / (length - 1));
+        uint32_t phase = k % interp_;
+        uint32_t tap   = k / interp_;
+        filter_[phase * SRC_TAPS_PER_PHASE + (SRC_TAPS_PER_PHASE - 1 - tap)] =
+                static_cast<float>(sinc * window * interp_);
+    }
+}
+
+/*
+ * InputBytesFor(): how much to decode into a buffer of bufCapacity bytes
+ * so that one block converts into ( a little less than ) a full buffer;
+ * the small shortfall lets the FIFO drain over time.
+ */
+uint32_t AudioConverter::InputBytesFor(uint32_t bufCapacity) {
+    if (!configured_) {
+        return bufCapacity;
+    }
+    uint32_t outFrames = bufCapacity / dstFrameSize_;
+    if (outFrames > maxFrames_) {
+        outFrames = maxFrames_;
+    }
+    outFrames = outFrames > 2 ? outFrames - 2 : 1;
+    uint32_t inFrames = static_cast<uint32_t>(
+            static_cast<uint64_t>(outFrames) * decim_ / interp_);
+    if (!inFrames) {
+        inFrames = 1;
+    }
+    if (inFrames * srcFrameSize_ > bufCapacity) {
+        inFrames = bufCapacity / srcFrameSize_;
+    }
+    return inFrames * srcFrameSize_;
+}
+
+/*
+ * pullInput(): convert to float, mix to the output channel count and
+ * append to the FIFO
+ */
+uint32_t AudioConverter::pullInput(const uint8_t *src, uint32_t frames) {
+    uint32_t room = fifoCap_ - fifoFrames_;
+    if (frames > room) {
+        droppedFrames_ += frames - room;
+        frames = room;
+    }
+    if (frames > maxFrames_ * SRC_MAX_CHANNELS / srcChannels_) {
+        droppedFrames_ += frames - maxFrames_ * SRC_MAX_CHANNELS / srcChannels_;
+        frames = maxFrames_ * SRC_MAX_CHANNELS / srcChannels_;
+    }
+
+    // interleaved float in scratch_
+    uint32_t samples = frames * srcChannels_;
+    const float *in = scratch_;
+    if (srcFloat_) {
+        in = reinterpret_cast<const float*>(src);
+    } else {
+        convertPcm16ToFloat(reinterpret_cast<const int16_t*>(src), scratch_, samples);
+    }
+
+    float *left  = fifo_[0] + fifoFrames_;
+    float *right = fifo_[1] + fifoFrames_;
+    if (srcChannels_ == dstChannels_) {
+        if (dstChannels_ == 1) {
+            memcpy(left, in, sizeof(float) * frames);
+        } else {
+            for (uint32_t i = 0; i < frames; i++) {
+                left[i]  = in[2 * i];
+                right[i] = in[2 * i + 1];
+            }
+        }
+    } else if (dstChannels_ == 1) {
+        // down mix: average all source channels
+        float scale = 1.0f / srcChannels_;
+        for (uint32_t i = 0; i < frames; i++) {
+            float sum = 0.0f;
+            for (uint32_t ch = 0; ch < srcChannels_; ch++) {
+                sum += in[i * srcChannels_ + ch];
+            }
+            left[i] = sum * scale;
+        }
+    } else if (srcChannels_ == 1) {
+        // up mix: same signal on both sides
+        memcpy(left, in, sizeof(float) * frames);
+        memcpy(right, in, sizeof(float) * frames);
+    } else {
+        // more than stereo: keep front left/right
+        for (uint32_t i = 0; i < frames; i++) {
+            left[i]  = in[i * srcChannels_];
+            right[i] = in[i * srcChannels_ + 1];
+        }
+    }
+    fifoFrames_ += frames;
+    return frames;
+}
+
+/*
+ * resample(): run the polyphase filter over the FIFO into scratch_
+ * ( interleaved ), return the number of frames produced
+ */
+uint32_t AudioConverter::resample(uint32_t maxFrames) {
+    uint32_t frames = 0;
+    if (interp_ == decim_) {
+        frames = fifoFrames_ - fifoPos_;
+        if (frames > maxFrames) {
+            frames = maxFrames;
+        }
+        for (uint32_t i = 0; i < frames; i++) {
+            for (uint32_t ch = 0; ch < dstChannels_; ch++) {
+                scratch_[i * dstChannels_ + ch] = fifo_[ch][fifoPos_ + i];
+            }
+        }
+        fifoPos_ += frames;
+        return frames;
+    }
+
+    while (frames < maxFrames && fifoPos_ + SRC_TAPS_PER_PHASE <= fifoFrames_) {
+        const float *coef = filter_ + phase_ * SRC_TAPS_PER_PHASE;
+        for (uint32_t ch = 0; ch < dstChannels_; ch++) {
+            scratch_[frames * dstChannels_ + ch] =
+                    dotProduct(coef, fifo_[ch] + fifoPos_, SRC_TAPS_PER_PHASE);
+        }
+        frames++;
+        phase_ += decim_;
+        fifoPos_ += phase_ / interp_;
+        phase_ %= interp_;
+    }
+    return frames;
+}
+
+/*
+ * compactFifo(): keep the unused input plus the filter history at the
+ * front of the FIFO
+ */
+void AudioConverter::compactFifo(void) {
+    if (!fifoPos_) {
+        return;
+    }
+    uint32_t keep = fifoPos_ <= fifoFrames_ ? fifoFrames_ - fifoPos_ : 0;
+    for (uint32_t ch = 0; ch < dstChannels_; ch++) {
+        memmove(fifo_[ch], fifo_[ch] + fifoPos_, sizeof(float) * keep);
+    }
+    fifoFrames_ = keep;
+    fifoPos_ = 0;
+}
+
+void AudioConverter::Process(sample_buf *buf) {
+    if (!configured_) {
+        return;
+    }
+    pullInput(buf->buf_, buf->size_ / srcFrameSize_);
+
+    uint32_t outFrames = buf->cap_ / dstFrameSize_;
+    if (outFrames > maxFrames_) {
+        outFrames = maxFrames_;
+    }
+    outFrames = resample(outFrames);
+    compactFifo();
+
+    // input is in the FIFO already, so buf is free to take the output
+    uint32_t samples = outFrames * dstChannels_;
+    if (dstFloat_) {
+        memcpy(buf->buf_, scratch_, sizeof(float) * samples);
+    } else {
+        convertFloatToPcm16(scratch_, reinterpret_cast<int16_t*>(buf->buf_), samples);
+    }
+    buf->size_ = outFrames * dstFrameSize_;
+}
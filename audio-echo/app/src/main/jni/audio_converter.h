@@ -0,0 +1,91 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_AUDIO_CONVERTER_H
+#define NATIVE_AUDIO_AUDIO_CONVERTER_H
+#include <sys/types.h>
+#include "audio_common.h"
+
+/*
+ * Sample rate converter controls:
+ *   SRC_TAPS_PER_PHASE: FIR length of one polyphase branch ( multiple of 4 )
+ *   SRC_MAX_PHASES:     largest interpolation factor L of the L/M ratio;
+ *                       44.1k->48k is 160/147
+ *   SRC_FIFO_BLOCKS:    input blocks the converter can hold back between
+ *                       calls to Process()
+ *   SRC_MAX_CHANNELS:   output channels handled
+ */
+#define SRC_TAPS_PER_PHASE   16
+#define SRC_MAX_PHASES       1024
+#define SRC_FIFO_BLOCKS      4
+#define SRC_MAX_CHANNELS     2
+
+/*
+ * AudioConverter: streaming conversion of decoded PCM into the fast path
+ * SampleFormat given at construction:
+ *    *) 16 bit int / float input, 16 bit int / float output
+ *    *) channel up mix ( copy ) and down mix ( average )
+ *    *) polyphase sample rate conversion
+ * Process() works in place on one sample_buf at a time: the input is
+ * pulled into an internal FIFO, then as many output frames as fit into
+ * the buffer are written back. Input the resampler could not use yet
+ * stays in the FIFO for the next block. All memory is allocated up front
+ * ( the filter bank when the source format is set ), so Process() never
+ * allocates.
+ */
+class AudioConverter {
+public:
+    explicit AudioConverter(SampleFormat *dstFormat);
+    ~AudioConverter();
+    bool     SetSourceFormat(SampleFormat *srcFormat);
+    bool     IsConfigured(void) { return configured_; }
+    uint32_t InputBytesFor(uint32_t bufCapacity);
+    void     Process(sample_buf *buf);
+    void     Reset(void);
+    uint32_t dbgDroppedFrames(void) { return droppedFrames_; }
+
+private:
+    void     buildFilter(void);
+    uint32_t pullInput(const uint8_t *src, uint32_t frames);
+    uint32_t resample(uint32_t maxFrames);
+    void     compactFifo(void);
+
+    SampleFormat  dst_;
+    SampleFormat  src_;
+    bool          configured_;
+    uint32_t      dstChannels_;
+    uint32_t      srcChannels_;
+    uint32_t      dstFrameSize_;
+    uint32_t      srcFrameSize_;
+    bool          dstFloat_;
+    bool          srcFloat_;
+
+    // rate conversion: output rate / input rate = L / M
+    uint32_t      interp_;          // L
+    uint32_t      decim_;           // M
+    uint32_t      phase_;           // 0 .. L-1
+    float        *filter_;          // L phases x SRC_TAPS_PER_PHASE
+
+    uint32_t      maxFrames_;       // largest block, in frames
+    float        *fifo_[SRC_MAX_CHANNELS];   // planar input history
+    uint32_t      fifoCap_;
+    uint32_t      fifoFrames_;      // valid frames in fifo_
+    uint32_t      fifoPos_;         // first frame of the next filter window
+    float        *scratch_;         // interleaved, maxFrames_ * channels
+    uint32_t      droppedFrames_;   // input lost to a full fifo
+};
+
+#endif //NATIVE_AUDIO_AUDIO_CONVERTER_H
@@ -14,8 +14,10 @@
  * limitations under the License.
  */
 
+#include <cstddef>
 #include <cstring>
 #include <cstdlib>
+#include <SLES/OpenSLES_AndroidMetadata.h>
 #include "audio_decoder.h"
 
 void PlayEventCallback(SLPlayItf caller, void *pContext,  SLuint32 recordevent)
@@ -33,22 +35,45 @@ void bqDecoderCallback(SLAndroidSimpleBufferQueueItf bq, void *rec) {
 }
 
 void AudioDecoder::ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq) {
-#ifdef ENABLE_LOG
-    recLog_->logTime();
-#endif
     assert(bq == recBufQueueItf_);
+    if (threads_) {
+        threads_->OnThreadRunning(THREAD_ROLE_DECODER);
+    }
     sample_buf *dataBuf = NULL;
     devShadowQueue_->front(&dataBuf);
     devShadowQueue_->pop();
-    dataBuf->size_ = dataBuf->cap_;           //device only calls us when it is really full
-    recQueue_->push(dataBuf);
+    // dataBuf->size_ is what we asked for when enqueueing: device only
+    // calls us when it is really full
 
-    sample_buf* freeBuf;
-    while (freeQueue_->front(&freeBuf) && devShadowQueue_->push(freeBuf)) {
-        freeQueue_->pop();
-        SLresult result = (*bq)->Enqueue(bq, freeBuf->buf_, freeBuf->cap_);
-        SLASSERT(result);
+    /*
+     * decoded PCM comes out in the source file's format: convert it to
+     * the fast path format in place. Source format is known once the
+     * first buffer is decoded.
+     */
+    if (!formatQueried_) {
+        // one try: without the metadata the converter passes buffers through
+        formatQueried_ = true;
+        if (QuerySourceFormat()) {
+            decodeSize_ = converter_->InputBytesFor(dataBuf->cap_);
+        } else {
+            LOGW("AudioDecoder: source format unknown, playing it as is");
+        }
+    }
+    converter_->Process(dataBuf);
+
+    // refill the device queue with one batch from the free queue; a
+    // buffer that all went into the converter's history is decoded into
+    // again right away
+    sample_buf* freeBufs[DEVICE_SHADOW_BUFFER_QUEUE_LEN];
+    int count = 0;
+    if (dataBuf->size_) {
+        recQueue_->push(dataBuf);
+    } else {
+        freeBufs[count++] = dataBuf;
     }
+    count += freeQueue_->pop_n(freeBufs + count, devShadowQueue_->space() - count);
+    EnqueueForDecoding(freeBufs, count);
+    TRACE(TRACE_EVENT_DECODER_CALLBACK, recQueue_->size(), count);
 
     /*
      * PLAY_KICKSTART_BUFFER_COUNT: # of buffers cached in the queue before
@@ -65,10 +90,11 @@ void AudioDecoder::ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq) {
         (*recItf_)->SetPlayState(recItf_, SL_PLAYSTATE_STOPPED);
     }
 
-    //if the record queue is full, pause the PCM decoder
-    if (recQueue_->size()>=BUF_COUNT-2*DEVICE_SHADOW_BUFFER_QUEUE_LEN)
-    {
-        LOGI("AudioRecorder::ProcessSLCallback - SL_PLAYSTATE_PAUSED");
+    // play queue deep enough: sleep until the player drains it to the
+    // low watermark ( it sends ENGINE_SERVICE_CONTINUE_DECODING then )
+    if (backpressure_ &&
+        backpressure_->OnDecoded(recQueue_->size(), GetSystemTicks())) {
+        TRACE(TRACE_EVENT_DECODER_PAUSE, recQueue_->size(), 0);
         (*recItf_)->SetPlayState(recItf_, SL_PLAYSTATE_PAUSED);
     }
 
@@ -76,7 +102,7 @@ void AudioDecoder::ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq) {
 
 AudioDecoder::AudioDecoder(SampleFormat *sampleFormat, SLEngineItf slEngine, const char* uri) :
         freeQueue_(nullptr), devShadowQueue_(nullptr), recQueue_(nullptr),
-        callback_(nullptr)
+        callback_(nullptr), backpressure_(nullptr), threads_(nullptr)
 {
     SLresult result;
     sampleInfo_ = *sampleFormat;
@@ -90,8 +116,8 @@ AudioDecoder::AudioDecoder(SampleFormat *sampleFormat, SLEngineItf slEngine, con
             DEVICE_SHADOW_BUFFER_QUEUE_LEN };
 
     //although we provide PCM format to the player, the output PCM is matching the PCM format of the
-    //source file (it's not converted to the PCM format we specify). To use the fast path conversion
-    //of PCM data must be implemented
+    //source file (it's not converted to the PCM format we specify). converter_ turns it into the
+    //fast path format once the metadata tells us what the source format is
     SLDataSink audioSnk = {&loc_bq, &format_pcm};
 
     // configure audio source
@@ -102,13 +128,14 @@ AudioDecoder::AudioDecoder(SampleFormat *sampleFormat, SLEngineItf slEngine, con
 
     // create audio decoder
     // (requires the RECORD_AUDIO permission)
-    const SLInterfaceID id[2] = {SL_IID_SEEK, SL_IID_ANDROIDSIMPLEBUFFERQUEUE};
-    const SLboolean req[2] = {SL_BOOLEAN_TRUE, SL_BOOLEAN_TRUE};
+    const SLInterfaceID id[3] = {SL_IID_SEEK, SL_IID_ANDROIDSIMPLEBUFFERQUEUE,
+                                 SL_IID_METADATAEXTRACTION};
+    const SLboolean req[3] = {SL_BOOLEAN_TRUE, SL_BOOLEAN_TRUE, SL_BOOLEAN_FALSE};
     result = (*slEngine)->CreateAudioPlayer(slEngine,
                                               &recObjectItf_,
                                               &audioSrc,
                                               &audioSnk,
-                                              2, id, req);
+                                              3, id, req);
     SLASSERT(result);
 
     result = (*recObjectItf_)->Realize(recObjectItf_, SL_BOOLEAN_FALSE);
@@ -121,6 +148,14 @@ AudioDecoder::AudioDecoder(SampleFormat *sampleFormat, SLEngineItf slEngine, con
     result = (*recObjectItf_)->GetInterface(recObjectItf_, SL_IID_SEEK, &seekItf_);
     SLASSERT(result);
 
+    // metadata tells the decoded PCM format; optional, without it no
+    // conversion is done
+    result = (*recObjectItf_)->GetInterface(recObjectItf_, SL_IID_METADATAEXTRACTION,
+                                            &metaItf_);
+    if (result != SL_RESULT_SUCCESS) {
+        metaItf_ = NULL;
+    }
+
     result = (*recObjectItf_)->GetInterface(recObjectItf_,
                                             SL_IID_ANDROIDSIMPLEBUFFERQUEUE, &recBufQueueItf_);
     SLASSERT(result);
@@ -147,21 +182,118 @@ AudioDecoder::AudioDecoder(SampleFormat *sampleFormat, SLEngineItf slEngine, con
 
     devShadowQueue_ = new AudioQueue(DEVICE_SHADOW_BUFFER_QUEUE_LEN);
     assert(devShadowQueue_);
-#ifdef ENABLE_LOG
-    std::string name = "rec";
-    recLog_ = new AndroidLog(name);
-#endif
+
+    converter_ = new AudioConverter(&sampleInfo_);
+    assert(converter_);
+    decodeSize_ = 0;    // buffer capacity until the source format is known
+    formatQueried_ = false;
 }
 
-SLboolean AudioDecoder::Resume(void) {
-    LOGI("AudioDecoder::Resume - SL_PLAYSTATE_PLAYING");
-    if (recItf_ != NULL) {
-        (*recItf_)->SetPlayState(recItf_, SL_PLAYSTATE_PLAYING);
+/*
+ * MetadataKeyIs(): true when the size bytes at name hold exactly key,
+ * terminating NUL included
+ */
+static bool MetadataKeyIs(const char *name, SLuint32 size, const char *key) {
+    size_t len = strlen(key) + 1;
+    return size >= len && !memcmp(name, key, len);
+}
+
+/*
+ * QuerySourceFormat(): pick the decoded PCM format out of the Android
+ * metadata keys and hand it to the converter
+ */
+bool AudioDecoder::QuerySourceFormat(void) {
+    if (!metaItf_) {
+        return false;
     }
-    else
-    {
-        LOGE("AudioDecoder::Resume - recItf_ IS null");
+    SLuint32 itemCount;
+    if (SL_RESULT_SUCCESS != (*metaItf_)->GetItemCount(metaItf_, &itemCount)) {
+        return false;
+    }
+
+    SampleFormat srcFormat;
+    memset(&srcFormat, 0, sizeof(srcFormat));
+    // SLMetadataInfo with room for the key/value that follows it
+    union {
+        SLMetadataInfo info;
+        uint8_t        storage[sizeof(SLMetadataInfo) + 64];
+    } key, value;
+    uint32_t found = 0;
+    for (SLuint32 i = 0; i < itemCount; i++) {
+        SLuint32 keySize, valueSize;
+        if (SL_RESULT_SUCCESS != (*metaItf_)->GetKeySize(metaItf_, i, &keySize) ||
+            SL_RESULT_SUCCESS != (*metaItf_)->GetValueSize(metaItf_, i, &valueSize) ||
+            keySize > sizeof(key) || valueSize > sizeof(value) ||
+            SL_RESULT_SUCCESS != (*metaItf_)->GetKey(metaItf_, i, keySize, &key.info) ||
+            SL_RESULT_SUCCESS != (*metaItf_)->GetValue(metaItf_, i, valueSize, &value.info)) {
+            continue;
+        }
+        // read key and value through the storage bytes: data[] is declared
+        // with one element, and the compiler may assume that is all there is
+        const char *name = reinterpret_cast<const char*>(key.storage +
+                                                         offsetof(SLMetadataInfo, data));
+        SLuint32 nameSize = key.info.size;
+        if (nameSize > sizeof(key) - offsetof(SLMetadataInfo, data)) {
+            nameSize = sizeof(key) - offsetof(SLMetadataInfo, data);
+        }
+        SLuint32 data;
+        if (value.info.size < sizeof(data)) {
+            continue;
+        }
+        memcpy(&data, value.storage + offsetof(SLMetadataInfo, data), sizeof(data));
+        if (MetadataKeyIs(name, nameSize, ANDROID_KEY_PCMFORMAT_NUMCHANNELS)) {
+            srcFormat.channels_ = static_cast<uint16_t>(data);
+            found++;
+        } else if (MetadataKeyIs(name, nameSize, ANDROID_KEY_PCMFORMAT_SAMPLERATE)) {
+            srcFormat.sampleRate_ = data * 1000;  // metadata key is in Hz, not milliHz
+            found++;
+        } else if (MetadataKeyIs(name, nameSize, ANDROID_KEY_PCMFORMAT_BITSPERSAMPLE)) {
+            srcFormat.pcmFormat_ = static_cast<uint16_t>(data);
+            found++;
+        }
     }
+    if (found < 3) {
+        return false;
+    }
+    if (srcFormat.pcmFormat_ == SL_PCMSAMPLEFORMAT_FIXED_32) {
+        srcFormat.representation_ = SL_ANDROID_PCM_REPRESENTATION_FLOAT;
+    }
+    srcFormat.framesPerBuf_ = sampleInfo_.framesPerBuf_;
+    return converter_->SetSourceFormat(&srcFormat);
+}
+
+/*
+ * EnqueueForDecoding(): hand free buffers to the decoder, each asking for
+ * decodeSize_ bytes
+ */
+void AudioDecoder::EnqueueForDecoding(sample_buf **bufs, int count) {
+    devShadowQueue_->push_n(bufs, count);
+    for (int i = 0; i < count; i++) {
+        bufs[i]->size_ = decodeSize_ ? decodeSize_ : bufs[i]->cap_;
+        SLresult result = (*recBufQueueItf_)->Enqueue(recBufQueueItf_, bufs[i]->buf_,
+                                                      bufs[i]->size_);
+        SLASSERT(result);
+    }
+}
+
+/*
+ * Resume(): called from the player callback thread through EngineService,
+ * once per low watermark crossing; keep it quiet
+ */
+SLboolean AudioDecoder::Resume(void) {
+    if (recItf_ == NULL) {
+        return SL_BOOLEAN_FALSE;
+    }
+    SLresult result = (*recItf_)->SetPlayState(recItf_, SL_PLAYSTATE_PLAYING);
+    return (result == SL_RESULT_SUCCESS) ? SL_BOOLEAN_TRUE : SL_BOOLEAN_FALSE;
+}
+
+void AudioDecoder::SetBackpressure(BackpressureController *backpressure) {
+    backpressure_ = backpressure;
+}
+
+void AudioDecoder::SetThreadPolicy(ThreadPolicyManager *threads) {
+    threads_ = threads;
 }
 
 void AudioDecoder::Rewind(SLPlayItf caller) {
@@ -196,12 +328,12 @@ SLboolean AudioDecoder::Start(void) {
         freeQueue_->pop();
         assert(buf->buf_ && buf->cap_ && !buf->size_);
 
-        result = (*recBufQueueItf_)->Enqueue(recBufQueueItf_, buf->buf_,
-                                             buf->cap_);
-        SLASSERT(result);
-        devShadowQueue_->push(buf);
+        EnqueueForDecoding(&buf, 1);
     }
 
+    if (backpressure_) {
+        backpressure_->DecoderStarted(GetSystemTicks());
+    }
     result = (*recItf_)->SetPlayState(recItf_, SL_PLAYSTATE_PLAYING);
     SLASSERT(result);
 
@@ -223,11 +355,12 @@ SLboolean AudioDecoder::SoftStart(void) {
     {
         freeQueue_->pop();
         assert(buf->buf_ && buf->cap_ && !buf->size_);
-        result = (*recBufQueueItf_)->Enqueue(recBufQueueItf_, buf->buf_, buf->cap_);
-        SLASSERT(result);
-        devShadowQueue_->push(buf);
+        EnqueueForDecoding(&buf, 1);
     }
 
+    if (backpressure_) {
+        backpressure_->DecoderStarted(GetSystemTicks());
+    }
     result = (*recItf_)->SetPlayState(recItf_, SL_PLAYSTATE_PLAYING);
     SLASSERT(result);
 
@@ -251,13 +384,10 @@ SLboolean  AudioDecoder::Stop(void) {
     sample_buf *buf = NULL;
     while(devShadowQueue_->front(&buf)) {
         devShadowQueue_->pop();
+        buf->size_ = 0;
         freeQueue_->push(buf);
     }
 
-#ifdef ENABLE_LOG
-    recLog_->flush();
-#endif
-
     return SL_BOOLEAN_TRUE;
 }
 
@@ -269,11 +399,7 @@ AudioDecoder::~AudioDecoder() {
 
     if(devShadowQueue_)
         delete (devShadowQueue_);
-#ifdef  ENABLE_LOG
-    if(recLog_) {
-        delete recLog_;
-    }
-#endif
+    delete converter_;
 }
 
 void AudioDecoder::SetBufQueues(AudioQueue *freeQ, AudioQueue *recQ) {
@@ -22,11 +22,15 @@
 #include "audio_common.h"
 #include "buf_manager.h"
 #include "debug_utils.h"
+#include "audio_converter.h"
+#include "backpressure.h"
+#include "thread_policy.h"
 
 class AudioDecoder {
     SLObjectItf recObjectItf_;
     SLPlayItf recItf_;
     SLSeekItf seekItf_;
+    SLMetadataExtractionItf metaItf_;
     SLAndroidSimpleBufferQueueItf recBufQueueItf_;
 
     SampleFormat  sampleInfo_;
@@ -35,9 +39,16 @@ class AudioDecoder {
     AudioQueue *devShadowQueue_;    // owner
     uint32_t    audioBufCount;
 
+    AudioConverter *converter_;     // owner
+    uint32_t    decodeSize_;        // bytes to decode into each buffer
+    bool        formatQueried_;     // QuerySourceFormat() tried already
+
     ENGINE_CALLBACK callback_;
     void           *ctx_;
 
+    BackpressureController *backpressure_;   // user
+    ThreadPolicyManager    *threads_;        // user
+
 public:
     explicit AudioDecoder(SampleFormat *, SLEngineItf engineEngine, const char* uri);
     ~AudioDecoder();
@@ -50,10 +61,12 @@ public:
     void      ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq);
     void      RegisterCallback(ENGINE_CALLBACK cb, void *ctx);
     int32_t   dbgGetDevBufCount(void);
+    void      SetBackpressure(BackpressureController *backpressure);
+    void      SetThreadPolicy(ThreadPolicyManager *threads);
 
-#ifdef  ENABLE_LOG
-    AndroidLog *recLog_;
-#endif
+private:
+    bool      QuerySourceFormat(void);
+    void      EnqueueForDecoding(sample_buf **bufs, int count);
 };
 
 #endif //NATIVE_AUDIO_AUDIO_DECODER_H
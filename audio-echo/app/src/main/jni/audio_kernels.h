@@ -0,0 +1,313 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_AUDIO_KERNELS_H
+#define NATIVE_AUDIO_AUDIO_KERNELS_H
+#include <sys/types.h>
+#include <stdint.h>
+
+/*
+ * Sample processing kernels shared by the audio stages. Each one has a
+ * NEON and an SSE2 body plus a plain C one for whatever is left over
+ * ( and for ABIs built without NEON, e.g. plain armeabi-v7a ).
+ */
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIO_KERNELS_NEON  1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_KERNELS_SSE2  1
+#endif
+
+#define PCM16_TO_FLOAT  (1.0f / 32768.0f)
+#define FLOAT_TO_PCM16  32768.0f
+
+/*
+ * convertPcm16ToFloat(): [-32768, 32767] --> [-1.0, 1.0)
+ */
+__inline__ void convertPcm16ToFloat(const int16_t *src, float *dst, uint32_t count) {
+    uint32_t i = 0;
+#if defined(AUDIO_KERNELS_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t s = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))),
+                                       PCM16_TO_FLOAT));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))),
+                                           PCM16_TO_FLOAT));
+    }
+#elif defined(AUDIO_KERNELS_SSE2)
+    const __m128 scale = _mm_set1_ps(PCM16_TO_FLOAT);
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = src[i] * PCM16_TO_FLOAT;
+    }
+}
+
+/*
+ * convertFloatToPcm16(): [-1.0, 1.0) --> [-32768, 32767], saturating
+ */
+__inline__ void convertFloatToPcm16(const float *src, int16_t *dst, uint32_t count) {
+    uint32_t i = 0;
+#if defined(AUDIO_KERNELS_NEON)
+    for (; i + 8 <= count; i += 8) {
+        // vcvtq saturates to int32, vqmovn saturates to int16
+        int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), FLOAT_TO_PCM16));
+        int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), FLOAT_TO_PCM16));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#elif defined(AUDIO_KERNELS_SSE2)
+    const __m128 scale = _mm_set1_ps(FLOAT_TO_PCM16);
+    const __m128 maxVal = _mm_set1_ps(32767.0f);
+    const __m128 minVal = _mm_set1_ps(-32768.0f);
+    for (; i + 8 <= count; i += 8) {
+        // clamp first: out of range cvtps gives 0x80000000 for both signs
+        __m128 lo = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale),
+                                          maxVal), minVal);
+        __m128 hi = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale),
+                                          maxVal), minVal);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_packs_epi32(_mm_cvttps_epi32(lo), _mm_cvttps_epi32(hi)));
+    }
+#endif
+    for (; i < count; i++) {
+        float s = src[i] * FLOAT_TO_PCM16;
+        s = s > 32767.0f ? 32767.0f : (s < -32768.0f ? -32768.0f : s);
+        dst[i] = static_cast<int16_t>(s);
+    }
+}
+
+/*
+ * dotProduct(): sum of a[i] * b[i]
+ */
+__inline__ float dotProduct(const float *a, const float *b, uint32_t count) {
+    uint32_t i = 0;
+    float sum = 0.0f;
+#if defined(AUDIO_KERNELS_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(half, half), 0);
+#elif defined(AUDIO_KERNELS_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < count; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/*
+ * mixPcm16() / mixFloat(): acc[i] += src[i] * gain, the gain moving by
+ * step every sample ( step 0: constant gain ). acc is in float [-1.0, 1.0)
+ * scale; convertFloatToPcm16() saturates the sum on the way out.
+ */
+__inline__ void mixPcm16(const int16_t *src, float *acc, uint32_t count,
+                         float gain, float step) {
+    uint32_t i = 0;
+    gain *= PCM16_TO_FLOAT;
+    step *= PCM16_TO_FLOAT;
+#if defined(AUDIO_KERNELS_NEON)
+    const float start[4] = { gain, gain + step, gain + 2 * step, gain + 3 * step };
+    float32x4_t g = vld1q_f32(start);
+    const float32x4_t inc = vdupq_n_f32(4 * step);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t s = vld1q_s16(src + i);
+        vst1q_f32(acc + i, vmlaq_f32(vld1q_f32(acc + i),
+                                     vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), g));
+        g = vaddq_f32(g, inc);
+        vst1q_f32(acc + i + 4, vmlaq_f32(vld1q_f32(acc + i + 4),
+                                         vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), g));
+        g = vaddq_f32(g, inc);
+    }
+#elif defined(AUDIO_KERNELS_SSE2)
+    __m128 g = _mm_setr_ps(gain, gain + step, gain + 2 * step, gain + 3 * step);
+    const __m128 inc = _mm_set1_ps(4 * step);
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(lo, g)));
+        g = _mm_add_ps(g, inc);
+        _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(hi, g)));
+        g = _mm_add_ps(g, inc);
+    }
+#endif
+    for (; i < count; i++) {
+        acc[i] += src[i] * (gain + step * i);
+    }
+}
+
+__inline__ void mixFloat(const float *src, float *acc, uint32_t count,
+                         float gain, float step) {
+    uint32_t i = 0;
+#if defined(AUDIO_KERNELS_NEON)
+    const float start[4] = { gain, gain + step, gain + 2 * step, gain + 3 * step };
+    float32x4_t g = vld1q_f32(start);
+    const float32x4_t inc = vdupq_n_f32(4 * step);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(acc + i, vmlaq_f32(vld1q_f32(acc + i), vld1q_f32(src + i), g));
+        g = vaddq_f32(g, inc);
+    }
+#elif defined(AUDIO_KERNELS_SSE2)
+    __m128 g = _mm_setr_ps(gain, gain + step, gain + 2 * step, gain + 3 * step);
+    const __m128 inc = _mm_set1_ps(4 * step);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i),
+                                          _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+        g = _mm_add_ps(g, inc);
+    }
+#endif
+    for (; i < count; i++) {
+        acc[i] += src[i] * (gain + step * i);
+    }
+}
+
+/*
+ * scaleFloat(): buf[i] *= gain, the gain moving by step every sample
+ */
+__inline__ void scaleFloat(float *buf, uint32_t count, float gain, float step) {
+    uint32_t i = 0;
+#if defined(AUDIO_KERNELS_NEON)
+    const float start[4] = { gain, gain + step, gain + 2 * step, gain + 3 * step };
+    float32x4_t g = vld1q_f32(start);
+    const float32x4_t inc = vdupq_n_f32(4 * step);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(buf + i, vmulq_f32(vld1q_f32(buf + i), g));
+        g = vaddq_f32(g, inc);
+    }
+#elif defined(AUDIO_KERNELS_SSE2)
+    __m128 g = _mm_setr_ps(gain, gain + step, gain + 2 * step, gain + 3 * step);
+    const __m128 inc = _mm_set1_ps(4 * step);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(buf + i, _mm_mul_ps(_mm_loadu_ps(buf + i), g));
+        g = _mm_add_ps(g, inc);
+    }
+#endif
+    for (; i < count; i++) {
+        buf[i] *= gain + step * i;
+    }
+}
+
+/*
+ * peakAbsFloat(): largest |buf[i]|
+ */
+__inline__ float peakAbsFloat(const float *buf, uint32_t count) {
+    uint32_t i = 0;
+    float peak = 0.0f;
+#if defined(AUDIO_KERNELS_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        acc = vmaxq_f32(acc, vabsq_f32(vld1q_f32(buf + i)));
+    }
+    float32x2_t half = vmax_f32(vget_low_f32(acc), vget_high_f32(acc));
+    peak = vget_lane_f32(vpmax_f32(half, half), 0);
+#elif defined(AUDIO_KERNELS_SSE2)
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        acc = _mm_max_ps(acc, _mm_and_ps(_mm_loadu_ps(buf + i), absMask));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    peak = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+    peak = lanes[2] > peak ? lanes[2] : peak;
+    peak = lanes[3] > peak ? lanes[3] : peak;
+#endif
+    for (; i < count; i++) {
+        float a = buf[i] < 0.0f ? -buf[i] : buf[i];
+        peak = a > peak ? a : peak;
+    }
+    return peak;
+}
+
+/*
+ * complexMac() / complexMacConj(): y[i] += a[i] * b[i], or conj(a[i]) * b[i],
+ * over complex values kept as split re[] / im[] arrays ( RealFft layout )
+ */
+__inline__ void complexMac(const float *ar, const float *ai,
+                           const float *br, const float *bi,
+                           float *yr, float *yi, uint32_t count) {
+    uint32_t i = 0;
+#if defined(AUDIO_KERNELS_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t xr = vld1q_f32(ar + i), xi = vld1q_f32(ai + i);
+        float32x4_t wr = vld1q_f32(br + i), wi = vld1q_f32(bi + i);
+        float32x4_t sr = vmlaq_f32(vld1q_f32(yr + i), xr, wr);
+        float32x4_t si = vmlaq_f32(vld1q_f32(yi + i), xr, wi);
+        vst1q_f32(yr + i, vmlsq_f32(sr, xi, wi));
+        vst1q_f32(yi + i, vmlaq_f32(si, xi, wr));
+    }
+#elif defined(AUDIO_KERNELS_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 xr = _mm_loadu_ps(ar + i), xi = _mm_loadu_ps(ai + i);
+        __m128 wr = _mm_loadu_ps(br + i), wi = _mm_loadu_ps(bi + i);
+        __m128 pr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+        __m128 pi = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+        _mm_storeu_ps(yr + i, _mm_add_ps(_mm_loadu_ps(yr + i), pr));
+        _mm_storeu_ps(yi + i, _mm_add_ps(_mm_loadu_ps(yi + i), pi));
+    }
+#endif
+    for (; i < count; i++) {
+        yr[i] += ar[i] * br[i] - ai[i] * bi[i];
+        yi[i] += ar[i] * bi[i] + ai[i] * br[i];
+    }
+}
+
+__inline__ void complexMacConj(const float *ar, const float *ai,
+                               const float *br, const float *bi,
+                               float *yr, float *yi, uint32_t count) {
+    uint32_t i = 0;
+#if defined(AUDIO_KERNELS_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t xr = vld1q_f32(ar + i), xi = vld1q_f32(ai + i);
+        float32x4_t wr = vld1q_f32(br + i), wi = vld1q_f32(bi + i);
+        float32x4_t sr = vmlaq_f32(vld1q_f32(yr + i), xr, wr);
+        float32x4_t si = vmlaq_f32(vld1q_f32(yi + i), xr, wi);
+        vst1q_f32(yr + i, vmlaq_f32(sr, xi, wi));
+        vst1q_f32(yi + i, vmlsq_f32(si, xi, wr));
+    }
+#elif defined(AUDIO_KERNELS_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 xr = _mm_loadu_ps(ar + i), xi = _mm_loadu_ps(ai + i);
+        __m128 wr = _mm_loadu_ps(br + i), wi = _mm_loadu_ps(bi + i);
+        __m128 pr = _mm_add_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+        __m128 pi = _mm_sub_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+        _mm_storeu_ps(yr + i, _mm_add_ps(_mm_loadu_ps(yr + i), pr));
+        _mm_storeu_ps(yi + i, _mm_add_ps(_mm_loadu_ps(yi + i), pi));
+    }
+#endif
+    for (; i < count; i++) {
+        yr[i] += ar[i] * br[i] + ai[i] * bi[i];
+        yi[i] += ar[i] * bi[i] - ai[i] * br[i];
+    }
+}
+
+#endif //NATIVE_AUDIO_AUDIO_KERNELS_H
@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 #include <cassert>
+#include <chrono>
 #include <cstring>
+#include <thread>
 #include <jni.h>
 
 #include <sys/types.h>
@@ -24,6 +26,7 @@
 #include "audio_decoder.h"
 #include "audio_recorder.h"
 #include "audio_player.h"
+#include "calibration.h"
 
 struct EchoAudioEngine {
     SLmilliHertz fastPathSampleRate_;
@@ -43,6 +46,17 @@ struct EchoAudioEngine {
     sample_buf  *bufs_;
     uint32_t     bufCount_;
     uint32_t     frameCount_;
+
+    AudioStats  *stats_;              //Owner of the stats
+    JitterController *jitter_;        //Owner of the controller
+    BackpressureController *backpressure_;  //Owner, decoder flow control
+    MappedFileSource *fileSource_;    //Owner, plays instead of decoder_
+    AudioMixer  *mixer_;              //Owner, echo and fileSource_ together
+    ThreadPolicyManager *threads_;    //Owner, scheduling of the callback threads
+    EffectChain *effects_;            //Owner, echo path processing
+    EchoCanceller *aec_;              //Owner, speaker echo out of the recording
+    CaptureWriter *capture_;          //Owner, mic stream archived to a WAV file
+    BufferSizeCalibrator *calibrator_;  //Owner, picks fastPathFramesPerBuf_
 };
 static EchoAudioEngine engine;
 
@@ -68,12 +82,94 @@ JNIEXPORT jboolean JNICALL
         Java_com_google_sample_echo_NativeFastPlayer_createAudioDecoder(JNIEnv *env, jclass type, jbyteArray uri);
 JNIEXPORT void JNICALL
         Java_com_google_sample_echo_NativeFastPlayer_deleteAudioDecoder(JNIEnv *env, jclass type);
+JNIEXPORT jboolean JNICALL
+        Java_com_google_sample_echo_NativeFastPlayer_createFileSource(JNIEnv *env, jclass type, jbyteArray path);
+JNIEXPORT void JNICALL
+        Java_com_google_sample_echo_NativeFastPlayer_deleteFileSource(JNIEnv *env, jclass type);
+JNIEXPORT jboolean JNICALL
+        Java_com_google_sample_echo_NativeFastPlayer_createCaptureWriter(JNIEnv *env, jclass type, jbyteArray path);
+JNIEXPORT void JNICALL
+        Java_com_google_sample_echo_NativeFastPlayer_deleteCaptureWriter(JNIEnv *env, jclass type);
+JNIEXPORT void JNICALL
+        Java_com_google_sample_echo_NativeFastPlayer_setMixGain(JNIEnv *env, jclass type, jint input, jfloat gain);
+JNIEXPORT jboolean JNICALL
+        Java_com_google_sample_echo_NativeFastPlayer_setEffectParam(JNIEnv *env, jclass type, jint node, jint param, jfloat value);
+JNIEXPORT jint JNICALL
+        Java_com_google_sample_echo_NativeFastPlayer_calibrateFramesPerBuf(JNIEnv *env, jclass type, jint windowMs);
+JNIEXPORT jint JNICALL
+        Java_com_google_sample_echo_NativeFastPlayer_getCalibrationResult(JNIEnv *env, jclass type, jintArray result);
 JNIEXPORT void JNICALL
         Java_com_google_sample_echo_NativeFastPlayer_startPlay(JNIEnv *env, jclass type);
 JNIEXPORT void JNICALL
         Java_com_google_sample_echo_NativeFastPlayer_stopPlay(JNIEnv *env, jclass type);
 }
 
+/*
+ * createBufferState(): everything sized by fastPathFramesPerBuf_ -- the
+ * buffer pool with its queues and the stages working a buffer at a time.
+ * Rebuilt by calibrateFramesPerBuf() for every size it tries.
+ */
+static void createBufferState(void) {
+    // compute the RECOMMENDED fast audio buffer size:
+    //   the lower latency required
+    //     *) the smaller the buffer should be (adjust it here) AND
+    //     *) the less buffering should be before starting player AFTER
+    //        receiving the recordered buffer
+    //   Adjust the bufSize here to fit your bill [before it busts]
+    uint32_t bufSize = engine.fastPathFramesPerBuf_ * engine.sampleChannels_
+                       * engine.bitsPerSample_;
+    bufSize = (bufSize + 7) >> 3;            // bits --> byte
+    // one spare frame per buffer: JitterController may repeat a frame
+    uint32_t frameSize = (engine.sampleChannels_ * engine.bitsPerSample_ + 7) >> 3;
+    engine.bufCount_ = BUF_COUNT;
+    engine.bufs_ = allocateSampleBufs(engine.bufCount_, bufSize + frameSize,
+                                      SAMPLE_BUF_MLOCK | SAMPLE_BUF_PREFAULT);
+    assert(engine.bufs_);
+
+    // power of 2 capacity: queue slot indexing becomes a mask
+    engine.freeBufQueue_ = new AudioQueue (engine.bufCount_, true);
+    engine.recBufQueue_  = new AudioQueue (engine.bufCount_, true);
+    assert(engine.freeBufQueue_ && engine.recBufQueue_);
+    for(int i=0; i<engine.bufCount_; i++) {
+        engine.freeBufQueue_->push(&engine.bufs_[i]);
+    }
+
+    SampleFormat sampleFormat;
+    memset(&sampleFormat, 0, sizeof(sampleFormat));
+    sampleFormat.pcmFormat_ = engine.bitsPerSample_;
+    sampleFormat.channels_ = engine.sampleChannels_;
+    sampleFormat.sampleRate_ = engine.fastPathSampleRate_;
+    sampleFormat.framesPerBuf_ = engine.fastPathFramesPerBuf_;
+    engine.jitter_ = new JitterController(&sampleFormat);
+    assert(engine.jitter_);
+
+    // echo path: gain -> EQ -> delay -> limiter, see NativeFastPlayer.setEffectParam()
+    engine.effects_ = new EffectChain(&sampleFormat);
+    assert(engine.effects_);
+    engine.effects_->AddNode(EFFECT_GAIN);
+    engine.effects_->AddNode(EFFECT_BIQUAD);
+    engine.effects_->AddNode(EFFECT_DELAY);
+    engine.effects_->AddNode(EFFECT_LIMITER);
+
+    engine.aec_ = new EchoCanceller(&sampleFormat);
+    assert(engine.aec_);
+}
+
+static void deleteBufferState(void) {
+    delete engine.aec_;
+    delete engine.effects_;
+    delete engine.jitter_;
+    delete engine.recBufQueue_;
+    delete engine.freeBufQueue_;
+    releaseSampleBufs(engine.bufs_, engine.bufCount_);
+    engine.aec_ = nullptr;
+    engine.effects_ = nullptr;
+    engine.jitter_ = nullptr;
+    engine.recBufQueue_ = nullptr;
+    engine.freeBufQueue_ = nullptr;
+    engine.bufs_ = nullptr;
+}
+
 JNIEXPORT void JNICALL
 Java_com_google_sample_echo_NativeFastPlayer_createSLEngine(
         JNIEnv *env, jclass type, jint sampleRate, jint framesPerBuf) {
@@ -94,25 +190,29 @@ Java_com_google_sample_echo_NativeFastPlayer_createSLEngine(
     result = (*engine.slEngineObj_)->GetInterface(engine.slEngineObj_, SL_IID_ENGINE, &engine.slEngineItf_);
     SLASSERT(result);
 
-    // compute the RECOMMENDED fast audio buffer size:
-    //   the lower latency required
-    //     *) the smaller the buffer should be (adjust it here) AND
-    //     *) the less buffering should be before starting player AFTER
-    //        receiving the recordered buffer
-    //   Adjust the bufSize here to fit your bill [before it busts]
-    uint32_t bufSize = engine.fastPathFramesPerBuf_ * engine.sampleChannels_
-                       * engine.bitsPerSample_;
-    bufSize = (bufSize + 7) >> 3;            // bits --> byte
-    engine.bufCount_ = BUF_COUNT;
-    engine.bufs_ = allocateSampleBufs(engine.bufCount_, bufSize);
-    assert(engine.bufs_);
+    engine.stats_ = new AudioStats();
+    assert(engine.stats_);
 
-    engine.freeBufQueue_ = new AudioQueue (engine.bufCount_);
-    engine.recBufQueue_  = new AudioQueue (engine.bufCount_);
-    assert(engine.freeBufQueue_ && engine.recBufQueue_);
-    for(int i=0; i<engine.bufCount_; i++) {
-        engine.freeBufQueue_->push(&engine.bufs_[i]);
-    }
+    engine.backpressure_ = new BackpressureController();
+    assert(engine.backpressure_);
+
+    engine.threads_ = new ThreadPolicyManager();
+    assert(engine.threads_);
+
+    SampleFormat sampleFormat;
+    memset(&sampleFormat, 0, sizeof(sampleFormat));
+    sampleFormat.pcmFormat_ = engine.bitsPerSample_;
+    sampleFormat.channels_ = engine.sampleChannels_;
+    sampleFormat.sampleRate_ = engine.fastPathSampleRate_;
+    sampleFormat.framesPerBuf_ = engine.fastPathFramesPerBuf_;
+    engine.calibrator_ = new BufferSizeCalibrator(&sampleFormat);
+    assert(engine.calibrator_);
+
+    createBufferState();
+
+#ifdef ENABLE_LOG
+    TraceStart(TRACE_FILE_NAME);
+#endif
 }
 
 jboolean createSLBufferQueueAudioPlayer(void)
@@ -133,6 +233,8 @@ jboolean createSLBufferQueueAudioPlayer(void)
 
     engine.player_->SetBufQueue(engine.recBufQueue_, engine.freeBufQueue_);
     engine.player_->RegisterCallback(EngineService, (void*)&engine);
+    engine.player_->SetStats(engine.stats_);
+    engine.player_->SetThreadPolicy(engine.threads_);
 
     return JNI_TRUE;
 }
@@ -171,6 +273,10 @@ Java_com_google_sample_echo_NativeFastPlayer_createAudioRecorder(JNIEnv *env, jc
     }
     engine.recorder_->SetBufQueues(engine.freeBufQueue_, engine.recBufQueue_);
     engine.recorder_->RegisterCallback(EngineService, (void*)&engine);
+    engine.recorder_->SetJitterController(engine.jitter_);
+    engine.recorder_->SetThreadPolicy(engine.threads_);
+    engine.recorder_->SetEffectChain(engine.effects_);
+    engine.recorder_->SetEchoCanceller(engine.aec_);
     return JNI_TRUE;
 }
 
@@ -208,6 +314,8 @@ jboolean createAudioDecoder(void) {
 
     engine.decoder_->SetBufQueues(engine.freeBufQueue_, engine.recBufQueue_);
     engine.decoder_->RegisterCallback(EngineService, (void *) &engine);
+    engine.decoder_->SetBackpressure(engine.backpressure_);
+    engine.decoder_->SetThreadPolicy(engine.threads_);
 
     return JNI_TRUE;
 }
@@ -243,10 +351,238 @@ Java_com_google_sample_echo_NativeFastPlayer_deleteAudioDecoder(JNIEnv *env, jcl
     deleteAudioDecoder();
 }
 
+void deleteFileSource(void)
+{
+    delete engine.fileSource_;
+    engine.fileSource_ = nullptr;
+}
+
+/*
+ * createFileSource(): uncompressed WAV/raw PCM in the fast path format is
+ * played straight out of the mapped file, no decoder and no copies
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_google_sample_echo_NativeFastPlayer_createFileSource(JNIEnv *env, jclass type, jbyteArray path) {
+    jbyte *text_input = env->GetByteArrayElements(path, NULL);
+    jsize size = env->GetArrayLength(path);
+    std::string pathString((char *)text_input, size);
+    env->ReleaseByteArrayElements(path, text_input, JNI_ABORT);
+
+    SampleFormat sampleFormat;
+    memset(&sampleFormat, 0, sizeof(sampleFormat));
+    sampleFormat.pcmFormat_ = static_cast<uint16_t>(engine.bitsPerSample_);
+    sampleFormat.channels_ = engine.sampleChannels_;
+    sampleFormat.sampleRate_ = engine.fastPathSampleRate_;
+    sampleFormat.framesPerBuf_ = engine.fastPathFramesPerBuf_;
+
+    deleteFileSource();
+    engine.fileSource_ = new MappedFileSource(&sampleFormat);
+    if (!engine.fileSource_->Open(pathString.c_str())) {
+        deleteFileSource();
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_google_sample_echo_NativeFastPlayer_deleteFileSource(JNIEnv *env, jclass type) {
+    deleteFileSource();
+}
+
+/*
+ * createMixer(): echo ( input 0 ) with the file source laid over it,
+ * through the one fast path player
+ */
+bool createMixer(void) {
+    SampleFormat sampleFormat;
+    memset(&sampleFormat, 0, sizeof(sampleFormat));
+    sampleFormat.pcmFormat_ = static_cast<uint16_t>(engine.bitsPerSample_);
+    sampleFormat.channels_ = engine.sampleChannels_;
+    sampleFormat.sampleRate_ = engine.fastPathSampleRate_;
+    sampleFormat.framesPerBuf_ = engine.fastPathFramesPerBuf_;
+
+    engine.mixer_ = new AudioMixer(&sampleFormat);
+    // echo waits for its pre-roll ( ENGINE_SERVICE_MSG_KICKSTART_PLAYER )
+    if (engine.mixer_->AddInput(engine.recBufQueue_, engine.freeBufQueue_,
+                                &sampleFormat, 1.0f, false) < 0 ||
+        engine.mixer_->AddInput(engine.fileSource_->PlayQueue(),
+                                engine.fileSource_->FreeQueue(),
+                                &sampleFormat, 1.0f, true) < 0) {
+        delete engine.mixer_;
+        engine.mixer_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * deleteCaptureWriter(): drop the capture writer, if any, closing its file
+ */
+void deleteCaptureWriter(void)
+{
+    delete engine.capture_;
+    engine.capture_ = nullptr;
+}
+
+/*
+ * createCaptureWriter(): archive what the recorder captures into a WAV
+ * file at path, for the next startPlay() .. stopPlay()
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_google_sample_echo_NativeFastPlayer_createCaptureWriter(JNIEnv *env, jclass type, jbyteArray path) {
+    jbyte *text_input = env->GetByteArrayElements(path, NULL);
+    jsize size = env->GetArrayLength(path);
+    std::string pathString((char *)text_input, size);
+    env->ReleaseByteArrayElements(path, text_input, JNI_ABORT);
+
+    SampleFormat sampleFormat;
+    memset(&sampleFormat, 0, sizeof(sampleFormat));
+    sampleFormat.pcmFormat_ = static_cast<uint16_t>(engine.bitsPerSample_);
+    sampleFormat.channels_ = engine.sampleChannels_;
+    sampleFormat.sampleRate_ = engine.fastPathSampleRate_;
+    sampleFormat.framesPerBuf_ = engine.fastPathFramesPerBuf_;
+
+    deleteCaptureWriter();
+    engine.capture_ = new CaptureWriter(&sampleFormat);
+    if (!engine.capture_->Open(pathString.c_str(), true)) {
+        deleteCaptureWriter();
+        return JNI_FALSE;
+    }
+    engine.capture_->SetThreadPolicy(engine.threads_);
+    return JNI_TRUE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_google_sample_echo_NativeFastPlayer_deleteCaptureWriter(JNIEnv *env, jclass type) {
+    deleteCaptureWriter();
+}
+
+/*
+ * setMixGain(): gain of a mixer input ( 0: echo, 1: file ), while playing
+ */
+JNIEXPORT void JNICALL
+Java_com_google_sample_echo_NativeFastPlayer_setMixGain(JNIEnv *env, jclass type,
+                                                        jint input, jfloat gain) {
+    if (engine.mixer_) {
+        engine.mixer_->SetGain(input, gain);
+    }
+}
+
+/*
+ * setEffectParam(): node 0 gain, 1 EQ, 2 delay, 3 limiter; param and
+ * value as in effect_chain.h. Takes effect on the next recorded buffer.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_google_sample_echo_NativeFastPlayer_setEffectParam(JNIEnv *env, jclass type,
+                                                            jint node, jint param, jfloat value) {
+    return engine.effects_->SetParam(node, static_cast<uint32_t>(param), value) ?
+           JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * calibrateFramesPerBuf(): runs the echo path for windowMs ( 0: default )
+ * at 1x, 2x and 4x the framesPerBuf given to createSLEngine(), keeps the
+ * smallest size that ran without underruns / overruns and with bounded
+ * callback jitter, and returns it. Call it right after createSLEngine():
+ * the buffer pool, effect settings and AEC are rebuilt for every size.
+ */
+JNIEXPORT jint JNICALL
+Java_com_google_sample_echo_NativeFastPlayer_calibrateFramesPerBuf(JNIEnv *env, jclass type,
+                                                                   jint windowMs) {
+    if (engine.player_ || engine.recorder_ || engine.decoder_ ||
+        engine.fileSource_ || engine.capture_) {
+        LOGE("====%s: engine is in use, keeping %d frames per buffer",
+             __FUNCTION__, engine.fastPathFramesPerBuf_);
+        return static_cast<jint>(engine.fastPathFramesPerBuf_);
+    }
+
+    engine.calibrator_->Reset(windowMs > 0 ? static_cast<uint32_t>(windowMs) : 0);
+    for (uint32_t i = 0; i < CALIBRATION_CANDIDATES; i++) {
+        engine.fastPathFramesPerBuf_ = engine.calibrator_->Candidate(i);
+        deleteBufferState();
+        createBufferState();
+        if (!createSLBufferQueueAudioPlayer() ||
+            !Java_com_google_sample_echo_NativeFastPlayer_createAudioRecorder(env, type)) {
+            LOGE("====%s: no echo path at %d frames per buffer",
+                 __FUNCTION__, engine.fastPathFramesPerBuf_);
+            deleteSLBufferQueueAudioPlayer();
+            Java_com_google_sample_echo_NativeFastPlayer_deleteAudioRecorder(env, type);
+            continue;
+        }
+        Java_com_google_sample_echo_NativeFastPlayer_startPlay(env, type);
+        std::this_thread::sleep_for(std::chrono::milliseconds(CALIBRATION_SETTLE_MS));
+
+        // measure while running: stopping the recorder first starves the player
+        JitterStats jitter;
+        LatencyStats latency;
+        EngineService(&engine, ENGINE_SERVICE_MSG_GET_JITTER_STATS, &jitter);
+        EngineService(&engine, ENGINE_SERVICE_MSG_GET_LATENCY_STATS, &latency);
+        engine.jitter_->ResetPeaks();
+        engine.calibrator_->Begin(&jitter, &latency);
+        std::this_thread::sleep_for(std::chrono::milliseconds(
+                engine.calibrator_->WindowMs()));
+        EngineService(&engine, ENGINE_SERVICE_MSG_GET_JITTER_STATS, &jitter);
+        EngineService(&engine, ENGINE_SERVICE_MSG_GET_LATENCY_STATS, &latency);
+        engine.calibrator_->End(i, &jitter, &latency);
+        Java_com_google_sample_echo_NativeFastPlayer_stopPlay(env, type);
+    }
+
+    engine.fastPathFramesPerBuf_ = engine.calibrator_->Choose();
+    deleteBufferState();
+    createBufferState();
+    LOGI("Calibration: %d frames per buffer", engine.fastPathFramesPerBuf_);
+    return static_cast<jint>(engine.fastPathFramesPerBuf_);
+}
+
+/*
+ * getCalibrationResult(): CALIBRATION_FIELDS ints per candidate size, laid
+ * out as CalibrationResult, into result; returns the size picked, or 0 when
+ * calibrateFramesPerBuf() did not run
+ */
+JNIEXPORT jint JNICALL
+Java_com_google_sample_echo_NativeFastPlayer_getCalibrationResult(JNIEnv *env, jclass type,
+                                                                  jintArray result) {
+    CalibrationResult results[CALIBRATION_CANDIDATES];
+    uint32_t count = engine.calibrator_->GetResults(results, CALIBRATION_CANDIDATES);
+    static_assert(sizeof(CalibrationResult) == CALIBRATION_FIELDS * sizeof(jint),
+                  "CalibrationResult is handed to Java as an int[]");
+
+    jsize length = env->GetArrayLength(result);
+    jsize fields = static_cast<jsize>(count * CALIBRATION_FIELDS);
+    env->SetIntArrayRegion(result, 0, length < fields ? length : fields,
+                           reinterpret_cast<const jint*>(results));
+    return static_cast<jint>(engine.calibrator_->Chosen());
+}
+
 JNIEXPORT void JNICALL
 Java_com_google_sample_echo_NativeFastPlayer_startPlay(JNIEnv *env, jclass type) {
 
     engine.frameCount_  = 0;
+    engine.stats_->Reset();
+    engine.jitter_->Reset();
+    engine.backpressure_->Reset();
+    engine.threads_->Reset();
+    engine.effects_->ResetStats();
+    engine.aec_->Reset();
+    engine.player_->SetJitterController(engine.recorder_ ? engine.jitter_ : nullptr);
+    engine.player_->SetEchoCanceller(engine.recorder_ ? engine.aec_ : nullptr);
+    engine.player_->SetBackpressure(engine.decoder_ ? engine.backpressure_ : nullptr);
+    if(engine.fileSource_) {
+        // player pulls from the mapped file: prime the play queue for Start()
+        engine.fileSource_->Rewind();
+        engine.fileSource_->Fill();
+        engine.player_->SetFileSource(engine.fileSource_);
+        if(!engine.recorder_) {
+            engine.player_->SetBufQueue(engine.fileSource_->PlayQueue(),
+                                        engine.fileSource_->FreeQueue());
+        } else if(createMixer()) {
+            engine.player_->SetMixer(engine.mixer_);
+        }
+    }
+    if(engine.capture_ && engine.recorder_) {
+        engine.capture_->Start();
+        engine.recorder_->SetCaptureWriter(engine.capture_);
+    }
     /*
      * start player: make it into waitForData state
      */
@@ -264,9 +600,91 @@ Java_com_google_sample_echo_NativeFastPlayer_stopPlay(JNIEnv *env, jclass type)
     if(engine.decoder_) engine.decoder_->Stop();
     engine.player_ ->Stop();
 
+    LatencyStats stats;
+    EngineService(&engine, ENGINE_SERVICE_MSG_GET_LATENCY_STATS, &stats);
+    LOGI("Echo latency(us): P50=%d, P99=%d, Max=%d over %d bufs; "
+         "PlayQ depth: P50=%d, P99=%d, Max=%d",
+         stats.latencyP50_, stats.latencyP99_, stats.latencyMax_,
+         stats.bufCount_, stats.depthP50_, stats.depthP99_, stats.depthMax_);
+
+    JitterStats jitter;
+    EngineService(&engine, ENGINE_SERVICE_MSG_GET_JITTER_STATS, &jitter);
+    LOGI("Jitter(us): rec=%d, play=%d, max rec=%d, play=%d (period=%d); preroll=%d, "
+         "target depth=%d; underruns=%d, overruns=%d, frames dropped=%d, repeated=%d",
+         jitter.recJitterUs_, jitter.playJitterUs_, jitter.recJitterMaxUs_,
+         jitter.playJitterMaxUs_, jitter.periodUs_,
+         jitter.prerollCount_, jitter.targetDepth_, jitter.underruns_,
+         jitter.overruns_, jitter.framesDropped_, jitter.framesRepeated_);
+
+    if(engine.decoder_) {
+        DecoderFlowStats flow;
+        EngineService(&engine, ENGINE_SERVICE_MSG_GET_DECODER_FLOW_STATS, &flow);
+        LOGI("Decoder: pauses=%d (forced=%d), resumes=%d, paused=%dms, bufs=%d; "
+             "PlayQ occupancy: P50=%d, P99=%d, Max=%d over %d callbacks",
+             flow.pauses_, flow.forcedPauses_, flow.resumes_, flow.pausedMs_,
+             flow.decodedBufs_, flow.occupancyP50_, flow.occupancyP99_,
+             flow.occupancyMax_, flow.occupancySamples_);
+    }
+
+    ThreadSchedStats threads[THREAD_ROLE_COUNT];
+    EngineService(&engine, ENGINE_SERVICE_MSG_GET_THREAD_STATS, threads);
+    static const char *roleNames[THREAD_ROLE_COUNT] = {
+        "player", "recorder", "decoder", "helper" };
+    for (uint32_t i = 0; i < THREAD_ROLE_COUNT; i++) {
+        if (!threads[i].tid_) {
+            continue;
+        }
+        LOGI("Thread %s(%d): %s prio=%d on %d cores; wakeup(us): "
+             "P50=%d, P99=%d, Max=%d over %d samples", roleNames[i],
+             threads[i].tid_, threads[i].sched_ == SCHED_OTHER ? "nice" : "rt",
+             threads[i].priority_, threads[i].cpuCount_, threads[i].wakeupP50_,
+             threads[i].wakeupP99_, threads[i].wakeupMax_, threads[i].samples_);
+    }
+
+    if(engine.recorder_) {
+        EffectNodeStats effects[EFFECT_MAX_NODES];
+        EngineService(&engine, ENGINE_SERVICE_MSG_GET_EFFECT_STATS, effects);
+        static const char *typeNames[] = { "gain", "biquad", "delay", "limiter" };
+        for (uint32_t i = 0; i < engine.effects_->NodeCount(); i++) {
+            LOGI("Effect %d %s(ns per buf): P50=%d, P99=%d, Max=%d over %d bufs",
+                 i, typeNames[effects[i].type_], effects[i].costP50Ns_,
+                 effects[i].costP99Ns_, effects[i].costMaxNs_, effects[i].blocks_);
+        }
+    }
+
+    if(engine.recorder_) {
+        AecStats aec;
+        EngineService(&engine, ENGINE_SERVICE_MSG_GET_AEC_STATS, &aec);
+        LOGI("AEC: ERLE=%.1fdB over %d blocks, adapted=%d, double talk=%d, "
+             "resets=%d; reference underruns=%d, dropped=%d samples",
+             aec.erleDb_, aec.blocks_, aec.adaptedBlocks_, aec.doubleTalk_,
+             aec.resets_, aec.refUnderruns_, aec.refDropped_);
+    }
+
+    if(engine.capture_) {
+        // recorder is stopped: this writes out the rest and patches the header
+        engine.capture_->Close();
+        CaptureStats capture;
+        EngineService(&engine, ENGINE_SERVICE_MSG_GET_CAPTURE_STATS, &capture);
+        LOGI("Capture: %lld bytes in %d writes (slowest %dus), %d bufs, "
+             "overruns=%d (%d bytes dropped), write errors=%d, ring peak=%d bytes",
+             static_cast<long long>(capture.fileBytes_), capture.writes_,
+             capture.maxWriteUs_, capture.buffers_, capture.overruns_,
+             capture.droppedBytes_, capture.writeErrors_, capture.ringPeak_);
+    }
+
+    if(engine.mixer_) {
+        LOGI("Mixer: %d bufs mixed, %d silent",
+             engine.mixer_->dbgGetMixedCount(), engine.mixer_->dbgGetSilentCount());
+    }
+
     if(engine.recorder_) delete engine.recorder_;
     if(engine.decoder_) delete engine.decoder_;
     delete engine.player_;
+    delete engine.mixer_;
+    engine.mixer_ = nullptr;
+    deleteFileSource();
+    deleteCaptureWriter();
     engine.recorder_ = NULL;
     engine.decoder_ = NULL;
     engine.player_ = NULL;
@@ -274,9 +692,14 @@ Java_com_google_sample_echo_NativeFastPlayer_stopPlay(JNIEnv *env, jclass type)
 
 JNIEXPORT void JNICALL
 Java_com_google_sample_echo_NativeFastPlayer_deleteSLEngine(JNIEnv *env, jclass type) {
-    delete engine.recBufQueue_;
-    delete engine.freeBufQueue_;
-    releaseSampleBufs(engine.bufs_, engine.bufCount_);
+#ifdef ENABLE_LOG
+    TraceStop();
+#endif
+    deleteBufferState();
+    delete engine.calibrator_;
+    delete engine.threads_;
+    delete engine.backpressure_;
+    delete engine.stats_;
     if (engine.slEngineObj_ != NULL) {
         (*engine.slEngineObj_)->Destroy(engine.slEngineObj_);
         engine.slEngineObj_ = NULL;
@@ -329,7 +752,7 @@ bool EngineService(void* ctx, uint32_t msg, void* data ) {
     assert(ctx == &engine);
     switch (msg) {
         case ENGINE_SERVICE_MSG_KICKSTART_PLAYER:
-            engine.player_->PlayAudioBuffers(PLAY_KICKSTART_BUFFER_COUNT);
+            engine.player_->PlayAudioBuffers(engine.jitter_->PrerollCount());
             // we only allow it to call once, so tell caller do not call
             // anymore
             return false;
@@ -337,7 +760,7 @@ bool EngineService(void* ctx, uint32_t msg, void* data ) {
             *(static_cast<uint32_t*>(data)) = dbgEngineGetBufCount();
             break;
 
-        /*Resume decoding again - typically when the buffer que is getting low on buffers*/
+        /*Resume decoding again - the player drained the play queue to the low watermark*/
         case ENGINE_SERVICE_CONTINUE_DECODING:
             if(engine.decoder_) engine.decoder_->Resume();
             return true;
@@ -352,6 +775,45 @@ bool EngineService(void* ctx, uint32_t msg, void* data ) {
             if(engine.decoder_) restartDecoder();
             return true;
 
+        /*Snapshot of capture-to-playout latency and play queue depth*/
+        case ENGINE_SERVICE_MSG_GET_LATENCY_STATS:
+            engine.stats_->GetLatencyStats(static_cast<LatencyStats*>(data));
+            return true;
+
+        /*Callback jitter, jitter buffer depth and underrun/overrun counters*/
+        case ENGINE_SERVICE_MSG_GET_JITTER_STATS:
+            engine.jitter_->GetStats(static_cast<JitterStats*>(data));
+            return true;
+
+        /*Decoder pause/resume counts and play queue occupancy*/
+        case ENGINE_SERVICE_MSG_GET_DECODER_FLOW_STATS:
+            engine.backpressure_->GetStats(static_cast<DecoderFlowStats*>(data));
+            return true;
+
+        /*Processing time of every effect node, per buffer*/
+        case ENGINE_SERVICE_MSG_GET_EFFECT_STATS:
+            for (uint32_t i = 0; i < engine.effects_->NodeCount(); i++) {
+                engine.effects_->GetNodeStats(i, static_cast<EffectNodeStats*>(data) + i);
+            }
+            return true;
+
+        /*Echo left after cancelling and what kept the canceller from learning*/
+        case ENGINE_SERVICE_MSG_GET_AEC_STATS:
+            engine.aec_->GetStats(static_cast<AecStats*>(data));
+            return true;
+
+        /*What made it into the capture file and what the disk could not take*/
+        case ENGINE_SERVICE_MSG_GET_CAPTURE_STATS:
+            engine.capture_->GetStats(static_cast<CaptureStats*>(data));
+            return true;
+
+        /*Policy each callback thread got and its wakeup-to-run latency*/
+        case ENGINE_SERVICE_MSG_GET_THREAD_STATS:
+            for (uint32_t i = 0; i < THREAD_ROLE_COUNT; i++) {
+                engine.threads_->GetStats(i, static_cast<ThreadSchedStats*>(data) + i);
+            }
+            return true;
+
         default:
             assert(false);
             return false;
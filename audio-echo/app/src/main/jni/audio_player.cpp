@@ -31,10 +31,9 @@ void bqPlayerCallback(SLAndroidSimpleBufferQueueItf bq, void *ctx) {
     (static_cast<AudioPlayer *>(ctx))->ProcessSLCallback(bq);
 }
 void AudioPlayer::ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq) {
-#ifdef ENABLE_LOG
-    logFile_->logTime();
-#endif
-
+    if (threads_) {
+        threads_->OnThreadRunning(THREAD_ROLE_PLAYER);
+    }
     // retrieve the finished device buf and put onto the free queue
     // so recorder could re-use it
     sample_buf *buf;
@@ -51,18 +50,68 @@ void AudioPlayer::ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq) {
         return;
     }
     devShadowQueue_->pop();
-    buf->size_ = 0;
-    freeQueue_->push(buf);
-    while(playQueue_->front(&buf) && devShadowQueue_->push(buf) && buf->size_>0 ) {
-        //LOGI("AudioPlayer::ProcessSLCallback, Enqueue, buf->size_: %d", buf->size_);
-        (*bq)->Enqueue(bq, buf->buf_, buf->size_);
-        playQueue_->pop();
+    if (mixer_) {
+        mixer_->Recycle(buf);
+    } else {
+        buf->size_ = 0;
+        buf->captureTime_ = 0;
+        freeQueue_->push(buf);
     }
 
-    //if the play queue is less than the PLAY_KICKSTART_BUFFER_COUNT, start the PCM decoder again.
-    if (playQueue_->size() < PLAY_KICKSTART_BUFFER_COUNT)
-    {
-        LOGI("AudioPlayer::ProcessSLCallback, playQueue_ too low, start decoding again");
+    uint64_t now = GetSystemTicks();
+    if (source_) {
+        source_->Fill();
+    }
+    if (jitter_) {
+        // measured before the play queue is flushed into the device
+        jitter_->OnPlayerCallback(now,
+                playQueue_->size() + devShadowQueue_->size());
+    }
+
+    int queued = 0;
+    bool starved;
+    if (mixer_) {
+        // one mixed buffer back for every one played, silent or not
+        queued = enqueueMixed(bq, now) ? 1 : 0;
+        starved = !queued && mixer_->IsActive(0);
+    } else {
+        // move as many buffers as the device queue can take in one batch:
+        // only the leading buffers with audio data in them are sent
+        sample_buf *bufs[DEVICE_SHADOW_BUFFER_QUEUE_LEN];
+        int count = playQueue_->peek_n(bufs, devShadowQueue_->space());
+        while (queued < count && bufs[queued]->size_ > 0) {
+            queued++;
+        }
+        devShadowQueue_->push_n(bufs, queued);
+        for (int i = 0; i < queued; i++) {
+            if (jitter_) {
+                jitter_->AdjustBuffer(bufs[i]);
+            }
+            //LOGI("AudioPlayer::ProcessSLCallback, Enqueue, buf->size_: %d", bufs[i]->size_);
+            (*bq)->Enqueue(bq, bufs[i]->buf_, bufs[i]->size_);
+            RecordPlayout(bufs[i], now);
+        }
+        playQueue_->pop_n(queued);
+        starved = !queued;
+    }
+    TRACE(TRACE_EVENT_PLAYER_CALLBACK, playQueue_->size(), queued);
+    if (starved) {
+        TRACE(TRACE_EVENT_PLAYER_STARVED, playQueue_->size(),
+              devShadowQueue_->size());
+        // nothing new to send is only an underrun once the device has
+        // played out everything it had, too
+        if (jitter_ && !devShadowQueue_->size()) {
+            jitter_->OnPlayerUnderrun();
+        }
+    }
+    if (stats_) {
+        stats_->RecordQueueDepth(playQueue_->size());
+    }
+
+    // play queue drained to the low watermark: wake the decoder up, once
+    if (backpressure_ &&
+        backpressure_->OnConsumed(playQueue_->size(), now)) {
+        TRACE(TRACE_EVENT_DECODER_RESUME, playQueue_->size(), 0);
         callback_(ctx_,ENGINE_SERVICE_CONTINUE_DECODING, NULL);
     }
 
@@ -75,7 +124,9 @@ void AudioPlayer::ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq) {
 
 AudioPlayer::AudioPlayer(SampleFormat *sampleFormat, SLEngineItf slEngine) :
     playQueue_(nullptr),freeQueue_(nullptr), devShadowQueue_(nullptr),
-    callback_(nullptr)
+    callback_(nullptr), stats_(nullptr), jitter_(nullptr),
+    backpressure_(nullptr), source_(nullptr), mixer_(nullptr),
+    threads_(nullptr), aec_(nullptr)
 {
     SLresult result;
     assert(sampleFormat);
@@ -134,11 +185,6 @@ AudioPlayer::AudioPlayer(SampleFormat *sampleFormat, SLEngineItf slEngine) :
     // create an empty queue to track deviceQueue
     devShadowQueue_ = new AudioQueue(DEVICE_SHADOW_BUFFER_QUEUE_LEN);
     assert(devShadowQueue_);
-
-#ifdef  ENABLE_LOG
-    std::string name = "play";
-    logFile_ = new AndroidLog(name);
-#endif
 }
 
 AudioPlayer::~AudioPlayer() {
@@ -178,20 +224,31 @@ SLresult AudioPlayer::Start(void) {
     result = (*playItf_)->SetPlayState(playItf_, SL_PLAYSTATE_PLAYING);
     SLASSERT(result);
 
+    if (mixer_) {
+        // the device runs from now on, inputs join in when they have data
+        for (int i = 0; i < MIXER_PRIME_BUF_COUNT; i++) {
+            enqueueMixed(playBufferQueueItf_, GetSystemTicks());
+        }
+        return devShadowQueue_->size() ? SL_BOOLEAN_TRUE : SL_BOOLEAN_FALSE;
+    }
+
     // send pre-defined audio buffers to device
     int i = PLAY_KICKSTART_BUFFER_COUNT;
     while(i--) {
         sample_buf *buf;
+        if(!devShadowQueue_->space())   //device queue is full, the rest goes via callbacks
+            break;
         if(!playQueue_->front(&buf))    //we have buffers for sure
             break;
         if(SL_RESULT_SUCCESS !=
-           (*playBufferQueueItf_)->Enqueue(playBufferQueueItf_, buf, buf->size_))
+           (*playBufferQueueItf_)->Enqueue(playBufferQueueItf_, buf->buf_, buf->size_))
         {
             LOGE("====failed to enqueue (%d) in %s", i, __FUNCTION__);
             return SL_BOOLEAN_FALSE;
         } else {
             playQueue_->pop();
             devShadowQueue_->push(buf);
+            RecordPlayout(buf, GetSystemTicks());
         }
     }
     return SL_BOOLEAN_TRUE;
@@ -217,28 +274,35 @@ void AudioPlayer::Stop(void) {
     // Consume all non-completed audio buffers
     sample_buf *buf = NULL;
     while(devShadowQueue_->front(&buf)) {
-        buf->size_ = 0;
         devShadowQueue_->pop();
+        if (mixer_) {
+            mixer_->Recycle(buf);
+            continue;
+        }
+        buf->size_ = 0;
+        buf->captureTime_ = 0;
         freeQueue_->push(buf);
     }
+    if (mixer_) {
+        mixer_->Flush();
+    }
     while(playQueue_->front(&buf)) {
         buf->size_ = 0;
+        buf->captureTime_ = 0;
         playQueue_->pop();
         freeQueue_->push(buf);
     }
-
-#ifdef ENABLE_LOG
-    if (logFile_) {
-        delete logFile_;
-        logFile_ = nullptr;
-    }
-#endif
 }
 
 void AudioPlayer::PlayAudioBuffers(int32_t count) {
     if(!count) {
         return;
     }
+    if (mixer_) {
+        // device is already running: the pre-rolled input joins the mix
+        mixer_->Activate(0);
+        return;
+    }
 
     while(count--) {
         sample_buf *buf = NULL;
@@ -275,6 +339,7 @@ void AudioPlayer::PlayAudioBuffers(int32_t count) {
             break;
         }
         playQueue_->pop();   // really pop out the buffer
+        RecordPlayout(buf, GetSystemTicks());
     }
 }
 
@@ -283,6 +348,91 @@ void AudioPlayer::RegisterCallback(ENGINE_CALLBACK cb, void *ctx) {
     ctx_ = ctx;
 }
 
+void AudioPlayer::SetStats(AudioStats *stats) {
+    stats_ = stats;
+}
+
+/*
+ * SetJitterController(): only for the echo path, decoded audio is
+ * buffered deep on purpose and must not be steered
+ */
+void AudioPlayer::SetJitterController(JitterController *jitter) {
+    jitter_ = jitter;
+}
+
+/*
+ * SetBackpressure(): only when playing from the decoder
+ */
+void AudioPlayer::SetBackpressure(BackpressureController *backpressure) {
+    backpressure_ = backpressure;
+}
+
+/*
+ * SetFileSource(): the player pulls from the mapped file itself, there is
+ * no producer thread; queues must be the ones of the source
+ */
+void AudioPlayer::SetFileSource(MappedFileSource *source) {
+    source_ = source;
+}
+
+/*
+ * SetMixer(): play the sum of the mixer inputs instead of playQueue_;
+ * playQueue_/freeQueue_ must be input 0 of the mixer. Set before Start().
+ */
+void AudioPlayer::SetMixer(AudioMixer *mixer) {
+    mixer_ = mixer;
+}
+
+void AudioPlayer::SetThreadPolicy(ThreadPolicyManager *threads) {
+    threads_ = threads;
+}
+
+/*
+ * SetEchoCanceller(): every buffer handed to the device becomes the
+ * reference the recorder side cancels against. Set before Start().
+ */
+void AudioPlayer::SetEchoCanceller(EchoCanceller *aec) {
+    aec_ = aec;
+}
+
+/*
+ * enqueueMixed(): mix one buffer and send it to the device. Returns true
+ * when input 0 had audio in it.
+ */
+bool AudioPlayer::enqueueMixed(SLAndroidSimpleBufferQueueItf bq, uint64_t now) {
+    sample_buf *in;
+    bool played = mixer_->IsActive(0) && playQueue_->front(&in) && in->size_;
+    if (played && jitter_) {
+        jitter_->AdjustBuffer(in);
+    }
+    sample_buf *out = mixer_->Mix();
+    if (!out) {
+        return false;
+    }
+    if (SL_RESULT_SUCCESS != (*bq)->Enqueue(bq, out->buf_, out->size_)) {
+        LOGE("====failed to enqueue mixed buffer in %s", __FUNCTION__);
+        mixer_->Recycle(out);
+        return false;
+    }
+    devShadowQueue_->push(out);
+    RecordPlayout(out, now);
+    return played;
+}
+
+/*
+ * RecordPlayout(): buf is handed to the device at "now"; buffers coming
+ * from the recorder carry their capture time, which gives the latency of
+ * the echo path ( excluding the device buffering on both ends )
+ */
+void AudioPlayer::RecordPlayout(sample_buf *buf, uint64_t now) {
+    if (stats_ && buf->captureTime_) {
+        stats_->RecordLatency(now - buf->captureTime_);
+    }
+    if (aec_) {
+        aec_->PushReference(buf);
+    }
+}
+
 uint32_t  AudioPlayer::dbgGetDevBufCount(void) {
     return (devShadowQueue_->size());
 }
\ No newline at end of file
@@ -21,6 +21,12 @@
 #include "audio_common.h"
 #include "buf_manager.h"
 #include "debug_utils.h"
+#include "jitter_controller.h"
+#include "backpressure.h"
+#include "file_source.h"
+#include "mixer.h"
+#include "thread_policy.h"
+#include "echo_canceller.h"
 
 class AudioPlayer {
     // buffer queue player interfaces
@@ -37,11 +43,15 @@ class AudioPlayer {
     ENGINE_CALLBACK callback_;
     void           *ctx_;
 
-    bool decodingFinished = false;
+    AudioStats     *stats_;           // user
+    JitterController *jitter_;        // user
+    BackpressureController *backpressure_;  // user
+    MappedFileSource *source_;        // user
+    AudioMixer     *mixer_;           // user
+    ThreadPolicyManager *threads_;    // user
+    EchoCanceller  *aec_;             // user
 
-#ifdef  ENABLE_LOG
-    AndroidLog  *logFile_;
-#endif
+    bool decodingFinished = false;
 public:
     explicit AudioPlayer(SampleFormat *sampleFormat, SLEngineItf engine);
     ~AudioPlayer();
@@ -53,6 +63,16 @@ public:
     uint32_t    dbgGetDevBufCount(void);
     void        PlayAudioBuffers(int32_t count);
     void        RegisterCallback(ENGINE_CALLBACK cb, void *ctx);
+    void        SetStats(AudioStats *stats);
+    void        SetJitterController(JitterController *jitter);
+    void        SetBackpressure(BackpressureController *backpressure);
+    void        SetFileSource(MappedFileSource *source);
+    void        SetMixer(AudioMixer *mixer);
+    void        SetThreadPolicy(ThreadPolicyManager *threads);
+    void        SetEchoCanceller(EchoCanceller *aec);
+private:
+    void        RecordPlayout(sample_buf *buf, uint64_t now);
+    bool        enqueueMixed(SLAndroidSimpleBufferQueueItf bq, uint64_t now);
 
 };
 
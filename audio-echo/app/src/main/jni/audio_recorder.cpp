@@ -26,30 +26,54 @@ void bqRecorderCallback(SLAndroidSimpleBufferQueueItf bq, void *rec) {
 }
 
 void AudioRecorder::ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq) {
-#ifdef ENABLE_LOG
-    recLog_->logTime();
-#endif
     assert(bq == recBufQueueItf_);
+    uint64_t now = GetSystemTicks();
+    if (threads_) {
+        threads_->OnThreadRunning(THREAD_ROLE_RECORDER);
+    }
+    if (jitter_) {
+        jitter_->OnRecorderCallback(now);
+    }
     sample_buf *dataBuf = NULL;
     devShadowQueue_->front(&dataBuf);
     devShadowQueue_->pop();
-    dataBuf->size_ = dataBuf->cap_;           //device only calls us when it is really full
+    dataBuf->size_ = bufSize_;                //device only calls us when it is really full
+    dataBuf->captureTime_ = now;              // latency is measured from here
+    if (capture_) {
+        capture_->Append(dataBuf);            // the mic as it came, copied off
+    }
+    if (aec_) {
+        aec_->Process(dataBuf);               // what the speaker put in, out first
+    }
+    if (effects_) {
+        effects_->Process(dataBuf);           // in place, before the player sees it
+    }
     recQueue_->push(dataBuf);
 
-    sample_buf* freeBuf;
-    while (freeQueue_->front(&freeBuf) && devShadowQueue_->push(freeBuf)) {
-        freeQueue_->pop();
-        SLresult result = (*bq)->Enqueue(bq, freeBuf->buf_, freeBuf->cap_);
+    // refill the device queue with one batch from the free queue
+    sample_buf* freeBufs[DEVICE_SHADOW_BUFFER_QUEUE_LEN];
+    int count = freeQueue_->pop_n(freeBufs, devShadowQueue_->space());
+    devShadowQueue_->push_n(freeBufs, count);
+    for (int i = 0; i < count; i++) {
+        SLresult result = (*bq)->Enqueue(bq, freeBufs[i]->buf_, bufSize_);
         SLASSERT(result);
     }
+    TRACE(TRACE_EVENT_RECORDER_CALLBACK, recQueue_->size(), count);
+    if (!count && jitter_) {
+        jitter_->OnRecorderOverrun();     // player is not returning buffers
+    }
 
     /*
-     * PLAY_KICKSTART_BUFFER_COUNT: # of buffers cached in the queue before
-     * STARTING player. it is defined in audio_common.h. Whatever buffered
-     * here is the part of the audio LATENCY! adjust to fit your bill [ until
-     * it busts ]
+     * # of buffers cached in the queue before STARTING player: whatever
+     * buffered here is the part of the audio LATENCY! JitterController
+     * picks the smallest count that covers the measured callback jitter,
+     * without it we wait for PLAY_KICKSTART_BUFFER_COUNT ( audio_common.h )
      */
-    if(++audioBufCount == PLAY_KICKSTART_BUFFER_COUNT && callback_) {
+    ++audioBufCount;
+    if (!playerKicked_ && callback_ &&
+        (jitter_ ? jitter_->PrerollReady(audioBufCount) :
+                   audioBufCount == PLAY_KICKSTART_BUFFER_COUNT)) {
+        playerKicked_ = true;
         callback_(ctx_, ENGINE_SERVICE_MSG_KICKSTART_PLAYER, NULL);
     }
 
@@ -60,11 +84,14 @@ void AudioRecorder::ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq) {
 }
 
 AudioRecorder::AudioRecorder(SampleFormat *sampleFormat, SLEngineItf slEngine) :
-        freeQueue_(nullptr), devShadowQueue_(nullptr), recQueue_(nullptr),
-        callback_(nullptr)
+        freeQueue_(nullptr), recQueue_(nullptr), devShadowQueue_(nullptr),
+        playerKicked_(false), jitter_(nullptr), threads_(nullptr),
+        effects_(nullptr), aec_(nullptr), capture_(nullptr), callback_(nullptr)
 {
     SLresult result;
     sampleInfo_ = *sampleFormat;
+    bufSize_ = sampleInfo_.framesPerBuf_ * sampleInfo_.channels_ *
+               (sampleInfo_.pcmFormat_ >> 3);
     SLAndroidDataFormat_PCM_EX format_pcm;
     ConvertToSLSampleFormat(&format_pcm, &sampleInfo_);
 
@@ -109,10 +136,6 @@ AudioRecorder::AudioRecorder(SampleFormat *sampleFormat, SLEngineItf slEngine) :
 
     devShadowQueue_ = new AudioQueue(DEVICE_SHADOW_BUFFER_QUEUE_LEN);
     assert(devShadowQueue_);
-#ifdef ENABLE_LOG
-    std::string name = "rec";
-    recLog_ = new AndroidLog(name);
-#endif
 }
 
 SLboolean AudioRecorder::Start(void) {
@@ -121,6 +144,7 @@ SLboolean AudioRecorder::Start(void) {
         return SL_BOOLEAN_FALSE;
     }
     audioBufCount = 0;
+    playerKicked_ = false;
 
     SLresult result;
     // in case already recording, stop recording and clear buffer queue
@@ -136,10 +160,10 @@ SLboolean AudioRecorder::Start(void) {
             break;
         }
         freeQueue_->pop();
-        assert(buf->buf_ && buf->cap_ && !buf->size_);
+        assert(buf->buf_ && buf->cap_ >= bufSize_ && !buf->size_);
 
         result = (*recBufQueueItf_)->Enqueue(recBufQueueItf_, buf->buf_,
-                                                 buf->cap_);
+                                                 bufSize_);
         SLASSERT(result);
         devShadowQueue_->push(buf);
     }
@@ -170,10 +194,6 @@ SLboolean  AudioRecorder::Stop(void) {
         freeQueue_->push(buf);
     }
 
-#ifdef ENABLE_LOG
-    recLog_->flush();
-#endif
-
     return SL_BOOLEAN_TRUE;
 }
 
@@ -185,11 +205,6 @@ AudioRecorder::~AudioRecorder() {
 
     if(devShadowQueue_)
         delete (devShadowQueue_);
-#ifdef  ENABLE_LOG
-    if(recLog_) {
-        delete recLog_;
-    }
-#endif
 }
 
 void AudioRecorder::SetBufQueues(AudioQueue *freeQ, AudioQueue *recQ) {
@@ -202,6 +217,27 @@ void AudioRecorder::RegisterCallback(ENGINE_CALLBACK cb, void *ctx) {
     callback_ = cb;
     ctx_ = ctx;
 }
+
+void AudioRecorder::SetJitterController(JitterController *jitter) {
+    jitter_ = jitter;
+}
+
+void AudioRecorder::SetThreadPolicy(ThreadPolicyManager *threads) {
+    threads_ = threads;
+}
+
+void AudioRecorder::SetEffectChain(EffectChain *effects) {
+    effects_ = effects;
+}
+
+void AudioRecorder::SetEchoCanceller(EchoCanceller *aec) {
+    aec_ = aec;
+}
+
+void AudioRecorder::SetCaptureWriter(CaptureWriter *capture) {
+    capture_ = capture;
+}
+
 int32_t AudioRecorder::dbgGetDevBufCount(void) {
      return devShadowQueue_->size();
 }
@@ -22,6 +22,11 @@
 #include "audio_common.h"
 #include "buf_manager.h"
 #include "debug_utils.h"
+#include "jitter_controller.h"
+#include "thread_policy.h"
+#include "effect_chain.h"
+#include "echo_canceller.h"
+#include "capture_writer.h"
 
 class AudioRecorder {
     SLObjectItf recObjectItf_;
@@ -33,6 +38,13 @@ class AudioRecorder {
     AudioQueue *recQueue_;          // user
     AudioQueue *devShadowQueue_;    // owner
     uint32_t    audioBufCount;
+    uint32_t    bufSize_;           // bytes per device buffer
+    bool        playerKicked_;
+    JitterController *jitter_;      // user
+    ThreadPolicyManager *threads_;  // user
+    EffectChain *effects_;          // user
+    EchoCanceller *aec_;            // user
+    CaptureWriter *capture_;        // user
 
     ENGINE_CALLBACK callback_;
     void           *ctx_;
@@ -45,11 +57,12 @@ public:
     void      SetBufQueues(AudioQueue *freeQ, AudioQueue *recQ);
     void      ProcessSLCallback(SLAndroidSimpleBufferQueueItf bq);
     void      RegisterCallback(ENGINE_CALLBACK cb, void *ctx);
+    void      SetJitterController(JitterController *jitter);
+    void      SetThreadPolicy(ThreadPolicyManager *threads);
+    void      SetEffectChain(EffectChain *effects);
+    void      SetEchoCanceller(EchoCanceller *aec);
+    void      SetCaptureWriter(CaptureWriter *capture);
     int32_t   dbgGetDevBufCount(void);
-
-#ifdef  ENABLE_LOG
-    AndroidLog *recLog_;
-#endif
 };
 
 #endif //NATIVE_AUDIO_AUDIO_RECORDER_H
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "audio_stats.h"
+
+AudioHistogram::AudioHistogram(uint32_t binWidth, uint32_t binCount) :
+    binWidth_(binWidth), binCount_(binCount), count_(0), max_(0) {
+    assert(binWidth_ && binCount_);
+    bins_ = new std::atomic<uint32_t>[binCount_];
+    Reset();
+}
+
+AudioHistogram::~AudioHistogram() {
+    delete [] bins_;
+}
+
+void AudioHistogram::Record(uint32_t value) {
+    uint32_t bin = value / binWidth_;
+    if (bin >= binCount_) {
+        bin = binCount_ - 1;
+    }
+    bins_[bin].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t curMax = max_.load(std::memory_order_relaxed);
+    while (value > curMax &&
+           !max_.compare_exchange_weak(curMax, value, std::memory_order_relaxed)) {
+        // curMax reloaded by compare_exchange_weak()
+    }
+}
+
+void AudioHistogram::Reset(void) {
+    for (uint32_t i = 0; i < binCount_; i++) {
+        bins_[i].store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint32_t AudioHistogram::Count(void) {
+    return count_.load(std::memory_order_relaxed);
+}
+
+uint32_t AudioHistogram::Max(void) {
+    return max_.load(std::memory_order_relaxed);
+}
+
+uint32_t AudioHistogram::Percentile(uint32_t percent) {
+    uint32_t total = Count();
+    if (!total) {
+        return 0;
+    }
+    // rank of the sample we are after, rounded up
+    uint64_t rank = (static_cast<uint64_t>(total) * percent + 99) / 100;
+    uint64_t seen = 0;
+    uint32_t bin = binCount_ - 1;
+    for (uint32_t i = 0; i < binCount_; i++) {
+        seen += bins_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            bin = i;
+            break;
+        }
+    }
+    // largest value the bin holds, but nothing above what was recorded:
+    // the last bin also takes everything beyond the histogram range
+    uint32_t value = (bin + 1) * binWidth_ - 1;
+    uint32_t max = Max();
+    return (value > max || bin == binCount_ - 1) ? max : value;
+}
+
+AudioStats::AudioStats() :
+    latency_(LATENCY_BIN_WIDTH_US, LATENCY_BIN_COUNT),
+    queueDepth_(1, QUEUE_DEPTH_BIN_COUNT) {
+}
+
+void AudioStats::RecordLatency(uint64_t latencyInUs) {
+    latency_.Record(latencyInUs > UINT32_MAX ?
+                    UINT32_MAX : static_cast<uint32_t>(latencyInUs));
+}
+
+void AudioStats::RecordQueueDepth(uint32_t depth) {
+    queueDepth_.Record(depth);
+}
+
+void AudioStats::GetLatencyStats(LatencyStats *stats) {
+    assert(stats);
+    memset(stats, 0, sizeof(*stats));
+    stats->bufCount_   = latency_.Count();
+    stats->latencyP50_ = latency_.Percentile(50);
+    stats->latencyP99_ = latency_.Percentile(99);
+    stats->latencyMax_ = latency_.Max();
+
+    stats->depthSamples_ = queueDepth_.Count();
+    // depth bins are 1 buffer wide: percentiles are exact depths
+    stats->depthP50_ = queueDepth_.Percentile(50);
+    stats->depthP99_ = queueDepth_.Percentile(99);
+    stats->depthMax_ = queueDepth_.Max();
+}
+
+void AudioStats::Reset(void) {
+    latency_.Reset();
+    queueDepth_.Reset();
+}
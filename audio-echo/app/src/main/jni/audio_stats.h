@@ -0,0 +1,79 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_AUDIO_STATS_H
+#define NATIVE_AUDIO_AUDIO_STATS_H
+#include <sys/types.h>
+#include <atomic>
+
+/*
+ * Histogram controls: capture-to-playout latency is binned in
+ * LATENCY_BIN_WIDTH_US steps, queue depth in single buffers. Anything
+ * beyond the last bin lands in the last bin.
+ */
+#define LATENCY_BIN_WIDTH_US      250
+#define LATENCY_BIN_COUNT         1024      // up to 256 ms
+#define QUEUE_DEPTH_BIN_COUNT     256
+
+/*
+ * AudioHistogram: fixed bin histogram. Record() is wait-free and safe to
+ * call from the audio callback threads; readers get a (slightly racy but
+ * consistent enough) snapshot while recording goes on.
+ */
+class AudioHistogram {
+public:
+    explicit AudioHistogram(uint32_t binWidth, uint32_t binCount);
+    ~AudioHistogram();
+    void     Record(uint32_t value);
+    void     Reset(void);
+    uint32_t Count(void);
+    uint32_t Max(void);
+    uint32_t Percentile(uint32_t percent);   // top of the bin, at most Max()
+private:
+    uint32_t binWidth_;
+    uint32_t binCount_;
+    std::atomic<uint32_t> *bins_;
+    std::atomic<uint32_t>  count_;
+    std::atomic<uint32_t>  max_;
+};
+
+/*
+ * snapshot handed out with ENGINE_SERVICE_MSG_GET_LATENCY_STATS
+ */
+struct LatencyStats {
+    uint32_t  bufCount_;        // buffers measured capture -> playout
+    uint32_t  latencyP50_;      // in micro sec
+    uint32_t  latencyP99_;
+    uint32_t  latencyMax_;
+    uint32_t  depthSamples_;    // player callbacks sampled
+    uint32_t  depthP50_;        // play queue depth, in buffers
+    uint32_t  depthP99_;
+    uint32_t  depthMax_;
+};
+
+class AudioStats {
+public:
+    AudioStats();
+    void RecordLatency(uint64_t latencyInUs);
+    void RecordQueueDepth(uint32_t depth);
+    void GetLatencyStats(LatencyStats *stats);
+    void Reset(void);
+private:
+    AudioHistogram latency_;
+    AudioHistogram queueDepth_;
+};
+
+#endif //NATIVE_AUDIO_AUDIO_STATS_H
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cassert>
+#include "backpressure.h"
+
+#define DECODER_STATE_RUNNING   0
+#define DECODER_STATE_PAUSED    1
+
+BackpressureController::BackpressureController() :
+    occupancy_(OCCUPANCY_BIN_WIDTH, OCCUPANCY_BIN_COUNT) {
+    Reset();
+}
+
+void BackpressureController::Reset(void) {
+    state_.store(DECODER_STATE_RUNNING);
+    lastChange_.store(0);
+    pauses_.store(0);
+    resumes_.store(0);
+    forcedPauses_.store(0);
+    decodedBufs_.store(0);
+    pausedUs_.store(0);
+    occupancy_.Reset();
+}
+
+/*
+ * DecoderStarted(): a (re)started decoder is playing whatever state we
+ * thought it was in
+ */
+void BackpressureController::DecoderStarted(uint64_t now) {
+    uint64_t prevChange = lastChange_.exchange(now);
+    if (state_.exchange(DECODER_STATE_RUNNING) == DECODER_STATE_PAUSED) {
+        pausedUs_.fetch_add(now - prevChange, std::memory_order_relaxed);
+    }
+}
+
+/*
+ * changeState(): one edge from -> to. Refused while the previous edge is
+ * younger than DECODER_MIN_STATE_US unless forced; the caller simply asks
+ * again on its next callback.
+ */
+bool BackpressureController::changeState(uint32_t from, uint32_t to,
+                                         uint64_t now, bool force) {
+    uint64_t prevChange = lastChange_.load();
+    if (!force && now - prevChange < DECODER_MIN_STATE_US) {
+        return false;
+    }
+    if (!state_.compare_exchange_strong(from, to)) {
+        return false;
+    }
+    lastChange_.store(now);
+    if (to == DECODER_STATE_RUNNING) {
+        pausedUs_.fetch_add(now - prevChange, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool BackpressureController::OnDecoded(uint32_t queueDepth, uint64_t now) {
+    decodedBufs_.fetch_add(1, std::memory_order_relaxed);
+    if (queueDepth < DECODER_HIGH_WATERMARK) {
+        return false;
+    }
+    if (changeState(DECODER_STATE_RUNNING, DECODER_STATE_PAUSED, now, false)) {
+        pauses_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (queueDepth >= DECODER_HARD_LIMIT &&
+        changeState(DECODER_STATE_RUNNING, DECODER_STATE_PAUSED, now, true)) {
+        pauses_.fetch_add(1, std::memory_order_relaxed);
+        forcedPauses_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool BackpressureController::OnConsumed(uint32_t queueDepth, uint64_t now) {
+    occupancy_.Record(queueDepth);
+    if (queueDepth > DECODER_LOW_WATERMARK) {
+        return false;
+    }
+    if (changeState(DECODER_STATE_PAUSED, DECODER_STATE_RUNNING, now, false)) {
+        resumes_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool BackpressureController::IsPaused(void) {
+    return state_.load() == DECODER_STATE_PAUSED;
+}
+
+void BackpressureController::GetStats(DecoderFlowStats *stats) {
+    assert(stats);
+    stats->pauses_       = pauses_.load(std::memory_order_relaxed);
+    stats->resumes_      = resumes_.load(std::memory_order_relaxed);
+    stats->forcedPauses_ = forcedPauses_.load(std::memory_order_relaxed);
+    stats->decodedBufs_  = decodedBufs_.load(std::memory_order_relaxed);
+    stats->pausedMs_     = static_cast<uint32_t>(
+            pausedUs_.load(std::memory_order_relaxed) / 1000);
+    stats->occupancySamples_ = occupancy_.Count();
+    stats->occupancyP50_ = occupancy_.Percentile(50);
+    stats->occupancyP99_ = occupancy_.Percentile(99);
+    stats->occupancyMax_ = occupancy_.Max();
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_BACKPRESSURE_H
+#define NATIVE_AUDIO_BACKPRESSURE_H
+#include <sys/types.h>
+#include <atomic>
+#include "audio_common.h"
+#include "audio_stats.h"
+
+/*
+ * Decoder flow control, in buffers of the play queue:
+ *   DECODER_HIGH_WATERMARK: decoder pauses once the queue gets this deep
+ *   DECODER_LOW_WATERMARK:  and resumes once the player drained it to here
+ *   DECODER_HARD_LIMIT:     pause right away, whatever the rate limit says;
+ *        keeps enough free buffers around for the decoder device queue
+ *   DECODER_MIN_STATE_US:   shortest time between two state changes
+ * the gap between the watermarks is the size of one decoding burst
+ */
+#define DECODER_HIGH_WATERMARK      (BUF_COUNT * 3 / 4)
+#define DECODER_LOW_WATERMARK       (BUF_COUNT / 4)
+#define DECODER_HARD_LIMIT          (BUF_COUNT - 2 * DEVICE_SHADOW_BUFFER_QUEUE_LEN)
+#define DECODER_MIN_STATE_US        20000
+#define OCCUPANCY_BIN_WIDTH         8
+#define OCCUPANCY_BIN_COUNT         (BUF_COUNT / OCCUPANCY_BIN_WIDTH)
+
+/*
+ * snapshot handed out with ENGINE_SERVICE_MSG_GET_DECODER_FLOW_STATS
+ */
+struct DecoderFlowStats {
+    uint32_t  pauses_;            // decoder paused at the high watermark
+    uint32_t  resumes_;           // decoder resumed at the low watermark
+    uint32_t  forcedPauses_;      // paused at the hard limit, rate limit ignored
+    uint32_t  decodedBufs_;       // buffers the decoder delivered
+    uint32_t  pausedMs_;          // total time spent paused
+    uint32_t  occupancySamples_;  // player callbacks sampled
+    uint32_t  occupancyP50_;      // play queue depth, in buffers
+    uint32_t  occupancyP99_;
+    uint32_t  occupancyMax_;
+};
+
+/*
+ * BackpressureController: hysteresis between the decoder ( producer ) and
+ * the player ( consumer ) of the play queue. The decoder fills the queue
+ * in one burst up to the high watermark and then sleeps until the player
+ * drained it to the low watermark, instead of flipping its play state on
+ * every callback around a single threshold.
+ *
+ * Both sides only ask whether to change state; exactly one caller wins a
+ * transition, so SetPlayState() is issued once per edge. Nothing here
+ * blocks or logs: safe for the callback threads.
+ */
+class BackpressureController {
+public:
+    BackpressureController();
+    void  Reset(void);
+    void  DecoderStarted(uint64_t now);
+
+    // decoder callback thread: true when the decoder should pause now
+    bool  OnDecoded(uint32_t queueDepth, uint64_t now);
+    // player callback thread: true when the decoder should resume now
+    bool  OnConsumed(uint32_t queueDepth, uint64_t now);
+
+    bool  IsPaused(void);
+    void  GetStats(DecoderFlowStats *stats);
+
+private:
+    bool  changeState(uint32_t from, uint32_t to, uint64_t now, bool force);
+
+    std::atomic<uint32_t>  state_;
+    std::atomic<uint64_t>  lastChange_;      // time of the last transition
+    std::atomic<uint32_t>  pauses_;
+    std::atomic<uint32_t>  resumes_;
+    std::atomic<uint32_t>  forcedPauses_;
+    std::atomic<uint32_t>  decodedBufs_;
+    std::atomic<uint64_t>  pausedUs_;
+    AudioHistogram         occupancy_;
+};
+
+#endif //NATIVE_AUDIO_BACKPRESSURE_H
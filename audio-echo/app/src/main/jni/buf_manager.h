@@ -16,11 +16,15 @@
 #ifndef NATIVE_AUDIO_BUF_MANAGER_H
 #define NATIVE_AUDIO_BUF_MANAGER_H
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <SLES/OpenSLES.h>
 #include <atomic>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <limits>
+#include "android_debug.h"
 
 #ifndef CACHE_ALIGN
 #define CACHE_ALIGN 64
@@ -28,6 +32,14 @@
 
 /*
  * ProducerConsumerQueue, borrowed from Ian NiLewis
+ *
+ * Single producer, single consumer lock free queue. Besides the one-element
+ * push()/front()/pop() interface, push_n()/peek_n()/pop_n() move a batch of
+ * elements with one acquire load and one release store, which is what the
+ * audio callbacks want when they shuffle several buffers per callback.
+ * When the capacity is a power of two ( or the queue is created with
+ * pow2Capacity = true, which rounds capacity up ), slot indexing is a mask
+ * instead of a modulo.
  */
 template <typename T>
 class ProducerConsumerQueue {
@@ -35,9 +47,11 @@ public:
     explicit ProducerConsumerQueue(int size)
             : ProducerConsumerQueue(size, new T[size]) {}
 
+    explicit ProducerConsumerQueue(int size, bool pow2Capacity)
+            : ProducerConsumerQueue(pow2Capacity ? roundUpPow2(size) : size) {}
 
     explicit ProducerConsumerQueue(int size, T* buffer)
-            : size_(size), buffer_(buffer) {
+            : size_(size), mask_(isPow2(size) ? size - 1 : 0), buffer_(buffer) {
 
         // This is necessary because we depend on twos-complement wraparound
         // to take care of overflow conditions.
@@ -98,13 +112,36 @@ public:
             result = true;
 
             // writer
-            if (writer(buffer_.get() + (writeptr % size_))) {
+            if (writer(slot(writeptr))) {
                 ++writeptr;
                 write_.store(writeptr, std::memory_order_release);
             }
         }
         return result;
     }
+
+    /*
+     * push_n(): push up to count items, publish all of them with one
+     * release store. Returns the number of items actually pushed.
+     */
+    int push_n(const T* items, int count) {
+        int readptr = read_.load(std::memory_order_acquire);
+        int writeptr = write_.load(std::memory_order_relaxed);
+
+        int space = size_ - (int)(writeptr - readptr);
+        if (count > space) {
+            count = space;
+        }
+        if (count <= 0) {
+            return 0;
+        }
+        for (int i = 0; i < count; i++) {
+            *slot(writeptr + i) = items[i];
+        }
+        write_.store(writeptr + count, std::memory_order_release);
+        return count;
+    }
+
     // front out the queue, but not pop-out
     bool front(T* out_item) {
         return front([&](T* ptr)-> bool {*out_item = *ptr; return true;});
@@ -127,11 +164,51 @@ public:
         int available = (int)(writeptr - readptr);
         if (available >= 1) {
             result = true;
-            reader(buffer_.get() + (readptr % size_));
+            reader(slot(readptr));
         }
 
         return result;
     }
+
+    /*
+     * peek_n(): copy up to count items from the front of the queue without
+     * removing them. Returns the number of items copied.
+     */
+    int peek_n(T* items, int count) {
+        int writeptr = write_.load(std::memory_order_acquire);
+        int readptr = read_.load(std::memory_order_relaxed);
+
+        int available = (int)(writeptr - readptr);
+        if (count > available) {
+            count = available;
+        }
+        for (int i = 0; i < count; i++) {
+            items[i] = *slot(readptr + i);
+        }
+        return (count > 0 ? count : 0);
+    }
+
+    /*
+     * pop_n(): remove up to count items, copying them out, and release all
+     * of the slots with one store. Returns the number of items removed.
+     */
+    int pop_n(T* items, int count) {
+        count = peek_n(items, count);
+        if (count) {
+            pop_n(count);
+        }
+        return count;
+    }
+
+    /*
+     * pop_n(): drop count items already examined with peek_n()
+     */
+    void pop_n(int count) {
+        int readptr = read_.load(std::memory_order_relaxed);
+        assert(count <= (int)(write_.load(std::memory_order_acquire) - readptr));
+        read_.store(readptr + count, std::memory_order_release);
+    }
+
     uint32_t size(void) {
         int writeptr = write_.load(std::memory_order_acquire);
         int readptr = read_.load(std::memory_order_relaxed);
@@ -139,9 +216,37 @@ public:
         return (uint32_t)(writeptr - readptr);
     }
 
+    // free slots as seen from the producer side
+    uint32_t space(void) {
+        int readptr = read_.load(std::memory_order_acquire);
+        int writeptr = write_.load(std::memory_order_relaxed);
+
+        return (uint32_t)(size_ - (int)(writeptr - readptr));
+    }
+
+    uint32_t capacity(void) const {
+        return (uint32_t)size_;
+    }
+
 private:
+    static bool isPow2(int n) {
+        return (n > 0) && !(n & (n - 1));
+    }
+    static int roundUpPow2(int n) {
+        int pow2 = 1;
+        while (pow2 < n) {
+            pow2 <<= 1;
+        }
+        return pow2;
+    }
+    T* slot(int ptr) {
+        // masking keeps working across the int wraparound, modulo does not
+        return buffer_.get() + (mask_ ? (ptr & mask_) : (ptr % size_));
+    }
+
     int size_;
-    std::unique_ptr<T> buffer_;
+    int mask_;        // size_ - 1 when size_ is a power of two, otherwise 0
+    std::unique_ptr<T[]> buffer_;
 
     // forcing cache line alignment to eliminate false sharing of the
     // frequently-updated read and write pointers. The object is to never
@@ -155,43 +260,74 @@ struct sample_buf {
     uint8_t    *buf_;       // audio sample container
     uint32_t    cap_;       // buffer capacity in byte
     uint32_t    size_;      // audio sample size (n buf) in byte
+    uint64_t    captureTime_;  // GetSystemTicks() when recorded, 0 otherwise
 };
 
 using AudioQueue = ProducerConsumerQueue<sample_buf*>;
 
+/*
+ * sample_buf pool: all of the sample_buf descriptors and audio payloads
+ * are carved out of ONE CACHE_ALIGN aligned allocation:
+ *   [ sample_buf descriptors ][ buf 0 ][ buf 1 ] ... [ buf count-1 ]
+ * descriptors stay in a dense array at the front, every payload starts on
+ * its own cache line. Flags for allocateSampleBufs():
+ *   SAMPLE_BUF_MLOCK:    lock the pool into memory ( falls back to
+ *                        SAMPLE_BUF_PREFAULT when mlock() is not permitted )
+ *   SAMPLE_BUF_PREFAULT: touch every page now so the audio callbacks
+ *                        do not take page faults on first use
+ */
+#define SAMPLE_BUF_MLOCK      0x01
+#define SAMPLE_BUF_PREFAULT   0x02
+
+__inline__ uint32_t sampleBufDescSize(uint32_t count) {
+    return (sizeof(sample_buf) * count + CACHE_ALIGN - 1) & ~(CACHE_ALIGN - 1);
+}
+__inline__ uint32_t sampleBufStride(uint32_t sizeInByte) {
+    return (sizeInByte + CACHE_ALIGN - 1) & ~(CACHE_ALIGN - 1);
+}
+
 __inline__ void releaseSampleBufs(sample_buf* bufs, uint32_t& count) {
     if(!bufs || !count) {
         return;
     }
-    for(int i=0; i<count; i++) {
-        if(bufs[i].buf_) delete [] bufs[i].buf_;
-    }
-    delete [] bufs;
+    // munlock() on a pool that never got locked is harmless
+    munlock(bufs, sampleBufDescSize(count) + sampleBufStride(bufs[0].cap_) * count);
+    free(bufs);
+    count = 0;
 }
-__inline__ sample_buf *allocateSampleBufs(uint32_t count, uint32_t sizeInByte){
+__inline__ sample_buf *allocateSampleBufs(uint32_t count, uint32_t sizeInByte,
+                                          uint32_t flags = 0) {
     if (count <= 0 || sizeInByte <= 0) {
         return nullptr;
     }
-    sample_buf* bufs = new sample_buf[count];
-    assert(bufs);
-    memset(bufs, 0, sizeof(sample_buf) * count);
-
-    uint32_t allocSize = (sizeInByte + 3) & ~3;   // padding to 4 bytes aligned
-    uint32_t i ;
-    for(i =0; i < count; i++) {
-        bufs[i].buf_ = new uint8_t [allocSize];
-        if(bufs[i].buf_ == nullptr) {
-            LOGW("====Requesting %d buffers, allocated %d in %s", __FUNCTION__);
-            break;
-        }
-        bufs[i].cap_ = sizeInByte;
-        bufs[i].size_ = 0;        //0 data in it
+    uint32_t descSize = sampleBufDescSize(count);
+    uint32_t stride   = sampleBufStride(sizeInByte);
+    size_t   poolSize = descSize + static_cast<size_t>(stride) * count;
+
+    void *pool = nullptr;
+    if (posix_memalign(&pool, CACHE_ALIGN, poolSize)) {
+        LOGW("====Requesting %d buffers (%zu bytes) failed in %s",
+             count, poolSize, __FUNCTION__);
+        return nullptr;
+    }
+
+    if ((flags & SAMPLE_BUF_MLOCK) && mlock(pool, poolSize)) {
+        LOGW("====mlock(%zu) failed in %s, pre-faulting instead",
+             poolSize, __FUNCTION__);
+        flags |= SAMPLE_BUF_PREFAULT;
     }
-    if(i < 2) {
-        releaseSampleBufs(bufs, i);
-        bufs = nullptr;
+    if (flags & SAMPLE_BUF_PREFAULT) {
+        memset(pool, 0, poolSize);
+    }
+
+    sample_buf* bufs = static_cast<sample_buf*>(pool);
+    uint8_t* payload = static_cast<uint8_t*>(pool) + descSize;
+    for(uint32_t i = 0; i < count; i++) {
+        bufs[i].buf_  = payload + static_cast<size_t>(stride) * i;
+        bufs[i].cap_  = sizeInByte;
+        bufs[i].size_ = 0;        //0 data in it
+        bufs[i].captureTime_ = 0;
     }
-    count = i;
     return bufs;
 }
 
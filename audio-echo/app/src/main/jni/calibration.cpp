@@ -0,0 +1,100 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cassert>
+#include <cstring>
+#include "calibration.h"
+
+BufferSizeCalibrator::BufferSizeCalibrator(SampleFormat *format) :
+    nativeFrames_(format->framesPerBuf_), windowMs_(CALIBRATION_WINDOW_MS),
+    chosen_(0) {
+    memset(results_, 0, sizeof(results_));
+    memset(&startJitter_, 0, sizeof(startJitter_));
+    memset(&startLatency_, 0, sizeof(startLatency_));
+}
+
+void BufferSizeCalibrator::Reset(uint32_t windowMs) {
+    windowMs_ = windowMs ? windowMs : CALIBRATION_WINDOW_MS;
+    chosen_ = 0;
+    memset(results_, 0, sizeof(results_));
+    for (uint32_t i = 0; i < CALIBRATION_CANDIDATES; i++) {
+        results_[i].framesPerBuf_ = Candidate(i);
+    }
+}
+
+uint32_t BufferSizeCalibrator::Candidate(uint32_t idx) {
+    assert(idx < CALIBRATION_CANDIDATES);
+    return nativeFrames_ << idx;
+}
+
+void BufferSizeCalibrator::Begin(const JitterStats *jitter, const LatencyStats *latency) {
+    startJitter_  = *jitter;
+    startLatency_ = *latency;
+}
+
+/*
+ * End(): counters are taken relative to Begin(); the jitter peaks are
+ * the engine's to reset ( JitterController::ResetPeaks() ) at Begin()
+ */
+void BufferSizeCalibrator::End(uint32_t idx, const JitterStats *jitter,
+                               const LatencyStats *latency) {
+    assert(idx < CALIBRATION_CANDIDATES);
+    CalibrationResult *result = &results_[idx];
+    result->periodUs_        = jitter->periodUs_;
+    result->buffers_         = latency->bufCount_ - startLatency_.bufCount_;
+    result->recJitterMaxUs_  = jitter->recJitterMaxUs_;
+    result->playJitterMaxUs_ = jitter->playJitterMaxUs_;
+    // JitterController only counts an underrun once the device queue is
+    // empty too: a momentarily empty play queue does not fail a size
+    result->starved_         = jitter->underruns_ - startJitter_.underruns_;
+    result->overruns_        = jitter->overruns_ - startJitter_.overruns_;
+
+    uint64_t expected = jitter->periodUs_ ?
+                        static_cast<uint64_t>(windowMs_) * 1000 / jitter->periodUs_ : 0;
+    uint32_t worstJitter = result->recJitterMaxUs_ > result->playJitterMaxUs_ ?
+                           result->recJitterMaxUs_ : result->playJitterMaxUs_;
+    result->stable_ = (!result->starved_ && !result->overruns_ &&
+                       expected &&
+                       result->buffers_ * 100ULL >= expected * CALIBRATION_MIN_BUF_PCT &&
+                       worstJitter * 100ULL <=
+                       static_cast<uint64_t>(jitter->periodUs_) * CALIBRATION_JITTER_PCT) ? 1 : 0;
+    LOGI("Calibration %d frames: period=%dus, bufs=%d (expected %d), jitter max "
+         "rec=%dus play=%dus, starved=%d, overruns=%d -> %s",
+         result->framesPerBuf_, result->periodUs_, result->buffers_,
+         static_cast<uint32_t>(expected), result->recJitterMaxUs_,
+         result->playJitterMaxUs_, result->starved_, result->overruns_,
+         result->stable_ ? "stable" : "unstable");
+}
+
+uint32_t BufferSizeCalibrator::Choose(void) {
+    chosen_ = Candidate(CALIBRATION_CANDIDATES - 1);
+    for (uint32_t i = 0; i < CALIBRATION_CANDIDATES; i++) {
+        if (results_[i].stable_) {
+            chosen_ = results_[i].framesPerBuf_;
+            break;
+        }
+    }
+    return chosen_;
+}
+
+uint32_t BufferSizeCalibrator::GetResults(CalibrationResult *results, uint32_t count) {
+    if (count > CALIBRATION_CANDIDATES) {
+        count = CALIBRATION_CANDIDATES;
+    }
+    memcpy(results, results_, count * sizeof(CalibrationResult));
+    return count;
+}
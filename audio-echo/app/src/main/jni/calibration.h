@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef NATIVE_AUDIO_CALIBRATION_H
+#define NATIVE_AUDIO_CALIBRATION_H
+#include <sys/types.h>
+#include "audio_common.h"
+#include "jitter_controller.h"
+
+/*
+ * Buffer size calibration controls:
+ *   CALIBRATION_CANDIDATES:  sizes tried, 1x, 2x, 4x ... the native burst
+ *   CALIBRATION_WINDOW_MS:   default time each size is measured for
+ *   CALIBRATION_SETTLE_MS:   run before measuring, for the pre-roll and
+ *        the jitter buffer to settle
+ *   CALIBRATION_JITTER_PCT:  worst callback jitter a stable size may see,
+ *        in percent of its period
+ *   CALIBRATION_MIN_BUF_PCT: buffers that must make it from recorder to
+ *        player, in percent of what the window should carry
+ *   CALIBRATION_FIELDS:      ints per candidate in getCalibrationResult()
+ */
+#define CALIBRATION_CANDIDATES    3
+#define CALIBRATION_WINDOW_MS     1000
+#define CALIBRATION_SETTLE_MS     250
+#define CALIBRATION_JITTER_PCT    50
+#define CALIBRATION_MIN_BUF_PCT   80
+#define CALIBRATION_FIELDS        8
+
+/*
+ * measurements of one candidate; CALIBRATION_FIELDS uint32_t, in the
+ * order NativeFastPlayer.getCalibrationResult() hands them to Java
+ */
+struct CalibrationResult {
+    uint32_t  framesPerBuf_;
+    uint32_t  periodUs_;
+    uint32_t  buffers_;           // echoed in the window
+    uint32_t  recJitterMaxUs_;    // worst callback jitter, recorder side
+    uint32_t  playJitterMaxUs_;   // worst callback jitter, player side
+    uint32_t  starved_;           // player device ran dry, not just its queue
+    uint32_t  overruns_;
+    uint32_t  stable_;            // 1: passed, 0: failed or not run
+};
+
+/*
+ * BufferSizeCalibrator: bookkeeping for picking framesPerBuf on the
+ * device instead of trusting the value Java read from AudioManager.
+ * The engine runs the echo path at each Candidate(), hands JitterController
+ * / AudioStats snapshots to Begin() once it settled and to End() after
+ * the window, so only what happened in between is judged; a
+ * candidate is stable when nothing under/overran, its worst callback
+ * jitter stayed under CALIBRATION_JITTER_PCT of the period and the
+ * buffers actually flowed. Choose() takes the smallest stable size,
+ * or the largest candidate when none was stable.
+ *
+ * Engine thread only, with no player / recorder running.
+ */
+class BufferSizeCalibrator {
+public:
+    explicit BufferSizeCalibrator(SampleFormat *format);
+    void      Reset(uint32_t windowMs);
+    uint32_t  Candidate(uint32_t idx);
+    uint32_t  WindowMs(void) { return windowMs_; }
+    void      Begin(const JitterStats *jitter, const LatencyStats *latency);
+    void      End(uint32_t idx, const JitterStats *jitter,
+                  const LatencyStats *latency);
+    uint32_t  Choose(void);
+    uint32_t  Chosen(void) { return chosen_; }
+    uint32_t  GetResults(CalibrationResult *results, uint32_t count);
+
+private:
+    uint32_t  nativeFrames_;
+    uint32_t  windowMs_;
+    uint32_t  chosen_;              // 0 until Choose()
+    JitterStats  startJitter_;      // Begin() snapshots
+    LatencyStats startLatency_;
+    CalibrationResult results_[CALIBRATION_CANDIDATES];
+};
+
+#endif //NATIVE_AUDIO_CALIBRATION_H
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "capture_writer.h"
+
+#define WAV_SIZE_UNKNOWN   0xFFFFFFFF
+
+static uint64_t nowUs(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+}
+
+static void put16(uint8_t *dst, uint16_t value) {
+    dst[0] = static_cast<uint8_t>(value);
+    dst[1] = static_cast<uint8_t>(value >> 8);
+}
+
+static void put32(uint8_t *dst, uint32_t value) {
+    put16(dst, static_cast<uint16_t>(value));
+    put16(dst + 2, static_cast<uint16_t>(value >> 16));
+}
+
+CaptureWriter::CaptureWriter(SampleFormat *format) :
+        sampleInfo_(*format), fd_(-1), direct_(false), fileOffset_(0),
+        failed_(false), ring_(nullptr), bounce_(nullptr),
+        ringSize_(CAPTURE_CHUNK_SIZE * CAPTURE_RING_CHUNKS),
+        read_(0), write_(0), running_(false), writer_(nullptr),
+        threads_(nullptr) {
+    static_assert(!(CAPTURE_CHUNK_SIZE % CAPTURE_ALIGN), "chunk must be aligned");
+    static_assert(!(CAPTURE_RING_CHUNKS & (CAPTURE_RING_CHUNKS - 1)) &&
+                  !(CAPTURE_CHUNK_SIZE & (CAPTURE_CHUNK_SIZE - 1)),
+                  "ring size must be a power of 2");
+    void *ring = nullptr, *bounce = nullptr;
+    if (posix_memalign(&ring, CAPTURE_ALIGN, ringSize_) ||
+        posix_memalign(&bounce, CAPTURE_ALIGN, CAPTURE_CHUNK_SIZE)) {
+        LOGE("====failed to allocate %d bytes of capture ring", ringSize_);
+    }
+    ring_ = static_cast<uint8_t*>(ring);
+    bounce_ = static_cast<uint8_t*>(bounce);
+    assert(ring_ && bounce_);
+
+    // the recorder thread writes into the ring: no page faults there
+    if (mlock(ring_, ringSize_)) {
+        LOGW("====mlock(%d) failed in %s, pre-faulting instead",
+             ringSize_, __FUNCTION__);
+    }
+    memset(ring_, 0, ringSize_);
+}
+
+CaptureWriter::~CaptureWriter() {
+    Close();
+    munlock(ring_, ringSize_);
+    free(ring_);
+    free(bounce_);
+}
+
+/*
+ * fillHeader(): CAPTURE_ALIGN bytes of WAV header; a JUNK chunk pads it
+ * so the samples start on an aligned offset
+ */
+void CaptureWriter::fillHeader(uint8_t *block, uint64_t dataBytes) {
+    uint32_t dataSize = WAV_SIZE_UNKNOWN, riffSize = WAV_SIZE_UNKNOWN;
+    if (dataBytes != WAV_SIZE_UNKNOWN) {
+        uint64_t limit = WAV_SIZE_UNKNOWN - CAPTURE_ALIGN;
+        dataSize = static_cast<uint32_t>(dataBytes < limit ? dataBytes : limit);
+        riffSize = dataSize + CAPTURE_ALIGN - 8;
+    }
+    uint16_t channels = sampleInfo_.channels_;
+    uint16_t bits = sampleInfo_.pcmFormat_;
+    uint32_t sampleRate = sampleInfo_.sampleRate_ / 1000;      // milliHz
+    uint16_t blockAlign = channels * ((bits + 7) >> 3);
+
+    memset(block, 0, CAPTURE_ALIGN);
+    memcpy(block, "RIFF", 4);
+    put32(block + 4, riffSize);
+    memcpy(block + 8, "WAVEfmt ", 8);
+    put32(block + 16, 16);
+    put16(block + 20, 1);                       // PCM
+    put16(block + 22, channels);
+    put32(block + 24, sampleRate);
+    put32(block + 28, sampleRate * blockAlign);
+    put16(block + 32, blockAlign);
+    put16(block + 34, bits);
+    memcpy(block + 36, "JUNK", 4);
+    put32(block + 40, CAPTURE_ALIGN - 36 - 8 - 8);
+    memcpy(block + CAPTURE_ALIGN - 8, "data", 4);
+    put32(block + CAPTURE_ALIGN - 4, dataSize);
+}
+
+/*
+ * writeAt(): the whole of data at offset, or mark the writer failed.
+ * O_DIRECT turned down at the first write ( the file system took the
+ * flag but not the I/O ) falls back to buffered writes.
+ */
+bool CaptureWriter::writeAt(const uint8_t *data, uint32_t size, uint64_t offset) {
+    uint64_t start = nowUs();
+    while (size) {
+        ssize_t done = pwrite(fd_, data, size, static_cast<off_t>(offset));
+        if (done < 0 && errno == EINTR) {
+            continue;
+        }
+        if (done < 0 && errno == EINVAL && direct_) {
+            LOGW("====O_DIRECT refused for %s, buffered writes instead", path_.c_str());
+            fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+            direct_ = false;
+            continue;
+        }
+        if (done <= 0) {
+            LOGE("====capture write of %d bytes to %s failed: %s",
+                 size, path_.c_str(), strerror(errno));
+            writeErrors_.fetch_add(1, std::memory_order_relaxed);
+            failed_ = true;
+            return false;
+        }
+        data += done;
+        offset += done;
+        size -= static_cast<uint32_t>(done);
+    }
+    uint32_t spent = static_cast<uint32_t>(nowUs() - start);
+    if (spent > maxWriteUs_.load(std::memory_order_relaxed)) {
+        maxWriteUs_.store(spent, std::memory_order_relaxed);
+    }
+    writes_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool CaptureWriter::Open(const char *path, bool direct) {
+    assert(!running_.load());
+    Close();
+    path_ = path;
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    direct_ = false;
+    if (direct) {
+        fd_ = open(path, flags | O_DIRECT, 0644);
+        direct_ = (fd_ >= 0);
+    }
+    if (fd_ < 0) {
+        fd_ = open(path, flags, 0644);
+    }
+    if (fd_ < 0) {
+        LOGE("====failed to open capture file %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    read_.store(0);
+    write_.store(0);
+    failed_ = false;
+    buffers_.store(0);
+    overruns_.store(0);
+    droppedBytes_.store(0);
+    writes_.store(0);
+    writeErrors_.store(0);
+    maxWriteUs_.store(0);
+    ringPeak_.store(0);
+    fileBytes_.store(0);
+
+    fillHeader(bounce_, WAV_SIZE_UNKNOWN);
+    if (!writeAt(bounce_, CAPTURE_ALIGN, 0)) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    fileOffset_ = CAPTURE_ALIGN;
+    return true;
+}
+
+void CaptureWriter::SetThreadPolicy(ThreadPolicyManager *threads) {
+    threads_ = threads;
+}
+
+void CaptureWriter::Start(void) {
+    if (fd_ < 0 || running_.load()) {
+        return;
+    }
+    running_.store(true, std::memory_order_release);
+    writer_ = new std::thread(&CaptureWriter::writerLoop, this);
+}
+
+/*
+ * Append(): recorder thread. Copy and publish, or drop the buffer whole
+ */
+void CaptureWriter::Append(const sample_buf *buf) {
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    uint32_t size = buf->size_;
+    uint32_t w = write_.load(std::memory_order_relaxed);
+    uint32_t r = read_.load(std::memory_order_acquire);
+    if (size > ringSize_ - (w - r)) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        droppedBytes_.fetch_add(size, std::memory_order_relaxed);
+        return;
+    }
+    uint32_t pos = w & (ringSize_ - 1);
+    uint32_t first = (size < ringSize_ - pos) ? size : (ringSize_ - pos);
+    memcpy(ring_ + pos, buf->buf_, first);
+    memcpy(ring_, buf->buf_ + first, size - first);
+    write_.store(w + size, std::memory_order_release);
+    buffers_.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*
+ * drain(): write every whole chunk waiting in the ring. Chunks start at
+ * multiples of CAPTURE_CHUNK_SIZE and the ring is a multiple of it, so a
+ * chunk is one piece of ring memory. Returns true when it wrote any.
+ */
+bool CaptureWriter::drain(void) {
+    uint32_t r = read_.load(std::memory_order_relaxed);
+    uint32_t avail = write_.load(std::memory_order_acquire) - r;
+    if (avail > ringPeak_.load(std::memory_order_relaxed)) {
+        ringPeak_.store(avail, std::memory_order_relaxed);
+    }
+    bool wrote = false;
+    while (avail >= CAPTURE_CHUNK_SIZE) {
+        if (!failed_ && writeAt(ring_ + (r & (ringSize_ - 1)), CAPTURE_CHUNK_SIZE, fileOffset_)) {
+            fileOffset_ += CAPTURE_CHUNK_SIZE;
+            fileBytes_.store(fileOffset_ - CAPTURE_ALIGN, std::memory_order_relaxed);
+        } else {
+            // keep the ring moving so the recorder side does not back up
+            droppedBytes_.fetch_add(CAPTURE_CHUNK_SIZE, std::memory_order_relaxed);
+        }
+        r += CAPTURE_CHUNK_SIZE;
+        avail -= CAPTURE_CHUNK_SIZE;
+        read_.store(r, std::memory_order_release);
+        wrote = true;
+    }
+    return wrote;
+}
+
+void CaptureWriter::writerLoop(void) {
+    while (running_.load(std::memory_order_acquire)) {
+        if (threads_) {
+            threads_->OnThreadRunning(THREAD_ROLE_HELPER);
+        }
+        if (!drain()) {
+            usleep(CAPTURE_FLUSH_MS * 1000);
+        }
+    }
+}
+
+/*
+ * Close(): recorder already stopped. Write out the rest, patch the header
+ */
+void CaptureWriter::Close(void) {
+    if (fd_ < 0) {
+        return;
+    }
+    if (writer_) {
+        running_.store(false, std::memory_order_release);
+        writer_->join();
+        delete writer_;
+        writer_ = nullptr;
+    }
+    drain();
+
+    // last partial chunk: O_DIRECT wants whole blocks, the padding is cut
+    // off again afterwards
+    uint32_t r = read_.load(std::memory_order_relaxed);
+    uint32_t tail = write_.load(std::memory_order_acquire) - r;
+    if (tail && !failed_) {
+        uint32_t size = direct_ ? (tail + CAPTURE_ALIGN - 1) & ~(CAPTURE_ALIGN - 1) : tail;
+        memcpy(bounce_, ring_ + (r & (ringSize_ - 1)), tail);
+        memset(bounce_ + tail, 0, size - tail);
+        if (writeAt(bounce_, size, fileOffset_)) {
+            fileOffset_ += tail;
+            fileBytes_.store(fileOffset_ - CAPTURE_ALIGN, std::memory_order_relaxed);
+            if (size != tail && ftruncate(fd_, static_cast<off_t>(fileOffset_))) {
+                LOGW("====failed to trim %s: %s", path_.c_str(), strerror(errno));
+            }
+        }
+    }
+    read_.store(r + tail, std::memory_order_release);
+
+    if (!failed_) {
+        fillHeader(bounce_, fileOffset_ - CAPTURE_ALIGN);
+        writeAt(bounce_, CAPTURE_ALIGN, 0);
+    }
+    close(fd_);
+    fd_ = -1;
+}
+
+void CaptureWriter::GetStats(CaptureStats *stats) {
+    stats->buffers_ = buffers_.load(std::memory_order_relaxed);
+    stats->overruns_ = overruns_.load(std::memory_order_relaxed);
+    stats->droppedBytes_ = droppedBytes_.load(std::memory_order_relaxed);
+    stats->writes_ = writes_.load(std::memory_order_relaxed);
+    stats->writeErrors_ = writeErrors_.load(std::memory_order_relaxed);
+    stats->maxWriteUs_ = maxWriteUs_.load(std::memory_order_relaxed);
+    stats->ringPeak_ = ringPeak_.load(std::memory_order_relaxed);
+    stats->fileBytes_ = fileBytes_.load(std::memory_order_relaxed);
+}
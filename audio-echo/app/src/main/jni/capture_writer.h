@@ -0,0 +1,119 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_CAPTURE_WRITER_H
+#define NATIVE_AUDIO_CAPTURE_WRITER_H
+#include <sys/types.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "audio_common.h"
+#include "buf_manager.h"
+#include "thread_policy.h"
+
+/*
+ * Capture writer controls:
+ *   CAPTURE_CHUNK_SIZE:   bytes per write(); a multiple of CAPTURE_ALIGN
+ *   CAPTURE_RING_CHUNKS:  chunks in the staging ring: 32 x 64KB holds ~20
+ *        seconds of 48kHz mono, the disk stall the recorder rides out
+ *   CAPTURE_ALIGN:        O_DIRECT alignment of memory, offsets and sizes;
+ *        also where the samples start in the file ( WAV header + JUNK )
+ *   CAPTURE_FLUSH_MS:     writer thread period when less than a chunk waits
+ */
+#define CAPTURE_CHUNK_SIZE    (64 * 1024)
+#define CAPTURE_RING_CHUNKS   32
+#define CAPTURE_ALIGN         4096
+#define CAPTURE_FLUSH_MS      20
+
+/*
+ * snapshot handed out with ENGINE_SERVICE_MSG_GET_CAPTURE_STATS
+ */
+struct CaptureStats {
+    uint32_t  buffers_;         // recorded buffers taken into the ring
+    uint32_t  overruns_;        // ... dropped, the ring was full
+    uint32_t  droppedBytes_;
+    uint32_t  writes_;          // chunks written
+    uint32_t  writeErrors_;
+    uint32_t  maxWriteUs_;      // slowest write()
+    uint32_t  ringPeak_;        // most bytes ever waiting in the ring
+    uint64_t  fileBytes_;       // samples in the file
+};
+
+/*
+ * CaptureWriter: archives the recorded stream into a WAV file without
+ * the recorder thread ever touching the file system.
+ *
+ * Append() copies a buffer into a lock-free staging ring ( single
+ * producer, single consumer ) and returns; if the ring is full the whole
+ * buffer is dropped and counted. A writer thread of our own drains the
+ * ring in CAPTURE_CHUNK_SIZE pieces with pwrite(), straight out of the
+ * ring memory: the ring is a whole number of aligned chunks, so chunks
+ * never wrap and the recorder keeps filling one while the writer writes
+ * another. With O_DIRECT ( when the file system allows it ) the page
+ * cache is skipped too.
+ *
+ * The file starts with a streaming WAV header ( sizes unknown ) padded
+ * out to CAPTURE_ALIGN; Close() writes the last partial chunk and patches
+ * the sizes in.
+ *
+ * Threads: Open()/Start()/Close() from the engine, with the recorder
+ * stopped for Open() and Close(); Append() on the recorder thread.
+ */
+class CaptureWriter {
+public:
+    explicit CaptureWriter(SampleFormat *format);
+    ~CaptureWriter();
+    bool      Open(const char *path, bool direct);
+    void      Start(void);
+    void      Close(void);
+    void      Append(const sample_buf *buf);
+    void      SetThreadPolicy(ThreadPolicyManager *threads);
+    void      GetStats(CaptureStats *stats);
+
+private:
+    void      writerLoop(void);
+    bool      drain(void);
+    bool      writeAt(const uint8_t *data, uint32_t size, uint64_t offset);
+    void      fillHeader(uint8_t *block, uint64_t dataBytes);
+
+    SampleFormat  sampleInfo_;
+    int           fd_;
+    bool          direct_;
+    std::string   path_;
+    uint64_t      fileOffset_;      // writer thread only
+    bool          failed_;          // writer thread only, stop writing
+
+    uint8_t      *ring_;            // owner, CAPTURE_RING_CHUNKS chunks
+    uint8_t      *bounce_;          // owner, header and tail blocks
+    uint32_t      ringSize_;
+    alignas(CACHE_ALIGN) std::atomic<uint32_t> read_;
+    alignas(CACHE_ALIGN) std::atomic<uint32_t> write_;
+
+    std::atomic<bool> running_;
+    std::thread  *writer_;          // owner
+    ThreadPolicyManager *threads_;  // user
+
+    std::atomic<uint32_t> buffers_;
+    std::atomic<uint32_t> overruns_;
+    std::atomic<uint32_t> droppedBytes_;
+    std::atomic<uint32_t> writes_;
+    std::atomic<uint32_t> writeErrors_;
+    std::atomic<uint32_t> maxWriteUs_;
+    std::atomic<uint32_t> ringPeak_;
+    std::atomic<uint64_t> fileBytes_;
+};
+
+#endif //NATIVE_AUDIO_CAPTURE_WRITER_H
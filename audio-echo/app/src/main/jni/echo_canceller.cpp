@@ -0,0 +1,305 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "echo_canceller.h"
+#include "audio_kernels.h"
+
+EchoCanceller::EchoCanceller(SampleFormat *format) :
+        fft_(AEC_FFT_SIZE), mem_(nullptr) {
+    enabled_ = (format->channels_ == 1 &&
+                format->pcmFormat_ == SL_PCMSAMPLEFORMAT_FIXED_16);
+    if (!enabled_) {
+        LOGW("EchoCanceller: %d channels of %d bits not supported, bypassed",
+             format->channels_, format->pcmFormat_);
+    }
+    bufSamples_ = format->framesPerBuf_ * format->channels_;
+    outDelay_ = (bufSamples_ % AEC_BLOCK) ? AEC_BLOCK : 0;
+    refQueue_ = new ProducerConsumerQueue<int16_t>(AEC_REF_QUEUE_LEN, true);
+    refPcm_ = new int16_t[bufSamples_];
+
+    uint32_t outCap = outDelay_ + bufSamples_ + AEC_BLOCK;
+    uint32_t floats = 3 * AEC_BLOCK + outCap + 4 * AEC_PARTITIONS * AEC_BINS +
+                      5 * AEC_BINS + AEC_FFT_SIZE;
+    void *mem = nullptr;
+    if (posix_memalign(&mem, CACHE_ALIGN, floats * sizeof(float))) {
+        mem = nullptr;
+    }
+    assert(mem && refQueue_ && refPcm_);
+    mem_ = static_cast<float*>(mem);
+
+    float *next = mem_;
+    mic_ = next;       next += AEC_BLOCK;
+    ref_ = next;       next += AEC_BLOCK;
+    refPrev_ = next;   next += AEC_BLOCK;
+    out_ = next;       next += outCap;
+    for (uint32_t p = 0; p < AEC_PARTITIONS; p++) {
+        filterRe_[p] = next;  next += AEC_BINS;
+        filterIm_[p] = next;  next += AEC_BINS;
+        specRe_[p] = next;    next += AEC_BINS;
+        specIm_[p] = next;    next += AEC_BINS;
+    }
+    power_ = next;     next += AEC_BINS;
+    echoRe_ = next;    next += AEC_BINS;
+    echoIm_ = next;    next += AEC_BINS;
+    errRe_ = next;     next += AEC_BINS;
+    errIm_ = next;     next += AEC_BINS;
+    frame_ = next;     next += AEC_FFT_SIZE;
+    assert(next == mem_ + floats);
+
+    Reset();
+}
+
+EchoCanceller::~EchoCanceller() {
+    free(mem_);
+    delete [] refPcm_;
+    delete refQueue_;
+}
+
+void EchoCanceller::clearFilter(void) {
+    for (uint32_t p = 0; p < AEC_PARTITIONS; p++) {
+        memset(filterRe_[p], 0, AEC_BINS * sizeof(float));
+        memset(filterIm_[p], 0, AEC_BINS * sizeof(float));
+    }
+    divergeCount_ = 0;
+}
+
+/*
+ * Reset(): forget the echo path and the reference, for a new session
+ */
+void EchoCanceller::Reset(void) {
+    clearFilter();
+    for (uint32_t p = 0; p < AEC_PARTITIONS; p++) {
+        memset(specRe_[p], 0, AEC_BINS * sizeof(float));
+        memset(specIm_[p], 0, AEC_BINS * sizeof(float));
+        specPeak_[p] = 0.0f;
+    }
+    memset(power_, 0, AEC_BINS * sizeof(float));
+    memset(refPrev_, 0, AEC_BLOCK * sizeof(float));
+    refQueue_->pop_n(refQueue_->size());
+    primed_ = false;
+    refDebt_ = 0;
+    refGap_ = false;
+    head_ = 0;
+    constrain_ = 0;
+    fill_ = 0;
+    // a full block ahead when blocks straddle buffers, so Process() always
+    // has a buffer worth of output
+    memset(out_, 0, outDelay_ * sizeof(float));
+    outCount_ = outDelay_;
+    micEnergy_ = errEnergy_ = 0.0f;
+
+    blocks_.store(0);
+    adaptedBlocks_.store(0);
+    doubleTalk_.store(0);
+    refUnderruns_.store(0);
+    refDropped_.store(0);
+    resets_.store(0);
+    erleDb_.store(0.0f);
+}
+
+/*
+ * PushReference(): buf went to the speaker, its echo is on the way
+ */
+void EchoCanceller::PushReference(const sample_buf *buf) {
+    if (!enabled_) {
+        return;
+    }
+    int count = static_cast<int>(buf->size_ / sizeof(int16_t));
+    int pushed = refQueue_->push_n(reinterpret_cast<const int16_t*>(buf->buf_), count);
+    if (pushed < count) {
+        // recorder not running: nobody cancels with it anyway
+        refDropped_.fetch_add(count - pushed, std::memory_order_relaxed);
+    }
+}
+
+/*
+ * Process(): cancel the echo out of one recorded buffer, in place
+ */
+void EchoCanceller::Process(sample_buf *buf) {
+    if (!enabled_) {
+        return;
+    }
+    uint32_t count = buf->size_ / sizeof(int16_t);
+    assert(count <= bufSamples_);
+    uint32_t level = refQueue_->size();
+    if (!primed_) {
+        if (level < bufSamples_) {
+            return;     // player has not started: no echo yet either
+        }
+        // start from the newest reference: the most room for the echo
+        // path delay before the echo would lead its reference
+        refQueue_->pop_n(static_cast<int>(level - count));
+        level = count;
+        primed_ = true;
+    }
+
+    // reference late for the last buffer: its time is gone, drop what
+    // came in on top of this buffer's share so the rest stays lined up
+    // with the echo. Nothing extra came: the player moved its phase for
+    // good, carry on from here
+    if (refDebt_) {
+        uint32_t surplus = level > count ? level - count : 0;
+        uint32_t late = surplus < refDebt_ ? surplus : refDebt_;
+        refQueue_->pop_n(static_cast<int>(late));
+        level -= late;
+        refDebt_ = 0;
+    }
+    // keep the reference from falling behind the echo it stands for
+    uint32_t maxLevel = AEC_REF_MAX_BUFS * bufSamples_ + count;
+    if (level > maxLevel) {
+        refQueue_->pop_n(static_cast<int>(level - maxLevel));
+        refDropped_.fetch_add(level - maxLevel, std::memory_order_relaxed);
+    }
+    uint32_t got = static_cast<uint32_t>(refQueue_->pop_n(refPcm_, static_cast<int>(count)));
+    if (got < count) {
+        // a few samples short: frames the jitter controller dropped, the
+        // speaker did not play them either. More: the player callback is
+        // late, its reference belongs to this buffer
+        memset(refPcm_ + got, 0, (count - got) * sizeof(int16_t));
+        refUnderruns_.fetch_add(1, std::memory_order_relaxed);
+        refGap_ = (count - got) >= AEC_BLOCK;
+        if (refGap_) {
+            refDebt_ += count - got;
+        }
+    } else {
+        refGap_ = false;
+    }
+
+    int16_t *pcm = reinterpret_cast<int16_t*>(buf->buf_);
+    for (uint32_t i = 0; i < count; ) {
+        uint32_t n = AEC_BLOCK - fill_;
+        n = (n < count - i) ? n : (count - i);
+        convertPcm16ToFloat(pcm + i, mic_ + fill_, n);
+        convertPcm16ToFloat(refPcm_ + i, ref_ + fill_, n);
+        fill_ += n;
+        i += n;
+        if (fill_ == AEC_BLOCK) {
+            processBlock(out_ + outCount_);
+            outCount_ += AEC_BLOCK;
+            fill_ = 0;
+        }
+    }
+    assert(outCount_ >= count);
+    convertFloatToPcm16(out_, pcm, count);
+    outCount_ -= count;
+    memmove(out_, out_ + count, outCount_ * sizeof(float));
+}
+
+/*
+ * processBlock(): mic_ minus the echo estimated from ref_ and the blocks
+ * before it --> out, then move the filter toward the error
+ */
+void EchoCanceller::processBlock(float *out) {
+    // reference spectrum of [previous block, this block]
+    head_ = head_ ? head_ - 1 : AEC_PARTITIONS - 1;
+    memcpy(frame_, refPrev_, AEC_BLOCK * sizeof(float));
+    memcpy(frame_ + AEC_BLOCK, ref_, AEC_BLOCK * sizeof(float));
+    memcpy(refPrev_, ref_, AEC_BLOCK * sizeof(float));
+    fft_.Forward(frame_, specRe_[head_], specIm_[head_]);
+    specPeak_[head_] = peakAbsFloat(ref_, AEC_BLOCK);
+    const float *newRe = specRe_[head_], *newIm = specIm_[head_];
+    for (uint32_t k = 0; k < AEC_BINS; k++) {
+        float power = newRe[k] * newRe[k] + newIm[k] * newIm[k];
+        power_[k] = power > power_[k] ? power :
+                    AEC_POWER_SMOOTH * power_[k] + (1.0f - AEC_POWER_SMOOTH) * power;
+    }
+
+    // echo estimate: partition p filters the reference of p blocks ago;
+    // the second half of the inverse is the part free of wrap around
+    memset(echoRe_, 0, AEC_BINS * sizeof(float));
+    memset(echoIm_, 0, AEC_BINS * sizeof(float));
+    float refPeak = 0.0f;
+    for (uint32_t p = 0; p < AEC_PARTITIONS; p++) {
+        uint32_t q = (head_ + p) % AEC_PARTITIONS;
+        complexMac(filterRe_[p], filterIm_[p], specRe_[q], specIm_[q],
+                   echoRe_, echoIm_, AEC_BINS);
+        refPeak = specPeak_[q] > refPeak ? specPeak_[q] : refPeak;
+    }
+    fft_.Inverse(echoRe_, echoIm_, frame_);
+    for (uint32_t i = 0; i < AEC_BLOCK; i++) {
+        out[i] = mic_[i] - frame_[AEC_BLOCK + i];
+    }
+    blocks_.fetch_add(1, std::memory_order_relaxed);
+
+    float micEnergy = dotProduct(mic_, mic_, AEC_BLOCK);
+    float errEnergy = dotProduct(out, out, AEC_BLOCK);
+    bool echo = refPeak >= AEC_REF_SILENCE;
+    bool adapt = echo && !refGap_;
+    if (adapt && peakAbsFloat(mic_, AEC_BLOCK) > AEC_DTD_RATIO * refPeak) {
+        // near end talking over the echo: the error is not all echo
+        doubleTalk_.fetch_add(1, std::memory_order_relaxed);
+        adapt = false;
+    }
+    if (adapt) {
+        // error spectrum of [zeros, error]: only this block's samples count
+        memset(frame_, 0, AEC_BLOCK * sizeof(float));
+        memcpy(frame_ + AEC_BLOCK, out, AEC_BLOCK * sizeof(float));
+        fft_.Forward(frame_, errRe_, errIm_);
+        for (uint32_t k = 0; k < AEC_BINS; k++) {
+            float step = AEC_STEP / (AEC_PARTITIONS * power_[k] + AEC_REGULARIZE);
+            errRe_[k] *= step;
+            errIm_[k] *= step;
+        }
+        for (uint32_t p = 0; p < AEC_PARTITIONS; p++) {
+            uint32_t q = (head_ + p) % AEC_PARTITIONS;
+            complexMacConj(specRe_[q], specIm_[q], errRe_, errIm_,
+                           filterRe_[p], filterIm_[p], AEC_BINS);
+        }
+
+        // gradient constraint: the impulse response of a partition is
+        // AEC_BLOCK long, drop what the circular update put past that
+        fft_.Inverse(filterRe_[constrain_], filterIm_[constrain_], frame_);
+        memset(frame_ + AEC_BLOCK, 0, AEC_BLOCK * sizeof(float));
+        fft_.Forward(frame_, filterRe_[constrain_], filterIm_[constrain_]);
+        constrain_ = (constrain_ + 1) % AEC_PARTITIONS;
+
+        adaptedBlocks_.fetch_add(1, std::memory_order_relaxed);
+        micEnergy_ = 0.99f * micEnergy_ + micEnergy;
+        errEnergy_ = 0.99f * errEnergy_ + errEnergy;
+        erleDb_.store(10.0f * log10f((micEnergy_ + 1e-10f) / (errEnergy_ + 1e-10f)),
+                      std::memory_order_relaxed);
+    }
+
+    // never hand out more than came in; a filter that keeps doing that
+    // ( or went NaN ) has diverged
+    if (!(errEnergy <= micEnergy)) {
+        memcpy(out, mic_, AEC_BLOCK * sizeof(float));
+    }
+    if (echo) {
+        if (!(errEnergy <= 2.0f * micEnergy)) {
+            if (++divergeCount_ >= AEC_DIVERGE_BLOCKS) {
+                clearFilter();
+                resets_.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            divergeCount_ = 0;
+        }
+    }
+}
+
+void EchoCanceller::GetStats(AecStats *stats) {
+    stats->blocks_ = blocks_.load(std::memory_order_relaxed);
+    stats->adaptedBlocks_ = adaptedBlocks_.load(std::memory_order_relaxed);
+    stats->doubleTalk_ = doubleTalk_.load(std::memory_order_relaxed);
+    stats->refUnderruns_ = refUnderruns_.load(std::memory_order_relaxed);
+    stats->refDropped_ = refDropped_.load(std::memory_order_relaxed);
+    stats->resets_ = resets_.load(std::memory_order_relaxed);
+    stats->erleDb_ = erleDb_.load(std::memory_order_relaxed);
+}
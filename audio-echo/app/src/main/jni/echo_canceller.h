@@ -0,0 +1,150 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_ECHO_CANCELLER_H
+#define NATIVE_AUDIO_ECHO_CANCELLER_H
+#include <sys/types.h>
+#include <atomic>
+#include "audio_common.h"
+#include "buf_manager.h"
+#include "fft.h"
+
+/*
+ * Echo canceller controls:
+ *   AEC_BLOCK:         samples per filter block; the FFT is twice that. Up
+ *                      to one block of latency is added when the buffer
+ *                      size is not a multiple of it ( 192 and 240 frame
+ *                      buffers: none and 64 samples )
+ *   AEC_PARTITIONS:    filter length in blocks: 48 x 64 = 64 ms at 48kHz
+ *   AEC_STEP:          NLMS step size, normalized per bin
+ *   AEC_POWER_SMOOTH:  decay of the per bin reference power; it follows
+ *                      rises at once, an onset must not get a huge step
+ *   AEC_REGULARIZE:    power floor per bin, keeps quiet bins from blowing up
+ *   AEC_DTD_RATIO:     double talk ( Geigel ): the block adapts only while
+ *                      mic peak < AEC_DTD_RATIO x reference peak over the
+ *                      filter span
+ *   AEC_REF_SILENCE:   reference peak below this: nothing to cancel, no update
+ *   AEC_REF_MAX_BUFS:  played but not yet cancelled reference kept, in
+ *                      buffers; beyond it the oldest is dropped. Must stay
+ *                      under the playout delay or the echo shows up in the
+ *                      mic before its reference does
+ *   AEC_REF_QUEUE_LEN: reference samples in flight from the player thread
+ *   AEC_DIVERGE_BLOCKS: blocks in a row with output over twice the input
+ *                      energy before the filter is thrown away
+ */
+#define AEC_BLOCK            64
+#define AEC_FFT_SIZE         (2 * AEC_BLOCK)
+#define AEC_BINS             (AEC_BLOCK + 1)
+#define AEC_PARTITIONS       48
+#define AEC_STEP             0.5f
+#define AEC_POWER_SMOOTH     0.9f
+#define AEC_REGULARIZE       (AEC_FFT_SIZE * 1e-6f)
+#define AEC_DTD_RATIO        1.0f
+#define AEC_REF_SILENCE      (1.0f / 4096)
+#define AEC_REF_MAX_BUFS     2
+#define AEC_REF_QUEUE_LEN    8192
+#define AEC_DIVERGE_BLOCKS   64
+
+/*
+ * snapshot handed out with ENGINE_SERVICE_MSG_GET_AEC_STATS
+ */
+struct AecStats {
+    uint32_t  blocks_;          // blocks cancelled
+    uint32_t  adaptedBlocks_;   // ... the filter learned from
+    uint32_t  doubleTalk_;      // ... frozen by double talk
+    uint32_t  refUnderruns_;    // mic buffers without enough reference
+    uint32_t  refDropped_;      // reference samples trimmed, too old
+    uint32_t  resets_;          // filter diverged and was cleared
+    float     erleDb_;          // echo return loss enhancement, smoothed
+};
+
+/*
+ * EchoCanceller: partitioned block frequency domain adaptive filter
+ * ( PBFDAF, NLMS update ) taking out of the recorded stream what the
+ * player sent to the speaker.
+ *
+ * The filter is AEC_PARTITIONS spectra of AEC_FFT_SIZE points; for every
+ * block of AEC_BLOCK samples the echo estimate is the sum over partitions
+ * of filter x reference spectrum of that many blocks ago ( overlap-save ),
+ * and the update adds conj(reference) x error spectrum, scaled down by
+ * the reference power of each bin. One partition per block is made
+ * causal again ( gradient constraint ), round robin.
+ *
+ * All state is allocated in the constructor; PushReference() and
+ * Process() never allocate or lock. Mono 16 bit only, other formats
+ * pass through untouched.
+ *
+ * Threads: PushReference() on the player thread, Process() on the
+ * recorder thread, Reset() while neither runs, stats from anywhere.
+ */
+class EchoCanceller {
+public:
+    explicit EchoCanceller(SampleFormat *format);
+    ~EchoCanceller();
+    void      Reset(void);
+    void      PushReference(const sample_buf *buf);
+    void      Process(sample_buf *buf);
+    void      GetStats(AecStats *stats);
+
+private:
+    void      processBlock(float *out);
+    void      clearFilter(void);
+
+    bool      enabled_;
+    uint32_t  bufSamples_;        // samples in one device buffer
+    uint32_t  outDelay_;          // latency added to line up blocks and buffers
+    RealFft   fft_;
+
+    ProducerConsumerQueue<int16_t> *refQueue_;   // owner
+    bool      primed_;
+    uint32_t  refDebt_;           // zeros stood in for these, drop when they come
+    bool      refGap_;            // this buffer's reference is partly zeros
+
+    // block assembly: samples in, error samples out
+    int16_t  *refPcm_;            // one buffer of reference
+    float    *mic_;               // AEC_BLOCK
+    float    *ref_;               // AEC_BLOCK
+    float    *refPrev_;           // previous block of reference
+    uint32_t  fill_;
+    float    *out_;               // error samples waiting for their buffer
+    uint32_t  outCount_;
+
+    // filter state, one allocation
+    float    *mem_;               // owner
+    float    *filterRe_[AEC_PARTITIONS];
+    float    *filterIm_[AEC_PARTITIONS];
+    float    *specRe_[AEC_PARTITIONS];    // reference spectra, ring
+    float    *specIm_[AEC_PARTITIONS];
+    float     specPeak_[AEC_PARTITIONS];  // reference peak of each block
+    uint32_t  head_;              // newest reference spectrum
+    uint32_t  constrain_;         // partition made causal next
+    float    *power_;             // AEC_BINS
+    float    *echoRe_, *echoIm_;  // AEC_BINS
+    float    *errRe_, *errIm_;    // AEC_BINS
+    float    *frame_;             // AEC_FFT_SIZE time domain scratch
+    uint32_t  divergeCount_;
+    float     micEnergy_, errEnergy_;
+
+    std::atomic<uint32_t> blocks_;
+    std::atomic<uint32_t> adaptedBlocks_;
+    std::atomic<uint32_t> doubleTalk_;
+    std::atomic<uint32_t> refUnderruns_;
+    std::atomic<uint32_t> refDropped_;
+    std::atomic<uint32_t> resets_;
+    std::atomic<float>    erleDb_;
+};
+
+#endif //NATIVE_AUDIO_ECHO_CANCELLER_H
@@ -0,0 +1,470 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+#include "effect_chain.h"
+#include "audio_kernels.h"
+
+static uint64_t nowNs(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+static float *allocFloats(uint32_t count) {
+    void *mem = nullptr;
+    if (posix_memalign(&mem, CACHE_ALIGN, count * sizeof(float))) {
+        return nullptr;
+    }
+    memset(mem, 0, count * sizeof(float));
+    return static_cast<float*>(mem);
+}
+
+/*
+ * SmoothedParam: linear ramp from the current value to the last target
+ */
+struct SmoothedParam {
+    float     value_;
+    float     target_;
+    float     step_;
+    uint32_t  left_;        // samples to go
+
+    void Reset(float value) {
+        value_ = target_ = value;
+        step_ = 0.0f;
+        left_ = 0;
+    }
+    void SetTarget(float target, uint32_t samples) {
+        target_ = target;
+        left_ = samples ? samples : 1;
+        step_ = (target_ - value_) / left_;
+    }
+    bool Moving(void) {
+        return left_ != 0;
+    }
+    // value at the first of the next count samples, *step per sample after
+    // that; the ramp never runs past the end of the block
+    float Next(uint32_t count, float *step) {
+        float start = value_;
+        *step = 0.0f;
+        if (!left_) {
+            return start;
+        }
+        if (left_ <= count) {
+            *step = (target_ - value_) / count;
+            value_ = target_;
+            left_ = 0;
+        } else {
+            *step = step_;
+            value_ += step_ * count;
+            left_ -= count;
+        }
+        return start;
+    }
+};
+
+/*
+ * EffectNode: one stage of the chain. Both calls come on the audio
+ * thread; count is in samples ( frames * channels, interleaved ).
+ */
+class EffectNode {
+public:
+    virtual ~EffectNode() {}
+    virtual void SetParam(uint32_t param, float value) = 0;
+    virtual void Process(float *samples, uint32_t count) = 0;
+};
+
+class GainNode : public EffectNode {
+public:
+    explicit GainNode(uint32_t smoothSamples) : smooth_(smoothSamples) {
+        gain_.Reset(1.0f);
+    }
+    void SetParam(uint32_t param, float value) {
+        if (param == EFFECT_PARAM_GAIN) {
+            gain_.SetTarget(value, smooth_);
+        }
+    }
+    void Process(float *samples, uint32_t count) {
+        float step;
+        float gain = gain_.Next(count, &step);
+        if (gain != 1.0f || step != 0.0f) {
+            scaleFloat(samples, count, gain, step);
+        }
+    }
+private:
+    uint32_t      smooth_;
+    SmoothedParam gain_;
+};
+
+/*
+ * BiquadNode: RBJ cookbook filters, transposed direct form II. The
+ * recursion is serial, so this one stays scalar; coefficients follow the
+ * smoothed parameters once per buffer.
+ */
+class BiquadNode : public EffectNode {
+public:
+    BiquadNode(SampleFormat *format, uint32_t smoothSamples) :
+        smooth_(smoothSamples), shape_(BIQUAD_PEAKING) {
+        sampleRate_ = format->sampleRate_ / 1000.0f;    // milliHz -> Hz
+        channels_ = format->channels_;
+        assert(channels_ <= EFFECT_MAX_CHANNELS);
+        freq_.Reset(1000.0f);
+        q_.Reset(0.707f);
+        gainDb_.Reset(0.0f);
+        memset(z1_, 0, sizeof(z1_));
+        memset(z2_, 0, sizeof(z2_));
+        updateCoefs();
+    }
+    void SetParam(uint32_t param, float value) {
+        switch (param) {
+            case EFFECT_PARAM_SHAPE:
+                shape_ = static_cast<uint32_t>(value);
+                updateCoefs();
+                break;
+            case EFFECT_PARAM_FREQ:
+                freq_.SetTarget(value, smooth_);
+                break;
+            case EFFECT_PARAM_Q:
+                q_.SetTarget(value, smooth_);
+                break;
+            case EFFECT_PARAM_GAIN:
+                gainDb_.SetTarget(value, smooth_);
+                break;
+        }
+    }
+    void Process(float *samples, uint32_t count) {
+        if (freq_.Moving() || q_.Moving() || gainDb_.Moving()) {
+            float step;
+            freq_.Next(count, &step);
+            q_.Next(count, &step);
+            gainDb_.Next(count, &step);
+            updateCoefs();
+        } else if (shape_ == BIQUAD_PEAKING && gainDb_.value_ == 0.0f) {
+            return;     // flat
+        }
+        for (uint32_t c = 0; c < channels_; c++) {
+            float z1 = z1_[c], z2 = z2_[c];
+            for (uint32_t i = c; i < count; i += channels_) {
+                float x = samples[i];
+                float y = b0_ * x + z1;
+                z1 = b1_ * x - a1_ * y + z2;
+                z2 = b2_ * x - a2_ * y;
+                samples[i] = y;
+            }
+            z1_[c] = z1;
+            z2_[c] = z2;
+        }
+    }
+private:
+    void updateCoefs(void) {
+        float freq = freq_.value_;
+        freq = freq < 10.0f ? 10.0f : (freq > 0.45f * sampleRate_ ? 0.45f * sampleRate_ : freq);
+        float q = q_.value_ < 0.1f ? 0.1f : q_.value_;
+        float w0 = 2.0f * static_cast<float>(M_PI) * freq / sampleRate_;
+        float cosW = cosf(w0);
+        float alpha = sinf(w0) / (2.0f * q);
+        float a0;
+        switch (shape_) {
+            case BIQUAD_LOWPASS:
+                b0_ = b2_ = (1.0f - cosW) / 2.0f;
+                b1_ = 1.0f - cosW;
+                a0  = 1.0f + alpha;
+                a2_ = 1.0f - alpha;
+                break;
+            case BIQUAD_HIGHPASS:
+                b0_ = b2_ = (1.0f + cosW) / 2.0f;
+                b1_ = -(1.0f + cosW);
+                a0  = 1.0f + alpha;
+                a2_ = 1.0f - alpha;
+                break;
+            default: {
+                float a = powf(10.0f, gainDb_.value_ / 40.0f);
+                b0_ = 1.0f + alpha * a;
+                b1_ = -2.0f * cosW;
+                b2_ = 1.0f - alpha * a;
+                a0  = 1.0f + alpha / a;
+                a2_ = 1.0f - alpha / a;
+                break;
+            }
+        }
+        a1_ = -2.0f * cosW;
+        b0_ /= a0, b1_ /= a0, b2_ /= a0, a1_ /= a0, a2_ /= a0;
+    }
+
+    float         sampleRate_;
+    uint32_t      channels_;
+    uint32_t      smooth_;
+    uint32_t      shape_;
+    SmoothedParam freq_, q_, gainDb_;
+    float         b0_, b1_, b2_, a1_, a2_;
+    float         z1_[EFFECT_MAX_CHANNELS], z2_[EFFECT_MAX_CHANNELS];
+};
+
+/*
+ * DelayNode: delay line with feedback. The delay is at least one buffer,
+ * so the part read in one buffer never overlaps the part written: the tap
+ * is copied out and the rest are vector kernels. A new delay time
+ * crossfades from the old tap to the new one over one buffer.
+ */
+class DelayNode : public EffectNode {
+public:
+    DelayNode(SampleFormat *format, uint32_t smoothSamples, uint32_t capSamples) :
+        smooth_(smoothSamples), capSamples_(capSamples), write_(0) {
+        channels_ = format->channels_;
+        samplesPerMs_ = format->sampleRate_ / 1000000.0f * channels_;
+        lineLen_ = static_cast<uint32_t>(samplesPerMs_ * EFFECT_DELAY_MAX_MS) + 2 * capSamples_;
+        line_ = allocFloats(lineLen_);
+        tap_  = allocFloats(capSamples_);
+        feed_ = allocFloats(capSamples_);
+        assert(line_ && tap_ && feed_);
+        delay_ = pendingDelay_ = toSamples(250.0f);
+        feedback_.Reset(0.3f);
+        mix_.Reset(0.0f);
+    }
+    ~DelayNode() {
+        free(line_);
+        free(tap_);
+        free(feed_);
+    }
+    void SetParam(uint32_t param, float value) {
+        switch (param) {
+            case EFFECT_PARAM_TIME_MS:
+                pendingDelay_ = toSamples(value);
+                break;
+            case EFFECT_PARAM_FEEDBACK:
+                feedback_.SetTarget(value < 0.99f ? value : 0.99f, smooth_);
+                break;
+            case EFFECT_PARAM_MIX:
+                mix_.SetTarget(value, smooth_);
+                break;
+        }
+    }
+    void Process(float *samples, uint32_t count) {
+        gather(tap_, delay_, count);
+        if (pendingDelay_ != delay_) {
+            gather(feed_, pendingDelay_, count);
+            scaleFloat(tap_, count, 1.0f, -1.0f / count);
+            mixFloat(feed_, tap_, count, 0.0f, 1.0f / count);
+            delay_ = pendingDelay_;
+        }
+
+        float fbStep, mixStep;
+        float feedback = feedback_.Next(count, &fbStep);
+        float mix = mix_.Next(count, &mixStep);
+        memcpy(feed_, samples, count * sizeof(float));
+        mixFloat(tap_, feed_, count, feedback, fbStep);
+        scatter(feed_, count);
+        if (mix != 0.0f || mixStep != 0.0f) {
+            mixFloat(tap_, samples, count, mix, mixStep);
+        }
+    }
+private:
+    uint32_t toSamples(float ms) {
+        uint32_t samples = static_cast<uint32_t>(ms * samplesPerMs_);
+        samples -= samples % channels_;
+        uint32_t minDelay = (capSamples_ + channels_ - 1) / channels_ * channels_;
+        uint32_t maxDelay = (lineLen_ - capSamples_) / channels_ * channels_;
+        return samples < minDelay ? minDelay : (samples > maxDelay ? maxDelay : samples);
+    }
+    void gather(float *dst, uint32_t delay, uint32_t count) {
+        uint32_t read = (write_ + lineLen_ - delay) % lineLen_;
+        uint32_t first = lineLen_ - read < count ? lineLen_ - read : count;
+        memcpy(dst, line_ + read, first * sizeof(float));
+        memcpy(dst + first, line_, (count - first) * sizeof(float));
+    }
+    void scatter(const float *src, uint32_t count) {
+        uint32_t first = lineLen_ - write_ < count ? lineLen_ - write_ : count;
+        memcpy(line_ + write_, src, first * sizeof(float));
+        memcpy(line_, src + first, (count - first) * sizeof(float));
+        write_ = (write_ + count) % lineLen_;
+    }
+
+    uint32_t      channels_;
+    uint32_t      smooth_;
+    uint32_t      capSamples_;
+    float         samplesPerMs_;
+    float        *line_;        // owner
+    float        *tap_;         // owner, delayed samples of this buffer
+    float        *feed_;        // owner, what goes back into the line
+    uint32_t      lineLen_;
+    uint32_t      write_;
+    uint32_t      delay_;       // in samples
+    uint32_t      pendingDelay_;
+    SmoothedParam feedback_, mix_;
+};
+
+/*
+ * LimiterNode: peak limiter without look ahead. Every EFFECT_LIMITER_CHUNK
+ * samples the peak sets the gain: down at once when over the threshold,
+ * back up with the release time constant, ramped over the chunk.
+ */
+class LimiterNode : public EffectNode {
+public:
+    LimiterNode(SampleFormat *format, uint32_t smoothSamples) :
+        smooth_(smoothSamples), gain_(1.0f) {
+        samplesPerMs_ = format->sampleRate_ / 1000000.0f * format->channels_;
+        threshold_.Reset(0.9f);
+        setRelease(100.0f);
+    }
+    void SetParam(uint32_t param, float value) {
+        switch (param) {
+            case EFFECT_PARAM_THRESHOLD:
+                threshold_.SetTarget(value, smooth_);
+                break;
+            case EFFECT_PARAM_RELEASE_MS:
+                setRelease(value);
+                break;
+        }
+    }
+    void Process(float *samples, uint32_t count) {
+        float step;
+        threshold_.Next(count, &step);
+        float threshold = threshold_.value_;
+        for (uint32_t i = 0; i < count; i += EFFECT_LIMITER_CHUNK) {
+            uint32_t n = count - i < EFFECT_LIMITER_CHUNK ? count - i : EFFECT_LIMITER_CHUNK;
+            float peak = peakAbsFloat(samples + i, n);
+            float needed = peak > threshold ? threshold / peak : 1.0f;
+            if (needed < gain_) {
+                gain_ = needed;
+                scaleFloat(samples + i, n, gain_, 0.0f);
+            } else if (gain_ < 1.0f) {
+                float next = gain_ + (needed - gain_) * release_;
+                scaleFloat(samples + i, n, gain_, (next - gain_) / n);
+                gain_ = next > 0.9999f ? 1.0f : next;
+            }
+        }
+    }
+private:
+    void setRelease(float ms) {
+        float samples = ms * samplesPerMs_;
+        release_ = samples > 1.0f ? 1.0f - expf(-EFFECT_LIMITER_CHUNK / samples) : 1.0f;
+    }
+
+    uint32_t      smooth_;
+    float         samplesPerMs_;
+    SmoothedParam threshold_;
+    float         release_;     // share of the way back to unity per chunk
+    float         gain_;
+};
+
+EffectChain::EffectChain(SampleFormat *format) : nodeCount_(0) {
+    assert(format && format->pcmFormat_ == SL_PCMSAMPLEFORMAT_FIXED_16);
+    sampleInfo_ = *format;
+    capSamples_ = (sampleInfo_.framesPerBuf_ + 1) * sampleInfo_.channels_;
+    scratch_ = allocFloats(capSamples_);
+    commands_ = new ProducerConsumerQueue<EffectCommand>(EFFECT_COMMAND_QUEUE_LEN);
+    assert(scratch_ && commands_);
+    memset(nodes_, 0, sizeof(nodes_));
+    memset(cost_, 0, sizeof(cost_));
+}
+
+EffectChain::~EffectChain() {
+    for (uint32_t i = 0; i < nodeCount_; i++) {
+        delete nodes_[i];
+        delete cost_[i];
+    }
+    delete commands_;
+    free(scratch_);
+}
+
+/*
+ * AddNode(): append a node of type at its default ( transparent or close
+ * to it ) settings; returns its index, -1 when it can not be added
+ */
+int32_t EffectChain::AddNode(uint32_t type) {
+    if (nodeCount_ >= EFFECT_MAX_NODES) {
+        return -1;
+    }
+    // sampleRate_ is in milliHz
+    uint32_t smoothSamples = static_cast<uint32_t>(
+            static_cast<uint64_t>(sampleInfo_.sampleRate_) * EFFECT_SMOOTH_MS / 1000000)
+            * sampleInfo_.channels_;
+    EffectNode *node;
+    switch (type) {
+        case EFFECT_GAIN:
+            node = new GainNode(smoothSamples);
+            break;
+        case EFFECT_BIQUAD:
+            node = new BiquadNode(&sampleInfo_, smoothSamples);
+            break;
+        case EFFECT_DELAY:
+            node = new DelayNode(&sampleInfo_, smoothSamples, capSamples_);
+            break;
+        case EFFECT_LIMITER:
+            node = new LimiterNode(&sampleInfo_, smoothSamples);
+            break;
+        default:
+            LOGE("====%s: unknown effect type %d", __FUNCTION__, type);
+            return -1;
+    }
+    nodes_[nodeCount_] = node;
+    types_[nodeCount_] = type;
+    cost_[nodeCount_] = new AudioHistogram(EFFECT_COST_BIN_WIDTH_NS, EFFECT_COST_BIN_COUNT);
+    return nodeCount_++;
+}
+
+/*
+ * SetParam(): queue a parameter change for the audio thread; false when
+ * the node does not exist or the command queue is full
+ */
+bool EffectChain::SetParam(int32_t node, uint32_t param, float value) {
+    if (node < 0 || static_cast<uint32_t>(node) >= nodeCount_) {
+        return false;
+    }
+    EffectCommand cmd = { static_cast<uint32_t>(node), param, value };
+    return commands_->push(cmd);
+}
+
+void EffectChain::Process(sample_buf *buf) {
+    EffectCommand cmd;
+    while (commands_->front(&cmd)) {
+        nodes_[cmd.node_]->SetParam(cmd.param_, cmd.value_);
+        commands_->pop();
+    }
+    if (!nodeCount_) {
+        return;
+    }
+
+    uint32_t count = buf->size_ / sizeof(int16_t);
+    count = count < capSamples_ ? count : capSamples_;
+    int16_t *samples = reinterpret_cast<int16_t*>(buf->buf_);
+    convertPcm16ToFloat(samples, scratch_, count);
+    for (uint32_t i = 0; i < nodeCount_; i++) {
+        uint64_t start = nowNs();
+        nodes_[i]->Process(scratch_, count);
+        cost_[i]->Record(static_cast<uint32_t>(nowNs() - start));
+    }
+    convertFloatToPcm16(scratch_, samples, count);
+}
+
+void EffectChain::GetNodeStats(int32_t node, EffectNodeStats *stats) {
+    assert(node >= 0 && static_cast<uint32_t>(node) < nodeCount_ && stats);
+    stats->type_      = types_[node];
+    stats->blocks_    = cost_[node]->Count();
+    stats->costP50Ns_ = cost_[node]->Percentile(50);
+    stats->costP99Ns_ = cost_[node]->Percentile(99);
+    stats->costMaxNs_ = cost_[node]->Max();
+}
+
+void EffectChain::ResetStats(void) {
+    for (uint32_t i = 0; i < nodeCount_; i++) {
+        cost_[i]->Reset();
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_EFFECT_CHAIN_H
+#define NATIVE_AUDIO_EFFECT_CHAIN_H
+#include <sys/types.h>
+#include "audio_common.h"
+#include "audio_stats.h"
+#include "buf_manager.h"
+
+/*
+ * Effect node types and their parameters ( EffectChain::SetParam() ):
+ *   EFFECT_GAIN:     EFFECT_PARAM_GAIN         linear
+ *   EFFECT_BIQUAD:   EFFECT_PARAM_SHAPE        BIQUAD_* ( not smoothed )
+ *                    EFFECT_PARAM_FREQ         Hz
+ *                    EFFECT_PARAM_Q
+ *                    EFFECT_PARAM_GAIN         dB, BIQUAD_PEAKING only
+ *   EFFECT_DELAY:    EFFECT_PARAM_TIME_MS      one buffer .. EFFECT_DELAY_MAX_MS
+ *                    EFFECT_PARAM_FEEDBACK     linear, < 1.0
+ *                    EFFECT_PARAM_MIX          linear, delayed signal added
+ *   EFFECT_LIMITER:  EFFECT_PARAM_THRESHOLD    linear, of full scale
+ *                    EFFECT_PARAM_RELEASE_MS
+ */
+#define EFFECT_GAIN             0
+#define EFFECT_BIQUAD           1
+#define EFFECT_DELAY            2
+#define EFFECT_LIMITER          3
+
+#define EFFECT_PARAM_GAIN       0
+#define EFFECT_PARAM_SHAPE      1
+#define EFFECT_PARAM_FREQ       2
+#define EFFECT_PARAM_Q          3
+#define EFFECT_PARAM_TIME_MS    4
+#define EFFECT_PARAM_FEEDBACK   5
+#define EFFECT_PARAM_MIX        6
+#define EFFECT_PARAM_THRESHOLD  7
+#define EFFECT_PARAM_RELEASE_MS 8
+
+#define BIQUAD_PEAKING          0
+#define BIQUAD_LOWPASS          1
+#define BIQUAD_HIGHPASS         2
+
+/*
+ * Effect chain controls:
+ *   EFFECT_MAX_NODES:        nodes in one chain
+ *   EFFECT_MAX_CHANNELS:     channels a biquad keeps state for
+ *   EFFECT_COMMAND_QUEUE_LEN: parameter changes in flight to the audio
+ *        thread; SetParam() fails when they pile up beyond this
+ *   EFFECT_SMOOTH_MS:        parameter changes are ramped over this long
+ *   EFFECT_DELAY_MAX_MS:     delay line length, allocated in AddNode()
+ *   EFFECT_LIMITER_CHUNK:    samples the limiter takes one peak over
+ */
+#define EFFECT_MAX_NODES          8
+#define EFFECT_MAX_CHANNELS       2
+#define EFFECT_COMMAND_QUEUE_LEN  64
+#define EFFECT_SMOOTH_MS          20
+#define EFFECT_DELAY_MAX_MS       1000
+#define EFFECT_LIMITER_CHUNK      16
+#define EFFECT_COST_BIN_WIDTH_NS  100
+#define EFFECT_COST_BIN_COUNT     2000      // up to 200 us
+
+/*
+ * snapshot handed out with ENGINE_SERVICE_MSG_GET_EFFECT_STATS, per node
+ */
+struct EffectNodeStats {
+    uint32_t  type_;
+    uint32_t  blocks_;          // buffers processed
+    uint32_t  costP50Ns_;       // processing time of one buffer, in ns
+    uint32_t  costP99Ns_;
+    uint32_t  costMaxNs_;
+};
+
+class EffectNode;
+
+/*
+ * EffectChain: effect nodes run one after the other over every buffer,
+ * in place. The 16 bit samples are converted to float once, go through
+ * all nodes and are converted back ( saturating ) at the end.
+ *
+ * Everything is allocated when the chain is built ( AddNode() ), so
+ * Process() never allocates or locks. Parameter changes travel to the
+ * audio thread through a ProducerConsumerQueue of commands, which
+ * Process() drains before each buffer; the nodes ramp to the new values
+ * over EFFECT_SMOOTH_MS.
+ *
+ * Threads: AddNode() before processing starts; SetParam() from ONE
+ * control thread; Process() on the audio thread; stats from anywhere.
+ */
+class EffectChain {
+public:
+    explicit EffectChain(SampleFormat *format);
+    ~EffectChain();
+    int32_t   AddNode(uint32_t type);
+    bool      SetParam(int32_t node, uint32_t param, float value);
+    void      Process(sample_buf *buf);
+    uint32_t  NodeCount(void) { return nodeCount_; }
+    void      GetNodeStats(int32_t node, EffectNodeStats *stats);
+    void      ResetStats(void);
+
+private:
+    struct EffectCommand {
+        uint32_t  node_;
+        uint32_t  param_;
+        float     value_;
+    };
+
+    SampleFormat  sampleInfo_;
+    uint32_t      capSamples_;      // one buffer plus the spare frame
+    float        *scratch_;         // owner
+
+    EffectNode   *nodes_[EFFECT_MAX_NODES];    // owner
+    uint32_t      types_[EFFECT_MAX_NODES];
+    AudioHistogram *cost_[EFFECT_MAX_NODES];   // owner
+    uint32_t      nodeCount_;
+
+    ProducerConsumerQueue<EffectCommand> *commands_;   // owner
+};
+
+#endif //NATIVE_AUDIO_EFFECT_CHAIN_H
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "fft.h"
+#include "audio_kernels.h"
+
+RealFft::RealFft(uint32_t size) : size_(size), half_(size / 2) {
+    assert(size >= 16 && !(size & (size - 1)));
+    // one allocation: bitrev | twiddles | split twiddles | work
+    size_t floats = 2 * half_ + 2 * (half_ + 1) + 2 * half_;
+    size_t bytes = half_ * sizeof(uint32_t) + floats * sizeof(float);
+    if (posix_memalign(&mem_, 64, bytes)) {
+        mem_ = nullptr;
+    }
+    assert(mem_);
+    bitrev_  = static_cast<uint32_t*>(mem_);
+    twRe_    = reinterpret_cast<float*>(bitrev_ + half_);
+    twIm_    = twRe_ + half_;
+    splitRe_ = twIm_ + half_;
+    splitIm_ = splitRe_ + half_ + 1;
+    workRe_  = splitIm_ + half_ + 1;
+    workIm_  = workRe_ + half_;
+
+    uint32_t bits = 0;
+    while ((1u << bits) < half_) {
+        bits++;
+    }
+    for (uint32_t i = 0; i < half_; i++) {
+        uint32_t r = 0;
+        for (uint32_t b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitrev_[i] = r;
+    }
+    for (uint32_t h = 1; h < half_; h <<= 1) {
+        for (uint32_t j = 0; j < h; j++) {
+            double angle = -M_PI * j / h;
+            twRe_[h - 1 + j] = static_cast<float>(cos(angle));
+            twIm_[h - 1 + j] = static_cast<float>(sin(angle));
+        }
+    }
+    for (uint32_t k = 0; k <= half_; k++) {
+        double angle = -2.0 * M_PI * k / size_;
+        splitRe_[k] = static_cast<float>(cos(angle));
+        splitIm_[k] = static_cast<float>(sin(angle));
+    }
+}
+
+RealFft::~RealFft() {
+    free(mem_);
+}
+
+/*
+ * complexFft(): radix-2 decimation in time over workRe_/workIm_, input in
+ * bit reversed order, output in order
+ */
+void RealFft::complexFft(void) {
+    float *re = workRe_, *im = workIm_;
+    // span 1 and 2: twiddles are 1 and -i
+    for (uint32_t g = 0; g < half_; g += 4) {
+        float r0 = re[g] + re[g + 1], i0 = im[g] + im[g + 1];
+        float r1 = re[g] - re[g + 1], i1 = im[g] - im[g + 1];
+        float r2 = re[g + 2] + re[g + 3], i2 = im[g + 2] + im[g + 3];
+        float r3 = re[g + 2] - re[g + 3], i3 = im[g + 2] - im[g + 3];
+        re[g]     = r0 + r2;  im[g]     = i0 + i2;
+        re[g + 2] = r0 - r2;  im[g + 2] = i0 - i2;
+        // (r3 + i i3) * -i = i3 - i r3
+        re[g + 1] = r1 + i3;  im[g + 1] = i1 - r3;
+        re[g + 3] = r1 - i3;  im[g + 3] = i1 + r3;
+    }
+
+    for (uint32_t h = 4; h < half_; h <<= 1) {
+        const float *wr = twRe_ + h - 1, *wi = twIm_ + h - 1;
+        for (uint32_t g = 0; g < half_; g += 2 * h) {
+            float *ar = re + g, *ai = im + g, *br = re + g + h, *bi = im + g + h;
+            uint32_t j = 0;
+#if defined(AUDIO_KERNELS_NEON)
+            for (; j + 4 <= h; j += 4) {
+                float32x4_t xr = vld1q_f32(br + j), xi = vld1q_f32(bi + j);
+                float32x4_t cr = vld1q_f32(wr + j), ci = vld1q_f32(wi + j);
+                float32x4_t tr = vmlsq_f32(vmulq_f32(xr, cr), xi, ci);
+                float32x4_t ti = vmlaq_f32(vmulq_f32(xr, ci), xi, cr);
+                float32x4_t ur = vld1q_f32(ar + j), ui = vld1q_f32(ai + j);
+                vst1q_f32(ar + j, vaddq_f32(ur, tr));
+                vst1q_f32(ai + j, vaddq_f32(ui, ti));
+                vst1q_f32(br + j, vsubq_f32(ur, tr));
+                vst1q_f32(bi + j, vsubq_f32(ui, ti));
+            }
+#elif defined(AUDIO_KERNELS_SSE2)
+            for (; j + 4 <= h; j += 4) {
+                __m128 xr = _mm_loadu_ps(br + j), xi = _mm_loadu_ps(bi + j);
+                __m128 cr = _mm_loadu_ps(wr + j), ci = _mm_loadu_ps(wi + j);
+                __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, cr), _mm_mul_ps(xi, ci));
+                __m128 ti = _mm_add_ps(_mm_mul_ps(xr, ci), _mm_mul_ps(xi, cr));
+                __m128 ur = _mm_loadu_ps(ar + j), ui = _mm_loadu_ps(ai + j);
+                _mm_storeu_ps(ar + j, _mm_add_ps(ur, tr));
+                _mm_storeu_ps(ai + j, _mm_add_ps(ui, ti));
+                _mm_storeu_ps(br + j, _mm_sub_ps(ur, tr));
+                _mm_storeu_ps(bi + j, _mm_sub_ps(ui, ti));
+            }
+#endif
+            for (; j < h; j++) {
+                float tr = br[j] * wr[j] - bi[j] * wi[j];
+                float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+void RealFft::Forward(const float *in, float *re, float *im) {
+    for (uint32_t n = 0; n < half_; n++) {
+        workRe_[bitrev_[n]] = in[2 * n];
+        workIm_[bitrev_[n]] = in[2 * n + 1];
+    }
+    complexFft();
+
+    // Z = FFT(even + i odd): E[k] = (Z[k] + Z*[M-k]) / 2, O[k] = (Z[k] - Z*[M-k]) / 2i,
+    // X[k] = E[k] + W^k O[k]; k and M - k are done together
+    for (uint32_t k = 0; k <= half_ / 2; k++) {
+        uint32_t m = half_ - k;
+        float zr = workRe_[k & (half_ - 1)], zi = workIm_[k & (half_ - 1)];
+        float yr = workRe_[m & (half_ - 1)], yi = workIm_[m & (half_ - 1)];
+        float er = 0.5f * (zr + yr), ei = 0.5f * (zi - yi);
+        float orr = 0.5f * (zi + yi), oi = -0.5f * (zr - yr);
+        float cr = splitRe_[k], ci = splitIm_[k];
+        re[k] = er + cr * orr - ci * oi;
+        im[k] = ei + cr * oi + ci * orr;
+        // X[M - k] = E*[k] - (W^k O[k])*, since W^(M-k) = -(W^k)*
+        re[m] = er - (cr * orr - ci * oi);
+        im[m] = -ei + (cr * oi + ci * orr);
+    }
+    im[0] = 0.0f;
+    im[half_] = 0.0f;
+}
+
+void RealFft::Inverse(const float *re, const float *im, float *out) {
+    // back to Z[k] = E[k] + i O[k], then inverse complex FFT as the
+    // conjugate of the forward one
+    for (uint32_t k = 0; k < half_; k++) {
+        uint32_t m = half_ - k;
+        float er = 0.5f * (re[k] + re[m]), ei = 0.5f * (im[k] - im[m]);
+        float dr = re[k] - re[m], di = im[k] + im[m];
+        float cr = splitRe_[k], ci = splitIm_[k];
+        float orr = 0.5f * (dr * cr + di * ci), oi = 0.5f * (di * cr - dr * ci);
+        workRe_[bitrev_[k]] = er - oi;
+        workIm_[bitrev_[k]] = -(ei + orr);
+    }
+    complexFft();
+    float scale = 1.0f / half_;
+    for (uint32_t n = 0; n < half_; n++) {
+        out[2 * n] = workRe_[n] * scale;
+        out[2 * n + 1] = -workIm_[n] * scale;
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_FFT_H
+#define NATIVE_AUDIO_FFT_H
+#include <sys/types.h>
+#include <stdint.h>
+
+/*
+ * RealFft: FFT of a real signal of Size() points ( power of 2, >= 16 ).
+ *   Forward(): Size() samples --> Size()/2 + 1 complex bins, split into
+ *              re[] and im[] arrays ( bin 0 and Size()/2 have im 0 )
+ *   Inverse(): the exact inverse, 1/Size() scaling included
+ * Done as one complex FFT of Size()/2 points ( even samples real, odd
+ * samples imaginary ) plus a split pass. The butterflies of the later
+ * stages run 4 wide on NEON/SSE2. Twiddles, the bit reverse table and
+ * the work area are allocated in the constructor: no allocation when
+ * transforming, but one object must not be used by two threads at once.
+ */
+class RealFft {
+public:
+    explicit RealFft(uint32_t size);
+    ~RealFft();
+    uint32_t Size(void) { return size_; }
+    void     Forward(const float *in, float *re, float *im);
+    void     Inverse(const float *re, const float *im, float *out);
+
+private:
+    void     complexFft(void);
+
+    uint32_t  size_;
+    uint32_t  half_;
+    uint32_t *bitrev_;      // half_ entries
+    float    *twRe_;        // butterfly twiddles, stage of span h at [h - 1]
+    float    *twIm_;
+    float    *splitRe_;     // e^(-2 pi i k / size_), k <= half_
+    float    *splitIm_;
+    float    *workRe_;      // half_ complex points
+    float    *workIm_;
+    void     *mem_;         // owner of all of the above
+};
+
+#endif //NATIVE_AUDIO_FFT_H
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cassert>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "file_source.h"
+
+#define WAV_FORMAT_PCM          0x0001
+#define WAV_FORMAT_EXTENSIBLE   0xFFFE
+
+static uint32_t readLE32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint16_t readLE16(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+MappedFileSource::MappedFileSource(SampleFormat *format) :
+    map_(nullptr), mapSize_(0), data_(nullptr), dataSize_(0),
+    cursor_(0), loopCount_(0) {
+    assert(format);
+    sampleInfo_ = *format;
+    frameSize_ = sampleInfo_.channels_ * (sampleInfo_.pcmFormat_ >> 3);
+    bufSize_   = sampleInfo_.framesPerBuf_ * frameSize_;
+    assert(frameSize_ && bufSize_);
+
+    memset(bufs_, 0, sizeof(bufs_));
+    freeQueue_ = new AudioQueue(FILE_SOURCE_BUF_COUNT, true);
+    playQueue_ = new AudioQueue(FILE_SOURCE_BUF_COUNT, true);
+    assert(freeQueue_ && playQueue_);
+}
+
+MappedFileSource::~MappedFileSource() {
+    Close();
+    delete playQueue_;
+    delete freeQueue_;
+}
+
+/*
+ * parseWav(): locate the data chunk and check the fmt chunk against the
+ * fast path format. Not a RIFF file: the whole file is raw PCM.
+ */
+bool MappedFileSource::parseWav(const uint8_t *file, size_t fileSize) {
+    if (fileSize < 12 || memcmp(file, "RIFF", 4) || memcmp(file + 8, "WAVE", 4)) {
+        data_ = file;
+        dataSize_ = static_cast<uint32_t>(fileSize);
+        return true;
+    }
+
+    bool fmtFound = false;
+    size_t offset = 12;
+    while (offset + 8 <= fileSize) {
+        const uint8_t *chunk = file + offset;
+        uint32_t chunkSize = readLE32(chunk + 4);
+        size_t available = fileSize - offset - 8;
+        if (!memcmp(chunk, "fmt ", 4)) {
+            if (chunkSize < 16 || chunkSize > available) {
+                break;
+            }
+            uint16_t tag      = readLE16(chunk + 8);
+            uint16_t channels = readLE16(chunk + 10);
+            uint32_t rate     = readLE32(chunk + 12);
+            uint16_t bits     = readLE16(chunk + 22);
+            if ((tag != WAV_FORMAT_PCM && tag != WAV_FORMAT_EXTENSIBLE) ||
+                channels != sampleInfo_.channels_ ||
+                bits != sampleInfo_.pcmFormat_ ||
+                static_cast<SLmilliHertz>(rate) * 1000 != sampleInfo_.sampleRate_) {
+                LOGE("====MappedFileSource: %d ch/%d Hz/%d bit (tag 0x%x) is not "
+                     "the fast path format, use the decoder", channels, rate, bits, tag);
+                return false;
+            }
+            fmtFound = true;
+        } else if (!memcmp(chunk, "data", 4)) {
+            if (!fmtFound) {
+                break;
+            }
+            // streaming writers leave the size at 0 or ~0: take what is there
+            data_ = chunk + 8;
+            dataSize_ = static_cast<uint32_t>(
+                    (chunkSize && chunkSize <= available) ? chunkSize : available);
+            return true;
+        }
+        if (chunkSize > available) {
+            break;          // runs past the end, and would wrap offset
+        }
+        offset += 8 + chunkSize + (chunkSize & 1);    // chunks are word aligned
+    }
+    LOGE("====MappedFileSource: malformed WAV file");
+    return false;
+}
+
+bool MappedFileSource::Open(const char *path) {
+    Close();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LOGE("====MappedFileSource: cannot open %s", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    mapSize_ = static_cast<size_t>(st.st_size);
+    map_ = mmap(NULL, mapSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);      // the mapping keeps the file
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        mapSize_ = 0;
+        LOGE("====MappedFileSource: mmap failed for %s", path);
+        return false;
+    }
+    madvise(map_, mapSize_, MADV_SEQUENTIAL);
+    madvise(map_, mapSize_ < FILE_SOURCE_PREFETCH ? mapSize_ : FILE_SOURCE_PREFETCH,
+            MADV_WILLNEED);
+
+    if (!parseWav(static_cast<const uint8_t*>(map_), mapSize_)) {
+        Close();
+        return false;
+    }
+    dataSize_ -= dataSize_ % frameSize_;
+    if (!dataSize_) {
+        Close();
+        return false;
+    }
+    Rewind();
+    return true;
+}
+
+void MappedFileSource::Close(void) {
+    if (map_) {
+        munmap(map_, mapSize_);
+    }
+    map_ = nullptr;
+    mapSize_ = 0;
+    data_ = nullptr;
+    dataSize_ = 0;
+}
+
+/*
+ * Rewind(): back to the start of the data with all descriptors free;
+ * call it while the player is stopped
+ */
+void MappedFileSource::Rewind(void) {
+    sample_buf *buf;
+    while (playQueue_->front(&buf)) {
+        playQueue_->pop();
+    }
+    while (freeQueue_->front(&buf)) {
+        freeQueue_->pop();
+    }
+    for (int i = 0; i < FILE_SOURCE_BUF_COUNT; i++) {
+        bufs_[i].size_ = 0;
+        freeQueue_->push(&bufs_[i]);
+    }
+    cursor_ = 0;
+    loopCount_ = 0;
+}
+
+/*
+ * Fill(): point every descriptor the player returned at the next piece
+ * of the file and queue it for playing. File buffers carry no capture
+ * time, so they stay out of the echo latency stats.
+ */
+void MappedFileSource::Fill(void) {
+    if (!data_) {
+        return;
+    }
+    sample_buf *bufs[FILE_SOURCE_BUF_COUNT];
+    int count = freeQueue_->pop_n(bufs, playQueue_->space());
+    for (int i = 0; i < count; i++) {
+        uint32_t size = dataSize_ - cursor_;
+        if (size > bufSize_) {
+            size = bufSize_;
+        }
+        bufs[i]->buf_  = const_cast<uint8_t*>(data_ + cursor_);
+        bufs[i]->cap_  = size;
+        bufs[i]->size_ = size;
+        bufs[i]->captureTime_ = 0;            // not captured: no latency to measure
+        cursor_ += size;
+        if (cursor_ == dataSize_) {
+            cursor_ = 0;
+            loopCount_++;
+        }
+    }
+    playQueue_->push_n(bufs, count);
+}
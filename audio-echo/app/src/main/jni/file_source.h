@@ -0,0 +1,78 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_FILE_SOURCE_H
+#define NATIVE_AUDIO_FILE_SOURCE_H
+#include <sys/types.h>
+#include "audio_common.h"
+#include "buf_manager.h"
+
+/*
+ * File source controls:
+ *   FILE_SOURCE_BUF_COUNT:    descriptors cycling between the source and
+ *        the player; covers the player device queue plus the play queue
+ *   FILE_SOURCE_PREFETCH:     bytes read ahead right after mapping, so
+ *        the first callbacks do not page fault into the disk
+ */
+#define FILE_SOURCE_BUF_COUNT     8
+#define FILE_SOURCE_PREFETCH      (256 * 1024)
+
+/*
+ * MappedFileSource: plays an uncompressed WAV or raw PCM file without
+ * copying it. The file is mmap()ed once; the sample_buf descriptors handed
+ * to the player point straight into the mapping, one fast path buffer
+ * each, and the read pointer rewinds to the start of the data to loop.
+ * The last buffer of a loop may be short.
+ *
+ * The content must already be in the fast path format ( WAV header is
+ * checked, raw PCM is taken as is ): there is no conversion. Use
+ * AudioDecoder for anything else.
+ *
+ * Buffers are READ ONLY: nothing on the play path may write into them.
+ * Fill() is called from the player callback thread and never blocks.
+ */
+class MappedFileSource {
+public:
+    explicit MappedFileSource(SampleFormat *format);
+    ~MappedFileSource();
+    bool        Open(const char *path);
+    void        Close(void);
+    void        Rewind(void);
+    void        Fill(void);
+    AudioQueue *PlayQueue(void) { return playQueue_; }
+    AudioQueue *FreeQueue(void) { return freeQueue_; }
+    uint32_t    dbgGetLoopCount(void) { return loopCount_; }
+
+private:
+    bool        parseWav(const uint8_t *file, size_t fileSize);
+
+    SampleFormat  sampleInfo_;
+    uint32_t      bufSize_;         // one fast path buffer, in bytes
+    uint32_t      frameSize_;
+
+    void         *map_;
+    size_t        mapSize_;
+    const uint8_t *data_;           // PCM inside the mapping
+    uint32_t      dataSize_;        // whole frames only
+    uint32_t      cursor_;          // player thread only
+    uint32_t      loopCount_;
+
+    sample_buf    bufs_[FILE_SOURCE_BUF_COUNT];
+    AudioQueue   *freeQueue_;       // owner, returned by the player
+    AudioQueue   *playQueue_;       // owner, consumed by the player
+};
+
+#endif //NATIVE_AUDIO_FILE_SOURCE_H
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cassert>
+#include <cstring>
+#include "jitter_controller.h"
+
+JitterController::JitterController(SampleFormat *format) {
+    assert(format && format->sampleRate_ && format->framesPerBuf_);
+    // sampleRate_ is in milliHz
+    periodUs_ = static_cast<uint32_t>(
+            static_cast<uint64_t>(format->framesPerBuf_) * 1000000000ULL /
+            format->sampleRate_);
+    channels_  = format->channels_ ? format->channels_ : 1;
+    frameSize_ = channels_ * (format->pcmFormat_ >> 3);
+    Reset();
+}
+
+void JitterController::Reset(void) {
+    recPrevTime_  = 0;
+    playPrevTime_ = 0;
+    avgDepth_     = 0;
+    adjustment_   = 0;
+    cleanCallbacks_ = 0;
+    recJitter_.store(0);
+    playJitter_.store(0);
+    ResetPeaks();
+    preroll_.store(0);
+    minDepth_.store(JITTER_MIN_DEPTH);
+    targetDepth_.store(JITTER_MIN_DEPTH + JITTER_DEVICE_PREROLL);
+    underruns_.store(0);
+    overruns_.store(0);
+    dropped_.store(0);
+    repeated_.store(0);
+}
+
+/*
+ * ResetPeaks(): forget the worst jitter seen so far, e.g. the start up
+ * hiccups; safe while the callbacks run
+ */
+void JitterController::ResetPeaks(void) {
+    recJitterMax_.store(0);
+    playJitterMax_.store(0);
+}
+
+/*
+ * updateJitter(): peak hold of |callback interval - period|, decaying
+ * slowly so that a device with occasional late callbacks keeps enough
+ * buffering around
+ */
+uint32_t JitterController::updateJitter(uint64_t now, uint64_t *prevTime,
+                                        std::atomic<uint32_t> *jitter,
+                                        std::atomic<uint32_t> *maxJitter) {
+    uint32_t cur = jitter->load(std::memory_order_relaxed);
+    if (*prevTime) {
+        int64_t delta = static_cast<int64_t>(now - *prevTime) - periodUs_;
+        uint32_t dev = static_cast<uint32_t>(delta < 0 ? -delta : delta);
+        cur -= cur >> JITTER_DECAY_SHIFT;
+        if (dev > cur) {
+            cur = dev;
+        }
+        jitter->store(cur, std::memory_order_relaxed);
+        if (dev > maxJitter->load(std::memory_order_relaxed)) {
+            maxJitter->store(dev, std::memory_order_relaxed);
+        }
+    }
+    *prevTime = now;
+    return cur;
+}
+
+/*
+ * jitterBufCount(): buffers needed to cover a late recorder callback
+ * followed by an early player callback
+ */
+uint32_t JitterController::jitterBufCount(void) {
+    uint32_t recJitter  = recJitter_.load(std::memory_order_relaxed);
+    uint32_t playJitter = playJitter_.load(std::memory_order_relaxed);
+    if (!playJitter) {
+        playJitter = recJitter;     // player not running yet, assume alike
+    }
+    uint32_t count = (recJitter + playJitter + periodUs_ - 1) / periodUs_;
+    uint32_t minDepth = minDepth_.load(std::memory_order_relaxed);
+    return count > minDepth ? count : minDepth;
+}
+
+void JitterController::OnRecorderCallback(uint64_t now) {
+    updateJitter(now, &recPrevTime_, &recJitter_, &recJitterMax_);
+}
+
+void JitterController::OnRecorderOverrun(void) {
+    overruns_.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*
+ * PrerollReady(): recorder has bufCount buffers queued up for the
+ * player; tell it whether that is enough to start playing
+ */
+bool JitterController::PrerollReady(uint32_t bufCount) {
+    if (bufCount < JITTER_WARMUP_BUF_COUNT) {
+        return false;
+    }
+    uint32_t preroll = jitterBufCount() + JITTER_DEVICE_PREROLL;
+    if (preroll > PLAY_KICKSTART_BUFFER_COUNT) {
+        preroll = PLAY_KICKSTART_BUFFER_COUNT;
+    }
+    if (bufCount < preroll) {
+        return false;
+    }
+    preroll_.store(bufCount, std::memory_order_relaxed);
+    return true;
+}
+
+uint32_t JitterController::PrerollCount(void) {
+    uint32_t preroll = preroll_.load(std::memory_order_relaxed);
+    return preroll ? preroll : PLAY_KICKSTART_BUFFER_COUNT;
+}
+
+/*
+ * OnPlayerCallback(): bufferedDepth is all the audio waiting to be heard,
+ * play queue and device queue together; the play queue alone is drained
+ * into the device on every callback and says little
+ */
+void JitterController::OnPlayerCallback(uint64_t now, uint32_t bufferedDepth) {
+    updateJitter(now, &playPrevTime_, &playJitter_, &playJitterMax_);
+
+    // a long stretch without underruns: the extra depth is not needed
+    if (++cleanCallbacks_ >= JITTER_CLEAN_CALLBACKS) {
+        cleanCallbacks_ = 0;
+        uint32_t minDepth = minDepth_.load(std::memory_order_relaxed);
+        if (minDepth > JITTER_MIN_DEPTH) {
+            minDepth_.store(minDepth - 1, std::memory_order_relaxed);
+        }
+    }
+
+    uint32_t target = jitterBufCount() + JITTER_DEVICE_PREROLL;
+    targetDepth_.store(target, std::memory_order_relaxed);
+
+    // running average of the depth, x 2^JITTER_DEPTH_AVG_SHIFT
+    if (!avgDepth_) {
+        avgDepth_ = bufferedDepth << JITTER_DEPTH_AVG_SHIFT;
+    } else {
+        avgDepth_ += bufferedDepth;
+        // rounded, so an empty queue averages down to below 1/2
+        avgDepth_ -= (avgDepth_ + (1 << (JITTER_DEPTH_AVG_SHIFT - 1))) >>
+                     JITTER_DEPTH_AVG_SHIFT;
+    }
+
+    // hysteresis: shrink above target + 1, grow below target - 1/2
+    uint32_t unit = 1 << JITTER_DEPTH_AVG_SHIFT;
+    if (avgDepth_ > (target + 1) * unit) {
+        adjustment_ = -1;
+    } else if (avgDepth_ + unit / 2 < target * unit) {
+        adjustment_ = 1;
+    } else {
+        adjustment_ = 0;
+    }
+}
+
+/*
+ * OnPlayerUnderrun(): the player device played out all it had; only
+ * real device underruns count, not a momentarily empty play queue
+ */
+void JitterController::OnPlayerUnderrun(void) {
+    underruns_.fetch_add(1, std::memory_order_relaxed);
+    cleanCallbacks_ = 0;
+    // the jitter estimate was not enough: keep one more buffer from now on
+    uint32_t minDepth = minDepth_.load(std::memory_order_relaxed);
+    if (minDepth < PLAY_KICKSTART_BUFFER_COUNT) {
+        minDepth_.store(minDepth + 1, std::memory_order_relaxed);
+    }
+}
+
+int32_t JitterController::findZeroCrossing(const int16_t *samples, uint32_t frames) {
+    for (uint32_t i = 1; i < frames; i++) {
+        int16_t prev = samples[(i - 1) * channels_];
+        int16_t cur  = samples[i * channels_];
+        if (!cur || ((prev ^ cur) < 0)) {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return -1;
+}
+
+/*
+ * AdjustBuffer(): drop or repeat one frame of buf at its first zero
+ * crossing ( first channel ). Buffers without a crossing are left alone,
+ * the next one will do. Only 16 bit PCM is handled.
+ */
+void JitterController::AdjustBuffer(sample_buf *buf) {
+    if (!adjustment_ || frameSize_ != channels_ * sizeof(int16_t)) {
+        return;
+    }
+    uint32_t frames = buf->size_ / frameSize_;
+    if (adjustment_ > 0 && buf->size_ + frameSize_ > buf->cap_) {
+        return;
+    }
+    int32_t pos = findZeroCrossing(reinterpret_cast<int16_t*>(buf->buf_), frames);
+    if (pos < 0) {
+        return;
+    }
+    uint8_t *frame = buf->buf_ + pos * frameSize_;
+    uint32_t tail = (frames - pos) * frameSize_;
+    if (adjustment_ < 0) {
+        memmove(frame, frame + frameSize_, tail - frameSize_);
+        buf->size_ -= frameSize_;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        memmove(frame + frameSize_, frame, tail);
+        buf->size_ += frameSize_;
+        repeated_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void JitterController::GetStats(JitterStats *stats) {
+    assert(stats);
+    memset(stats, 0, sizeof(*stats));
+    stats->periodUs_       = periodUs_;
+    stats->recJitterUs_    = recJitter_.load(std::memory_order_relaxed);
+    stats->playJitterUs_   = playJitter_.load(std::memory_order_relaxed);
+    stats->recJitterMaxUs_ = recJitterMax_.load(std::memory_order_relaxed);
+    stats->playJitterMaxUs_ = playJitterMax_.load(std::memory_order_relaxed);
+    stats->prerollCount_   = PrerollCount();
+    stats->targetDepth_    = targetDepth_.load(std::memory_order_relaxed);
+    stats->underruns_      = underruns_.load(std::memory_order_relaxed);
+    stats->overruns_       = overruns_.load(std::memory_order_relaxed);
+    stats->framesDropped_  = dropped_.load(std::memory_order_relaxed);
+    stats->framesRepeated_ = repeated_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_JITTER_CONTROLLER_H
+#define NATIVE_AUDIO_JITTER_CONTROLLER_H
+#include <sys/types.h>
+#include <atomic>
+#include "audio_common.h"
+
+/*
+ * Jitter buffer controls:
+ *   JITTER_WARMUP_BUF_COUNT: recorder callbacks to watch before the
+ *        player is allowed to start
+ *   JITTER_DEVICE_PREROLL:   buffers sent to the player device at start,
+ *        on top of the jitter buffer
+ *   JITTER_MIN_DEPTH:        smallest play queue depth we aim for
+ *   JITTER_DECAY_SHIFT:      peak jitter estimate decays by 1/2^N per
+ *        callback, so one late callback is remembered for a while
+ *   JITTER_DEPTH_AVG_SHIFT:  buffered depth is averaged over ~2^N
+ *        callbacks before the depth is corrected
+ *   JITTER_CLEAN_CALLBACKS:  player callbacks without an underrun after
+ *        which the depth added for past underruns is given back, one
+ *        buffer at a time
+ * PLAY_KICKSTART_BUFFER_COUNT stays as the upper bound for the pre-roll.
+ */
+#define JITTER_WARMUP_BUF_COUNT     4
+#define JITTER_DEVICE_PREROLL       2
+#define JITTER_MIN_DEPTH            1
+#define JITTER_DECAY_SHIFT          7
+#define JITTER_DEPTH_AVG_SHIFT      5
+#define JITTER_CLEAN_CALLBACKS      512
+
+/*
+ * snapshot handed out with ENGINE_SERVICE_MSG_GET_JITTER_STATS
+ */
+struct JitterStats {
+    uint32_t  periodUs_;          // nominal buffer period
+    uint32_t  recJitterUs_;       // peak callback jitter, recorder side
+    uint32_t  playJitterUs_;      // peak callback jitter, player side
+    uint32_t  recJitterMaxUs_;    // worst callback jitter since ResetPeaks()
+    uint32_t  playJitterMaxUs_;
+    uint32_t  prerollCount_;      // buffers queued before player started
+    uint32_t  targetDepth_;       // buffered depth ( queue + device ) we steer to
+    uint32_t  underruns_;         // player device ran out of audio
+    uint32_t  overruns_;          // recorder found no free buffer
+    uint32_t  framesDropped_;     // shrinking the play queue
+    uint32_t  framesRepeated_;    // growing the play queue
+};
+
+/*
+ * JitterController: replaces the fixed PLAY_KICKSTART_BUFFER_COUNT
+ * pre-roll. It watches how regular the recorder and player callbacks
+ * are, starts the player as soon as enough audio is buffered to ride
+ * out the measured jitter, and then steers the play queue depth to the
+ * target by dropping or repeating ONE frame per buffer at a zero
+ * crossing -- slow enough to be inaudible.
+ *
+ * Recorder side methods are called from the recorder callback thread,
+ * player side ones from the player callback thread; neither blocks.
+ * Buffers must have room for one extra frame ( cap_ ) for repeats.
+ */
+class JitterController {
+public:
+    explicit JitterController(SampleFormat *format);
+    void     Reset(void);
+    void     ResetPeaks(void);
+
+    // recorder callback thread
+    void     OnRecorderCallback(uint64_t now);
+    void     OnRecorderOverrun(void);
+    bool     PrerollReady(uint32_t bufCount);
+    uint32_t PrerollCount(void);
+
+    // player callback thread
+    void     OnPlayerCallback(uint64_t now, uint32_t bufferedDepth);
+    void     OnPlayerUnderrun(void);
+    void     AdjustBuffer(sample_buf *buf);
+
+    void     GetStats(JitterStats *stats);
+
+private:
+    uint32_t updateJitter(uint64_t now, uint64_t *prevTime,
+                          std::atomic<uint32_t> *jitter,
+                          std::atomic<uint32_t> *maxJitter);
+    uint32_t jitterBufCount(void);
+    int32_t  findZeroCrossing(const int16_t *samples, uint32_t frames);
+
+    uint32_t  periodUs_;
+    uint32_t  channels_;
+    uint32_t  frameSize_;             // in bytes
+
+    uint64_t  recPrevTime_;           // recorder thread only
+    uint64_t  playPrevTime_;          // player thread only
+    uint32_t  avgDepth_;              // player thread only, x 2^DEPTH_AVG_SHIFT
+    int32_t   adjustment_;            // player thread only: -1, 0, +1
+    uint32_t  cleanCallbacks_;        // player thread only, since the last underrun
+
+    std::atomic<uint32_t>  recJitter_;
+    std::atomic<uint32_t>  playJitter_;
+    std::atomic<uint32_t>  recJitterMax_;
+    std::atomic<uint32_t>  playJitterMax_;
+    std::atomic<uint32_t>  preroll_;
+    std::atomic<uint32_t>  minDepth_;     // raised on underruns, decays back
+    std::atomic<uint32_t>  targetDepth_;
+    std::atomic<uint32_t>  underruns_;
+    std::atomic<uint32_t>  overruns_;
+    std::atomic<uint32_t>  dropped_;
+    std::atomic<uint32_t>  repeated_;
+};
+
+#endif //NATIVE_AUDIO_JITTER_CONTROLLER_H
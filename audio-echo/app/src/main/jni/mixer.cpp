@@ -0,0 +1,250 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include "mixer.h"
+#include "audio_kernels.h"
+
+AudioMixer::AudioMixer(SampleFormat *format) :
+    inputCount_(0), scratch_(nullptr), mixedCount_(0), silentCount_(0) {
+    assert(format && format->pcmFormat_ == SL_PCMSAMPLEFORMAT_FIXED_16);
+    sampleInfo_ = *format;
+    bufSamples_ = sampleInfo_.framesPerBuf_ * sampleInfo_.channels_;
+    capSamples_ = bufSamples_ + sampleInfo_.channels_;
+    // sampleRate_ is in milliHz
+    rampSamples_ = static_cast<uint32_t>(static_cast<uint64_t>(sampleInfo_.sampleRate_)
+                   * MIXER_RAMP_MS / 1000000) * sampleInfo_.channels_;
+    if (!rampSamples_) {
+        rampSamples_ = 1;
+    }
+
+    void *scratch = nullptr;
+    if (posix_memalign(&scratch, CACHE_ALIGN, capSamples_ * sizeof(float))) {
+        scratch = nullptr;
+    }
+    scratch_ = static_cast<float*>(scratch);
+    assert(scratch_);
+
+    outBufCount_ = DEVICE_SHADOW_BUFFER_QUEUE_LEN;
+    outBufs_ = allocateSampleBufs(outBufCount_, capSamples_ * sizeof(int16_t),
+                                  SAMPLE_BUF_MLOCK | SAMPLE_BUF_PREFAULT);
+    outQueue_ = new AudioQueue(outBufCount_);
+    assert(outBufs_ && outQueue_);
+    for (uint32_t i = 0; i < outBufCount_; i++) {
+        outQueue_->push(&outBufs_[i]);
+    }
+}
+
+AudioMixer::~AudioMixer() {
+    delete outQueue_;
+    releaseSampleBufs(outBufs_, outBufCount_);
+    free(scratch_);
+}
+
+/*
+ * AddInput(): playQ/freeQ as a player would take them; format must be in
+ * the output rate and channel count. Returns the input index, -1 if the
+ * input can not be mixed.
+ */
+int32_t AudioMixer::AddInput(AudioQueue *playQ, AudioQueue *freeQ,
+                             SampleFormat *format, float gain, bool active) {
+    if (inputCount_ >= MIXER_MAX_INPUTS || !playQ || !freeQ || !format ||
+        format->channels_ != sampleInfo_.channels_ ||
+        format->sampleRate_ != sampleInfo_.sampleRate_) {
+        LOGE("====%s: can not mix the input in", __FUNCTION__);
+        return -1;
+    }
+    bool isFloat = format->representation_ == SL_ANDROID_PCM_REPRESENTATION_FLOAT;
+    if (!isFloat && format->pcmFormat_ != SL_PCMSAMPLEFORMAT_FIXED_16) {
+        LOGE("====%s: %d bit input not supported", __FUNCTION__, format->pcmFormat_);
+        return -1;
+    }
+
+    Input *input = &inputs_[inputCount_];
+    input->playQ_ = playQ;
+    input->freeQ_ = freeQ;
+    input->float_ = isFloat;
+    input->active_.store(active);
+    input->target_.store(gain);
+    input->gain_ = gain;
+    input->rampTarget_ = gain;
+    input->step_ = 0.0f;
+    input->rampLeft_ = 0;
+    input->offset_ = 0;
+    return inputCount_++;
+}
+
+void AudioMixer::SetGain(int32_t input, float gain) {
+    if (input >= 0 && input < inputCount_) {
+        inputs_[input].target_.store(gain, std::memory_order_relaxed);
+    }
+}
+
+/*
+ * Activate(): an input added inactive is left alone ( its buffers pile
+ * up in its queue ) until now; the echo path uses this for its pre-roll
+ */
+void AudioMixer::Activate(int32_t input) {
+    if (input >= 0 && input < inputCount_) {
+        inputs_[input].active_.store(true, std::memory_order_release);
+    }
+}
+
+bool AudioMixer::IsActive(int32_t input) {
+    return input >= 0 && input < inputCount_ &&
+           inputs_[input].active_.load(std::memory_order_acquire);
+}
+
+/*
+ * mixInput(): add samples of buf, starting at sample from, into scratch_
+ * at sample to, with the input gain, moving the gain along its ramp
+ */
+void AudioMixer::mixInput(Input *input, sample_buf *buf, uint32_t from,
+                          uint32_t to, uint32_t samples) {
+    float target = input->target_.load(std::memory_order_relaxed);
+    if (target != input->rampTarget_) {
+        input->rampTarget_ = target;
+        input->rampLeft_ = rampSamples_;
+        input->step_ = (target - input->gain_) / rampSamples_;
+    }
+
+    uint32_t done = 0;
+    while (done < samples) {
+        uint32_t count = samples - done;
+        float step = 0.0f;
+        if (input->rampLeft_) {
+            count = count < input->rampLeft_ ? count : input->rampLeft_;
+            step = input->step_;
+        }
+        if (input->float_) {
+            mixFloat(reinterpret_cast<const float*>(buf->buf_) + from + done,
+                     scratch_ + to + done, count, input->gain_, step);
+        } else {
+            mixPcm16(reinterpret_cast<const int16_t*>(buf->buf_) + from + done,
+                     scratch_ + to + done, count, input->gain_, step);
+        }
+        if (input->rampLeft_) {
+            input->rampLeft_ -= count;
+            input->gain_ = input->rampLeft_ ?
+                           input->gain_ + step * count : input->rampTarget_;
+        }
+        done += count;
+    }
+}
+
+/*
+ * Mix(): one output buffer out of the front buffer of every active input.
+ * nullptr only when all output buffers are on the device.
+ */
+sample_buf *AudioMixer::Mix(void) {
+    sample_buf *out;
+    if (!outQueue_->front(&out)) {
+        return nullptr;
+    }
+    outQueue_->pop();
+
+    sample_buf *bufs[MIXER_MAX_INPUTS];
+    uint32_t outSamples = bufSamples_;
+    bool silent = true;
+    for (int32_t i = 0; i < inputCount_; i++) {
+        Input *input = &inputs_[i];
+        bufs[i] = nullptr;
+        if (!input->active_.load(std::memory_order_acquire) ||
+            !input->playQ_->front(&bufs[i]) || !bufs[i]->size_) {
+            bufs[i] = nullptr;
+            continue;
+        }
+        if (!i) {
+            uint32_t samples = bufs[0]->size_ /
+                               (input->float_ ? sizeof(float) : sizeof(int16_t)) -
+                               input->offset_;
+            outSamples = samples < capSamples_ ? samples : capSamples_;
+        }
+        silent = false;
+    }
+
+    memset(scratch_, 0, outSamples * sizeof(float));
+    out->captureTime_ = 0;
+    for (int32_t i = 0; i < inputCount_; i++) {
+        Input *input = &inputs_[i];
+        sample_buf *buf = bufs[i];
+        uint32_t mixed = 0;
+        if (buf && !i) {
+            out->captureTime_ = buf->captureTime_;
+        }
+        // fill outSamples from as many buffers as it takes; whatever is
+        // left of the last one is mixed into the next output buffer
+        while (buf) {
+            uint32_t samples = buf->size_ /
+                               (input->float_ ? sizeof(float) : sizeof(int16_t)) -
+                               input->offset_;
+            uint32_t count = outSamples - mixed;
+            count = samples < count ? samples : count;
+            mixInput(input, buf, input->offset_, mixed, count);
+            mixed += count;
+            if (count < samples) {
+                input->offset_ += count;
+                break;
+            }
+
+            input->offset_ = 0;
+            input->playQ_->pop();
+            buf->size_ = 0;
+            buf->captureTime_ = 0;
+            input->freeQ_->push(buf);
+            if (mixed == outSamples || !input->playQ_->front(&buf) || !buf->size_) {
+                buf = nullptr;
+            }
+        }
+    }
+
+    convertFloatToPcm16(scratch_, reinterpret_cast<int16_t*>(out->buf_), outSamples);
+    out->size_ = outSamples * sizeof(int16_t);
+    if (silent) {
+        silentCount_++;
+    } else {
+        mixedCount_++;
+    }
+    return out;
+}
+
+/*
+ * Recycle(): an output buffer the device is done with
+ */
+void AudioMixer::Recycle(sample_buf *buf) {
+    buf->size_ = 0;
+    buf->captureTime_ = 0;
+    outQueue_->push(buf);
+}
+
+/*
+ * Flush(): hand every buffer still queued on the inputs back to its free
+ * queue; only once the player stopped
+ */
+void AudioMixer::Flush(void) {
+    for (int32_t i = 0; i < inputCount_; i++) {
+        sample_buf *buf;
+        while (inputs_[i].playQ_->front(&buf)) {
+            inputs_[i].playQ_->pop();
+            buf->size_ = 0;
+            buf->captureTime_ = 0;
+            inputs_[i].freeQ_->push(buf);
+        }
+        inputs_[i].offset_ = 0;
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_MIXER_H
+#define NATIVE_AUDIO_MIXER_H
+#include <sys/types.h>
+#include <atomic>
+#include "audio_common.h"
+#include "buf_manager.h"
+
+/*
+ * Mixer controls:
+ *   MIXER_MAX_INPUTS:       streams one mixer sums
+ *   MIXER_PRIME_BUF_COUNT:  output buffers the player keeps in flight while
+ *        mixing; every input is delayed by this many buffers plus its own
+ *        queue, so keep it small
+ *   MIXER_RAMP_MS:          a gain change is spread over this long to
+ *        avoid zipper noise
+ */
+#define MIXER_MAX_INPUTS        4
+#define MIXER_PRIME_BUF_COUNT   2
+#define MIXER_RAMP_MS           10
+
+/*
+ * AudioMixer: sums up to MIXER_MAX_INPUTS buffer queues into the fast path
+ * format, so everything plays through the one fast track player. Inputs
+ * are 16 bit int or float in the output rate / channel count; each has
+ * its own gain with a linear ramp, the sum saturates to 16 bit.
+ *
+ * Input 0 is the player's own play queue. It sets the length of the
+ * output buffer ( JitterController may have added or dropped a frame )
+ * and its capture time goes with the output for the latency stats; the
+ * other inputs fill that length from as many of their buffers as it
+ * takes, and what is left of a buffer is mixed into the next output.
+ *
+ * Mix() always returns a buffer, silent when no input has data: the
+ * device queue never drains. Output buffers and the float scratch area
+ * are allocated up front, so Mix() never allocates; input buffers are
+ * only read ( MappedFileSource buffers are read only ) and go back to
+ * their free queue once fully mixed.
+ *
+ * Threads: AddInput() before playing; SetGain() / Activate() from any
+ * thread; Mix() / Recycle() on the player callback thread.
+ */
+class AudioMixer {
+public:
+    explicit AudioMixer(SampleFormat *format);
+    ~AudioMixer();
+    int32_t     AddInput(AudioQueue *playQ, AudioQueue *freeQ,
+                         SampleFormat *format, float gain, bool active);
+    void        SetGain(int32_t input, float gain);
+    void        Activate(int32_t input);
+    bool        IsActive(int32_t input);
+    sample_buf *Mix(void);
+    void        Recycle(sample_buf *buf);
+    void        Flush(void);
+    uint32_t    dbgGetMixedCount(void) { return mixedCount_; }
+    uint32_t    dbgGetSilentCount(void) { return silentCount_; }
+
+private:
+    struct Input {
+        AudioQueue *playQ_;         // user
+        AudioQueue *freeQ_;         // user
+        bool        float_;
+        std::atomic<bool>  active_;
+        std::atomic<float> target_; // set by SetGain()
+        float       gain_;          // player thread only from here on
+        float       rampTarget_;
+        float       step_;
+        uint32_t    rampLeft_;      // samples
+        uint32_t    offset_;        // samples of the front buffer mixed already
+    };
+    void        mixInput(Input *input, sample_buf *buf, uint32_t from,
+                         uint32_t to, uint32_t samples);
+
+    SampleFormat  sampleInfo_;
+    uint32_t      bufSamples_;      // one fast path buffer
+    uint32_t      capSamples_;      // plus the spare frame
+    uint32_t      rampSamples_;
+
+    Input         inputs_[MIXER_MAX_INPUTS];
+    int32_t       inputCount_;
+
+    float        *scratch_;         // owner, capSamples_ accumulators
+    sample_buf   *outBufs_;         // owner
+    uint32_t      outBufCount_;
+    AudioQueue   *outQueue_;        // owner, output buffers not on the device
+
+    uint32_t      mixedCount_;
+    uint32_t      silentCount_;
+};
+
+#endif //NATIVE_AUDIO_MIXER_H
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include "thread_policy.h"
+
+static int32_t currentTid(void) {
+    return static_cast<int32_t>(syscall(__NR_gettid));
+}
+
+static bool isRealTime(int32_t sched) {
+    return sched == SCHED_FIFO || sched == SCHED_RR;
+}
+
+ThreadPolicyManager::ThreadPolicyManager() {
+    // defaults: callbacks real time on any core, the decoder bursts ahead
+    // of the player and can take the little cores, helpers the big ones
+    static const ThreadPolicy defaults[THREAD_ROLE_COUNT] = {
+        { SCHED_FIFO,  THREAD_RT_PRIORITY,   THREAD_CORE_ANY },     // player
+        { SCHED_FIFO,  THREAD_RT_PRIORITY,   THREAD_CORE_ANY },     // recorder
+        { SCHED_OTHER, -16,                  THREAD_CORE_LITTLE },  // decoder
+        { SCHED_OTHER, THREAD_FALLBACK_NICE, THREAD_CORE_BIG },     // helper
+    };
+    for (uint32_t i = 0; i < THREAD_ROLE_COUNT; i++) {
+        RoleState *state = &roles_[i];
+        state->policy_ = defaults[i];
+        state->tid_.store(0);
+        state->statFd_ = -1;
+        state->wakeup_ = new AudioHistogram(SCHED_LATENCY_BIN_WIDTH_US,
+                                            SCHED_LATENCY_BIN_COUNT);
+        assert(state->wakeup_);
+    }
+    findCoreClasses();
+    Reset();
+}
+
+ThreadPolicyManager::~ThreadPolicyManager() {
+    Reset();
+    for (uint32_t i = 0; i < THREAD_ROLE_COUNT; i++) {
+        delete roles_[i].wakeup_;
+    }
+}
+
+/*
+ * findCoreClasses(): split the cores by their highest frequency
+ */
+void ThreadPolicyManager::findCoreClasses(void) {
+    long cpuCount = sysconf(_SC_NPROCESSORS_CONF);
+    uint32_t freq[CPU_SETSIZE];
+    uint32_t lowest = UINT32_MAX, highest = 0;
+    for (long cpu = 0; cpu < cpuCount && cpu < CPU_SETSIZE; cpu++) {
+        char path[96];
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%ld/cpufreq/cpuinfo_max_freq", cpu);
+        freq[cpu] = 0;
+        FILE *fp = fopen(path, "r");
+        if (fp) {
+            if (fscanf(fp, "%u", &freq[cpu]) != 1) {
+                freq[cpu] = 0;
+            }
+            fclose(fp);
+        }
+        lowest  = freq[cpu] < lowest ? freq[cpu] : lowest;
+        highest = freq[cpu] > highest ? freq[cpu] : highest;
+    }
+
+    for (uint32_t i = 0; i < THREAD_CORE_CLASS_COUNT; i++) {
+        CPU_ZERO(&cores_[i]);
+    }
+    for (long cpu = 0; cpu < cpuCount && cpu < CPU_SETSIZE; cpu++) {
+        CPU_SET(cpu, &cores_[THREAD_CORE_ANY]);
+        // unknown frequency: the core goes into both classes
+        if (!freq[cpu] || freq[cpu] == lowest) {
+            CPU_SET(cpu, &cores_[THREAD_CORE_LITTLE]);
+        }
+        if (!freq[cpu] || freq[cpu] == highest) {
+            CPU_SET(cpu, &cores_[THREAD_CORE_BIG]);
+        }
+    }
+    LOGI("Cores: %d, little %d ( %u kHz ), big %d ( %u kHz )",
+         CPU_COUNT(&cores_[THREAD_CORE_ANY]),
+         CPU_COUNT(&cores_[THREAD_CORE_LITTLE]), lowest,
+         CPU_COUNT(&cores_[THREAD_CORE_BIG]), highest);
+}
+
+void ThreadPolicyManager::SetPolicy(uint32_t role, const ThreadPolicy *policy) {
+    assert(role < THREAD_ROLE_COUNT && policy);
+    roles_[role].policy_ = *policy;
+    roles_[role].tid_.store(0);     // applied again on the next callback
+}
+
+/*
+ * Reset(): forget the threads and the stats, before a new play session
+ */
+void ThreadPolicyManager::Reset(void) {
+    for (uint32_t i = 0; i < THREAD_ROLE_COUNT; i++) {
+        RoleState *state = &roles_[i];
+        if (state->statFd_ >= 0) {
+            close(state->statFd_);
+            state->statFd_ = -1;
+        }
+        state->tid_.store(0);
+        state->sched_.store(SCHED_OTHER);
+        state->priority_.store(0);
+        state->cpuCount_.store(0);
+        state->waitNs_ = 0;
+        state->slices_ = 0;
+        state->callbacks_ = 0;
+        state->wakeup_->Reset();
+    }
+}
+
+void ThreadPolicyManager::OnThreadRunning(uint32_t role) {
+    assert(role < THREAD_ROLE_COUNT);
+    RoleState *state = &roles_[role];
+    int32_t tid = currentTid();
+    if (state->tid_.load(std::memory_order_relaxed) != tid) {
+        applyPolicy(state, tid);
+        return;
+    }
+    if (++state->callbacks_ % THREAD_STAT_INTERVAL == 0) {
+        sample(state);
+    }
+}
+
+/*
+ * applyPolicy(): on the thread itself, once per thread
+ */
+void ThreadPolicyManager::applyPolicy(RoleState *state, int32_t tid) {
+    const ThreadPolicy &policy = state->policy_;
+    int sched;
+    struct sched_param param;
+    if (pthread_getschedparam(pthread_self(), &sched, &param)) {
+        sched = SCHED_OTHER;
+        param.sched_priority = 0;
+    }
+
+    if (isRealTime(policy.sched_)) {
+        if (!isRealTime(sched) || param.sched_priority < policy.priority_) {
+            struct sched_param rtParam;
+            memset(&rtParam, 0, sizeof(rtParam));
+            rtParam.sched_priority = policy.priority_;
+            if (!pthread_setschedparam(pthread_self(), policy.sched_, &rtParam)) {
+                sched = policy.sched_;
+                param = rtParam;
+            } else if (!isRealTime(sched) &&
+                       setpriority(PRIO_PROCESS, tid, THREAD_FALLBACK_NICE)) {
+                LOGW("====thread %d: no real time scheduling, nice %d refused too",
+                     tid, THREAD_FALLBACK_NICE);
+            }
+        }
+    } else {
+        // a thread created from a real time one inherits its policy
+        if (isRealTime(sched)) {
+            struct sched_param otherParam;
+            memset(&otherParam, 0, sizeof(otherParam));
+            if (!pthread_setschedparam(pthread_self(), SCHED_OTHER, &otherParam)) {
+                sched = SCHED_OTHER;
+            }
+        }
+        if (setpriority(PRIO_PROCESS, tid, policy.priority_)) {
+            LOGW("====thread %d: nice %d refused", tid, policy.priority_);
+        }
+    }
+
+    if (policy.core_ != THREAD_CORE_ANY && CPU_COUNT(&cores_[policy.core_]) &&
+        sched_setaffinity(tid, sizeof(cpu_set_t), &cores_[policy.core_])) {
+        LOGW("====thread %d: can not pin to core class %d", tid, policy.core_);
+    }
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    sched_getaffinity(tid, sizeof(mask), &mask);
+    state->sched_.store(sched, std::memory_order_relaxed);
+    state->priority_.store(isRealTime(sched) ? param.sched_priority :
+                           getpriority(PRIO_PROCESS, tid), std::memory_order_relaxed);
+    state->cpuCount_.store(CPU_COUNT(&mask), std::memory_order_relaxed);
+
+    if (state->statFd_ >= 0) {
+        close(state->statFd_);
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", tid);
+    state->statFd_ = open(path, O_RDONLY | O_CLOEXEC);
+    state->slices_ = 0;
+    state->callbacks_ = 0;
+    sample(state);
+    state->tid_.store(tid, std::memory_order_relaxed);
+}
+
+/*
+ * sample(): schedstat is "<run ns> <runqueue wait ns> <time slices>";
+ * the wait added since the last sample over the slices added is the
+ * average wakeup-to-run latency in between
+ */
+void ThreadPolicyManager::sample(RoleState *state) {
+    if (state->statFd_ < 0) {
+        return;
+    }
+    char text[80];
+    ssize_t len = pread(state->statFd_, text, sizeof(text) - 1, 0);
+    if (len <= 0) {
+        return;
+    }
+    text[len] = 0;
+    char *end;
+    strtoull(text, &end, 10);
+    uint64_t waitNs = strtoull(end, &end, 10);
+    uint64_t slices = strtoull(end, &end, 10);
+
+    if (state->slices_ && slices > state->slices_) {
+        uint64_t us = (waitNs - state->waitNs_) / (slices - state->slices_) / 1000;
+        state->wakeup_->Record(static_cast<uint32_t>(us));
+    }
+    state->waitNs_ = waitNs;
+    state->slices_ = slices;
+}
+
+void ThreadPolicyManager::GetStats(uint32_t role, ThreadSchedStats *stats) {
+    assert(role < THREAD_ROLE_COUNT && stats);
+    RoleState *state = &roles_[role];
+    stats->tid_       = state->tid_.load(std::memory_order_relaxed);
+    stats->sched_     = state->sched_.load(std::memory_order_relaxed);
+    stats->priority_  = state->priority_.load(std::memory_order_relaxed);
+    stats->cpuCount_  = state->cpuCount_.load(std::memory_order_relaxed);
+    stats->samples_   = state->wakeup_->Count();
+    stats->wakeupP50_ = state->wakeup_->Percentile(50);
+    stats->wakeupP99_ = state->wakeup_->Percentile(99);
+    stats->wakeupMax_ = state->wakeup_->Max();
+}
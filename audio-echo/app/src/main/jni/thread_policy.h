@@ -0,0 +1,134 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_THREAD_POLICY_H
+#define NATIVE_AUDIO_THREAD_POLICY_H
+#include <sys/types.h>
+#include <sched.h>
+#include <atomic>
+#include "audio_common.h"
+#include "audio_stats.h"
+
+/*
+ * Threads the engine runs code on. The player/recorder/decoder ones are
+ * the OpenSL ES callback threads; helpers are threads of our own.
+ */
+#define THREAD_ROLE_PLAYER      0
+#define THREAD_ROLE_RECORDER    1
+#define THREAD_ROLE_DECODER     2
+#define THREAD_ROLE_HELPER      3
+#define THREAD_ROLE_COUNT       4
+
+/*
+ * Core classes a thread can be pinned to. On a big.LITTLE device the
+ * classes come from the highest / lowest cpuinfo_max_freq; on symmetric
+ * ones ( and when sysfs says nothing ) both are all cores.
+ */
+#define THREAD_CORE_ANY         0
+#define THREAD_CORE_LITTLE      1
+#define THREAD_CORE_BIG         2
+#define THREAD_CORE_CLASS_COUNT 3
+
+/*
+ * Thread policy controls:
+ *   THREAD_RT_PRIORITY:     SCHED_FIFO / SCHED_RR priority asked for; the
+ *        fast track callback threads of the framework run at 2..3
+ *   THREAD_FALLBACK_NICE:   used when real time scheduling is refused,
+ *        ANDROID_PRIORITY_URGENT_AUDIO
+ *   THREAD_STAT_INTERVAL:   callbacks between two scheduling latency
+ *        samples ( one pread() of /proc/self/task/<tid>/schedstat )
+ */
+#define THREAD_RT_PRIORITY      2
+#define THREAD_FALLBACK_NICE    (-19)
+#define THREAD_STAT_INTERVAL    32
+#define SCHED_LATENCY_BIN_WIDTH_US  20
+#define SCHED_LATENCY_BIN_COUNT     1000    // up to 20 ms
+
+/*
+ * ThreadPolicy: what a role asks for.
+ *   sched_:    SCHED_FIFO, SCHED_RR or SCHED_OTHER
+ *   priority_: real time priority for SCHED_FIFO / SCHED_RR, nice value
+ *              for SCHED_OTHER
+ *   core_:     THREAD_CORE_*
+ */
+struct ThreadPolicy {
+    int32_t   sched_;
+    int32_t   priority_;
+    uint32_t  core_;
+};
+
+/*
+ * snapshot handed out with ENGINE_SERVICE_MSG_GET_THREAD_STATS, one per role
+ */
+struct ThreadSchedStats {
+    int32_t   tid_;             // 0: role not seen running
+    int32_t   sched_;           // what the thread got
+    int32_t   priority_;        // real time priority or nice
+    uint32_t  cpuCount_;        // cores it may run on
+    uint32_t  samples_;
+    uint32_t  wakeupP50_;       // runqueue wait per time slice, in micro sec
+    uint32_t  wakeupP99_;
+    uint32_t  wakeupMax_;
+};
+
+/*
+ * ThreadPolicyManager: applies a scheduling policy and core affinity to
+ * the threads of the engine and measures how long they sit runnable
+ * before they get a core ( wakeup-to-run ) from the kernel's schedstat.
+ *
+ * OpenSL ES threads are not ours to create, so OnThreadRunning() is
+ * called from every callback: the first call on a thread applies the
+ * policy of its role ( again when the role moves to another thread ),
+ * later calls only count and sample now and then. A thread that already
+ * is at a higher real time priority ( the fast track threads ) is left
+ * alone. When SCHED_FIFO / SCHED_RR is refused, the thread falls back to
+ * THREAD_FALLBACK_NICE; a SCHED_OTHER role drops real time scheduling it
+ * inherited ( the decoder is re-created from the player callback ).
+ *
+ * Threads: SetPolicy() / Reset() while no callbacks run; OnThreadRunning()
+ * from the thread of the role only; GetStats() from anywhere.
+ */
+class ThreadPolicyManager {
+public:
+    ThreadPolicyManager();
+    ~ThreadPolicyManager();
+    void  SetPolicy(uint32_t role, const ThreadPolicy *policy);
+    void  OnThreadRunning(uint32_t role);
+    void  Reset(void);
+    void  GetStats(uint32_t role, ThreadSchedStats *stats);
+
+private:
+    struct RoleState {
+        ThreadPolicy  policy_;
+        std::atomic<int32_t> tid_;
+        std::atomic<int32_t> sched_;
+        std::atomic<int32_t> priority_;
+        std::atomic<uint32_t> cpuCount_;
+        int           statFd_;
+        uint64_t      waitNs_;      // schedstat at the last sample
+        uint64_t      slices_;
+        uint32_t      callbacks_;
+        AudioHistogram *wakeup_;    // owner
+    };
+    void  applyPolicy(RoleState *state, int32_t tid);
+    void  sample(RoleState *state);
+    void  findCoreClasses(void);
+
+    RoleState     roles_[THREAD_ROLE_COUNT];
+    cpu_set_t     cores_[THREAD_CORE_CLASS_COUNT];
+};
+
+#endif //NATIVE_AUDIO_THREAD_POLICY_H
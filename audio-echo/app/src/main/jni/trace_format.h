@@ -0,0 +1,58 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_TRACE_FORMAT_H
+#define NATIVE_AUDIO_TRACE_FORMAT_H
+#include <stdint.h>
+
+/*
+ * Binary trace file layout, shared by the trace ring and the host side
+ * decoder ( tools/trace_decoder.cpp ):
+ *    TraceFileHeader
+ *    TraceRecord[]    in the order the flusher drained them; decoder sorts
+ *                     them by time
+ * all fields are little endian
+ */
+#define TRACE_FILE_MAGIC      0x43525445     // "ETRC"
+#define TRACE_FILE_VERSION    1
+
+struct TraceFileHeader {
+    uint32_t  magic_;
+    uint32_t  version_;
+    uint32_t  recordSize_;       // sizeof(TraceRecord)
+    uint32_t  reserved_;
+};
+
+struct TraceRecord {
+    uint64_t  time_;             // GetSystemTicks(), micro sec
+    uint32_t  event_;            // TRACE_EVENT_XXX
+    uint32_t  thread_;           // index of the per-thread ring
+    uint32_t  arg0_;
+    uint32_t  arg1_;
+};
+
+/*
+ * Trace events
+ */
+#define TRACE_EVENT_PLAYER_CALLBACK      1   // arg0: playQ depth,  arg1: bufs sent to device
+#define TRACE_EVENT_PLAYER_STARVED       2   // arg0: playQ depth,  arg1: devShadowQ depth
+#define TRACE_EVENT_RECORDER_CALLBACK    3   // arg0: recQ depth,   arg1: bufs sent to device
+#define TRACE_EVENT_DECODER_CALLBACK     4   // arg0: recQ depth,   arg1: bufs sent to device
+#define TRACE_EVENT_RING_OVERFLOW        5   // arg0: records dropped so far
+#define TRACE_EVENT_DECODER_PAUSE        6   // arg0: playQ depth
+#define TRACE_EVENT_DECODER_RESUME       7   // arg0: playQ depth
+
+#endif //NATIVE_AUDIO_TRACE_FORMAT_H
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cassert>
+#include <cstdio>
+#include <pthread.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+
+#include "audio_common.h"
+#include "trace_ring.h"
+
+using TraceQueue = ProducerConsumerQueue<TraceRecord>;
+
+struct TraceContext {
+    TraceQueue*           rings_[TRACE_MAX_THREADS];
+    std::atomic<uint32_t> ringCount_;    // rings handed out to threads
+    std::atomic<uint32_t> dropCount_;    // records lost to full rings
+    std::atomic<bool>     running_;
+    uint32_t              session_;      // bumped by every TraceStart()
+    std::thread          *flusher_;
+    FILE*                 fp_;
+};
+static TraceContext trace;
+
+/*
+ * calling thread -> (session << 8 | ring index + 1). The session part
+ * keeps a thread from reusing a ring it claimed in an earlier session.
+ */
+static pthread_key_t  ringKey;
+static pthread_once_t ringKeyOnce = PTHREAD_ONCE_INIT;
+static void createRingKey(void) {
+    pthread_key_create(&ringKey, NULL);
+}
+
+/*
+ * getThreadRing(): first event from a thread claims the next free ring;
+ * pthread_getspecific() does not allocate or block
+ */
+static int32_t getThreadRing(void) {
+    uintptr_t tag = reinterpret_cast<uintptr_t>(pthread_getspecific(ringKey));
+    if (tag && (tag >> 8) == trace.session_) {
+        return static_cast<int32_t>(tag & 0xFF) - 1;
+    }
+    uint32_t idx = trace.ringCount_.fetch_add(1, std::memory_order_acq_rel);
+    if (idx >= TRACE_MAX_THREADS) {
+        trace.ringCount_.fetch_sub(1, std::memory_order_relaxed);
+        return -1;
+    }
+    tag = (static_cast<uintptr_t>(trace.session_) << 8) | (idx + 1);
+    pthread_setspecific(ringKey, reinterpret_cast<void*>(tag));
+    return static_cast<int32_t>(idx);
+}
+
+void TraceEvent(uint32_t event, uint32_t arg0, uint32_t arg1) {
+    if (!trace.running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    int32_t idx = getThreadRing();
+    if (idx < 0) {
+        trace.dropCount_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    bool pushed = trace.rings_[idx]->push([&](TraceRecord* rec) -> bool {
+        rec->time_   = GetSystemTicks();
+        rec->event_  = event;
+        rec->thread_ = static_cast<uint32_t>(idx);
+        rec->arg0_   = arg0;
+        rec->arg1_   = arg1;
+        return true;
+    });
+    if (!pushed) {
+        trace.dropCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/*
+ * drainRings(): move everything buffered so far into the file, in big
+ * fwrite() chunks
+ */
+static void drainRings(void) {
+    TraceRecord records[256];
+    uint32_t ringCount = trace.ringCount_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < ringCount; i++) {
+        int count;
+        while ((count = trace.rings_[i]->pop_n(records, 256)) > 0) {
+            fwrite(records, sizeof(TraceRecord), count, trace.fp_);
+        }
+    }
+}
+
+static void flusherThread(void) {
+    uint32_t reportedDrops = 0;
+    while (trace.running_.load(std::memory_order_acquire)) {
+        usleep(TRACE_FLUSH_MS * 1000);
+        drainRings();
+
+        uint32_t drops = trace.dropCount_.load(std::memory_order_relaxed);
+        if (drops != reportedDrops) {
+            // logged from here, not from the thread that dropped it
+            TraceRecord rec = {GetSystemTicks(), TRACE_EVENT_RING_OVERFLOW,
+                               TRACE_MAX_THREADS, drops, 0};
+            fwrite(&rec, sizeof(rec), 1, trace.fp_);
+            reportedDrops = drops;
+        }
+    }
+    drainRings();
+}
+
+bool TraceStart(const char* fileName) {
+    assert(fileName);
+    if (trace.running_.load()) {
+        return true;
+    }
+    trace.fp_ = fopen(fileName, "wb");
+    if (!trace.fp_) {
+        LOGE("====failed to open trace file %s", fileName);
+        return false;
+    }
+    TraceFileHeader header = {TRACE_FILE_MAGIC, TRACE_FILE_VERSION,
+                              sizeof(TraceRecord), 0};
+    fwrite(&header, sizeof(header), 1, trace.fp_);
+
+    for (int i = 0; i < TRACE_MAX_THREADS; i++) {
+        trace.rings_[i] = new TraceQueue(TRACE_RING_LEN);
+    }
+    trace.ringCount_.store(0);
+    trace.dropCount_.store(0);
+    trace.session_ = (trace.session_ + 1) & 0xFFFFFF;
+    pthread_once(&ringKeyOnce, createRingKey);
+
+    trace.running_.store(true, std::memory_order_release);
+    trace.flusher_ = new std::thread(flusherThread);
+    return true;
+}
+
+void TraceStop(void) {
+    if (!trace.running_.load()) {
+        return;
+    }
+    trace.running_.store(false, std::memory_order_release);
+    trace.flusher_->join();
+    delete trace.flusher_;
+    trace.flusher_ = nullptr;
+
+    fclose(trace.fp_);
+    trace.fp_ = nullptr;
+
+    // caller has stopped the audio callbacks already, so nobody is still
+    // pushing onto the rings
+    for (int i = 0; i < TRACE_MAX_THREADS; i++) {
+        delete trace.rings_[i];
+        trace.rings_[i] = nullptr;
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_TRACE_RING_H
+#define NATIVE_AUDIO_TRACE_RING_H
+#include <sys/types.h>
+#include "trace_format.h"
+
+/*
+ * Real time safe event tracing for the audio callbacks.
+ *
+ * Every thread that emits events gets its own ring ( a
+ * ProducerConsumerQueue<TraceRecord> ) out of a pool that is allocated in
+ * TraceStart(). TraceEvent() only stamps a fixed size record and pushes it
+ * onto the calling thread's ring: no lock, no allocation, no system call
+ * other than reading the clock. When a ring is full, the record is dropped
+ * and counted. A background thread drains all rings into the trace file.
+ *
+ *   TRACE_MAX_THREADS: # of threads that could emit events
+ *   TRACE_RING_LEN:    records buffered per thread between flushes
+ *   TRACE_FLUSH_MS:    flusher period
+ */
+#define TRACE_MAX_THREADS    8
+#define TRACE_RING_LEN       2048
+#define TRACE_FLUSH_MS       20
+
+bool TraceStart(const char* fileName);
+void TraceStop(void);
+void TraceEvent(uint32_t event, uint32_t arg0, uint32_t arg1);
+
+/*
+ * TRACE(): compiled out unless ENABLE_LOG is on
+ */
+#ifdef ENABLE_LOG
+#define TRACE(event, arg0, arg1)  TraceEvent((event), (arg0), (arg1))
+#else
+#define TRACE(event, arg0, arg1)
+#endif
+
+#endif //NATIVE_AUDIO_TRACE_RING_H
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * echo_bench: runs EchoAudioEngine ( the jni sources, unchanged ) on a
+ * Linux host on top of the sles_host OpenSL ES stand-in. The engine logs
+ * its latency / jitter / decoder stats when it stops, as on a device;
+ * the bench adds what the stand-in devices saw.
+ *
+ * Build, from audio-echo/:
+ *     g++ -std=c++11 -O2 -pthread -Ihost/include -Ihost -o echo_bench \
+ *         host/[a-z]*.cpp app/src/main/jni/[a-z]*.cpp
+ * Run:
+ *     ./echo_bench -t 10 -j 3000            echo over loopback, 3 ms jitter
+ *     ./echo_bench -d ringtone.wav -t 30    decoder path
+ *     ./echo_bench -m tone.wav -o out.pcm   mapped file path
+ *     ./echo_bench -M tone.wav -g 0.5       file mixed over the echo
+ *     ./echo_bench -i tone.wav -c mic.wav   archive what was recorded
+ *     ./echo_bench -s 20 -t 60              1 minute of audio, 20x faster
+ *     ./echo_bench -C 500 -j 3000           pick the buffer size first
+ * Exits with 1 when the player starved more than -u times: a build server
+ * can gate buffer count changes on it.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <jni.h>
+#include "sles_host.h"
+
+extern "C" {
+void Java_com_google_sample_echo_NativeFastPlayer_createSLEngine(JNIEnv *env, jclass, jint, jint);
+void Java_com_google_sample_echo_NativeFastPlayer_deleteSLEngine(JNIEnv *env, jclass type);
+jboolean Java_com_google_sample_echo_NativeFastPlayer_createSLBufferQueueAudioPlayer(JNIEnv *env, jclass);
+void Java_com_google_sample_echo_NativeFastPlayer_deleteSLBufferQueueAudioPlayer(JNIEnv *env, jclass type);
+jboolean Java_com_google_sample_echo_NativeFastPlayer_createAudioRecorder(JNIEnv *env, jclass type);
+void Java_com_google_sample_echo_NativeFastPlayer_deleteAudioRecorder(JNIEnv *env, jclass type);
+jboolean Java_com_google_sample_echo_NativeFastPlayer_createAudioDecoder(JNIEnv *env, jclass type, jbyteArray uri);
+jboolean Java_com_google_sample_echo_NativeFastPlayer_createFileSource(JNIEnv *env, jclass type, jbyteArray path);
+jboolean Java_com_google_sample_echo_NativeFastPlayer_createCaptureWriter(JNIEnv *env, jclass type, jbyteArray path);
+jint Java_com_google_sample_echo_NativeFastPlayer_calibrateFramesPerBuf(JNIEnv *env, jclass type, jint windowMs);
+jint Java_com_google_sample_echo_NativeFastPlayer_getCalibrationResult(JNIEnv *env, jclass type, jintArray result);
+void Java_com_google_sample_echo_NativeFastPlayer_setMixGain(JNIEnv *env, jclass type, jint input, jfloat gain);
+void Java_com_google_sample_echo_NativeFastPlayer_startPlay(JNIEnv *env, jclass type);
+void Java_com_google_sample_echo_NativeFastPlayer_stopPlay(JNIEnv *env, jclass type);
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -r rate      sample rate in Hz ( 48000 )\n"
+            "  -f frames    frames per buffer ( 192 )\n"
+            "  -t seconds   audio time to run ( 5 )\n"
+            "  -s speed     run the clocks speed times faster than real time ( 1 )\n"
+            "  -j us        late callbacks by a random 0..us\n"
+            "  -S seed      jitter seed\n"
+            "  -p ppm       recorder clock drift against the player\n"
+            "  -i input     recorder input: null, loopback or a file ( loopback )\n"
+            "  -o output    player output: null, loopback or a file ( loopback )\n"
+            "  -d file      play a WAV/raw file through the decoder instead of echo\n"
+            "  -m file      play a WAV/raw file from memory mapping instead of echo\n"
+            "  -M file      mix a mapped WAV/raw file over the echo\n"
+            "  -g gain      gain of the file mixed over the echo ( 1.0 )\n"
+            "  -c file      archive the recorded stream into a WAV file\n"
+            "  -C ms        calibrate the buffer size, ms per candidate, before the run\n"
+            "  -u count     fail when the player starved more than count times\n"
+            "  -R           SCHED_FIFO clock threads\n", name);
+}
+
+static uint32_t endpoint(const char *arg, const char **file) {
+    if (!strcmp(arg, "null")) {
+        return SL_HOST_ENDPOINT_NULL;
+    }
+    if (!strcmp(arg, "loopback")) {
+        return SL_HOST_ENDPOINT_LOOPBACK;
+    }
+    *file = arg;
+    return SL_HOST_ENDPOINT_FILE;
+}
+
+static void printDevice(const char *name, const SLHostDeviceStats &dev, double wallSec) {
+    if (!dev.devices_) {
+        return;
+    }
+    double avgUs = dev.buffers_ ? dev.callbackNs_ / 1000.0 / dev.buffers_ : 0.0;
+    printf("%-9s %8llu bufs, starved %5u, late max %6u us, "
+           "callback avg %6.2f us max %6u us, cpu %5.2f%%\n",
+           name, static_cast<unsigned long long>(dev.buffers_), dev.starved_,
+           dev.maxLateUs_, avgUs, dev.maxCallbackUs_,
+           dev.callbackNs_ / 1e7 / wallSec);
+}
+
+int main(int argc, char *argv[]) {
+    SLHostConfig config;
+    memset(&config, 0, sizeof(config));
+    config.sinkType_   = SL_HOST_ENDPOINT_LOOPBACK;
+    config.sourceType_ = SL_HOST_ENDPOINT_LOOPBACK;
+    config.speed_      = 1;
+    int sampleRate = 48000, framesPerBuf = 192;
+    double seconds = 5.0;
+    const char *decodeFile = nullptr, *mappedFile = nullptr, *captureFile = nullptr;
+    bool mixFile = false;
+    float mixGain = 1.0f;
+    long maxStarved = -1;
+    int calibrateMs = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:f:t:s:j:S:p:i:o:d:m:M:g:c:C:u:R")) != -1) {
+        switch (opt) {
+            case 'r': sampleRate = atoi(optarg); break;
+            case 'f': framesPerBuf = atoi(optarg); break;
+            case 't': seconds = atof(optarg); break;
+            case 's': config.speed_ = static_cast<uint32_t>(atoi(optarg)); break;
+            case 'j': config.jitterUs_ = static_cast<uint32_t>(atoi(optarg)); break;
+            case 'S': config.seed_ = static_cast<uint32_t>(atoi(optarg)); break;
+            case 'p': config.recDriftPpm_ = atoi(optarg); break;
+            case 'i': config.sourceType_ = endpoint(optarg, &config.sourceFile_); break;
+            case 'o': config.sinkType_ = endpoint(optarg, &config.sinkFile_); break;
+            case 'd': decodeFile = optarg; break;
+            case 'm': mappedFile = optarg; break;
+            case 'M': mappedFile = optarg; mixFile = true; break;
+            case 'g': mixGain = static_cast<float>(atof(optarg)); break;
+            case 'c': captureFile = optarg; break;
+            case 'C': calibrateMs = atoi(optarg); break;
+            case 'u': maxStarved = atol(optarg); break;
+            case 'R': config.realtime_ = true; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (sampleRate <= 0 || framesPerBuf <= 0 || !config.speed_ || seconds <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    slHostConfigure(&config);
+
+    JNIEnv env;
+    Java_com_google_sample_echo_NativeFastPlayer_createSLEngine(&env, nullptr,
+                                                                sampleRate, framesPerBuf);
+    if (calibrateMs > 0) {
+        framesPerBuf = Java_com_google_sample_echo_NativeFastPlayer_calibrateFramesPerBuf(
+                &env, nullptr, calibrateMs);
+        jint rows[3 * 8];
+        struct _jintArray rowArray = { static_cast<jsize>(sizeof(rows) / sizeof(rows[0])), rows };
+        Java_com_google_sample_echo_NativeFastPlayer_getCalibrationResult(&env, nullptr, &rowArray);
+        printf("frames  period  bufs  rec jitter  play jitter  underruns  overruns\n");
+        for (int i = 0; i < 3; i++) {
+            const jint *row = &rows[i * 8];
+            printf("%6d %6dus %5d %9dus %10dus %10d %9d  %s\n", row[0], row[1], row[2],
+                   row[3], row[4], row[5], row[6], row[7] ? "stable" : "unstable");
+        }
+        printf("calibrated to %d frames/buf\n", framesPerBuf);
+        slHostResetStats();
+    }
+    if (!Java_com_google_sample_echo_NativeFastPlayer_createSLBufferQueueAudioPlayer(&env, nullptr)) {
+        fprintf(stderr, "failed to create the player\n");
+        return 1;
+    }
+    std::string path(decodeFile ? decodeFile : (mappedFile ? mappedFile : ""));
+    struct _jbyteArray pathArray = { static_cast<jsize>(path.size()),
+                                     reinterpret_cast<jbyte*>(&path[0]) };
+    jboolean created;
+    if (decodeFile) {
+        created = Java_com_google_sample_echo_NativeFastPlayer_createAudioDecoder(
+                &env, nullptr, &pathArray);
+    } else if (mappedFile) {
+        created = Java_com_google_sample_echo_NativeFastPlayer_createFileSource(
+                &env, nullptr, &pathArray);
+    } else {
+        created = Java_com_google_sample_echo_NativeFastPlayer_createAudioRecorder(&env, nullptr);
+    }
+    if (created && mixFile) {
+        created = Java_com_google_sample_echo_NativeFastPlayer_createAudioRecorder(&env, nullptr);
+    }
+    if (!created) {
+        fprintf(stderr, "failed to create the %s\n",
+                decodeFile ? "decoder" : (mappedFile ? "file source" : "recorder"));
+        return 1;
+    }
+
+    if (captureFile) {
+        std::string capturePath(captureFile);
+        struct _jbyteArray captureArray = { static_cast<jsize>(capturePath.size()),
+                                            reinterpret_cast<jbyte*>(&capturePath[0]) };
+        if (!Java_com_google_sample_echo_NativeFastPlayer_createCaptureWriter(
+                &env, nullptr, &captureArray)) {
+            fprintf(stderr, "failed to open the capture file %s\n", captureFile);
+            return 1;
+        }
+    }
+
+    double wallSec = seconds / config.speed_;
+    Java_com_google_sample_echo_NativeFastPlayer_startPlay(&env, nullptr);
+    if (mixFile) {
+        Java_com_google_sample_echo_NativeFastPlayer_setMixGain(&env, nullptr, 1, mixGain);
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(wallSec * 1e6)));
+    Java_com_google_sample_echo_NativeFastPlayer_stopPlay(&env, nullptr);
+    Java_com_google_sample_echo_NativeFastPlayer_deleteSLBufferQueueAudioPlayer(&env, nullptr);
+    Java_com_google_sample_echo_NativeFastPlayer_deleteAudioRecorder(&env, nullptr);
+    Java_com_google_sample_echo_NativeFastPlayer_deleteSLEngine(&env, nullptr);
+
+    SLHostStats stats;
+    slHostGetStats(&stats);
+    printf("%d Hz, %d frames/buf, %.1f s of audio in %.2f s, jitter %u us\n",
+           sampleRate, framesPerBuf, seconds, wallSec, config.jitterUs_);
+    printDevice("player", stats.player_, wallSec);
+    printDevice("recorder", stats.recorder_, wallSec);
+    printDevice("decoder", stats.decoder_, wallSec);
+    if (stats.loopbackDropped_) {
+        printf("loopback dropped %u bytes\n", stats.loopbackDropped_);
+    }
+
+    if (maxStarved >= 0 && stats.player_.starved_ > maxStarved) {
+        printf("FAIL: player starved %u times ( limit %ld )\n",
+               stats.player_.starved_, maxStarved);
+        return 1;
+    }
+    return 0;
+}
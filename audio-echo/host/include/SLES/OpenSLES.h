@@ -0,0 +1,257 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host stand-in for <SLES/OpenSLES.h>: only the part of OpenSL ES 1.0.1
+ * the echo engine uses, so that the jni sources build unchanged on Linux
+ * against host/sles_host.cpp. Constants carry the Khronos values;
+ * interface tables are cut down to the methods implemented there.
+ */
+#ifndef OPENSL_ES_H_
+#define OPENSL_ES_H_
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int8_t      SLint8;
+typedef uint8_t     SLuint8;
+typedef int16_t     SLint16;
+typedef uint16_t    SLuint16;
+typedef int32_t     SLint32;
+typedef uint32_t    SLuint32;
+typedef SLuint32    SLboolean;
+typedef SLuint8     SLchar;
+typedef SLint16     SLmillibel;
+typedef SLuint32    SLmillisecond;
+typedef SLuint32    SLmilliHertz;
+typedef SLuint32    SLresult;
+
+#define SL_BOOLEAN_FALSE                    ((SLboolean) 0x00000000)
+#define SL_BOOLEAN_TRUE                     ((SLboolean) 0x00000001)
+
+#define SL_MILLIBEL_MAX                     ((SLmillibel) 0x7FFF)
+#define SL_MILLIBEL_MIN                     ((SLmillibel) (-SL_MILLIBEL_MAX-1))
+#define SL_TIME_UNKNOWN                     ((SLuint32) 0xFFFFFFFF)
+
+#define SL_RESULT_SUCCESS                   ((SLuint32) 0x00000000)
+#define SL_RESULT_PRECONDITIONS_VIOLATED    ((SLuint32) 0x00000001)
+#define SL_RESULT_PARAMETER_INVALID         ((SLuint32) 0x00000002)
+#define SL_RESULT_MEMORY_FAILURE            ((SLuint32) 0x00000003)
+#define SL_RESULT_RESOURCE_ERROR            ((SLuint32) 0x00000004)
+#define SL_RESULT_IO_ERROR                  ((SLuint32) 0x00000006)
+#define SL_RESULT_BUFFER_INSUFFICIENT       ((SLuint32) 0x00000007)
+#define SL_RESULT_CONTENT_UNSUPPORTED       ((SLuint32) 0x00000009)
+#define SL_RESULT_CONTENT_NOT_FOUND         ((SLuint32) 0x0000000A)
+#define SL_RESULT_FEATURE_UNSUPPORTED       ((SLuint32) 0x0000000C)
+#define SL_RESULT_INTERNAL_ERROR            ((SLuint32) 0x0000000D)
+
+#define SL_SAMPLINGRATE_8                   ((SLuint32) 8000000)
+#define SL_SAMPLINGRATE_16                  ((SLuint32) 16000000)
+#define SL_SAMPLINGRATE_44_1                ((SLuint32) 44100000)
+#define SL_SAMPLINGRATE_48                  ((SLuint32) 48000000)
+
+#define SL_PCMSAMPLEFORMAT_FIXED_8          ((SLuint16) 0x0008)
+#define SL_PCMSAMPLEFORMAT_FIXED_16         ((SLuint16) 0x0010)
+#define SL_PCMSAMPLEFORMAT_FIXED_24         ((SLuint16) 0x0018)
+#define SL_PCMSAMPLEFORMAT_FIXED_32         ((SLuint16) 0x0020)
+
+#define SL_SPEAKER_FRONT_LEFT               ((SLuint32) 0x00000001)
+#define SL_SPEAKER_FRONT_RIGHT              ((SLuint32) 0x00000002)
+#define SL_SPEAKER_FRONT_CENTER             ((SLuint32) 0x00000004)
+
+#define SL_BYTEORDER_BIGENDIAN              ((SLuint32) 0x00000001)
+#define SL_BYTEORDER_LITTLEENDIAN           ((SLuint32) 0x00000002)
+
+#define SL_DATAFORMAT_MIME                  ((SLuint32) 0x00000001)
+#define SL_DATAFORMAT_PCM                   ((SLuint32) 0x00000002)
+#define SL_CONTAINERTYPE_UNSPECIFIED        ((SLuint32) 0x00000001)
+
+#define SL_DATALOCATOR_URI                  ((SLuint32) 0x00000001)
+#define SL_DATALOCATOR_IODEVICE             ((SLuint32) 0x00000003)
+#define SL_DATALOCATOR_OUTPUTMIX            ((SLuint32) 0x00000004)
+
+#define SL_IODEVICE_AUDIOINPUT              ((SLuint32) 0x00000001)
+#define SL_DEFAULTDEVICEID_AUDIOINPUT       ((SLuint32) 0xFFFFFFFF)
+
+#define SL_OBJECT_STATE_UNREALIZED          ((SLuint32) 0x00000001)
+#define SL_OBJECT_STATE_REALIZED            ((SLuint32) 0x00000002)
+
+#define SL_PLAYSTATE_STOPPED                ((SLuint32) 0x00000001)
+#define SL_PLAYSTATE_PAUSED                 ((SLuint32) 0x00000002)
+#define SL_PLAYSTATE_PLAYING                ((SLuint32) 0x00000003)
+#define SL_PLAYEVENT_HEADATEND              ((SLuint32) 0x00000001)
+
+#define SL_RECORDSTATE_STOPPED              ((SLuint32) 0x00000001)
+#define SL_RECORDSTATE_PAUSED               ((SLuint32) 0x00000002)
+#define SL_RECORDSTATE_RECORDING            ((SLuint32) 0x00000003)
+
+#define SL_CHARACTERENCODING_BINARY         ((SLuint32) 0x00000001)
+#define SL_CHARACTERENCODING_ASCII          ((SLuint32) 0x00000002)
+
+typedef const struct SLInterfaceID_ {
+    SLuint32 time_low;
+    SLuint16 time_mid;
+    SLuint16 time_hi_and_version;
+    SLuint16 clock_seq;
+    SLuint8  node[6];
+} * SLInterfaceID;
+
+extern const SLInterfaceID SL_IID_NULL;
+extern const SLInterfaceID SL_IID_OBJECT;
+extern const SLInterfaceID SL_IID_ENGINE;
+extern const SLInterfaceID SL_IID_PLAY;
+extern const SLInterfaceID SL_IID_RECORD;
+extern const SLInterfaceID SL_IID_SEEK;
+extern const SLInterfaceID SL_IID_VOLUME;
+extern const SLInterfaceID SL_IID_BUFFERQUEUE;
+extern const SLInterfaceID SL_IID_METADATAEXTRACTION;
+
+/* data sources and sinks */
+typedef struct SLDataLocator_URI_ {
+    SLuint32    locatorType;
+    SLchar     *URI;
+} SLDataLocator_URI;
+
+typedef struct SLDataFormat_MIME_ {
+    SLuint32    formatType;
+    SLchar     *mimeType;
+    SLuint32    containerType;
+} SLDataFormat_MIME;
+
+typedef struct SLDataFormat_PCM_ {
+    SLuint32    formatType;
+    SLuint32    numChannels;
+    SLuint32    samplesPerSec;
+    SLuint32    bitsPerSample;
+    SLuint32    containerSize;
+    SLuint32    channelMask;
+    SLuint32    endianness;
+} SLDataFormat_PCM;
+
+struct SLObjectItf_;
+typedef const struct SLObjectItf_ * const * SLObjectItf;
+
+typedef struct SLDataLocator_IODevice_ {
+    SLuint32    locatorType;
+    SLuint32    deviceType;
+    SLuint32    deviceID;
+    SLObjectItf device;
+} SLDataLocator_IODevice;
+
+typedef struct SLDataLocator_OutputMix_ {
+    SLuint32    locatorType;
+    SLObjectItf outputMix;
+} SLDataLocator_OutputMix;
+
+typedef struct SLDataSource_ {
+    void       *pLocator;
+    void       *pFormat;
+} SLDataSource;
+
+typedef struct SLDataSink_ {
+    void       *pLocator;
+    void       *pFormat;
+} SLDataSink;
+
+typedef struct SLEngineOption_ {
+    SLuint32    feature;
+    SLuint32    data;
+} SLEngineOption;
+
+typedef struct SLMetadataInfo_ {
+    SLuint32    size;
+    SLuint32    encoding;
+    SLchar      langCountry[16];
+    SLuint8     data[1];
+} SLMetadataInfo;
+
+/* interfaces */
+struct SLObjectItf_ {
+    SLresult (*Realize) (SLObjectItf self, SLboolean async);
+    SLresult (*Resume) (SLObjectItf self, SLboolean async);
+    SLresult (*GetState) (SLObjectItf self, SLuint32 *pState);
+    SLresult (*GetInterface) (SLObjectItf self, const SLInterfaceID iid, void *pInterface);
+    void (*Destroy) (SLObjectItf self);
+};
+
+struct SLEngineItf_;
+typedef const struct SLEngineItf_ * const * SLEngineItf;
+struct SLEngineItf_ {
+    SLresult (*CreateAudioPlayer) (SLEngineItf self, SLObjectItf *pPlayer,
+            SLDataSource *pAudioSrc, SLDataSink *pAudioSnk, SLuint32 numInterfaces,
+            const SLInterfaceID *pInterfaceIds, const SLboolean *pInterfaceRequired);
+    SLresult (*CreateAudioRecorder) (SLEngineItf self, SLObjectItf *pRecorder,
+            SLDataSource *pAudioSrc, SLDataSink *pAudioSnk, SLuint32 numInterfaces,
+            const SLInterfaceID *pInterfaceIds, const SLboolean *pInterfaceRequired);
+    SLresult (*CreateOutputMix) (SLEngineItf self, SLObjectItf *pMix, SLuint32 numInterfaces,
+            const SLInterfaceID *pInterfaceIds, const SLboolean *pInterfaceRequired);
+};
+
+struct SLPlayItf_;
+typedef const struct SLPlayItf_ * const * SLPlayItf;
+typedef void (*slPlayCallback) (SLPlayItf caller, void *pContext, SLuint32 event);
+struct SLPlayItf_ {
+    SLresult (*SetPlayState) (SLPlayItf self, SLuint32 state);
+    SLresult (*GetPlayState) (SLPlayItf self, SLuint32 *pState);
+    SLresult (*GetPosition) (SLPlayItf self, SLmillisecond *pMsec);
+    SLresult (*RegisterCallback) (SLPlayItf self, slPlayCallback callback, void *pContext);
+    SLresult (*SetCallbackEventsMask) (SLPlayItf self, SLuint32 eventFlags);
+};
+
+struct SLRecordItf_;
+typedef const struct SLRecordItf_ * const * SLRecordItf;
+struct SLRecordItf_ {
+    SLresult (*SetRecordState) (SLRecordItf self, SLuint32 state);
+    SLresult (*GetRecordState) (SLRecordItf self, SLuint32 *pState);
+};
+
+struct SLSeekItf_;
+typedef const struct SLSeekItf_ * const * SLSeekItf;
+struct SLSeekItf_ {
+    SLresult (*SetLoop) (SLSeekItf self, SLboolean loopEnable,
+                         SLmillisecond startPos, SLmillisecond endPos);
+};
+
+struct SLVolumeItf_;
+typedef const struct SLVolumeItf_ * const * SLVolumeItf;
+struct SLVolumeItf_ {
+    SLresult (*SetVolumeLevel) (SLVolumeItf self, SLmillibel level);
+    SLresult (*GetVolumeLevel) (SLVolumeItf self, SLmillibel *pLevel);
+};
+
+struct SLMetadataExtractionItf_;
+typedef const struct SLMetadataExtractionItf_ * const * SLMetadataExtractionItf;
+struct SLMetadataExtractionItf_ {
+    SLresult (*GetItemCount) (SLMetadataExtractionItf self, SLuint32 *pItemCount);
+    SLresult (*GetKeySize) (SLMetadataExtractionItf self, SLuint32 index, SLuint32 *pKeySize);
+    SLresult (*GetKey) (SLMetadataExtractionItf self, SLuint32 index, SLuint32 keySize,
+                        SLMetadataInfo *pKey);
+    SLresult (*GetValueSize) (SLMetadataExtractionItf self, SLuint32 index, SLuint32 *pValueSize);
+    SLresult (*GetValue) (SLMetadataExtractionItf self, SLuint32 index, SLuint32 valueSize,
+                          SLMetadataInfo *pValue);
+};
+
+SLresult slCreateEngine(SLObjectItf *pEngine, SLuint32 numOptions,
+                        const SLEngineOption *pEngineOptions, SLuint32 numInterfaces,
+                        const SLInterfaceID *pInterfaceIds, const SLboolean *pInterfaceRequired);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENSL_ES_H_ */
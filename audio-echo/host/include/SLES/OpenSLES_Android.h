@@ -0,0 +1,76 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host stand-in for <SLES/OpenSLES_Android.h>: the Android simple buffer
+ * queue and the PCM_EX format, see include/SLES/OpenSLES.h
+ */
+#ifndef OPENSL_ES_ANDROID_H_
+#define OPENSL_ES_ANDROID_H_
+#include "OpenSLES.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE     ((SLuint32) 0x800007BD)
+#define SL_ANDROID_DATAFORMAT_PCM_EX                ((SLuint32) 0x4)
+
+#define SL_ANDROID_PCM_REPRESENTATION_SIGNED_INT    ((SLuint32) 0x1)
+#define SL_ANDROID_PCM_REPRESENTATION_UNSIGNED_INT  ((SLuint32) 0x2)
+#define SL_ANDROID_PCM_REPRESENTATION_FLOAT         ((SLuint32) 0x3)
+
+extern const SLInterfaceID SL_IID_ANDROIDSIMPLEBUFFERQUEUE;
+
+typedef struct SLDataLocator_AndroidSimpleBufferQueue {
+    SLuint32    locatorType;
+    SLuint32    numBuffers;
+} SLDataLocator_AndroidSimpleBufferQueue;
+
+typedef struct SLAndroidDataFormat_PCM_EX_ {
+    SLuint32    formatType;
+    SLuint32    numChannels;
+    SLuint32    sampleRate;
+    SLuint32    bitsPerSample;
+    SLuint32    containerSize;
+    SLuint32    channelMask;
+    SLuint32    endianness;
+    SLuint32    representation;
+} SLAndroidDataFormat_PCM_EX;
+
+typedef struct SLAndroidSimpleBufferQueueState_ {
+    SLuint32    count;
+    SLuint32    index;
+} SLAndroidSimpleBufferQueueState;
+
+struct SLAndroidSimpleBufferQueueItf_;
+typedef const struct SLAndroidSimpleBufferQueueItf_ * const * SLAndroidSimpleBufferQueueItf;
+typedef void (*slAndroidSimpleBufferQueueCallback) (SLAndroidSimpleBufferQueueItf caller,
+                                                    void *pContext);
+struct SLAndroidSimpleBufferQueueItf_ {
+    SLresult (*Enqueue) (SLAndroidSimpleBufferQueueItf self, const void *pBuffer, SLuint32 size);
+    SLresult (*Clear) (SLAndroidSimpleBufferQueueItf self);
+    SLresult (*GetState) (SLAndroidSimpleBufferQueueItf self,
+                          SLAndroidSimpleBufferQueueState *pState);
+    SLresult (*RegisterCallback) (SLAndroidSimpleBufferQueueItf self,
+                                  slAndroidSimpleBufferQueueCallback callback, void* pContext);
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENSL_ES_ANDROID_H_ */
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host stand-in for <jni.h>: just enough for the JNI entry points in
+ * audio_main.cpp to be called straight from a host program. Java byte
+ * and int arrays are plain ( length, data ) pairs.
+ */
+#ifndef JNI_H_
+#define JNI_H_
+#include <stdint.h>
+
+#define JNIEXPORT  __attribute__ ((visibility ("default")))
+#define JNICALL
+
+#define JNI_FALSE  0
+#define JNI_TRUE   1
+#define JNI_COMMIT 1
+#define JNI_ABORT  2
+
+typedef uint8_t   jboolean;
+typedef int8_t    jbyte;
+typedef int32_t   jint;
+typedef int64_t   jlong;
+typedef float     jfloat;
+typedef jint      jsize;
+
+typedef void     *jclass;
+typedef struct _jbyteArray {
+    jsize   length_;
+    jbyte  *data_;
+} *jbyteArray;
+typedef struct _jintArray {
+    jsize   length_;
+    jint   *data_;
+} *jintArray;
+
+struct _JNIEnv {
+    jbyte *GetByteArrayElements(jbyteArray array, jboolean *isCopy) {
+        if (isCopy) {
+            *isCopy = JNI_FALSE;
+        }
+        return array->data_;
+    }
+    void ReleaseByteArrayElements(jbyteArray, jbyte *, jint) {}
+    jsize GetArrayLength(jbyteArray array) {
+        return array->length_;
+    }
+    jsize GetArrayLength(jintArray array) {
+        return array->length_;
+    }
+    void SetIntArrayRegion(jintArray array, jsize start, jsize len, const jint *buf) {
+        for (jsize i = 0; i < len && start + i < array->length_; i++) {
+            array->data_[start + i] = buf[i];
+        }
+    }
+};
+typedef _JNIEnv JNIEnv;
+
+#endif /* JNI_H_ */
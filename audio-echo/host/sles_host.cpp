@@ -0,0 +1,927 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cassert>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+#include <time.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <android/log.h>
+#include <SLES/OpenSLES_AndroidMetadata.h>
+#include "sles_host.h"
+
+/*
+ * interface ids: compared by address only
+ */
+static const struct SLInterfaceID_ hostIids[] = {
+    { 0x00000000, 0, 0, 0, {0} },       // NULL
+    { 0x00000001, 0, 0, 0, {0} },       // OBJECT
+    { 0x00000002, 0, 0, 0, {0} },       // ENGINE
+    { 0x00000003, 0, 0, 0, {0} },       // PLAY
+    { 0x00000004, 0, 0, 0, {0} },       // RECORD
+    { 0x00000005, 0, 0, 0, {0} },       // SEEK
+    { 0x00000006, 0, 0, 0, {0} },       // VOLUME
+    { 0x00000007, 0, 0, 0, {0} },       // BUFFERQUEUE
+    { 0x00000008, 0, 0, 0, {0} },       // METADATAEXTRACTION
+    { 0x00000009, 0, 0, 0, {0} },       // ANDROIDSIMPLEBUFFERQUEUE
+};
+const SLInterfaceID SL_IID_NULL                     = &hostIids[0];
+const SLInterfaceID SL_IID_OBJECT                   = &hostIids[1];
+const SLInterfaceID SL_IID_ENGINE                   = &hostIids[2];
+const SLInterfaceID SL_IID_PLAY                     = &hostIids[3];
+const SLInterfaceID SL_IID_RECORD                   = &hostIids[4];
+const SLInterfaceID SL_IID_SEEK                     = &hostIids[5];
+const SLInterfaceID SL_IID_VOLUME                   = &hostIids[6];
+const SLInterfaceID SL_IID_BUFFERQUEUE              = &hostIids[7];
+const SLInterfaceID SL_IID_METADATAEXTRACTION       = &hostIids[8];
+const SLInterfaceID SL_IID_ANDROIDSIMPLEBUFFERQUEUE = &hostIids[9];
+
+int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+    static const char levels[] = "??VDIWEFS";
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%c/%s: ", levels[prio < 9 ? prio : 0], tag);
+    int count = vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    return count;
+}
+
+namespace {
+
+enum ObjectKind {
+    KIND_ENGINE,
+    KIND_OUTPUTMIX,
+    KIND_PLAYER,
+    KIND_RECORDER,
+    KIND_DECODER,
+};
+
+struct HostObject;
+
+/*
+ * every interface handle points at one of these: the table first, as
+ * OpenSL ES wants, and the object it belongs to right after it
+ */
+template <typename VTBL>
+struct ItfSlot {
+    const VTBL  *vtbl_;
+    HostObject  *owner_;
+};
+
+template <typename VTBL>
+HostObject *ownerOf(const VTBL * const *self) {
+    return reinterpret_cast<const ItfSlot<VTBL>*>(self)->owner_;
+}
+
+struct PcmFormat {
+    uint32_t  channels_;
+    uint32_t  sampleRate_;      // Hz
+    uint32_t  bitsPerSample_;
+    uint32_t  bytesPerSec(void) const {
+        return sampleRate_ * channels_ * (bitsPerSample_ >> 3);
+    }
+};
+
+struct PendingBuf {
+    uint8_t   *data_;
+    uint32_t   size_;
+};
+
+/*
+ * Loopback: what the players write, the recorders read back
+ */
+struct Loopback {
+    std::mutex            lock_;
+    std::vector<uint8_t>  ring_;
+    size_t                read_;
+    size_t                count_;
+    uint32_t              dropped_;
+};
+
+SLHostConfig       config;
+Loopback           loopback;
+std::mutex         statsLock;
+SLHostStats        stats;
+uint32_t           jitterSeed;
+
+struct HostObject {
+    ItfSlot<SLObjectItf_>                     object_;
+    ItfSlot<SLEngineItf_>                     engine_;
+    ItfSlot<SLPlayItf_>                       play_;
+    ItfSlot<SLRecordItf_>                     record_;
+    ItfSlot<SLAndroidSimpleBufferQueueItf_>   bufQueue_;
+    ItfSlot<SLSeekItf_>                       seek_;
+    ItfSlot<SLVolumeItf_>                     volume_;
+    ItfSlot<SLMetadataExtractionItf_>         meta_;
+
+    ObjectKind  kind_;
+    SLuint32    objectState_;
+
+    // devices only: everything below is guarded by lock_
+    std::mutex               lock_;
+    std::condition_variable  wake_;
+    std::thread              thread_;
+    bool                     quit_;
+    SLuint32                 state_;        // SL_PLAYSTATE_XXX / SL_RECORDSTATE_XXX
+    std::vector<PendingBuf>  queue_;        // numBuffers slots
+    uint32_t                 head_;
+    uint32_t                 count_;
+    uint64_t                 periodNs_;
+
+    slAndroidSimpleBufferQueueCallback  bqCallback_;
+    void                               *bqContext_;
+    slPlayCallback                      playCallback_;
+    void                               *playContext_;
+    SLuint32                            eventMask_;
+    SLmillibel                          level_;
+
+    PcmFormat                format_;       // of the audio the buffers carry
+    FILE                    *file_;         // sink / recorder source
+    long                     fileStart_;    // recorder source: first PCM byte
+    std::vector<uint8_t>     content_;      // decoder source
+    size_t                   contentPos_;
+    bool                     eof_;
+
+    SLHostDeviceStats        stats_;        // written by the clock thread
+};
+
+uint64_t nowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+}
+
+void sleepUntil(uint64_t ns) {
+    struct timespec when;
+    when.tv_sec  = static_cast<time_t>(ns / 1000000000ULL);
+    when.tv_nsec = static_cast<long>(ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &when, NULL)) {
+        // interrupted, go back to sleep
+    }
+}
+
+/*
+ * jitterNs(): xorshift, so one seed always gives the same run; in
+ * audio time like the periods
+ */
+uint64_t jitterNs(void) {
+    if (!config.jitterUs_) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> guard(statsLock);
+    jitterSeed ^= jitterSeed << 13;
+    jitterSeed ^= jitterSeed >> 17;
+    jitterSeed ^= jitterSeed << 5;
+    return static_cast<uint64_t>(jitterSeed % (config.jitterUs_ + 1)) * 1000 / config.speed_;
+}
+
+bool isActive(HostObject *obj) {
+    if (obj->kind_ == KIND_RECORDER) {
+        return obj->state_ == SL_RECORDSTATE_RECORDING;
+    }
+    return obj->state_ == SL_PLAYSTATE_PLAYING &&
+           !(obj->kind_ == KIND_DECODER && obj->eof_);
+}
+
+/*
+ * bufferPeriodNs(): how long the device takes for size bytes
+ */
+uint64_t bufferPeriodNs(HostObject *obj, uint32_t size) {
+    uint64_t period = static_cast<uint64_t>(size) * 1000000000ULL /
+                      obj->format_.bytesPerSec();
+    if (obj->kind_ == KIND_RECORDER && config.recDriftPpm_) {
+        period = period * (1000000 + config.recDriftPpm_) / 1000000;
+    } else if (obj->kind_ == KIND_DECODER) {
+        period /= SL_HOST_DECODE_SPEEDUP;
+    }
+    return period / config.speed_;
+}
+
+void loopbackWrite(const uint8_t *data, uint32_t size) {
+    std::lock_guard<std::mutex> guard(loopback.lock_);
+    size_t cap = loopback.ring_.size();
+    size_t room = cap - loopback.count_;
+    if (size > room) {
+        loopback.dropped_ += size - room;
+        size = static_cast<uint32_t>(room);
+    }
+    size_t write = (loopback.read_ + loopback.count_) % cap;
+    for (uint32_t i = 0; i < size; i++) {
+        loopback.ring_[(write + i) % cap] = data[i];
+    }
+    loopback.count_ += size;
+}
+
+void loopbackRead(uint8_t *data, uint32_t size) {
+    std::lock_guard<std::mutex> guard(loopback.lock_);
+    size_t cap = loopback.ring_.size();
+    uint32_t count = static_cast<uint32_t>(size < loopback.count_ ? size : loopback.count_);
+    for (uint32_t i = 0; i < count; i++) {
+        data[i] = loopback.ring_[(loopback.read_ + i) % cap];
+    }
+    loopback.read_ = (loopback.read_ + count) % cap;
+    loopback.count_ -= count;
+    memset(data + count, 0, size - count);      // nothing played yet: silence
+}
+
+/*
+ * transfer(): what the device does with one buffer
+ */
+void transfer(HostObject *obj, PendingBuf *buf) {
+    switch (obj->kind_) {
+        case KIND_PLAYER:
+            if (config.sinkType_ == SL_HOST_ENDPOINT_FILE && obj->file_) {
+                fwrite(buf->data_, 1, buf->size_, obj->file_);
+            } else if (config.sinkType_ == SL_HOST_ENDPOINT_LOOPBACK) {
+                loopbackWrite(buf->data_, buf->size_);
+            }
+            break;
+        case KIND_RECORDER:
+            if (config.sourceType_ == SL_HOST_ENDPOINT_FILE && obj->file_) {
+                uint32_t count = 0;
+                while (count < buf->size_) {
+                    size_t got = fread(buf->data_ + count, 1, buf->size_ - count, obj->file_);
+                    if (!got) {
+                        if (fseek(obj->file_, obj->fileStart_, SEEK_SET)) {
+                            break;
+                        }
+                        continue;   // loop the input
+                    }
+                    count += static_cast<uint32_t>(got);
+                }
+                memset(buf->data_ + count, 0, buf->size_ - count);
+            } else if (config.sourceType_ == SL_HOST_ENDPOINT_LOOPBACK) {
+                loopbackRead(buf->data_, buf->size_);
+            } else {
+                memset(buf->data_, 0, buf->size_);
+            }
+            break;
+        case KIND_DECODER: {
+            size_t left = obj->content_.size() - obj->contentPos_;
+            size_t count = buf->size_ < left ? buf->size_ : left;
+            memcpy(buf->data_, obj->content_.data() + obj->contentPos_, count);
+            memset(buf->data_ + count, 0, buf->size_ - count);
+            obj->contentPos_ += count;
+            break;
+        }
+        default:
+            assert(false);
+    }
+}
+
+void setRealtime(void) {
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO) / 2;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) {
+        __android_log_print(ANDROID_LOG_WARN, "sles_host",
+                            "SCHED_FIFO not granted, clock thread runs SCHED_OTHER");
+    }
+}
+
+/*
+ * clockThread(): one per device. Buffer completions sit on a fixed grid
+ * ( no drift from late wake-ups ); injected jitter delays the callback,
+ * not the grid, so a late callback is followed by early ones
+ */
+void clockThread(HostObject *obj) {
+    if (config.realtime_) {
+        setRealtime();
+    }
+    std::unique_lock<std::mutex> lock(obj->lock_);
+    uint64_t due = 0;
+    while (true) {
+        if (!isActive(obj)) {
+            due = 0;            // stopped or paused: the grid restarts on wake up
+            obj->wake_.wait(lock, [obj] { return obj->quit_ || isActive(obj); });
+        }
+        if (obj->quit_) {
+            break;
+        }
+        if (!due) {
+            due = nowNs();
+        }
+        if (obj->count_) {
+            obj->periodNs_ = bufferPeriodNs(obj, obj->queue_[obj->head_].size_);
+        }
+        due += obj->periodNs_;
+        uint64_t deliver = due + jitterNs();
+
+        lock.unlock();
+        sleepUntil(deliver);
+        lock.lock();
+        if (obj->quit_) {
+            break;
+        }
+        if (!isActive(obj)) {
+            continue;
+        }
+        uint64_t late = (nowNs() - due) / 1000;
+        if (late > obj->stats_.maxLateUs_) {
+            obj->stats_.maxLateUs_ = static_cast<uint32_t>(late);
+        }
+        if (!obj->count_) {
+            // before the first buffer the app is still priming: not a glitch
+            if (obj->stats_.buffers_) {
+                obj->stats_.starved_++;
+            }
+            if (obj->kind_ == KIND_PLAYER && config.sinkType_ == SL_HOST_ENDPOINT_LOOPBACK) {
+                // the speaker plays silence meanwhile
+                uint32_t frameSize = obj->format_.channels_ * (obj->format_.bitsPerSample_ >> 3);
+                uint64_t bytes = obj->periodNs_ * config.speed_ *
+                                 obj->format_.bytesPerSec() / 1000000000ULL;
+                std::vector<uint8_t> silence(bytes - bytes % frameSize, 0);
+                loopbackWrite(silence.data(), static_cast<uint32_t>(silence.size()));
+            }
+            continue;
+        }
+        PendingBuf buf = obj->queue_[obj->head_];
+        obj->head_ = (obj->head_ + 1) % obj->queue_.size();
+        obj->count_--;
+        lock.unlock();
+
+        transfer(obj, &buf);
+        bool headAtEnd = (obj->kind_ == KIND_DECODER &&
+                          obj->contentPos_ == obj->content_.size());
+
+        uint64_t start = nowNs();
+        if (obj->bqCallback_) {
+            obj->bqCallback_(&obj->bufQueue_.vtbl_, obj->bqContext_);
+        }
+        uint64_t spent = nowNs() - start;
+        if (headAtEnd && obj->playCallback_ && (obj->eventMask_ & SL_PLAYEVENT_HEADATEND)) {
+            obj->playCallback_(&obj->play_.vtbl_, obj->playContext_, SL_PLAYEVENT_HEADATEND);
+        }
+
+        lock.lock();
+        obj->eof_ = headAtEnd;
+        obj->stats_.buffers_++;
+        obj->stats_.bytes_ += buf.size_;
+        obj->stats_.callbackNs_ += spent;
+        if (spent / 1000 > obj->stats_.maxCallbackUs_) {
+            obj->stats_.maxCallbackUs_ = static_cast<uint32_t>(spent / 1000);
+        }
+    }
+}
+
+void foldStats(HostObject *obj) {
+    SLHostDeviceStats *total = nullptr;
+    switch (obj->kind_) {
+        case KIND_PLAYER:   total = &stats.player_;   break;
+        case KIND_RECORDER: total = &stats.recorder_; break;
+        case KIND_DECODER:  total = &stats.decoder_;  break;
+        default:            return;
+    }
+    std::lock_guard<std::mutex> guard(statsLock);
+    total->devices_++;
+    total->buffers_ += obj->stats_.buffers_;
+    total->bytes_   += obj->stats_.bytes_;
+    total->starved_ += obj->stats_.starved_;
+    total->callbackNs_ += obj->stats_.callbackNs_;
+    if (obj->stats_.maxLateUs_ > total->maxLateUs_) {
+        total->maxLateUs_ = obj->stats_.maxLateUs_;
+    }
+    if (obj->stats_.maxCallbackUs_ > total->maxCallbackUs_) {
+        total->maxCallbackUs_ = obj->stats_.maxCallbackUs_;
+    }
+}
+
+/*
+ * SLObjectItf
+ */
+SLresult Object_Realize(SLObjectItf self, SLboolean async) {
+    HostObject *obj = ownerOf(self);
+    if (obj->objectState_ == SL_OBJECT_STATE_REALIZED) {
+        return SL_RESULT_PRECONDITIONS_VIOLATED;
+    }
+    obj->objectState_ = SL_OBJECT_STATE_REALIZED;
+    if (obj->kind_ >= KIND_PLAYER) {
+        obj->thread_ = std::thread(clockThread, obj);
+    }
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Object_Resume(SLObjectItf self, SLboolean async) {
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Object_GetState(SLObjectItf self, SLuint32 *pState) {
+    *pState = ownerOf(self)->objectState_;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Object_GetInterface(SLObjectItf self, const SLInterfaceID iid, void *pInterface) {
+    HostObject *obj = ownerOf(self);
+    if (obj->objectState_ != SL_OBJECT_STATE_REALIZED) {
+        return SL_RESULT_PRECONDITIONS_VIOLATED;
+    }
+    bool device = obj->kind_ >= KIND_PLAYER;
+    bool player = obj->kind_ == KIND_PLAYER || obj->kind_ == KIND_DECODER;
+    const void *itf = nullptr;
+    if (iid == SL_IID_OBJECT) {
+        itf = &obj->object_.vtbl_;
+    } else if (iid == SL_IID_ENGINE && obj->kind_ == KIND_ENGINE) {
+        itf = &obj->engine_.vtbl_;
+    } else if (iid == SL_IID_PLAY && player) {
+        itf = &obj->play_.vtbl_;
+    } else if (iid == SL_IID_RECORD && obj->kind_ == KIND_RECORDER) {
+        itf = &obj->record_.vtbl_;
+    } else if ((iid == SL_IID_BUFFERQUEUE || iid == SL_IID_ANDROIDSIMPLEBUFFERQUEUE) && device) {
+        itf = &obj->bufQueue_.vtbl_;
+    } else if (iid == SL_IID_VOLUME && player) {
+        itf = &obj->volume_.vtbl_;
+    } else if ((iid == SL_IID_SEEK || iid == SL_IID_METADATAEXTRACTION) &&
+               obj->kind_ == KIND_DECODER) {
+        itf = (iid == SL_IID_SEEK) ? static_cast<const void*>(&obj->seek_.vtbl_) :
+                                     static_cast<const void*>(&obj->meta_.vtbl_);
+    }
+    if (!itf) {
+        return SL_RESULT_FEATURE_UNSUPPORTED;
+    }
+    *static_cast<const void**>(pInterface) = itf;
+    return SL_RESULT_SUCCESS;
+}
+
+void Object_Destroy(SLObjectItf self) {
+    HostObject *obj = ownerOf(self);
+    if (obj->thread_.joinable()) {
+        assert(obj->thread_.get_id() != std::this_thread::get_id());
+        {
+            std::lock_guard<std::mutex> guard(obj->lock_);
+            obj->quit_ = true;
+        }
+        obj->wake_.notify_all();
+        obj->thread_.join();
+    }
+    foldStats(obj);
+    if (obj->file_) {
+        fclose(obj->file_);
+    }
+    delete obj;
+}
+
+/*
+ * SLPlayItf / SLRecordItf
+ */
+SLresult setDeviceState(HostObject *obj, SLuint32 state) {
+    {
+        std::lock_guard<std::mutex> guard(obj->lock_);
+        obj->state_ = state;
+    }
+    obj->wake_.notify_all();
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Play_SetPlayState(SLPlayItf self, SLuint32 state) {
+    if (state < SL_PLAYSTATE_STOPPED || state > SL_PLAYSTATE_PLAYING) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    return setDeviceState(ownerOf(self), state);
+}
+
+SLresult Play_GetPlayState(SLPlayItf self, SLuint32 *pState) {
+    HostObject *obj = ownerOf(self);
+    std::lock_guard<std::mutex> guard(obj->lock_);
+    *pState = obj->state_;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Play_GetPosition(SLPlayItf self, SLmillisecond *pMsec) {
+    HostObject *obj = ownerOf(self);
+    std::lock_guard<std::mutex> guard(obj->lock_);
+    *pMsec = static_cast<SLmillisecond>(obj->stats_.bytes_ * 1000 / obj->format_.bytesPerSec());
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Play_RegisterCallback(SLPlayItf self, slPlayCallback callback, void *pContext) {
+    HostObject *obj = ownerOf(self);
+    std::lock_guard<std::mutex> guard(obj->lock_);
+    obj->playCallback_ = callback;
+    obj->playContext_  = pContext;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Play_SetCallbackEventsMask(SLPlayItf self, SLuint32 eventFlags) {
+    HostObject *obj = ownerOf(self);
+    std::lock_guard<std::mutex> guard(obj->lock_);
+    obj->eventMask_ = eventFlags;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Record_SetRecordState(SLRecordItf self, SLuint32 state) {
+    if (state < SL_RECORDSTATE_STOPPED || state > SL_RECORDSTATE_RECORDING) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    return setDeviceState(ownerOf(self), state);
+}
+
+SLresult Record_GetRecordState(SLRecordItf self, SLuint32 *pState) {
+    HostObject *obj = ownerOf(self);
+    std::lock_guard<std::mutex> guard(obj->lock_);
+    *pState = obj->state_;
+    return SL_RESULT_SUCCESS;
+}
+
+/*
+ * SLAndroidSimpleBufferQueueItf
+ */
+SLresult BufQueue_Enqueue(SLAndroidSimpleBufferQueueItf self, const void *pBuffer, SLuint32 size) {
+    HostObject *obj = ownerOf(self);
+    if (!pBuffer || !size) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    {
+        std::lock_guard<std::mutex> guard(obj->lock_);
+        if (obj->count_ == obj->queue_.size()) {
+            return SL_RESULT_BUFFER_INSUFFICIENT;
+        }
+        PendingBuf &slot = obj->queue_[(obj->head_ + obj->count_) % obj->queue_.size()];
+        slot.data_ = static_cast<uint8_t*>(const_cast<void*>(pBuffer));
+        slot.size_ = size;
+        obj->count_++;
+    }
+    obj->wake_.notify_all();
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult BufQueue_Clear(SLAndroidSimpleBufferQueueItf self) {
+    HostObject *obj = ownerOf(self);
+    std::lock_guard<std::mutex> guard(obj->lock_);
+    obj->head_  = 0;
+    obj->count_ = 0;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult BufQueue_GetState(SLAndroidSimpleBufferQueueItf self,
+                           SLAndroidSimpleBufferQueueState *pState) {
+    HostObject *obj = ownerOf(self);
+    std::lock_guard<std::mutex> guard(obj->lock_);
+    pState->count = obj->count_;
+    pState->index = static_cast<SLuint32>(obj->stats_.buffers_);
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult BufQueue_RegisterCallback(SLAndroidSimpleBufferQueueItf self,
+                                   slAndroidSimpleBufferQueueCallback callback, void *pContext) {
+    HostObject *obj = ownerOf(self);
+    std::lock_guard<std::mutex> guard(obj->lock_);
+    obj->bqCallback_ = callback;
+    obj->bqContext_  = pContext;
+    return SL_RESULT_SUCCESS;
+}
+
+/*
+ * SLSeekItf / SLVolumeItf: looping is not supported while decoding,
+ * same as on Android
+ */
+SLresult Seek_SetLoop(SLSeekItf self, SLboolean loopEnable,
+                      SLmillisecond startPos, SLmillisecond endPos) {
+    return loopEnable ? SL_RESULT_FEATURE_UNSUPPORTED : SL_RESULT_SUCCESS;
+}
+
+SLresult Volume_SetVolumeLevel(SLVolumeItf self, SLmillibel level) {
+    ownerOf(self)->level_ = level;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Volume_GetVolumeLevel(SLVolumeItf self, SLmillibel *pLevel) {
+    *pLevel = ownerOf(self)->level_;
+    return SL_RESULT_SUCCESS;
+}
+
+/*
+ * SLMetadataExtractionItf: the decoded PCM format, Android keys
+ */
+const char * const metaKeys[] = {
+    ANDROID_KEY_PCMFORMAT_NUMCHANNELS,
+    ANDROID_KEY_PCMFORMAT_SAMPLERATE,
+    ANDROID_KEY_PCMFORMAT_BITSPERSAMPLE,
+};
+const SLuint32 META_ITEM_COUNT = sizeof(metaKeys) / sizeof(metaKeys[0]);
+const SLuint32 META_INFO_SIZE  = offsetof(SLMetadataInfo, data);
+
+SLresult Meta_GetItemCount(SLMetadataExtractionItf self, SLuint32 *pItemCount) {
+    *pItemCount = META_ITEM_COUNT;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Meta_GetKeySize(SLMetadataExtractionItf self, SLuint32 index, SLuint32 *pKeySize) {
+    if (index >= META_ITEM_COUNT) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    *pKeySize = META_INFO_SIZE + strlen(metaKeys[index]) + 1;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Meta_GetKey(SLMetadataExtractionItf self, SLuint32 index, SLuint32 keySize,
+                     SLMetadataInfo *pKey) {
+    SLuint32 size;
+    if (Meta_GetKeySize(self, index, &size) != SL_RESULT_SUCCESS || keySize < size) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    pKey->size = size - META_INFO_SIZE;
+    pKey->encoding = SL_CHARACTERENCODING_ASCII;
+    memset(pKey->langCountry, 0, sizeof(pKey->langCountry));
+    memcpy(pKey->data, metaKeys[index], pKey->size);
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Meta_GetValueSize(SLMetadataExtractionItf self, SLuint32 index, SLuint32 *pValueSize) {
+    if (index >= META_ITEM_COUNT) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    *pValueSize = META_INFO_SIZE + sizeof(SLuint32);
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Meta_GetValue(SLMetadataExtractionItf self, SLuint32 index, SLuint32 valueSize,
+                       SLMetadataInfo *pValue) {
+    if (index >= META_ITEM_COUNT || valueSize < META_INFO_SIZE + sizeof(SLuint32)) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    const PcmFormat &format = ownerOf(self)->format_;
+    SLuint32 value = (index == 0) ? format.channels_ :
+                     (index == 1) ? format.sampleRate_ : format.bitsPerSample_;
+    pValue->size = sizeof(value);
+    pValue->encoding = SL_CHARACTERENCODING_BINARY;
+    memset(pValue->langCountry, 0, sizeof(pValue->langCountry));
+    memcpy(pValue->data, &value, sizeof(value));
+    return SL_RESULT_SUCCESS;
+}
+
+const SLObjectItf_ objectVtbl = {
+    Object_Realize, Object_Resume, Object_GetState, Object_GetInterface, Object_Destroy,
+};
+const SLPlayItf_ playVtbl = {
+    Play_SetPlayState, Play_GetPlayState, Play_GetPosition,
+    Play_RegisterCallback, Play_SetCallbackEventsMask,
+};
+const SLRecordItf_ recordVtbl = {
+    Record_SetRecordState, Record_GetRecordState,
+};
+const SLAndroidSimpleBufferQueueItf_ bufQueueVtbl = {
+    BufQueue_Enqueue, BufQueue_Clear, BufQueue_GetState, BufQueue_RegisterCallback,
+};
+const SLSeekItf_ seekVtbl = {
+    Seek_SetLoop,
+};
+const SLVolumeItf_ volumeVtbl = {
+    Volume_SetVolumeLevel, Volume_GetVolumeLevel,
+};
+const SLMetadataExtractionItf_ metaVtbl = {
+    Meta_GetItemCount, Meta_GetKeySize, Meta_GetKey, Meta_GetValueSize, Meta_GetValue,
+};
+extern const SLEngineItf_ engineVtbl;
+
+template <typename VTBL>
+void bindItf(ItfSlot<VTBL> *slot, const VTBL *vtbl, HostObject *obj) {
+    slot->vtbl_  = vtbl;
+    slot->owner_ = obj;
+}
+
+HostObject *newObject(ObjectKind kind) {
+    HostObject *obj = new HostObject();
+    bindItf(&obj->object_,   &objectVtbl,   obj);
+    bindItf(&obj->engine_,   &engineVtbl,   obj);
+    bindItf(&obj->play_,     &playVtbl,     obj);
+    bindItf(&obj->record_,   &recordVtbl,   obj);
+    bindItf(&obj->bufQueue_, &bufQueueVtbl, obj);
+    bindItf(&obj->seek_,     &seekVtbl,     obj);
+    bindItf(&obj->volume_,   &volumeVtbl,   obj);
+    bindItf(&obj->meta_,     &metaVtbl,     obj);
+    obj->kind_ = kind;
+    obj->objectState_ = SL_OBJECT_STATE_UNREALIZED;
+    obj->quit_ = false;
+    obj->state_ = SL_PLAYSTATE_STOPPED;     // same value as SL_RECORDSTATE_STOPPED
+    obj->head_ = 0;
+    obj->count_ = 0;
+    obj->periodNs_ = static_cast<uint64_t>(SL_HOST_DEFAULT_PERIOD_US) * 1000 / config.speed_;
+    obj->bqCallback_ = nullptr;
+    obj->bqContext_ = nullptr;
+    obj->playCallback_ = nullptr;
+    obj->playContext_ = nullptr;
+    obj->eventMask_ = 0;
+    obj->level_ = 0;
+    memset(&obj->format_, 0, sizeof(obj->format_));
+    obj->file_ = nullptr;
+    obj->fileStart_ = 0;
+    obj->contentPos_ = 0;
+    obj->eof_ = false;
+    memset(&obj->stats_, 0, sizeof(obj->stats_));
+    return obj;
+}
+
+/*
+ * bufferQueueFormat(): queue depth and PCM format of a buffer queue end
+ */
+bool bufferQueueFormat(void *locator, void *format, HostObject *obj) {
+    const SLDataLocator_AndroidSimpleBufferQueue *bq =
+            static_cast<const SLDataLocator_AndroidSimpleBufferQueue*>(locator);
+    const SLAndroidDataFormat_PCM_EX *pcm = static_cast<const SLAndroidDataFormat_PCM_EX*>(format);
+    if (!bq || bq->locatorType != SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE ||
+        !bq->numBuffers || !pcm ||
+        (pcm->formatType != SL_DATAFORMAT_PCM && pcm->formatType != SL_ANDROID_DATAFORMAT_PCM_EX)) {
+        return false;
+    }
+    obj->queue_.resize(bq->numBuffers);
+    obj->format_.channels_ = pcm->numChannels;
+    obj->format_.sampleRate_ = pcm->sampleRate / 1000;      // milliHz
+    obj->format_.bitsPerSample_ = pcm->bitsPerSample;
+    return obj->format_.bytesPerSec() != 0;
+}
+
+/*
+ * skipWavHeader(): offset of the PCM data, 0 for raw files; fills format
+ * when it is a WAV file
+ */
+long skipWavHeader(const uint8_t *file, size_t size, PcmFormat *format) {
+    if (size < 12 || memcmp(file, "RIFF", 4) || memcmp(file + 8, "WAVE", 4)) {
+        return 0;
+    }
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        uint32_t chunkSize;
+        memcpy(&chunkSize, file + offset + 4, sizeof(chunkSize));
+        if (!memcmp(file + offset, "fmt ", 4) && offset + 8 + 16 <= size) {
+            uint16_t channels, bits;
+            uint32_t rate;
+            memcpy(&channels, file + offset + 10, sizeof(channels));
+            memcpy(&rate,     file + offset + 12, sizeof(rate));
+            memcpy(&bits,     file + offset + 22, sizeof(bits));
+            format->channels_ = channels;
+            format->sampleRate_ = rate;
+            format->bitsPerSample_ = bits;
+        } else if (!memcmp(file + offset, "data", 4)) {
+            return static_cast<long>(offset + 8);
+        }
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+    return 0;
+}
+
+/*
+ * SLEngineItf
+ */
+SLresult Engine_CreateAudioPlayer(SLEngineItf self, SLObjectItf *pPlayer,
+                                  SLDataSource *pAudioSrc, SLDataSink *pAudioSnk,
+                                  SLuint32 numInterfaces, const SLInterfaceID *pInterfaceIds,
+                                  const SLboolean *pInterfaceRequired) {
+    if (!pPlayer || !pAudioSrc || !pAudioSnk || !pAudioSrc->pLocator) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    SLuint32 srcType = *static_cast<SLuint32*>(pAudioSrc->pLocator);
+    HostObject *obj;
+    if (srcType == SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE) {
+        obj = newObject(KIND_PLAYER);
+        if (!bufferQueueFormat(pAudioSrc->pLocator, pAudioSrc->pFormat, obj)) {
+            delete obj;
+            return SL_RESULT_CONTENT_UNSUPPORTED;
+        }
+        if (config.sinkType_ == SL_HOST_ENDPOINT_FILE && config.sinkFile_) {
+            obj->file_ = fopen(config.sinkFile_, "ab");
+            if (!obj->file_) {
+                delete obj;
+                return SL_RESULT_IO_ERROR;
+            }
+        }
+    } else if (srcType == SL_DATALOCATOR_URI) {
+        // decode to PCM: sink is a buffer queue, source a WAV/raw file
+        obj = newObject(KIND_DECODER);
+        if (!bufferQueueFormat(pAudioSnk->pLocator, pAudioSnk->pFormat, obj)) {
+            delete obj;
+            return SL_RESULT_CONTENT_UNSUPPORTED;
+        }
+        const char *uri = reinterpret_cast<const char*>(
+                static_cast<SLDataLocator_URI*>(pAudioSrc->pLocator)->URI);
+        if (!strncmp(uri, "file://", 7)) {
+            uri += 7;
+        }
+        FILE *fp = fopen(uri, "rb");
+        if (!fp) {
+            delete obj;
+            return SL_RESULT_CONTENT_NOT_FOUND;
+        }
+        uint8_t chunk[4096];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+            obj->content_.insert(obj->content_.end(), chunk, chunk + got);
+        }
+        fclose(fp);
+        // WAV: decoded PCM comes out in the file's format, raw: as asked
+        long start = skipWavHeader(obj->content_.data(), obj->content_.size(), &obj->format_);
+        obj->content_.erase(obj->content_.begin(), obj->content_.begin() + start);
+    } else {
+        return SL_RESULT_FEATURE_UNSUPPORTED;
+    }
+    *pPlayer = &obj->object_.vtbl_;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Engine_CreateAudioRecorder(SLEngineItf self, SLObjectItf *pRecorder,
+                                    SLDataSource *pAudioSrc, SLDataSink *pAudioSnk,
+                                    SLuint32 numInterfaces, const SLInterfaceID *pInterfaceIds,
+                                    const SLboolean *pInterfaceRequired) {
+    if (!pRecorder || !pAudioSrc || !pAudioSnk || !pAudioSrc->pLocator ||
+        *static_cast<SLuint32*>(pAudioSrc->pLocator) != SL_DATALOCATOR_IODEVICE) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    HostObject *obj = newObject(KIND_RECORDER);
+    if (!bufferQueueFormat(pAudioSnk->pLocator, pAudioSnk->pFormat, obj)) {
+        delete obj;
+        return SL_RESULT_CONTENT_UNSUPPORTED;
+    }
+    if (config.sourceType_ == SL_HOST_ENDPOINT_FILE && config.sourceFile_) {
+        obj->file_ = fopen(config.sourceFile_, "rb");
+        if (!obj->file_) {
+            delete obj;
+            return SL_RESULT_CONTENT_NOT_FOUND;
+        }
+        uint8_t header[256];
+        size_t got = fread(header, 1, sizeof(header), obj->file_);
+        PcmFormat unused;
+        obj->fileStart_ = skipWavHeader(header, got, &unused);
+        fseek(obj->file_, obj->fileStart_, SEEK_SET);
+    }
+    *pRecorder = &obj->object_.vtbl_;
+    return SL_RESULT_SUCCESS;
+}
+
+SLresult Engine_CreateOutputMix(SLEngineItf self, SLObjectItf *pMix, SLuint32 numInterfaces,
+                                const SLInterfaceID *pInterfaceIds,
+                                const SLboolean *pInterfaceRequired) {
+    if (!pMix) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    *pMix = &newObject(KIND_OUTPUTMIX)->object_.vtbl_;
+    return SL_RESULT_SUCCESS;
+}
+
+const SLEngineItf_ engineVtbl = {
+    Engine_CreateAudioPlayer, Engine_CreateAudioRecorder, Engine_CreateOutputMix,
+};
+
+}  // namespace
+
+SLresult slCreateEngine(SLObjectItf *pEngine, SLuint32 numOptions,
+                        const SLEngineOption *pEngineOptions, SLuint32 numInterfaces,
+                        const SLInterfaceID *pInterfaceIds, const SLboolean *pInterfaceRequired) {
+    if (!pEngine) {
+        return SL_RESULT_PARAMETER_INVALID;
+    }
+    if (!config.speed_) {
+        slHostConfigure(NULL);
+    }
+    *pEngine = &newObject(KIND_ENGINE)->object_.vtbl_;
+    return SL_RESULT_SUCCESS;
+}
+
+void slHostConfigure(const SLHostConfig *newConfig) {
+    if (newConfig) {
+        config = *newConfig;
+    } else {
+        memset(&config, 0, sizeof(config));
+    }
+    if (!config.speed_) {
+        config.speed_ = 1;
+    }
+    jitterSeed = config.seed_ ? config.seed_ : 1;
+
+    std::lock_guard<std::mutex> guard(loopback.lock_);
+    // 48 kHz stereo 16 bit is the most a fast path runs at
+    loopback.ring_.assign(48000 * 2 * 2 * SL_HOST_LOOPBACK_MS / 1000, 0);
+    loopback.read_ = 0;
+    loopback.count_ = 0;
+}
+
+void slHostGetStats(SLHostStats *snapshot) {
+    std::lock_guard<std::mutex> guard(statsLock);
+    *snapshot = stats;
+    std::lock_guard<std::mutex> loopGuard(loopback.lock_);
+    snapshot->loopbackDropped_ = loopback.dropped_;
+}
+
+void slHostResetStats(void) {
+    std::lock_guard<std::mutex> guard(statsLock);
+    memset(&stats, 0, sizeof(stats));
+    std::lock_guard<std::mutex> loopGuard(loopback.lock_);
+    loopback.dropped_ = 0;
+}
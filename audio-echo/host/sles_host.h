@@ -0,0 +1,88 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_AUDIO_SLES_HOST_H
+#define NATIVE_AUDIO_SLES_HOST_H
+#include <stdint.h>
+#include <SLES/OpenSLES_Android.h>
+
+/*
+ * sles_host: OpenSL ES buffer queue stand-in for Linux. Players, recorders
+ * and URI decoders each get a clock thread that completes one enqueued
+ * buffer per buffer period ( size / byte rate of the object's format )
+ * and calls the buffer queue callback, like the Android fast path does.
+ * The jni sources build against it unchanged with host/include first in
+ * the include path.
+ *
+ * Where the audio goes / comes from:
+ *   SL_HOST_ENDPOINT_NULL:      player output dropped, recorder gets silence
+ *   SL_HOST_ENDPOINT_FILE:      raw PCM written to / read from a file; the
+ *                               input file loops, a WAV header is skipped
+ *   SL_HOST_ENDPOINT_LOOPBACK:  player output comes back as recorder input
+ * URI players ( decoders ) read WAV or raw PCM files, faster than real
+ * time by SL_HOST_DECODE_SPEEDUP, and report the PCM format through the
+ * Android metadata keys.
+ */
+#define SL_HOST_ENDPOINT_NULL       0
+#define SL_HOST_ENDPOINT_FILE       1
+#define SL_HOST_ENDPOINT_LOOPBACK   2
+
+#define SL_HOST_DECODE_SPEEDUP      8
+#define SL_HOST_LOOPBACK_MS         500     // audio the loopback holds at most
+#define SL_HOST_DEFAULT_PERIOD_US   10000   // until the first buffer tells
+
+struct SLHostConfig {
+    uint32_t     sinkType_;       // player output, SL_HOST_ENDPOINT_XXX
+    const char  *sinkFile_;
+    uint32_t     sourceType_;     // recorder input, SL_HOST_ENDPOINT_XXX
+    const char  *sourceFile_;
+    uint32_t     speed_;          // clocks run speed_ times real time; the
+                                  // engine still times itself in wall time
+    uint32_t     jitterUs_;       // callbacks are late by random 0..jitterUs_
+    uint32_t     seed_;           // same seed, same jitter pattern
+    int32_t      recDriftPpm_;    // recorder clock against the player clock
+    bool         realtime_;       // ask for SCHED_FIFO on the clock threads
+};
+
+/*
+ * per device kind, accumulated when a device object is destroyed
+ */
+struct SLHostDeviceStats {
+    uint32_t     devices_;        // objects destroyed
+    uint64_t     buffers_;        // buffers completed ( = callbacks )
+    uint64_t     bytes_;
+    uint32_t     starved_;        // clock tick with nothing enqueued
+    uint32_t     maxLateUs_;      // callback later than its nominal time
+    uint64_t     callbackNs_;     // total time spent in the app callbacks
+    uint32_t     maxCallbackUs_;
+};
+
+struct SLHostStats {
+    SLHostDeviceStats player_;
+    SLHostDeviceStats recorder_;
+    SLHostDeviceStats decoder_;
+    uint32_t     loopbackDropped_;    // bytes the loopback had no room for
+};
+
+/*
+ * slHostConfigure(): before slCreateEngine(); NULL restores the defaults
+ * ( null endpoints, real time, no jitter )
+ */
+void slHostConfigure(const SLHostConfig *config);
+void slHostGetStats(SLHostStats *stats);
+void slHostResetStats(void);
+
+#endif //NATIVE_AUDIO_SLES_HOST_H
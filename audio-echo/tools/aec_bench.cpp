@@ -0,0 +1,185 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * aec_bench: runs the EchoCanceller over a simulated echo path and prints
+ * how much echo it takes out and what it costs per buffer, against the
+ * buffer period: the budget it has on the recorder callback thread. The
+ * far end is shaped noise at speech level going through a random room
+ * response ( -d ms of playout plus acoustic delay, 30 ms of decay ); the
+ * near end is a noise floor plus one second of talk in the middle, which
+ * double talk detection has to keep the filter from learning.
+ * Exits with 1 when the P99 cost of a buffer does not fit in its period.
+ *
+ * Build and run on the host, from audio-echo/ ( for a device, build it
+ * with the NDK toolchain the same way and run it through adb shell ):
+ *     g++ -std=c++11 -O2 -pthread -Ihost/include -Ihost -o aec_bench \
+ *         tools/aec_bench.cpp host/sles_host.cpp app/src/main/jni/fft.cpp \
+ *         app/src/main/jni/echo_canceller.cpp app/src/main/jni/audio_stats.cpp
+ *     ./aec_bench [sample rate] [frames per buffer] [seconds] [delay ms]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <sched.h>
+#include <time.h>
+
+#include "../app/src/main/jni/echo_canceller.h"
+#include "../app/src/main/jni/audio_stats.h"
+
+#define ROOM_DECAY_MS      30
+#define COST_BIN_WIDTH_NS  250
+#define COST_BIN_COUNT     4000     // up to 1 ms
+
+static uint64_t nowNs(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+static uint32_t noise = 1;
+static float whiteNoise(void) {
+    noise = noise * 1664525 + 1013904223;
+    return static_cast<int32_t>(noise) / 2147483648.0f;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t sampleRate = argc > 1 ? atoi(argv[1]) : 48000;
+    uint32_t framesPerBuf = argc > 2 ? atoi(argv[2]) : 192;
+    uint32_t seconds = argc > 3 ? atoi(argv[3]) : 10;
+    uint32_t delayMs = argc > 4 ? atoi(argv[4]) : 10;
+    if (!sampleRate || !framesPerBuf || seconds < 4) {
+        fprintf(stderr, "usage: %s [sample rate] [frames per buffer] "
+                        "[seconds, >= 4] [delay ms]\n", argv[0]);
+        return 2;
+    }
+
+    // one core, no migration in the middle of a measurement
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(sched_getcpu(), &cpus);
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+
+    SampleFormat format;
+    memset(&format, 0, sizeof(format));
+    format.sampleRate_ = sampleRate * 1000;
+    format.framesPerBuf_ = framesPerBuf;
+    format.channels_ = AUDIO_SAMPLE_CHANNELS;
+    format.pcmFormat_ = SL_PCMSAMPLEFORMAT_FIXED_16;
+    EchoCanceller aec(&format);
+
+    // room: delay, then exponentially decaying random taps, -6 dB overall
+    uint32_t delay = delayMs * sampleRate / 1000;
+    uint32_t decay = ROOM_DECAY_MS * sampleRate / 1000;
+    std::vector<float> room(delay + decay, 0.0f);
+    double roomEnergy = 0.0;
+    for (uint32_t i = 0; i < decay; i++) {
+        room[delay + i] = whiteNoise() * expf(-6.0f * i / decay);
+        roomEnergy += room[delay + i] * room[delay + i];
+    }
+    for (uint32_t i = 0; i < decay; i++) {
+        room[delay + i] *= static_cast<float>(0.5 / sqrt(roomEnergy));
+    }
+
+    // far end: lowpassed noise, syllable rate envelope, -20 dBFS-ish
+    uint32_t total = seconds * sampleRate / framesPerBuf * framesPerBuf;
+    std::vector<float> far(total);
+    float lowpass = 0.0f;
+    for (uint32_t i = 0; i < total; i++) {
+        lowpass = 0.7f * lowpass + 0.3f * whiteNoise();
+        float envelope = 0.6f + 0.4f * sinf(2.0f * M_PI * 4.0f * i / sampleRate);
+        far[i] = 0.3f * lowpass * envelope;
+    }
+
+    uint32_t talkStart = (seconds / 2) * sampleRate, talkEnd = talkStart + sampleRate;
+    std::vector<int16_t> farPcm(framesPerBuf), micPcm(framesPerBuf + 1);
+    sample_buf refBuf = { reinterpret_cast<uint8_t*>(farPcm.data()),
+                          static_cast<uint32_t>(framesPerBuf * sizeof(int16_t)),
+                          static_cast<uint32_t>(framesPerBuf * sizeof(int16_t)), 0 };
+    sample_buf micBuf = { reinterpret_cast<uint8_t*>(micPcm.data()),
+                          static_cast<uint32_t>((framesPerBuf + 1) * sizeof(int16_t)),
+                          0, 0 };
+
+    AudioHistogram cost(COST_BIN_WIDTH_NS, COST_BIN_COUNT);
+    double echoEnergy = 0.0, residualEnergy = 0.0;
+    uint32_t convergedAt = 2 * sampleRate;
+    uint64_t totalNs = 0;
+    for (uint32_t base = 0; base < total; base += framesPerBuf) {
+        // player side: the buffer going to the speaker
+        for (uint32_t i = 0; i < framesPerBuf; i++) {
+            farPcm[i] = static_cast<int16_t>(far[base + i] * 32767.0f);
+        }
+        aec.PushReference(&refBuf);
+
+        // mic side: the room's echo of what was played, plus the near end
+        float echo[framesPerBuf];
+        for (uint32_t i = 0; i < framesPerBuf; i++) {
+            uint32_t n = base + i;
+            float sum = 0.0f;
+            for (uint32_t t = delay; t < room.size() && t <= n; t++) {
+                sum += room[t] * far[n - t];
+            }
+            float near = 0.0003f * whiteNoise();
+            if (n >= talkStart && n < talkEnd) {
+                near += 0.3f * sinf(2.0f * M_PI * 300.0f * n / sampleRate);
+            }
+            echo[i] = sum;
+            micPcm[i] = static_cast<int16_t>((sum + near) * 32767.0f);
+        }
+        micBuf.size_ = framesPerBuf * sizeof(int16_t);
+
+        uint64_t start = nowNs();
+        aec.Process(&micBuf);
+        uint64_t spent = nowNs() - start;
+        cost.Record(static_cast<uint32_t>(spent));
+        totalNs += spent;
+
+        // converged and no near end talk: all that is left is residual echo
+        // ( output may lag the input by one AEC_BLOCK, hence the extra buffer )
+        if (base >= convergedAt &&
+            (base + framesPerBuf <= talkStart || base >= talkEnd + framesPerBuf)) {
+            for (uint32_t i = 0; i < framesPerBuf; i++) {
+                float out = micPcm[i] / 32767.0f;
+                echoEnergy += echo[i] * echo[i];
+                residualEnergy += out * out;
+            }
+        }
+    }
+
+    AecStats stats;
+    aec.GetStats(&stats);
+    uint32_t bufCount = total / framesPerBuf;
+    double periodNs = 1e9 * framesPerBuf / sampleRate;
+    printf("%u Hz, %u frames/buf ( %.0f us period ), %u bufs, echo delay %u ms, "
+           "filter %u ms\n", sampleRate, framesPerBuf, periodNs / 1000.0, bufCount,
+           delayMs, AEC_PARTITIONS * AEC_BLOCK * 1000 / sampleRate);
+    printf("ERLE after 2 s: %.1f dB ( canceller's own estimate %.1f dB )\n",
+           10.0 * log10(echoEnergy / (residualEnergy + 1e-20)), stats.erleDb_);
+    printf("blocks %u, adapted %u, double talk %u, ref underruns %u, "
+           "ref dropped %u, resets %u\n", stats.blocks_, stats.adaptedBlocks_,
+           stats.doubleTalk_, stats.refUnderruns_, stats.refDropped_, stats.resets_);
+    uint32_t p99 = cost.Percentile(99);
+    printf("cost per buf: avg %.0f ns, P50 %u ns, P99 %u ns, max %u ns "
+           "( P99 %.2f%% of period )\n", static_cast<double>(totalNs) / bufCount,
+           cost.Percentile(50), p99, cost.Max(), 100.0 * p99 / periodNs);
+    if (p99 > periodNs) {
+        printf("FAIL: P99 cost does not fit in one buffer period\n");
+        return 1;
+    }
+    return 0;
+}
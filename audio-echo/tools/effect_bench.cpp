@@ -0,0 +1,104 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * effect_bench: runs the echo path EffectChain over generated audio and
+ * prints what every node costs per buffer, against the buffer period:
+ * the budget a node has to fit in on the recorder callback thread.
+ *
+ * Build and run on the host, from audio-echo/ ( for a device, build it
+ * with the NDK toolchain the same way and run it through adb shell ):
+ *     g++ -std=c++11 -O2 -pthread -Ihost/include -Ihost -o effect_bench \
+ *         tools/effect_bench.cpp host/sles_host.cpp \
+ *         app/src/main/jni/effect_chain.cpp app/src/main/jni/audio_stats.cpp
+ *     ./effect_bench [sample rate] [frames per buffer] [buffers]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "../app/src/main/jni/effect_chain.h"
+
+int main(int argc, char *argv[]) {
+    uint32_t sampleRate = argc > 1 ? atoi(argv[1]) : 48000;
+    uint32_t framesPerBuf = argc > 2 ? atoi(argv[2]) : 192;
+    uint32_t bufCount = argc > 3 ? atoi(argv[3]) : 20000;
+    if (!sampleRate || !framesPerBuf || !bufCount) {
+        fprintf(stderr, "usage: %s [sample rate] [frames per buffer] [buffers]\n", argv[0]);
+        return 2;
+    }
+
+    SampleFormat format;
+    memset(&format, 0, sizeof(format));
+    format.sampleRate_ = sampleRate * 1000;
+    format.framesPerBuf_ = framesPerBuf;
+    format.channels_ = AUDIO_SAMPLE_CHANNELS;
+    format.pcmFormat_ = SL_PCMSAMPLEFORMAT_FIXED_16;
+
+    // the engine's chain, with every node doing real work
+    EffectChain chain(&format);
+    chain.AddNode(EFFECT_GAIN);
+    chain.AddNode(EFFECT_BIQUAD);
+    chain.AddNode(EFFECT_DELAY);
+    chain.AddNode(EFFECT_LIMITER);
+    chain.SetParam(0, EFFECT_PARAM_GAIN, 2.0f);
+    chain.SetParam(1, EFFECT_PARAM_GAIN, 6.0f);
+    chain.SetParam(1, EFFECT_PARAM_FREQ, 2500.0f);
+    chain.SetParam(2, EFFECT_PARAM_MIX, 0.5f);
+    chain.SetParam(2, EFFECT_PARAM_FEEDBACK, 0.6f);
+    chain.SetParam(3, EFFECT_PARAM_THRESHOLD, 0.5f);
+
+    uint32_t samples = framesPerBuf * format.channels_;
+    int16_t *pcm = new int16_t[samples + format.channels_];
+    sample_buf buf = { reinterpret_cast<uint8_t*>(pcm),
+                       static_cast<uint32_t>((samples + format.channels_) * sizeof(int16_t)),
+                       0, 0 };
+    double phase = 0.0;
+    uint32_t noise = 1;
+    for (uint32_t n = 0; n < bufCount; n++) {
+        // tone plus noise, the way a mic sounds
+        for (uint32_t i = 0; i < samples; i++) {
+            noise = noise * 1664525 + 1013904223;
+            pcm[i] = static_cast<int16_t>(8000.0 * sin(phase) +
+                                          static_cast<int32_t>(noise >> 20) - 2048);
+            phase += 2.0 * M_PI * 440.0 / sampleRate;
+        }
+        buf.size_ = samples * sizeof(int16_t);
+        // keep the smoothing busy: a delay time change every 100 buffers
+        if (n % 100 == 0) {
+            chain.SetParam(2, EFFECT_PARAM_TIME_MS, n % 200 ? 120.0f : 250.0f);
+        }
+        chain.Process(&buf);
+    }
+
+    static const char *typeNames[] = { "gain", "biquad", "delay", "limiter" };
+    double periodNs = 1e9 * framesPerBuf / sampleRate;
+    printf("%u Hz, %u frames/buf ( %.0f us period ), %u bufs\n",
+           sampleRate, framesPerBuf, periodNs / 1000.0, bufCount);
+    uint32_t totalP99 = 0;
+    for (uint32_t i = 0; i < chain.NodeCount(); i++) {
+        EffectNodeStats stats;
+        chain.GetNodeStats(i, &stats);
+        printf("%-8s P50 %6u ns  P99 %6u ns  max %7u ns  ( P99 %.3f%% of period )\n",
+               typeNames[stats.type_], stats.costP50Ns_, stats.costP99Ns_,
+               stats.costMaxNs_, 100.0 * stats.costP99Ns_ / periodNs);
+        totalP99 += stats.costP99Ns_;
+    }
+    printf("chain    P99 sum %u ns ( %.3f%% of period )\n", totalP99, 100.0 * totalP99 / periodNs);
+    delete [] pcm;
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * trace_decoder: turn the binary trace written by the echo engine
+ * ( ENABLE_LOG in audio_common.h ) into text, one event per line:
+ *     time(us)  delta(us)  thread  event  arg0  arg1
+ * delta is against the previous event of the same thread/ring, which
+ * makes callback period jitter easy to spot.
+ *
+ * Build and run on the host:
+ *     g++ -std=c++11 -o trace_decoder trace_decoder.cpp
+ *     adb pull /sdcard/data/audio_trace
+ *     ./trace_decoder audio_trace
+ */
+#include <cstdio>
+#include <cinttypes>
+#include <algorithm>
+#include <vector>
+
+#include "../app/src/main/jni/trace_format.h"
+
+static const char* eventName(uint32_t event) {
+    switch (event) {
+        case TRACE_EVENT_PLAYER_CALLBACK:    return "PLAYER_CALLBACK";
+        case TRACE_EVENT_PLAYER_STARVED:     return "PLAYER_STARVED";
+        case TRACE_EVENT_RECORDER_CALLBACK:  return "RECORDER_CALLBACK";
+        case TRACE_EVENT_DECODER_CALLBACK:   return "DECODER_CALLBACK";
+        case TRACE_EVENT_RING_OVERFLOW:      return "RING_OVERFLOW";
+        case TRACE_EVENT_DECODER_PAUSE:      return "DECODER_PAUSE";
+        case TRACE_EVENT_DECODER_RESUME:     return "DECODER_RESUME";
+        default:                             return "UNKNOWN";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+        return 1;
+    }
+    FILE* fp = fopen(argv[1], "rb");
+    if (!fp) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    TraceFileHeader header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        header.magic_ != TRACE_FILE_MAGIC ||
+        header.version_ != TRACE_FILE_VERSION ||
+        header.recordSize_ != sizeof(TraceRecord)) {
+        fprintf(stderr, "%s is not a version %d trace file\n",
+                argv[1], TRACE_FILE_VERSION);
+        fclose(fp);
+        return 1;
+    }
+
+    std::vector<TraceRecord> records;
+    TraceRecord rec;
+    while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+        records.push_back(rec);
+    }
+    fclose(fp);
+
+    // each ring is in order already, the flusher interleaves them
+    std::stable_sort(records.begin(), records.end(),
+                     [](const TraceRecord& a, const TraceRecord& b) {
+                         return a.time_ < b.time_;
+                     });
+
+    std::vector<uint64_t> prevTime;
+    for (const TraceRecord& r : records) {
+        if (r.thread_ >= prevTime.size()) {
+            prevTime.resize(r.thread_ + 1, 0);
+        }
+        uint64_t delta = prevTime[r.thread_] ? r.time_ - prevTime[r.thread_] : 0;
+        prevTime[r.thread_] = r.time_;
+        printf("%" PRIu64 "\t%" PRIu64 "\t%u\t%-18s\t%u\t%u\n", r.time_, delta,
+               r.thread_, eventName(r.event_), r.arg0_, r.arg1_);
+    }
+    return 0;
+}
@@ -19,7 +19,8 @@
 //#define GEOM_DEBUG LOGD
 #define GEOM_DEBUG
 
-SimpleGeom* AsciiArtToGeom(const char *art, float scale) {
+void AsciiArtToLines(const char *art, float scale, GLfloat **outVertices, int *outVertexCount,
+        GLushort **outIndices, int *outIndexCount) {
     // figure out width and height
     LOGD("Creating geometry from ASCII art.");
     GEOM_DEBUG("Ascii art source:\n%s", art);
@@ -95,9 +96,7 @@ SimpleGeom* AsciiArtToGeom(const char *art, float scale) {
     GEOM_DEBUG("Total vertices: %d, total indices %d", vertices, indices);
 
     // allocate arrays for the vertices and lines
-    const int VERTICES_STRIDE = sizeof(GLfloat) * 7;
-    const int VERTICES_COLOR_OFFSET = sizeof(GLfloat) * 3;
-    GLfloat *verticesArray = new GLfloat[vertices * VERTICES_STRIDE];
+    GLfloat *verticesArray = new GLfloat[vertices * ASCII_ART_VERTEX_FLOATS];
     GLushort *indicesArray = new GLushort[indices];
     vertices = indices = 0; // current count of vertices and lines
 
@@ -197,9 +196,9 @@ SimpleGeom* AsciiArtToGeom(const char *art, float scale) {
     GEOM_DEBUG("Deallocating working space.");
     // get rid of the working arrays
     for (r = 0; r < rows; r++) {
-        delete v[r];
+        delete[] v[r];
     }
-    delete v;
+    delete[] v;
 
     for (int i = 0; i < indices; i++) {
         GEOM_DEBUG("indices[%d] = %d\n", i, indicesArray[i]);
@@ -211,22 +210,34 @@ SimpleGeom* AsciiArtToGeom(const char *art, float scale) {
         }
     }
 
+    LOGD("Created geometry from ascii art: %d vertices, %d indices", vertices, indices);
+
+    *outVertices = verticesArray;
+    *outVertexCount = vertices;
+    *outIndices = indicesArray;
+    *outIndexCount = indices;
+}
+
+SimpleGeom* AsciiArtToGeom(const char *art, float scale) {
+    GLfloat *verticesArray;
+    GLushort *indicesArray;
+    int vertices, indices;
+
+    AsciiArtToLines(art, scale, &verticesArray, &vertices, &indicesArray, &indices);
+
     // create the buffers
     GEOM_DEBUG("Creating output VBO (%d vertices) and IBO (%d indices).", vertices, indices);
-    SimpleGeom* out = new SimpleGeom(new VertexBuf(verticesArray, vertices * sizeof(GLfloat) *
-            VERTICES_STRIDE, VERTICES_STRIDE), new IndexBuf(indicesArray, indices *
-            sizeof(GLushort)));
+    SimpleGeom* out = new SimpleGeom(new VertexBuf(verticesArray, vertices *
+            ASCII_ART_VERTEX_STRIDE, ASCII_ART_VERTEX_STRIDE), new IndexBuf(indicesArray,
+            indices * sizeof(GLushort)));
     out->vbuf->SetPrimitive(GL_LINES);  // draw as lines
-    out->vbuf->SetColorsOffset(VERTICES_COLOR_OFFSET);
+    out->vbuf->SetColorsOffset(ASCII_ART_COLOR_OFFSET);
 
     // clean up our work buffers
-    delete verticesArray;
+    delete[] verticesArray;
     verticesArray = NULL;
-    delete indicesArray;
+    delete[] indicesArray;
     indicesArray = NULL;
 
-    LOGD("Created geometry from ascii art: %d vertices, %d indices", vertices, indices);
-
     return out;
 }
-
@@ -38,5 +38,17 @@
  */
 SimpleGeom* AsciiArtToGeom(const char *art, float scale);
 
+/* Layout of the vertices generated from ASCII art: x, y, z, then r, g, b, a. */
+#define ASCII_ART_VERTEX_FLOATS 7
+#define ASCII_ART_VERTEX_STRIDE (ASCII_ART_VERTEX_FLOATS * sizeof(GLfloat))
+#define ASCII_ART_COLOR_OFFSET (3 * sizeof(GLfloat))
+
+/* Same as AsciiArtToGeom, but returns the geometry in client memory rather than building
+ * a VBO/IBO out of it. *outVertices gets *outVertexCount vertices in the layout above,
+ * and *outIndices gets *outIndexCount indices, two per line. The caller must delete[]
+ * both arrays. */
+void AsciiArtToLines(const char *art, float scale, GLfloat **outVertices, int *outVertexCount,
+        GLushort **outIndices, int *outIndexCount);
+
 #endif
 
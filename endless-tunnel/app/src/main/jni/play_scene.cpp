@@ -69,7 +69,8 @@ PlayScene::PlayScene() : Scene() {
     mDifficulty = 0;
     mUseCloudSave = false;
 
-    mCubeGeom = NULL;
+    mObstacleVerts = NULL;
+    mObstacleBatch = NULL;
     mTunnelGeom = NULL;
 
     mObstacleCount = 0;
@@ -116,6 +117,17 @@ PlayScene::PlayScene() : Scene() {
 
     mCheckpointSignPending = false;
 
+    // render the sound effects now, so that they play without delay later
+    SfxMan *sfx = SfxMan::GetInstance();
+    sfx->PrepareTone(TONE_AMBIENT_0);
+    sfx->PrepareTone(TONE_AMBIENT_1);
+    sfx->PrepareTone(TONE_CRASHED);
+    sfx->PrepareTone(TONE_GAME_OVER);
+    sfx->PrepareTone(TONE_LEVEL_UP);
+    for (size_t i = 0; i < sizeof(TONE_BONUS)/sizeof(char*); i++) {
+        sfx->PrepareTone(TONE_BONUS[i]);
+    }
+
     SetScore(0);
 
     /*
@@ -253,10 +265,13 @@ void PlayScene::OnStartGraphics() {
     mTunnelGeom->vbuf->SetColorsOffset(TUNNEL_GEOM_COLOR_OFFSET);
     mTunnelGeom->vbuf->SetTexCoordsOffset(TUNNEL_GEOM_TEXCOORD_OFFSET);
 
-    // build cube geometry (to draw obstacles)
-    mCubeGeom = new SimpleGeom(new VertexBuf(CUBE_GEOM, sizeof(CUBE_GEOM),CUBE_GEOM_STRIDE));
-    mCubeGeom->vbuf->SetColorsOffset(CUBE_GEOM_COLOR_OFFSET);
-    mCubeGeom->vbuf->SetTexCoordsOffset(CUBE_GEOM_TEXCOORD_OFFSET);
+    // build obstacle batch (one copy of the cube geometry per box, refilled every frame)
+    mObstacleVerts = new GLfloat[MAX_OBS_BOXES * sizeof(CUBE_GEOM) / sizeof(GLfloat)];
+    memset(mObstacleVerts, 0, MAX_OBS_BOXES * sizeof(CUBE_GEOM));
+    mObstacleBatch = new VertexBuf(mObstacleVerts, MAX_OBS_BOXES * sizeof(CUBE_GEOM),
+            CUBE_GEOM_STRIDE);
+    mObstacleBatch->SetColorsOffset(CUBE_GEOM_COLOR_OFFSET);
+    mObstacleBatch->SetTexCoordsOffset(CUBE_GEOM_TEXCOORD_OFFSET);
 
     // make the wall texture
     mWallTexture = new Texture();
@@ -280,7 +295,11 @@ void PlayScene::OnKillGraphics() {
     CleanUp(&mOurShader);
     CleanUp(&mTrivialShader);
     CleanUp(&mTunnelGeom);
-    CleanUp(&mCubeGeom);
+    CleanUp(&mObstacleBatch);
+    if (mObstacleVerts) {
+        delete[] mObstacleVerts;
+        mObstacleVerts = NULL;
+    }
     CleanUp(&mWallTexture);
     CleanUp(&mLifeGeom);
 }
@@ -467,16 +486,44 @@ void PlayScene::RenderTunnel() {
     mOurShader->EndRender();
 }
 
+// Appends one copy of the cube geometry to out, transformed by modelMat and with its
+// colors multiplied by the given tint. Returns the number of floats written.
+static int _append_box(GLfloat *out, const glm::mat4& modelMat, float r, float g, float b) {
+    static const int FLOATS_PER_VERTEX = CUBE_GEOM_STRIDE / sizeof(GLfloat);
+    static const int COLOR_INDEX = CUBE_GEOM_COLOR_OFFSET / sizeof(GLfloat);
+    static const int TEXCOORD_INDEX = CUBE_GEOM_TEXCOORD_OFFSET / sizeof(GLfloat);
+    static const int VERTEX_COUNT = sizeof(CUBE_GEOM) / CUBE_GEOM_STRIDE;
+    const GLfloat *in = CUBE_GEOM;
+    int v;
+
+    for (v = 0; v < VERTEX_COUNT; v++, in += FLOATS_PER_VERTEX, out += FLOATS_PER_VERTEX) {
+        glm::vec4 pos = modelMat * glm::vec4(in[0], in[1], in[2], 1.0f);
+        out[0] = pos.x;
+        out[1] = pos.y;
+        out[2] = pos.z;
+        out[COLOR_INDEX] = in[COLOR_INDEX] * r;
+        out[COLOR_INDEX + 1] = in[COLOR_INDEX + 1] * g;
+        out[COLOR_INDEX + 2] = in[COLOR_INDEX + 2] * b;
+        out[COLOR_INDEX + 3] = in[COLOR_INDEX + 3];
+        out[TEXCOORD_INDEX] = in[TEXCOORD_INDEX];
+        out[TEXCOORD_INDEX + 1] = in[TEXCOORD_INDEX + 1];
+    }
+    return VERTEX_COUNT * FLOATS_PER_VERTEX;
+}
+
 void PlayScene::RenderObstacles() {
     int i;
     int r, c;
+    int floats = 0;
     float red, green, blue;
+    float shimmer = SineWave(0.8f, 1.0f, 0.5f, 0.0f);
     glm::mat4 modelMat;
-    glm::mat4 mvpMat;
-
-    mOurShader->BeginRender(mCubeGeom->vbuf);
-    mOurShader->SetTexture(mWallTexture);
+    glm::mat4 vpMat = mProjMat * mViewMat;
 
+    // Issuing one draw per box used to cost up to OBS_GRID_SIZE^2 draw calls per
+    // obstacle, so instead we transform every box into world space here, bake its tint
+    // into the vertex colors and render the lot in one go with just the view-projection
+    // matrix.
     for (i = 0; i < mObstacleCount; i++) {
         Obstacle *o = GetObstacleAt(i);
         float posY = GetSectionCenterY(mFirstSection + i);
@@ -486,35 +533,35 @@ void PlayScene::RenderObstacles() {
             continue;
         }
 
+        _get_obs_color(o->style, &red, &green, &blue);
         for (r = 0; r < OBS_GRID_SIZE; r++) {
             for (c = 0; c < OBS_GRID_SIZE; c++) {
                 bool isBonus = r == o->bonusRow && c == o->bonusCol;
                 if (o->grid[c][r]) {
-                    // set up matrices
                     modelMat = glm::translate(glm::mat4(1.0f), o->GetBoxCenter(c, r, posY));
                     modelMat = glm::scale(modelMat, o->GetBoxSize(c, r));
-                    mvpMat = mProjMat * mViewMat * modelMat;
-
-                    // set up color
-                    _get_obs_color(o->style, &red, &green, &blue);
-                    mOurShader->SetTintColor(red, green, blue);
-
-                    // render box
-                    mOurShader->Render(&mvpMat);
+                    floats += _append_box(mObstacleVerts + floats, modelMat, red, green, blue);
                 } else if (isBonus) {
                     modelMat = glm::translate(glm::mat4(1.0f), o->GetBoxCenter(c, r, posY));
                     modelMat = glm::scale(modelMat, glm::vec3(OBS_BONUS_SIZE, OBS_BONUS_SIZE,
                             OBS_BONUS_SIZE));
                     modelMat = glm::rotate(modelMat, Clock() * 90.0f, glm::vec3(0.0f, 0.0f, 1.0f));
-                    mvpMat = mProjMat * mViewMat * modelMat;
-                    mOurShader->SetTintColor(SineWave(0.8f, 1.0f, 0.5f, 0.0f),
-                            SineWave(0.8f, 1.0f, 0.5f, 0.0f),
-                            SineWave(0.8f, 1.0f, 0.5f, 0.0f)); // shimmering color
-                    mOurShader->Render(&mvpMat); // render
+                    // shimmering color
+                    floats += _append_box(mObstacleVerts + floats, modelMat, shimmer, shimmer,
+                            shimmer);
                 }
             }
         }
     }
+
+    if (floats == 0) {
+        return;
+    }
+
+    mObstacleBatch->Update(mObstacleVerts, floats * sizeof(GLfloat));
+    mOurShader->BeginRender(mObstacleBatch);
+    mOurShader->SetTexture(mWallTexture);
+    mOurShader->Render(&vpMat);
     mOurShader->EndRender();
 }
 
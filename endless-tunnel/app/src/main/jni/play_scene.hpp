@@ -83,8 +83,12 @@ class PlayScene : public Scene {
         // vertex buffer and index buffer to render tunnel
         SimpleGeom *mTunnelGeom;
 
-        // vertex buffer to render obstacles
-        SimpleGeom *mCubeGeom;
+        // obstacle boxes for the current frame, already transformed to world space and
+        // tinted, so all of them can go out in a single draw call (see RenderObstacles).
+        // mObstacleVerts is the CPU-side copy we build each frame, mObstacleBatch the
+        // VBO we upload it to.
+        GLfloat *mObstacleVerts;
+        VertexBuf *mObstacleBatch;
 
         // what is the first tunnel section that we are rendering
         int mFirstSection;
@@ -99,6 +103,9 @@ class PlayScene : public Scene {
         int mObstacleCount;
         Obstacle mObstacleCircBuf[MAX_OBS];
 
+        // most boxes (including bonuses) we'll ever render in one frame
+        static const int MAX_OBS_BOXES = MAX_OBS * OBS_GRID_SIZE * OBS_GRID_SIZE;
+
         // obstacle generator
         ObstacleGenerator mObstacleGen;
 
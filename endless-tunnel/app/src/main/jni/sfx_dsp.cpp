@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sfx_dsp.hpp"
+
+#include <math.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define SFX_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SFX_SSE2 1
+#endif
+
+void SfxMixAdd(int32_t *acc, const short *in, int frames) {
+    int i = 0;
+#if defined(SFX_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        int16x8_t x = vld1q_s16(in + i);
+        vst1q_s32(acc + i, vaddw_s16(vld1q_s32(acc + i), vget_low_s16(x)));
+        vst1q_s32(acc + i + 4, vaddw_s16(vld1q_s32(acc + i + 4), vget_high_s16(x)));
+    }
+#elif defined(SFX_SSE2)
+    for (; i + 8 <= frames; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+        // sign extend by unpacking into the high halves and shifting down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        __m128i *a = (__m128i*)(acc + i);
+        _mm_store_si128(a, _mm_add_epi32(_mm_load_si128(a), lo));
+        _mm_store_si128(a + 1, _mm_add_epi32(_mm_load_si128(a + 1), hi));
+    }
+#endif
+    for (; i < frames; i++) {
+        acc[i] += in[i];
+    }
+}
+
+void SfxMixStore(short *out, const int32_t *acc, int frames) {
+    int i = 0;
+#if defined(SFX_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vld1q_s32(acc + i)),
+                vqmovn_s32(vld1q_s32(acc + i + 4))));
+    }
+#elif defined(SFX_SSE2)
+    for (; i + 8 <= frames; i += 8) {
+        const __m128i *a = (const __m128i*)(acc + i);
+        _mm_store_si128((__m128i*)(out + i),
+                _mm_packs_epi32(_mm_load_si128(a), _mm_load_si128(a + 1)));
+    }
+#endif
+    for (; i < frames; i++) {
+        int32_t v = acc[i];
+        out[i] = v < -32768 ? -32768 : v > 32767 ? 32767 : (short)v;
+    }
+}
+
+// the tone waveform, and a plain sine for tones whose octave would alias;
+// one point more than a period, so interpolation never wraps
+static float _waveTone[SFX_WAVE_SIZE + 1] __attribute__((aligned(16)));
+static float _waveSine[SFX_WAVE_SIZE + 1] __attribute__((aligned(16)));
+
+static struct _WaveInit {
+    _WaveInit() {
+        for (int i = 0; i <= SFX_WAVE_SIZE; i++) {
+            double x = 2 * M_PI * i / SFX_WAVE_SIZE;
+            _waveSine[i] = (float)sin(x);
+            _waveTone[i] = (float)(sin(x) + 0.1 * sin(2 * x));
+        }
+    }
+} _waveInit;
+
+void SfxOscStart(SfxOsc *osc, int frequency, int rate) {
+    osc->phase = 0;
+    osc->step = 0;
+    osc->table = NULL;
+    if (frequency <= 0 || rate <= 0 || frequency * 2 >= rate) {
+        return;
+    }
+    osc->step = (uint32_t)(((uint64_t)frequency << 32) / rate);
+    osc->table = frequency * 4 < rate ? _waveTone : _waveSine;
+}
+
+int SfxOscWholePeriods(const SfxOsc *osc, int frames) {
+    if (!osc->step || frames <= 0) {
+        return frames;
+    }
+    // step is rounded down by less than 1 per sample: allow for it, so a
+    // tone that is an exact number of periods keeps its last one
+    uint64_t periods = ((uint64_t)osc->phase + (uint64_t)frames * osc->step + frames) >> 32;
+    if (!periods) {
+        return frames;
+    }
+    // the first sample at or past the end of the last whole period
+    uint64_t end = (periods << 32) - osc->phase;
+    int whole = (int)((end + osc->step - 1) / osc->step);
+    return whole < frames ? whole : frames;
+}
+
+#define FRAC_SHIFT (32 - SFX_WAVE_BITS - 16)  // 16 bits of phase below the index
+
+void SfxOscRender(SfxOsc *osc, float amplitude, short *out, int frames) {
+    const float *t = osc->table;
+    uint32_t phase = osc->phase, step = osc->step;
+    if (!t) {
+        for (int i = 0; i < frames; i++) {
+            out[i] = 0;
+        }
+        return;
+    }
+    float gain = amplitude * 32768.0f;
+    int i = 0;
+#if defined(SFX_NEON) || defined(SFX_SSE2)
+    uint32_t idx[4] __attribute__((aligned(16)));
+    float a[4] __attribute__((aligned(16))), b[4] __attribute__((aligned(16)));
+#endif
+#if defined(SFX_NEON)
+    uint32_t init[4] = { phase, phase + step, phase + 2 * step, phase + 3 * step };
+    uint32x4_t ph = vld1q_u32(init);
+    uint32x4_t step4 = vdupq_n_u32(4 * step);
+    uint32x4_t fracMask = vdupq_n_u32(0xFFFF);
+    for (; i + 4 <= frames; i += 4) {
+        vst1q_u32(idx, vshrq_n_u32(ph, 32 - SFX_WAVE_BITS));
+        for (int k = 0; k < 4; k++) {
+            a[k] = t[idx[k]];
+            b[k] = t[idx[k] + 1];
+        }
+        float32x4_t frac = vmulq_n_f32(vcvtq_f32_u32(
+                vandq_u32(vshrq_n_u32(ph, FRAC_SHIFT), fracMask)), 1.0f / 65536);
+        float32x4_t va = vld1q_f32(a);
+        float32x4_t v = vmlaq_f32(va, vsubq_f32(vld1q_f32(b), va), frac);
+        vst1_s16(out + i, vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(v, gain))));
+        ph = vaddq_u32(ph, step4);
+    }
+    phase += (uint32_t)i * step;
+#elif defined(SFX_SSE2)
+    __m128i ph = _mm_set_epi32((int)(phase + 3 * step), (int)(phase + 2 * step),
+            (int)(phase + step), (int)phase);
+    __m128i step4 = _mm_set1_epi32((int)(4 * step));
+    __m128i fracMask = _mm_set1_epi32(0xFFFF);
+    __m128 fracScale = _mm_set1_ps(1.0f / 65536);
+    __m128 vgain = _mm_set1_ps(gain);
+    for (; i + 4 <= frames; i += 4) {
+        _mm_store_si128((__m128i*)idx, _mm_srli_epi32(ph, 32 - SFX_WAVE_BITS));
+        for (int k = 0; k < 4; k++) {
+            a[k] = t[idx[k]];
+            b[k] = t[idx[k] + 1];
+        }
+        __m128 frac = _mm_mul_ps(_mm_cvtepi32_ps(
+                _mm_and_si128(_mm_srli_epi32(ph, FRAC_SHIFT), fracMask)), fracScale);
+        __m128 va = _mm_load_ps(a);
+        __m128 v = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(b), va), frac));
+        __m128i s = _mm_cvtps_epi32(_mm_mul_ps(v, vgain));
+        _mm_storel_epi64((__m128i*)(out + i), _mm_packs_epi32(s, s));
+        ph = _mm_add_epi32(ph, step4);
+    }
+    phase += (uint32_t)i * step;
+#endif
+    for (; i < frames; i++, phase += step) {
+        uint32_t k = phase >> (32 - SFX_WAVE_BITS);
+        float frac = ((phase >> FRAC_SHIFT) & 0xFFFF) * (1.0f / 65536);
+        int v = (int)((t[k] + (t[k + 1] - t[k]) * frac) * gain);
+        out[i] = v < -32768 ? -32768 : v > 32767 ? 32767 : (short)v;
+    }
+    osc->phase = phase;
+}
+
+void SfxEnvelope(short *buf, int frames, int attack, int release) {
+    // Q16 ramps; plain loops the compiler vectorizes
+    if (attack > frames) {
+        attack = frames;
+    }
+    if (release > frames) {
+        release = frames;
+    }
+    if (attack > 0) {
+        int32_t step = (1 << 16) / attack;
+        for (int i = 0; i < attack; i++) {
+            buf[i] = (short)((buf[i] * (i * step)) >> 16);
+        }
+    }
+    if (release > 0) {
+        int32_t step = (1 << 16) / release;
+        short *tail = buf + frames - release;
+        for (int i = 0; i < release; i++) {
+            tail[i] = (short)((tail[i] * ((release - i) * step)) >> 16);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef endlesstunnel_sfx_dsp_hpp
+#define endlesstunnel_sfx_dsp_hpp
+
+#include <stdint.h>
+
+/* Signal processing kernels for SfxMan. They don't touch OpenSL ES, so they
+ * can be built and benchmarked on the host (see tools/sfx_bench.cpp). The
+ * inner loops use NEON or SSE2 when the target has them. */
+
+// Mixer: voices are summed into a 32-bit accumulator, which is saturated to
+// 16 bits once all of them are in, so the order voices are added in doesn't
+// matter. acc and out are SFX_MIX_ALIGN byte aligned.
+#define SFX_MIX_ALIGN 16
+
+// Adds frames samples of in to acc. in need not be aligned.
+void SfxMixAdd(int32_t *acc, const short *in, int frames);
+
+// Writes acc to out, saturated to 16 bits.
+void SfxMixStore(short *out, const int32_t *acc, int frames);
+
+// Oscillator: one period of the SfxMan tone waveform (a sine plus a tenth of
+// its octave) tabulated in SFX_WAVE_SIZE points, read with a 32-bit fixed
+// point phase accumulator and linear interpolation.
+#define SFX_WAVE_BITS 8
+#define SFX_WAVE_SIZE (1 << SFX_WAVE_BITS)
+
+struct SfxOsc {
+    uint32_t phase;       // 1 << 32 is a whole period
+    uint32_t step;        // phase increment per sample
+    const float *table;   // NULL: silent
+};
+
+// Sets osc up to play frequency Hz at rate samples per second, from phase 0.
+// The tables are band limited: from a quarter of rate up the octave would
+// alias, so those tones are plain sines, and from half of rate up silent.
+void SfxOscStart(SfxOsc *osc, int frequency, int rate);
+
+// The number of samples, no more than frames, that end on a whole period,
+// so a tone stops on a zero crossing; frames if not even one period fits.
+int SfxOscWholePeriods(const SfxOsc *osc, int frames);
+
+// Renders frames samples at amplitude (1.0 is full scale) into out,
+// saturated to 16 bits, and advances the phase.
+void SfxOscRender(SfxOsc *osc, float amplitude, short *out, int frames);
+
+// Envelope: fades buf in linearly over its first attack samples, and out
+// over its last release samples.
+void SfxEnvelope(short *buf, int frames, int attack, int release);
+
+#endif
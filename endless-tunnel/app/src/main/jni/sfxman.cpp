@@ -14,14 +14,100 @@
  * limitations under the License.
  */
 #include "sfxman.hpp"
+#include "sfx_dsp.hpp"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #define SAMPLES_PER_SEC 8000
-#define BUF_SAMPLES_MAX SAMPLES_PER_SEC*5 // 5 seconds
+#define BUF_SAMPLES_MAX SAMPLES_PER_SEC*3 // 3 seconds per tone; TONE_GAME_OVER is ~2
 #define DEFAULT_VOLUME 0.9f
 
+// Tone cache: every recipe is rendered once, into a buffer that voices then
+// play straight out of. Up to SFX_TONES_MAX recipes and SFX_TONE_CACHE_BYTES
+// of samples are kept; past that, the least recently played tone that isn't
+// playing makes room.
+#define SFX_TONES_MAX 24
+#define SFX_TONE_CACHE_BYTES (256 * 1024)
+
+// Mixer: up to SFX_VOICES tones sound at once, summed into one buffer queue
+// player a SFX_MIX_FRAMES buffer at a time (32 ms). There is one voice slot
+// more than that, for a tone to wait in while all the others play; when it
+// is due and every voice is busy, the oldest one is stolen.
+#define SFX_VOICES 4
+#define SFX_VOICE_SLOTS (SFX_VOICES + 1)
+#define SFX_MIX_FRAMES 256
+
+// Commands from the game thread to the SfxMan worker, through a lock-free
+// single producer / single consumer ring of SFX_COMMANDS (a power of 2). The
+// worker logs the queue latency every SFX_STATS_INTERVAL tones.
+#define SFX_COMMANDS 64
+#define SFX_STATS_INTERVAL 64
+
+enum { CMD_PLAY, CMD_PREPARE };
+
+struct SfxCommand {
+    int type;
+    const char *tone;   // the recipe, which outlives the command
+    int64_t pushedNs;   // when the game thread pushed it
+};
+
+// A rendered recipe. Immutable once rendered; voices count as references,
+// and only a tone nothing refers to is freed. Worker only, but for refs.
+struct Tone {
+    char *recipe;       // NULL: unused entry
+    unsigned hash;
+    short *samples;
+    int length;
+    volatile int refs;
+    unsigned lastUse;
+};
+
+// Voice slot states. The worker owns FREE and WRITING slots, the mixer
+// (_mixerPump()) owns PLAYING ones; PENDING ones go to whichever claims them
+// first.
+enum { VOICE_FREE, VOICE_WRITING, VOICE_PENDING, VOICE_PLAYING };
+
+struct Voice {
+    volatile int state;
+    unsigned stamp;  // order the tones were played in
+    Tone *tone;
+    int pos;
+};
+
 static SfxMan *_instance = new SfxMan();
-static short _sample_buf[BUF_SAMPLES_MAX];
-static volatile bool _bufferActive = false;
+static Tone _tones[SFX_TONES_MAX];
+static int _toneBytes = 0;          // worker only, as is all of _tones but refs
+static short _renderBuf[BUF_SAMPLES_MAX];
+static Voice _voices[SFX_VOICE_SLOTS];
+static unsigned _voiceStamp = 0;  // worker only
+static short _mixBuf[2][SFX_MIX_FRAMES] __attribute__((aligned(SFX_MIX_ALIGN)));
+static int32_t _mixAcc[SFX_MIX_FRAMES] __attribute__((aligned(SFX_MIX_ALIGN)));
+static int _mixNext = 0;    // buffer to mix into next
+static int _mixQueued = 0;  // buffers with the player
+static volatile int _mixDone = 0;  // buffers played since the last pump
+static volatile int _pumpRequests = 0;  // see _requestPump()
+
+static SfxCommand _commands[SFX_COMMANDS];
+static uint32_t _commandHead = 0;  // next to pop, written by the worker only
+static uint32_t _commandTail = 0;  // next to push, written by the game thread only
+static sem_t _commandSem;
+static pthread_t _worker;
+
+// queue latency, from push to the tone being handed to the mixer; written by
+// the worker, read by anyone
+static volatile int _statTones = 0;
+static volatile int64_t _statLatencyNs = 0;
+static volatile int64_t _statLatencyMaxNs = 0;
+
+static int64_t _nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
 
 SfxMan* SfxMan::GetInstance() {
     return _instance ? _instance : (_instance = new SfxMan());
@@ -36,8 +122,102 @@ static bool _checkError(SLresult r, const char *what) {
     return false;
 }
 
+// Starts the tones that are ready, stealing the oldest voices if need be.
+static void _mixerTake() {
+    int playing = 0;
+    for (int i = 0; i < SFX_VOICE_SLOTS; i++) {
+        playing += (__atomic_load_n(&_voices[i].state, __ATOMIC_RELAXED) == VOICE_PLAYING);
+    }
+    for (;;) {
+        Voice *next = NULL, *oldest = NULL;
+        for (int i = 0; i < SFX_VOICE_SLOTS; i++) {
+            Voice *v = &_voices[i];
+            int state = __atomic_load_n(&v->state, __ATOMIC_ACQUIRE);
+            if (state == VOICE_PENDING && (!next || (int)(v->stamp - next->stamp) < 0)) {
+                next = v;
+            } else if (state == VOICE_PLAYING &&
+                    (!oldest || (int)(v->stamp - oldest->stamp) < 0)) {
+                oldest = v;
+            }
+        }
+        if (!next) {
+            return;
+        }
+        if (playing >= SFX_VOICES && oldest) {
+            __atomic_sub_fetch(&oldest->tone->refs, 1, __ATOMIC_RELEASE);
+            __atomic_store_n(&oldest->state, VOICE_FREE, __ATOMIC_RELEASE);
+            --playing;
+        }
+        int pending = VOICE_PENDING;
+        if (__atomic_compare_exchange_n(&next->state, &pending, VOICE_PLAYING, false,
+                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            next->pos = 0;
+            ++playing;
+        }
+    }
+}
+
+// Mixes the next SFX_MIX_FRAMES of every playing voice into out. Returns
+// false if nothing is playing.
+static bool _mix(short *out) {
+    int voices = 0;
+    memset(_mixAcc, 0, sizeof(_mixAcc));
+    for (int i = 0; i < SFX_VOICE_SLOTS; i++) {
+        Voice *v = &_voices[i];
+        if (__atomic_load_n(&v->state, __ATOMIC_RELAXED) != VOICE_PLAYING) {
+            continue;
+        }
+        int frames = v->tone->length - v->pos;
+        frames = frames < SFX_MIX_FRAMES ? frames : SFX_MIX_FRAMES;
+        SfxMixAdd(_mixAcc, v->tone->samples + v->pos, frames);
+        v->pos += frames;
+        if (v->pos >= v->tone->length) {
+            __atomic_sub_fetch(&v->tone->refs, 1, __ATOMIC_RELEASE);
+            __atomic_store_n(&v->state, VOICE_FREE, __ATOMIC_RELEASE);
+        }
+        ++voices;
+    }
+    if (!voices) {
+        return false;
+    }
+    SfxMixStore(out, _mixAcc, SFX_MIX_FRAMES);
+    return true;
+}
+
+// Keeps two mixed buffers with the player while anything plays.
+static void _mixerPump(SLAndroidSimpleBufferQueueItf bq) {
+    _mixQueued -= __atomic_exchange_n(&_mixDone, 0, __ATOMIC_ACQUIRE);
+    _mixerTake();
+    while (_mixQueued < 2) {
+        short *buf = _mixBuf[_mixNext];
+        if (!_mix(buf)) {
+            break;
+        }
+        SLresult result = (*bq)->Enqueue(bq, buf, sizeof(_mixBuf[0]));
+        if (result != SL_RESULT_SUCCESS) {
+            LOGW("SfxMan: warning: failed to enqueue buffer: %lu", (unsigned long)result);
+            break;
+        }
+        _mixNext ^= 1;
+        ++_mixQueued;
+    }
+}
+
+// Runs _mixerPump() once for every request, one at a time: the worker (a new
+// tone) and the buffer queue callback (a buffer played) both ask for one, and
+// whoever finds another pump under way leaves its request to that one.
+static void _requestPump(SLAndroidSimpleBufferQueueItf bq) {
+    if (__atomic_fetch_add(&_pumpRequests, 1, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+    do {
+        _mixerPump(bq);
+    } while (__atomic_sub_fetch(&_pumpRequests, 1, __ATOMIC_ACQ_REL));
+}
+
 static void _bqPlayerCallback(SLAndroidSimpleBufferQueueItf bq, void *context) {
-    _bufferActive = false;
+    __atomic_add_fetch(&_mixDone, 1, __ATOMIC_RELEASE);
+    _requestPump(bq);
 }
 
 
@@ -57,6 +237,7 @@ SfxMan::SfxMan() {
             SL_I3DL2_ENVIRONMENT_PRESET_STONECORRIDOR;
 
     LOGD("SfxMan: initializing.");
+    mInitOk = false;
     mPlayerBufferQueue = NULL;
 
     // create engine
@@ -144,12 +325,27 @@ SfxMan::SfxMan() {
     result = (*bqPlayerPlay)->SetPlayState(bqPlayerPlay, SL_PLAYSTATE_PLAYING);
     if (_checkError(result, "setting play state to playing")) return;
 
+    // start the worker
+    if (sem_init(&_commandSem, 0, 0) || pthread_create(&_worker, NULL, WorkerMain, this)) {
+        LOGW("SfxMan: can't start the worker thread.");
+        LOGW("DISABLING SOUND!");
+        return;
+    }
+
     LOGD("SfxMan: initialization complete.");
     mInitOk = true;
 }
 
 bool SfxMan::IsIdle() {
-    return !_bufferActive;
+    if (__atomic_load_n(&_commandHead, __ATOMIC_ACQUIRE) != _commandTail) {
+        return false;
+    }
+    for (int i = 0; i < SFX_VOICE_SLOTS; i++) {
+        if (__atomic_load_n(&_voices[i].state, __ATOMIC_ACQUIRE) != VOICE_FREE) {
+            return false;
+        }
+    }
+    return true;
 }
 
 static const char *_parseInt(const char *s, int *result) {
@@ -162,59 +358,28 @@ static const char *_parseInt(const char *s, int *result) {
 }
 
 static int _synth(int frequency, int duration, float amplitude, short *sample_buf, int samples) {
-    int i;
-
-    for (i = 0; i < samples; i++) {
-        float t = i / (float)SAMPLES_PER_SEC;
-        float v;
-        if (frequency > 0) {
-            v = amplitude * sin(frequency * t * 2 * M_PI) +
-                  (amplitude * 0.1f) * sin(frequency * 2 * t * 2 * M_PI);
-        } else {
-            int r = rand();
-            r = r > 0 ? r : -r;
-            v = amplitude * (-0.5f + (r % 1024) / 512.0f);
-        }
-        int value = (int)(v * 32768.0f);
-        sample_buf[i] = value < -32767 ? -32767 : value > 32767 ? 32767 : value;
-
-        if (i > 0 && sample_buf[i-1] < 0 && sample_buf[i] >= 0) {
-            // start of new wave -- check if we have room for a full period of it
-            int period_samples = (1.0f / frequency) * SAMPLES_PER_SEC;
-            if (i + period_samples >= samples) break;
-        }
+    if (frequency > 0) {
+        // end on a whole period, so the next tone starts from a zero crossing
+        SfxOsc osc;
+        SfxOscStart(&osc, frequency, SAMPLES_PER_SEC);
+        samples = SfxOscWholePeriods(&osc, samples);
+        SfxOscRender(&osc, amplitude, sample_buf, samples);
+        return samples;
     }
 
-    return i;
-}
-
-static void _taper(short *sample_buf, int samples) {
-    int i;
-    const float TAPER_SAMPLES_FRACTION = 0.1f;
-    int taper_samples = (int)(TAPER_SAMPLES_FRACTION * samples);
-    for (i = 0; i < taper_samples && i < samples; i++) {
-        float factor = i / (float)taper_samples;
-        sample_buf[i] = (short)((float)sample_buf[i] * factor);
-    }
-    for (i = samples - taper_samples; i < samples; i++) {
-        if (i < 0) continue;
-        float factor = (samples - i)/ (float)taper_samples;
-        sample_buf[i] = (short)((float)sample_buf[i] * factor);
+    for (int i = 0; i < samples; i++) {
+        int r = rand();
+        r = r > 0 ? r : -r;
+        float v = amplitude * (-0.5f + (r % 1024) / 512.0f);
+        int value = (int)(v * 32768.0f);
+        sample_buf[i] = value < -32767 ? -32767 : value > 32767 ? 32767 : value;
     }
+    return samples;
 }
 
-void SfxMan::PlayTone(const char *tone) {
-    if (!mInitOk) {
-        LOGW("SfxMan: not playing sound because initialization failed.");
-        return;
-    }
-    if (_bufferActive) {
-        // can't play -- the buffer is in use
-        LOGW("SfxMan: can't play tone; buffer is active.");
-        return;
-    }
-
-    // synth the tone
+// Renders a recipe into _renderBuf; returns the samples rendered.
+static int _render(const char *tone) {
+    short *sample_buf = _renderBuf;
     int total_samples = 0;
     int num_samples;
     int frequency = 100;
@@ -244,7 +409,7 @@ void SfxMan::PlayTone(const char *tone) {
                if (num_samples > (BUF_SAMPLES_MAX - total_samples - 1)) {
                    num_samples = BUF_SAMPLES_MAX - total_samples - 1;
                }
-               num_samples = _synth(frequency, duration, amplitude, _sample_buf + total_samples,
+               num_samples = _synth(frequency, duration, amplitude, sample_buf + total_samples,
                        num_samples);
                total_samples += num_samples;
                tone++;
@@ -255,20 +420,203 @@ void SfxMan::PlayTone(const char *tone) {
        }
     }
 
-    SLresult result;
-    int total_size = total_samples * sizeof(short);
-    if (total_size <= 0) {
-        LOGW("Tone is empty. Not playing.");
-        return;
+    if (total_samples > 0) {
+        // fade in and out over a tenth of the tone each
+        SfxEnvelope(sample_buf, total_samples, total_samples / 10, total_samples / 10);
     }
+    return total_samples;
+}
 
-    _taper(_sample_buf, total_samples);
+static unsigned _hash(const char *s) {
+    unsigned h = 2166136261u;  // FNV-1a
+    while (*s) {
+        h = (h ^ (unsigned char)*s++) * 16777619u;
+    }
+    return h;
+}
 
-    _bufferActive = true;
-    result = (*mPlayerBufferQueue)->Enqueue(mPlayerBufferQueue, _sample_buf, total_size);
-    if (result != SL_RESULT_SUCCESS) {
-        LOGW("SfxMan: warning: failed to enqueue buffer: %lu", (unsigned long)result);
+static void _freeTone(Tone *t) {
+    _toneBytes -= t->length * sizeof(short);
+    free(t->recipe);
+    free(t->samples);
+    t->recipe = NULL;
+    t->samples = NULL;
+    t->length = 0;
+}
+
+// The least recently used tone nothing is playing, or NULL.
+static Tone *_lruIdleTone() {
+    Tone *lru = NULL;
+    for (int i = 0; i < SFX_TONES_MAX; i++) {
+        Tone *t = &_tones[i];
+        if (t->recipe && __atomic_load_n(&t->refs, __ATOMIC_ACQUIRE) == 0 &&
+                (!lru || (int)(t->lastUse - lru->lastUse) < 0)) {
+            lru = t;
+        }
+    }
+    return lru;
+}
+
+// Returns the cached rendering of a recipe, rendering it if need be; NULL
+// if it's empty or there's no room for it.
+static Tone *_getTone(const char *recipe) {
+    static unsigned clock = 0;
+    unsigned hash = _hash(recipe);
+    Tone *slot = NULL;
+    for (int i = 0; i < SFX_TONES_MAX; i++) {
+        Tone *t = &_tones[i];
+        if (!t->recipe) {
+            slot = slot ? slot : t;
+        } else if (t->hash == hash && !strcmp(t->recipe, recipe)) {
+            t->lastUse = ++clock;
+            return t;
+        }
+    }
+
+    int length = _render(recipe);
+    if (length <= 0) {
+        return NULL;
+    }
+    int bytes = length * sizeof(short);
+    while (!slot || _toneBytes + bytes > SFX_TONE_CACHE_BYTES) {
+        Tone *lru = _lruIdleTone();
+        if (!lru) {
+            LOGW("SfxMan: no room in the tone cache for \"%s\".", recipe);
+            return NULL;
+        }
+        _freeTone(lru);
+        slot = slot ? slot : lru;
+    }
+    slot->samples = (short*)malloc(bytes);
+    slot->recipe = strdup(recipe);
+    if (!slot->samples || !slot->recipe) {
+        free(slot->samples);
+        free(slot->recipe);
+        slot->samples = NULL;
+        slot->recipe = NULL;
+        return NULL;
+    }
+    memcpy(slot->samples, _renderBuf, bytes);
+    slot->length = length;
+    slot->hash = hash;
+    slot->refs = 0;
+    slot->lastUse = ++clock;
+    _toneBytes += bytes;
+    return slot;
+}
+
+// Starts a tone on a voice: a free one, else that of the oldest tone that
+// hasn't started playing yet. Worker only.
+static void _startTone(Tone *t, SLAndroidSimpleBufferQueueItf bq) {
+    Voice *voice = NULL;
+    for (int i = 0; i < SFX_VOICE_SLOTS && !voice; i++) {
+        if (__sync_bool_compare_and_swap(&_voices[i].state, VOICE_FREE, VOICE_WRITING)) {
+            voice = &_voices[i];
+        }
+    }
+    while (!voice) {
+        Voice *oldest = NULL;
+        for (int i = 0; i < SFX_VOICE_SLOTS; i++) {
+            Voice *v = &_voices[i];
+            if (__atomic_load_n(&v->state, __ATOMIC_RELAXED) == VOICE_PENDING &&
+                    (!oldest || (int)(v->stamp - oldest->stamp) < 0)) {
+                oldest = v;
+            }
+        }
+        if (!oldest) {
+            // the mixer freed or took everything since we looked
+            for (int i = 0; i < SFX_VOICE_SLOTS && !voice; i++) {
+                if (__sync_bool_compare_and_swap(&_voices[i].state, VOICE_FREE, VOICE_WRITING)) {
+                    voice = &_voices[i];
+                }
+            }
+            if (!voice) {
+                LOGW("SfxMan: can't play tone; no voice available.");
+                return;
+            }
+        } else if (__sync_bool_compare_and_swap(&oldest->state, VOICE_PENDING, VOICE_WRITING)) {
+            __atomic_sub_fetch(&oldest->tone->refs, 1, __ATOMIC_RELEASE);
+            voice = oldest;
+        }
+    }
+
+    // hand it to the mixer, and start the mixer if it's idle
+    __atomic_add_fetch(&t->refs, 1, __ATOMIC_RELAXED);
+    voice->tone = t;
+    voice->stamp = ++_voiceStamp;
+    __atomic_store_n(&voice->state, VOICE_PENDING, __ATOMIC_RELEASE);
+    _requestPump(bq);
+}
+
+static void _recordLatency(int64_t pushedNs) {
+    int64_t latency = _nowNs() - pushedNs;
+    int64_t total = _statLatencyNs + latency;
+    int64_t max = latency > _statLatencyMaxNs ? latency : _statLatencyMaxNs;
+    int tones = _statTones + 1;
+    __atomic_store_n(&_statLatencyNs, total, __ATOMIC_RELAXED);
+    __atomic_store_n(&_statLatencyMaxNs, max, __ATOMIC_RELAXED);
+    __atomic_store_n(&_statTones, tones, __ATOMIC_RELEASE);
+    if (tones % SFX_STATS_INTERVAL == 0) {
+        LOGD("SfxMan: %d tones, queue latency %.3f ms average, %.3f ms max.", tones,
+                total * 1e-6 / tones, max * 1e-6);
+    }
+}
+
+void *SfxMan::WorkerMain(void *arg) {
+    SfxMan *sfx = (SfxMan*)arg;
+    for (;;) {
+        sem_wait(&_commandSem);
+        uint32_t head = _commandHead;
+        if (head == __atomic_load_n(&_commandTail, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        SfxCommand cmd = _commands[head & (SFX_COMMANDS - 1)];
+        __atomic_store_n(&_commandHead, head + 1, __ATOMIC_RELEASE);
+
+        Tone *t = _getTone(cmd.tone);
+        if (cmd.type != CMD_PLAY) {
+            continue;
+        }
+        if (!t) {
+            LOGW("Tone is empty. Not playing.");
+            continue;
+        }
+        _startTone(t, sfx->mPlayerBufferQueue);
+        _recordLatency(cmd.pushedNs);
+    }
+    return NULL;
+}
+
+void SfxMan::PushCommand(int type, const char *tone) {
+    if (!mInitOk) {
+        LOGW("SfxMan: not playing sound because initialization failed.");
+        return;
+    }
+    uint32_t tail = _commandTail;
+    if (tail - __atomic_load_n(&_commandHead, __ATOMIC_ACQUIRE) >= SFX_COMMANDS) {
+        LOGW("SfxMan: command queue full; dropping tone.");
         return;
     }
+    SfxCommand *cmd = &_commands[tail & (SFX_COMMANDS - 1)];
+    cmd->type = type;
+    cmd->tone = tone;
+    cmd->pushedNs = _nowNs();
+    __atomic_store_n(&_commandTail, tail + 1, __ATOMIC_RELEASE);
+    sem_post(&_commandSem);
 }
 
+void SfxMan::PrepareTone(const char *tone) {
+    PushCommand(CMD_PREPARE, tone);
+}
+
+void SfxMan::PlayTone(const char *tone) {
+    PushCommand(CMD_PLAY, tone);
+}
+
+void SfxMan::GetQueueStats(int *tones, float *avgLatencyMs, float *maxLatencyMs) {
+    int n = __atomic_load_n(&_statTones, __ATOMIC_ACQUIRE);
+    int64_t total = __atomic_load_n(&_statLatencyNs, __ATOMIC_RELAXED);
+    *tones = n;
+    *avgLatencyMs = n ? (float)(total * 1e-6 / n) : 0.0f;
+    *maxLatencyMs = (float)(__atomic_load_n(&_statLatencyMaxNs, __ATOMIC_RELAXED) * 1e-6);
+}
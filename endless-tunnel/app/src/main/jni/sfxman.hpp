@@ -24,15 +24,19 @@
 /* Sound effect manager. This class is a singleton that manages sound effect
  * playback. Sound effects are defined by recipes (which are strings) that
  * indicate frequencies and durations. See the PlayTone() method for more info.
- * Note: our sfx generation code is very simplistic and lacks a mixer, so
- * only one sound can be playing at any given time. This is not a problematic
- * limitation for this simple sample but, needless to say, doesn't scale well
- * to a more complex game. */
+ * Up to a few tones play at once: they are mixed into a single buffer queue
+ * player, and when all voices are busy a new tone takes over the oldest one.
+ * All the audio work happens on a worker thread of SfxMan's own; the calls
+ * below only queue a command for it, and are meant for one thread (the game
+ * thread) at a time. */
 class SfxMan {
     private:
         bool mInitOk;
         SLAndroidSimpleBufferQueueItf mPlayerBufferQueue;
 
+        void PushCommand(int type, const char *tone);
+        static void *WorkerMain(void *arg);
+
     public:
         SfxMan();
 
@@ -55,12 +59,24 @@ class SfxMan {
          * Example: "d100 f300. d50 f250. a0 d100. a100 d50 f0."
          * This will play a 300Hz tone for 100ms, followed by a 250Hz tone
          * for 50 milliseconds, followed by 100ms of silence, followed
-         * by 50 milliseconds of loud random noise. */
+         * by 50 milliseconds of loud random noise.
+         *
+         * The recipe isn't copied: it must stay valid until the tone plays, as
+         * string literals like the TONE_* ones do. */
         void PlayTone(const char *tone);
 
-        // Returns whether or not the sound effect pipeline is idle (able to play
-        // a tone right now).
+        /* Renders a tone ahead of time, so that playing it later costs no
+         * synthesis. Tones are rendered once per recipe and kept, within a
+         * memory budget, whether they were prepared or just played. */
+        void PrepareTone(const char *tone);
+
+        // Returns whether or not the sound effect pipeline is idle (nothing is
+        // queued or playing).
         bool IsIdle();
+
+        // Returns how many tones were played, and how long they waited in the
+        // command queue before reaching the mixer, on average and at most.
+        void GetQueueStats(int *tones, float *avgLatencyMs, float *maxLatencyMs);
 };
 
 #endif
@@ -28,26 +28,62 @@
 
 TextRenderer::TextRenderer(TrivialShader *t) {
     mTrivialShader = t;
-    memset(mCharGeom, 0, sizeof(mCharGeom));
     mFontScale = 1.0f;
     mMatrix = glm::mat4(1.0f);
+    mHasMatrix = false;
     mColor[0] = mColor[1] = mColor[2] = 1.0f;
+    memset(mBatchCache, 0, sizeof(mBatchCache));
+    mBatchClock = 0;
+    mTransientBatch = NULL;
+    mLayoutBuf = NULL;
+    mLayoutBufVerts = 0;
 
     LOGD("Loading alphabet glyphs.");
-    int i;
+    GLfloat *verts[CHAR_CODES];
+    GLushort *indices[CHAR_CODES];
+    int vertCount, indexCount[CHAR_CODES];
+    int i, j, total = 0;
     for (i = 0; i < CHAR_CODES; ++i) {
+        verts[i] = NULL;
+        indices[i] = NULL;
+        indexCount[i] = 0;
         if (ALPHABET_ART[i]) {
             LOGD("Creating glyph for chr %d.", i);
-            mCharGeom[i] = AsciiArtToGeom(ALPHABET_ART[i], ALPHABET_SCALE);
+            AsciiArtToLines(ALPHABET_ART[i], ALPHABET_SCALE, &verts[i], &vertCount,
+                    &indices[i], &indexCount[i]);
+            total += indexCount[i];
         }
     }
+
+    // Pack all glyphs into one array, expanding each line into its two end vertices so
+    // that laying out text is just a matter of copying glyphs and offsetting them.
+    mGlyphVerts = new GLfloat[total * ASCII_ART_VERTEX_FLOATS];
+    total = 0;
+    for (i = 0; i < CHAR_CODES; ++i) {
+        mGlyphFirstVert[i] = total;
+        mGlyphVertCount[i] = indexCount[i];
+        for (j = 0; j < indexCount[i]; ++j, ++total) {
+            memcpy(mGlyphVerts + total * ASCII_ART_VERTEX_FLOATS,
+                    verts[i] + indices[i][j] * ASCII_ART_VERTEX_FLOATS, ASCII_ART_VERTEX_STRIDE);
+        }
+        delete[] verts[i];
+        delete[] indices[i];
+    }
+    LOGD("Packed alphabet glyphs: %d vertices.", total);
 }
 
 TextRenderer::~TextRenderer() {
     int i;
-    for (i = 0; i < CHAR_CODES; i++) {
-        CleanUp(&mCharGeom[i]);
+    for (i = 0; i < BATCH_CACHE_SIZE; i++) {
+        CleanUp(&mBatchCache[i].vbuf);
+        delete[] mBatchCache[i].str;
+        mBatchCache[i].str = NULL;
     }
+    CleanUp(&mTransientBatch);
+    delete[] mGlyphVerts;
+    mGlyphVerts = NULL;
+    delete[] mLayoutBuf;
+    mLayoutBuf = NULL;
 }
 
 TextRenderer* TextRenderer::SetFontScale(float scale) {
@@ -75,6 +111,8 @@ static void _count_rows_cols(const char *p, int *outCols, int *outRows) {
 
 TextRenderer* TextRenderer::SetMatrix(glm::mat4 m) {
     mMatrix = m;
+    mHasMatrix = m != glm::mat4(1.0f);
+    return this;
 }
 
 void TextRenderer::MeasureText(const char *str, float fontScale, float *outWidth,
@@ -89,14 +127,125 @@ void TextRenderer::MeasureText(const char *str, float fontScale, float *outWidth
     }
 }
 
+// Lays out the given string into mLayoutBuf at font scale 1, centered on (0,0), with
+// the current matrix (if any) applied to each glyph. Returns the number of vertices.
+int TextRenderer::LayoutText(const char *str) {
+    const char *p;
+    int cols, rows, i, count = 0;
+
+    for (p = str; *p; ++p) {
+        int code = (int) *p;
+        if (code >= 0 && code < CHAR_CODES) {
+            count += mGlyphVertCount[code];
+        }
+    }
+    if (count > mLayoutBufVerts) {
+        delete[] mLayoutBuf;
+        mLayoutBuf = new GLfloat[count * ASCII_ART_VERTEX_FLOATS];
+        mLayoutBufVerts = count;
+    }
+
+    _count_rows_cols(str, &cols, &rows);
+    float charWidth = ALPHABET_GLYPH_COLS * ALPHABET_SCALE;
+    float charHeight = ALPHABET_GLYPH_ROWS * ALPHABET_SCALE;
+    float charSpacing = CHAR_SPACING_F * charWidth;
+    float lineSpacing = LINE_SPACING_F * charHeight;
+    float width = cols * charWidth + (cols - 1) * charSpacing;
+    float height = rows * charHeight + (rows - 1) * lineSpacing;
+    float startX = -width * 0.5f + 0.5f * charWidth;
+    float x = startX;
+    float y = CORRECTION_Y + height * 0.5f - 0.5f * charHeight;
+    GLfloat *out = mLayoutBuf;
+
+    for (p = str; *p; ++p) {
+        if (*p == '\n') {
+            x = startX;
+            y -= charHeight + lineSpacing;
+            continue;
+        }
+        int code = (int) *p;
+        if (code >= 0 && code < CHAR_CODES) {
+            const GLfloat *in = mGlyphVerts + mGlyphFirstVert[code] * ASCII_ART_VERTEX_FLOATS;
+            for (i = 0; i < mGlyphVertCount[code]; ++i) {
+                glm::vec4 pos(in[0], in[1], in[2], 1.0f);
+                if (mHasMatrix) {
+                    pos = mMatrix * pos;
+                }
+                memcpy(out, in, ASCII_ART_VERTEX_STRIDE);
+                out[0] = pos.x + x;
+                out[1] = pos.y + y;
+                out[2] = pos.z;
+                in += ASCII_ART_VERTEX_FLOATS;
+                out += ASCII_ART_VERTEX_FLOATS;
+            }
+        }
+        x += charWidth + charSpacing;
+    }
+    return count;
+}
+
+// Returns the cached batch for the given string, laying it out if we don't have it yet.
+// Returns NULL if the string has nothing to draw.
+VertexBuf* TextRenderer::GetBatch(const char *str) {
+    TextBatch *slot = NULL;
+    int i;
+
+    ++mBatchClock;
+    for (i = 0; i < BATCH_CACHE_SIZE; i++) {
+        TextBatch *b = &mBatchCache[i];
+        if (b->str && !strcmp(b->str, str)) {
+            b->lastUsed = mBatchClock;
+            return b->vbuf;
+        }
+        if (!slot || (slot->str && (!b->str || b->lastUsed < slot->lastUsed))) {
+            slot = b;
+        }
+    }
+
+    // not cached: replace an empty slot, or the least recently used one
+    CleanUp(&slot->vbuf);
+    delete[] slot->str;
+    slot->str = new char[strlen(str) + 1];
+    strcpy(slot->str, str);
+    slot->lastUsed = mBatchClock;
+
+    int count = LayoutText(str);
+    if (count > 0) {
+        slot->vbuf = new VertexBuf(mLayoutBuf, count * ASCII_ART_VERTEX_STRIDE,
+                ASCII_ART_VERTEX_STRIDE);
+        slot->vbuf->SetPrimitive(GL_LINES);
+        slot->vbuf->SetColorsOffset(ASCII_ART_COLOR_OFFSET);
+    }
+    return slot->vbuf;
+}
+
 TextRenderer* TextRenderer::RenderText(const char *str, float centerX, float centerY) {
     float aspect = SceneManager::GetInstance()->GetScreenAspect();
     glm::mat4 orthoMat = glm::ortho(0.0f, aspect, 0.0f, 1.0f);
-    glm::mat4 modelMat, mat, scaleMat;
-    int cols, rows;
+    glm::mat4 mat;
+    VertexBuf *batch;
     bool hadDepthTest;
 
-    centerY += CORRECTION_Y * mFontScale;
+    // The whole string is a single batch laid out at font scale 1 around (0,0), so
+    // placing and scaling it only takes a matrix, and the batch can be reused while
+    // the string stays the same, whatever the scale.
+    if (mHasMatrix) {
+        int count = LayoutText(str);
+        if (!mTransientBatch) {
+            mTransientBatch = new VertexBuf(mLayoutBuf, count * ASCII_ART_VERTEX_STRIDE,
+                    ASCII_ART_VERTEX_STRIDE);
+            mTransientBatch->SetPrimitive(GL_LINES);
+            mTransientBatch->SetColorsOffset(ASCII_ART_COLOR_OFFSET);
+        } else {
+            mTransientBatch->Update(mLayoutBuf, count * ASCII_ART_VERTEX_STRIDE);
+        }
+        batch = count > 0 ? mTransientBatch : NULL;
+    } else {
+        batch = GetBatch(str);
+    }
+    if (!batch) {
+        return this;
+    }
 
     glLineWidth(TEXT_LINE_WIDTH);
 
@@ -105,32 +254,11 @@ TextRenderer* TextRenderer::RenderText(const char *str, float centerX, float cen
 
     mTrivialShader->SetTintColor(mColor[0], mColor[1], mColor[2]);
 
-    _count_rows_cols(str, &cols, &rows);
-    scaleMat = glm::scale(glm::mat4(1.0f), glm::vec3(mFontScale, mFontScale, 1.0f));
-    float charWidth = ALPHABET_GLYPH_COLS * ALPHABET_SCALE * mFontScale;
-    float charHeight = ALPHABET_GLYPH_ROWS * ALPHABET_SCALE * mFontScale;
-    float charSpacing = CHAR_SPACING_F * charWidth;
-    float lineSpacing = LINE_SPACING_F * charHeight;
-    float width = cols * charWidth + (cols - 1) * charSpacing;
-    float height = rows * charHeight + (rows - 1) * lineSpacing;
-    float startX = centerX - width * 0.5f + 0.5f * charWidth;
-    float startY = centerY + height * 0.5f - 0.5f * charHeight;
-    float y = startY;
-
-    modelMat = glm::translate(glm::mat4(1.0f), glm::vec3(startX, startY, 0.0f));
-    for (; *str; ++str) {
-        if (*str == '\n') {
-            y -= charHeight + lineSpacing;
-            modelMat = glm::translate(glm::mat4(1.0f), glm::vec3(startX, y, 0.0f));
-        } else {
-            int code = (int) *str;
-            if (code >= 0 && code < CHAR_CODES && mCharGeom[code]) {
-                mat = orthoMat * modelMat * scaleMat * mMatrix;
-                mTrivialShader->RenderSimpleGeom(&mat, mCharGeom[code]);
-            }
-            modelMat = glm::translate(modelMat, glm::vec3(charWidth + charSpacing, 0.0f, 0.0f));
-        }
-    }
+    mat = glm::translate(orthoMat, glm::vec3(centerX, centerY, 0.0f));
+    mat = glm::scale(mat, glm::vec3(mFontScale, mFontScale, 1.0f));
+    mTrivialShader->BeginRender(batch);
+    mTrivialShader->Render(&mat);
+    mTrivialShader->EndRender();
 
     glLineWidth(1);
     if (hadDepthTest) {
@@ -138,4 +266,3 @@ TextRenderer* TextRenderer::RenderText(const char *str, float centerX, float cen
     }
     return this;
 }
-
@@ -23,12 +23,42 @@
 class TextRenderer {
     private:
         static const int CHAR_CODES = 128;
-        SimpleGeom* mCharGeom[CHAR_CODES];
+
+        // Line vertices (two per line) of all the glyphs, packed into one array.
+        // Glyph c owns mGlyphVertCount[c] vertices starting at vertex mGlyphFirstVert[c].
+        GLfloat *mGlyphVerts;
+        int mGlyphFirstVert[CHAR_CODES];
+        int mGlyphVertCount[CHAR_CODES];
+
+        // Strings we've recently rendered, each laid out (at font scale 1) into a VBO
+        // of its own so it can be drawn in a single call. Looked up by content; when
+        // the cache is full, the least recently rendered string is evicted.
+        static const int BATCH_CACHE_SIZE = 16;
+        struct TextBatch {
+            char *str;
+            VertexBuf *vbuf;
+            unsigned lastUsed;
+        };
+        TextBatch mBatchCache[BATCH_CACHE_SIZE];
+        unsigned mBatchClock;
+
+        // batch for text rendered with a custom matrix (rebuilt on every call, since
+        // the matrix applies to each glyph individually)
+        VertexBuf *mTransientBatch;
+
+        // scratch space for laying out text
+        GLfloat *mLayoutBuf;
+        int mLayoutBufVerts;
+
         TrivialShader *mTrivialShader;
 
         float mFontScale;
         float mColor[3];
         glm::mat4 mMatrix;
+        bool mHasMatrix;
+
+        int LayoutText(const char *str);
+        VertexBuf* GetBatch(const char *str);
 
     public:
         TextRenderer(TrivialShader *t);
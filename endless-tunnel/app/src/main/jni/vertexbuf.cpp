@@ -31,6 +31,18 @@ VertexBuf::VertexBuf(GLfloat *geomData, int dataSize, int stride) {
     UnbindBuffer();
 }
 
+void VertexBuf::Update(GLfloat *geomData, int dataSize) {
+    MY_ASSERT(dataSize % mStride == 0);
+    mCount = dataSize / mStride;
+
+    // re-specify the whole store rather than patching it with glBufferSubData, so the
+    // driver can give us fresh memory instead of waiting on draws that still read the
+    // previous frame's data
+    BindBuffer();
+    glBufferData(GL_ARRAY_BUFFER, dataSize, geomData, GL_STREAM_DRAW);
+    UnbindBuffer();
+}
+
 void VertexBuf::BindBuffer() {
     glBindBuffer(GL_ARRAY_BUFFER, mVbo);
 }
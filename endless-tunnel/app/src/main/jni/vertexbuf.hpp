@@ -35,6 +35,11 @@ class VertexBuf {
         void BindBuffer();
         void UnbindBuffer();
 
+        // Replaces the buffer's contents (and vertex count) with new data. Meant for
+        // geometry that is rebuilt every frame; don't call it between BeginRender()
+        // and EndRender() on a shader that's rendering this buffer.
+        void Update(GLfloat *geomData, int dataSize);
+
         inline int GetStride() { return mStride; }
         inline int GetCount() { return mCount; }
         inline int GetPositionsOffset() { return 0; }
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host micro-benchmark for the SfxMan signal processing kernels in
+ * sfx_dsp.cpp. Build and run from the endless-tunnel directory:
+ *
+ *    c++ -O2 -Iapp/src/main/jni -o sfx_bench tools/sfx_bench.cpp \
+ *        app/src/main/jni/sfx_dsp.cpp
+ *    ./sfx_bench
+ *
+ * The mixer costs are per voice per SfxMan mix buffer; the buffer lasts
+ * 32 ms, so anything under a few microseconds is noise next to it. The
+ * oscillator is compared with the sin() synthesis SfxMan used before it,
+ * for speed and for how close the tones come out. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sfx_dsp.hpp"
+
+#define MIX_FRAMES 256    // SFX_MIX_FRAMES in sfxman.cpp
+#define VOICES 4          // SFX_VOICES in sfxman.cpp
+#define ITERATIONS 200000
+#define SAMPLES_PER_SEC 8000
+#define TONE_SAMPLES 800  // a d100 tone
+
+static double _now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static short _voices[VOICES][MIX_FRAMES];
+static int32_t _acc[MIX_FRAMES] __attribute__((aligned(SFX_MIX_ALIGN)));
+static short _out[MIX_FRAMES] __attribute__((aligned(SFX_MIX_ALIGN)));
+static short _ref[MIX_FRAMES];
+
+// the plain C mix, as a baseline and a reference
+static void _mixScalar(short *out, int voices) {
+    for (int i = 0; i < MIX_FRAMES; i++) {
+        int32_t v = 0;
+        for (int j = 0; j < voices; j++) {
+            v += _voices[j][i];
+        }
+        out[i] = v < -32768 ? -32768 : v > 32767 ? 32767 : (short)v;
+    }
+}
+
+static void _mix(short *out, int voices) {
+    memset(_acc, 0, sizeof(_acc));
+    for (int j = 0; j < voices; j++) {
+        SfxMixAdd(_acc, _voices[j], MIX_FRAMES);
+    }
+    SfxMixStore(out, _acc, MIX_FRAMES);
+}
+
+static void _benchMixer() {
+    for (int j = 0; j < VOICES; j++) {
+        for (int i = 0; i < MIX_FRAMES; i++) {
+            _voices[j][i] = (short)(rand() % 65536 - 32768);  // clips often
+        }
+    }
+    printf("mixer, per voice per %d-frame buffer:\n", MIX_FRAMES);
+    for (int voices = 1; voices <= VOICES; voices++) {
+        _mixScalar(_ref, voices);
+        _mix(_out, voices);
+        if (memcmp(_ref, _out, sizeof(_out))) {
+            printf("  %d voices: MISMATCH against the scalar mix\n", voices);
+            exit(1);
+        }
+        double t0 = _now();
+        for (int n = 0; n < ITERATIONS; n++) {
+            _mixScalar(_ref, voices);
+            __asm__ __volatile__("" : : "r"(_ref) : "memory");
+        }
+        double t1 = _now();
+        for (int n = 0; n < ITERATIONS; n++) {
+            _mix(_out, voices);
+            __asm__ __volatile__("" : : "r"(_out) : "memory");
+        }
+        double t2 = _now();
+        double scale = 1e9 / ITERATIONS / voices;
+        printf("  %d voices: %6.1f ns scalar, %6.1f ns sfx_dsp\n", voices,
+                (t1 - t0) * scale, (t2 - t1) * scale);
+    }
+}
+
+// SfxMan's synthesis before the oscillator, tone part only
+static int _synthSin(int frequency, float amplitude, short *sample_buf, int samples) {
+    int i;
+    for (i = 0; i < samples; i++) {
+        float t = i / (float)SAMPLES_PER_SEC;
+        float v = amplitude * sin(frequency * t * 2 * M_PI) +
+                (amplitude * 0.1f) * sin(frequency * 2 * t * 2 * M_PI);
+        int value = (int)(v * 32768.0f);
+        sample_buf[i] = value < -32767 ? -32767 : value > 32767 ? 32767 : value;
+    }
+    return i;
+}
+
+static int _synthOsc(int frequency, float amplitude, short *sample_buf, int samples) {
+    SfxOsc osc;
+    SfxOscStart(&osc, frequency, SAMPLES_PER_SEC);
+    SfxOscRender(&osc, amplitude, sample_buf, samples);
+    return samples;
+}
+
+static void _benchOscillator() {
+    static short ref[TONE_SAMPLES], out[TONE_SAMPLES];
+    const int freqs[] = { 200, 300, 400, 500, 600, 700, 800 };  // the TONE_* ones
+    const int n = sizeof(freqs) / sizeof(freqs[0]);
+    const int iterations = ITERATIONS / 20;
+    printf("oscillator, %d-sample tones at 70%% amplitude:\n", TONE_SAMPLES);
+    for (int f = 0; f < n; f++) {
+        _synthSin(freqs[f], 0.7f, ref, TONE_SAMPLES);
+        _synthOsc(freqs[f], 0.7f, out, TONE_SAMPLES);
+        double sig = 0, err = 0;
+        for (int i = 0; i < TONE_SAMPLES; i++) {
+            sig += (double)ref[i] * ref[i];
+            err += (double)(ref[i] - out[i]) * (ref[i] - out[i]);
+        }
+        printf("  %d Hz: %.1f dB from the sin() tone\n", freqs[f], 10 * log10(sig / err));
+    }
+    double t0 = _now();
+    for (int k = 0; k < iterations; k++) {
+        _synthSin(freqs[k % n], 0.7f, ref, TONE_SAMPLES);
+        __asm__ __volatile__("" : : "r"(ref) : "memory");
+    }
+    double t1 = _now();
+    for (int k = 0; k < iterations; k++) {
+        _synthOsc(freqs[k % n], 0.7f, out, TONE_SAMPLES);
+        __asm__ __volatile__("" : : "r"(out) : "memory");
+    }
+    double t2 = _now();
+    double samples = (double)iterations * TONE_SAMPLES;
+    printf("  sin():      %7.1f Msamples/s, %7.1f ns per %d-sample buffer\n",
+            samples / (t1 - t0) * 1e-6, (t1 - t0) / samples * MIX_FRAMES * 1e9, MIX_FRAMES);
+    printf("  oscillator: %7.1f Msamples/s, %7.1f ns per %d-sample buffer\n",
+            samples / (t2 - t1) * 1e-6, (t2 - t1) / samples * MIX_FRAMES * 1e9, MIX_FRAMES);
+}
+
+int main() {
+    _benchMixer();
+    _benchOscillator();
+    return 0;
+}
@@ -267,14 +267,22 @@ public class NativeAudio extends Activity {
             }
         });
 
+        // records until pressed again; playback plays the last 5 seconds
         ((Button) findViewById(R.id.record)).setOnClickListener(new OnClickListener() {
             boolean created = false;
+            boolean recording = false;
             public void onClick(View view) {
+                if (recording) {
+                    stopRecording();
+                    recording = false;
+                    return;
+                }
                 if (!created) {
                     created = createAudioRecorder();
                 }
                 if (created) {
                     startRecording();
+                    recording = true;
                 }
             }
         });
@@ -294,6 +302,7 @@ public class NativeAudio extends Activity {
     {
         // turn off all audio
         selectClip(CLIP_NONE, 0);
+        stopRecording();
         isPlayingAsset = false;
         setPlayingAssetAudioPlayer(false);
         isPlayingUri = false;
@@ -310,6 +319,7 @@ public class NativeAudio extends Activity {
     }
 
     /** Native methods, implemented in jni folder */
+    public static native boolean setClipCache(int budget, boolean prewarm);
     public static native void createEngine();
     public static native void createBufferQueueAudioPlayer(int sampleRate, int samplesPerBuf);
     public static native boolean createAssetAudioPlayer(AssetManager assetManager, String filename);
@@ -328,7 +338,9 @@ public class NativeAudio extends Activity {
     public static native boolean selectClip(int which, int count);
     public static native boolean enableReverb(boolean enabled);
     public static native boolean createAudioRecorder();
+    public static native boolean setRecorderChunks(int frames, int count);
     public static native void startRecording();
+    public static native int stopRecording();
     public static native void shutdown();
 
     /** Load jni .so on initialization */
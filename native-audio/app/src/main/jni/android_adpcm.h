@@ -0,0 +1,209 @@
+#define ANDROID_ADPCM_FRAMES 6488
+	"\xfe\xff\x01\x00\x09\x91\x03\x19\x09\x12\x20\x99\x11\x0b\xb9\x11"
+	"\x93\x19\x19\x90\xab\x91\x12\x91\x39\x09\x12\x21\x99\x90\x91\x99"
+	"\x11\x19\x00\x91\x1a\x11\xbb\x11\x99\xb0\x10\x09\x09\x19\x13\xa3"
+	"\x32\x99\x22\x9b\x91\x99\x19\x11\x09\x11\x99\x10\xb0\x99\x99\x21"
+	"\x99\x00\xa1\x11\x30\x90\x2a\x90\x11\x11\x91\x1a\xb3\x39\xb0\x09"
+	"\x00\x00\x11\x99\x11\x10\x92\x91\x09\x0a\x3b\x90\x11\x0a\x01\x02"
+	"\x1a\x93\x09\x91\x90\x2b\x11\x99\x91\x09\x1a\x99\x99\x10\x09\x13"
+	"\x99\x93\x20\x21\x10\x1a\x00\x11\x09\x91\x9a\xb0\x19\x10\x99\x99"
+	"\x09\x90\x92\x10\x00\x10\x11\x21\x10\x10\x99\xb0\x11\x19\x99\x01"
+	"\x91\x10\x01\x09\xa0\x00\x10\x90\x11\x00\x10\x19\x92\x11\x9a\x11"
+	"\x99\x11\x91\x00\x0a\x91\x09\x99\x09\x09\x10\x91\x90\x10\x11\x01"
+	"\x21\x19\x03\x99\x93\x1b\xb0\x91\x01\xa9\xb9\x09\x19\x19\x39\x01"
+	"\x22\x19\x21\x90\x09\xa1\x00\x90\x19\x90\x00\x9a\x11\x99\x92\x19"
+	"\x93\x93\xb2\x01\x9d\x11\x8f\xb3\x95\x1f\xf5\x5f\xb9\x33\xaa\x17"
+	"\x0a\x82\x0b\x91\x98\x02\xf9\x93\xb1\x72\xaa\x08\xfa\x5e\x8c\x13"
+	"\x0a\x86\x88\x92\x0a\x00\x18\x32\x99\x94\xbc\xc0\x8c\x00\x28\x32"
+	"\x59\x00\x18\x00\x71\xe8\xaa\xd8\x28\x28\x33\x22\x96\x18\xb9\x8b"
+	"\xc2\x70\x01\x41\xa0\x88\x9e\xb9\x0a\xa0\x43\x08\xf0\xe1\x2b\x9b"
+	"\x52\x02\x35\x80\x12\x9a\x20\x19\x60\xa9\xb1\xfb\xa9\x9b\x18\x20"
+	"\x23\xa2\xf3\xd1\x28\xa0\xb7\x7f\xba\x51\xab\x15\x0a\x84\x09\x91"
+	"\x09\x10\x99\x23\xcb\x94\x8d\x90\x0b\x02\x28\x04\x90\x20\x8f\x00"
+	"\x09\x05\x28\x92\x10\xb8\x49\x9b\x40\x9c\x93\xab\xf3\xa9\xa8\xfb"
+	"\x40\x0e\x23\x2a\x87\x08\x91\x08\x00\x18\x11\x98\xd1\xc9\xe8\x29"
+	"\x0d\x03\x18\x84\x09\x98\x2a\x29\x59\x39\x0a\xf1\x70\xfb\x96\x0b"
+	"\x94\x3c\x92\x5a\xa0\x00\x98\x80\x01\x2a\x83\x0d\xc3\x0b\xb1\x3a"
+	"\x83\x68\x82\x88\xa1\x8c\x98\xa2\x51\x02\x59\xb8\x89\xc9\x18\x82"
+	"\x60\xa2\x49\xca\x19\x9c\xc4\x01\xf5\x40\x9b\x51\x9b\x05\x0a\x93"
+	"\x19\x80\x19\x39\xc0\x38\xeb\x91\xb8\x03\x18\x23\x08\x89\xc9\x0b"
+	"\xa6\x40\x92\x4a\x9b\xaa\x88\x80\x70\xd3\x53\xfa\x22\xad\x05\x1b"
+	"\x03\x2b\x92\x1b\x91\x88\x13\xba\xc3\xfc\x20\x8c\x42\x8a\x04\x9a"
+	"\x93\x09\x32\x19\x33\xae\x91\xad\x12\x8a\x03\x29\x0a\xe6\x71\xf0"
+	"\x7a\xba\x52\xaa\x43\xaa\x22\x9b\x10\x98\x30\xa4\x3a\xe3\x1c\xc2"
+	"\x39\xf4\x3a\x00\x33\x8b\x33\xd1\x18\xd0\x39\xa1\x68\x91\x19\xb2"
+	"\x2a\x91\x1d\xa3\x0c\x94\x1b\x85\x1b\x95\x1f\x89\xb1\x22\x95\x40"
+	"\xa0\x1c\xb0\x28\x93\x52\x80\x8a\xda\x9a\xa1\x30\x84\x10\xb1\x0d"
+	"\xb9\x00\x93\x33\xa0\x31\x0d\x14\x83\x40\x90\x4b\x03\x00\x57\x0b"
+	"\xc2\xce\x89\x8d\x39\x85\x31\xa3\x0c\x88\x0e\x13\x22\x13\xa8\xbc"
+	"\xbc\xab\xf3\x54\x0b\x43\xbb\x82\xd9\x21\x80\x30\x91\x9c\xb2\x0f"
+	"\x82\x3a\x62\xeb\x12\xab\x42\x08\x43\xa8\x98\x9a\xa0\x62\x01\x11"
+	"\xdb\xba\x8a\x8a\x73\x18\x12\xa9\x9c\xa1\x4c\x07\x18\x02\xbb\x00"
+	"\x8a\x32\x92\x0b\xf8\x8b\x00\x71\xf1\x3d\xd1\x4a\x03\x1a\x83\x9d"
+	"\x11\x99\x30\x05\x8a\x92\xcc\x18\xa8\x40\x03\x8a\x83\xbf\x11\x99"
+	"\x62\x81\x18\xa1\x8c\x11\x0a\x42\x99\x19\x80\x3e\x7b\xfb\x30\xf0"
+	"\x58\x91\x2a\x91\x9b\x22\xa8\x60\x92\x0c\x81\xab\x21\x90\x59\x83"
+	"\xab\x12\xce\x11\xa1\x31\x02\x0b\x91\xcb\x32\x88\x23\xa1\xe0\x12"
+	"\x9d\xc2\xaf\x87\x0d\x06\xa8\x11\xa9\x08\x12\x99\x54\xc8\x19\xa0"
+	"\x8b\x33\xa9\x51\xa2\x0d\x92\x8c\x21\x90\x12\x94\x99\x08\xc9\x48"
+	"\x92\x3a\x13\x0f\x10\x0e\xaf\x86\xb9\x17\xa0\x18\x98\x09\x30\x90"
+	"\x0c\x04\x3f\x00\x23\xdb\x08\xa0\x0a\x14\x89\x30\xb1\x8d\x92\xaa"
+	"\x52\x10\x29\x12\xfa\x28\xa0\x3a\x05\x0c\x13\xb9\x28\xff\x49\xd1"
+	"\x48\x02\x0b\x08\x8a\x29\x23\x09\x35\xdb\x0a\xa0\x8a\x15\x90\x11"
+	"\xa2\xac\x08\xc0\x38\x07\x09\x11\xd8\x09\x93\x0b\x25\x8a\x68\x89"
+	"\x0c\x9f\x12\xb8\x35\xa3\x99\x98\xaa\x30\x25\x28\x13\xec\x0a\xa8"
+	"\x1a\x33\x01\x11\xa3\xcf\x2a\xa8\x40\x16\x88\x80\xb9\x0a\x12\x0a"
+	"\x62\x91\x8c\xa3\xff\x28\x80\x49\x33\xa8\x99\x98\xab\x73\x02\x10"
+	"\x91\xbd\x89\xaa\x00\x34\x13\x20\xd2\xaf\x08\x90\x61\x84\x89\x91"
+	"\xaa\x19\x82\x9a\x27\xc9\x01\xf1\x2e\x00\x2b\x43\x80\x88\x90\xb9"
+	"\x28\x84\x11\x82\xc9\xbb\x99\xbb\x59\x33\x42\x03\xac\x90\x9e\x38"
+	"\x11\x90\x11\x09\xb0\x82\xcc\x0c\x24\x22\x15\xe0\xbb\xc8\x8c\x30"
+	"\x42\x99\x55\xa0\x40\x90\x00\x80\x12\x9c\x03\xbe\x00\xb9\x21\xe9"
+	"\x19\xa9\x01\x1a\x47\x99\x21\x80\x08\x11\xbd\x28\x80\x20\x96\x9f"
+	"\xd9\x19\xb0\x70\x82\x30\x02\x20\x08\x12\x9d\x13\xbc\x89\xa2\xbf"
+	"\x10\xc9\x29\x81\x9a\x51\x93\x39\x17\xaa\x21\xa1\x09\x98\x9d\x08"
+	"\x21\xd9\x2a\xdf\x2b\x91\x40\x14\x33\x11\x15\x90\x10\xa9\x89\xab"
+	"\x19\x02\x21\x00\xdb\x89\xbd\x0a\x90\x10\x34\xd0\x59\xa1\x39\x05"
+	"\x18\x10\x22\xa9\x90\xcd\x98\x0b\x13\x5a\xfa\x8c\xdb\x09\x18\x33"
+	"\x51\x26\x11\x22\x11\x00\x98\xba\xba\x9f\xb9\x9c\x99\xab\x89\xb8"
+	"\x90\x21\x57\x01\x12\x01\x21\xb1\x1b\xfa\x89\x18\x72\xb9\x0f\xd9"
+	"\x0b\x92\x38\x24\x34\x24\x14\x10\x01\x99\xaa\xb9\xae\xaa\xbd\xba"
+	"\xaa\x9a\x39\x44\x20\x56\x21\x10\x10\xb1\x0a\xc0\xdb\x9a\xe9\x29"
+	"\x00\x98\x0f\xb0\x0d\x82\x49\x23\x73\x22\x23\x20\x82\x89\xc0\xab"
+	"\xbe\xba\xbe\xa8\x9a\x99\x28\x21\x45\x33\x24\x12\x10\x81\xab\xa8"
+	"\xce\x9a\xb8\x9a\x86\x10\xa0\x2f\xda\x1b\xa9\x32\x40\x27\x41\x14"
+	"\x28\x02\x88\x98\xa9\xbd\xca\xbc\xab\xbb\x9b\x00\x51\x33\x35\x43"
+	"\x11\x21\xa1\x09\xc8\xbc\x99\x99\x1a\x51\x11\x34\x84\xd2\xdd\xab"
+	"\xbc\x09\x20\x53\x44\x43\x13\x33\x12\x81\x90\xda\xcd\xaa\xbd\xab"
+	"\xab\xaa\x28\x21\x54\x23\x34\x23\x22\x11\x08\xb9\xda\xbb\xc9\x98"
+	"\x20\x01\x28\x90\xcc\xcd\xca\xac\xcb\x09\x10\x65\x33\x54\x23\x22"
+	"\x12\x81\xa9\xdb\xbc\xbd\xac\xbc\xab\x9a\x08\x32\x35\x44\x33\x23"
+	"\x22\x01\x88\x90\xb9\xcb\xeb\x9c\xa9\x99\x10\x12\x21\x02\x99\xbc"
+	"\x67\xff\x1a\x00\xaa\x9a\xa9\x48\x44\x44\x43\x33\x23\x11\x08\xda"
+	"\xaa\xeb\xbb\xbc\xcb\xab\xaa\x8a\x20\x34\x44\x25\x22\x22\x10\x12"
+	"\x00\xa8\xa9\xfc\xaa\x9a\x9a\x20\x24\x24\x43\x02\x00\x9a\xda\x9f"
+	"\xb9\xbe\xba\xaa\x0a\x53\x53\x44\x24\x32\x23\x11\x01\xa9\xcb\xdb"
+	"\xcd\xba\xbc\xbb\x9a\x99\x21\x33\x36\x24\x43\x32\x23\x22\x12\xa8"
+	"\x99\xac\xdb\xaa\x98\xbb\xbf\x09\xf9\x2d\x27\xaa\x10\xc0\xbb\x0a"
+	"\x14\xb8\x70\x13\x88\x42\x23\x10\x49\x07\x98\x91\xfb\x19\xdb\x0a"
+	"\xa0\xac\x81\x32\x03\x12\x71\x84\x80\x63\x81\xa8\x6b\xc8\x09\x0a"
+	"\xb9\x00\x99\x3b\x02\xa8\xa7\x63\x08\x92\x30\x98\xa0\x38\xf4\x98"
+	"\x58\xc9\x18\x30\x9f\x04\x8a\x11\x09\x94\xaa\x17\x98\x09\x13\xbf"
+	"\x51\xaa\x59\x98\x90\x22\x0a\x5a\x29\xa8\x84\xc0\x93\xc3\x1b\xa5"
+	"\x9c\x85\xb9\x51\x9a\x78\x99\x01\x81\x19\x01\x2c\x11\xbb\x93\xa7"
+	"\x2c\x90\x1a\x90\xd8\x14\xb8\x22\x30\x8a\x14\x2a\x38\xeb\x80\xf2"
+	"\x00\xab\x02\xb2\x4e\x20\x29\x8b\x87\xa2\x3c\xa2\xd8\x11\x3a\x8f"
+	"\x01\xd1\x91\x03\x18\x2b\xa7\x10\x98\x21\x88\x4f\x8a\xa0\xc2\x10"
+	"\xb0\x08\x13\x1d\x78\x98\x01\xa4\x80\x40\x9b\x58\x1d\xb8\x12\xda"
+	"\x22\xff\x2a\x00\x30\xcb\x32\x1a\x1b\xb4\x21\xf4\xa3\x11\x2b\x4e"
+	"\xa8\x80\x20\x9b\x31\xf2\x3a\xb4\x48\x1c\x82\xc1\x29\xa8\xc4\x2a"
+	"\x81\x18\x29\x13\x38\x04\xe2\x42\x0b\xab\x18\xf0\x0b\x00\x2f\xa1"
+	"\x59\x19\x80\x08\x20\xd7\x00\x11\xca\x30\xe2\x18\x10\x2b\xc2\x10"
+	"\x28\xb8\x4d\xd3\x08\x80\x88\x8a\x01\x8c\x16\x10\x40\x11\x81\x00"
+	"\xf8\x40\x9e\x91\x19\xd8\x18\x10\x99\x21\x03\x08\x6a\xb0\x12\x9c"
+	"\x10\xa5\x8c\x83\x2a\x2d\xb1\x31\xa4\x0b\x15\x98\x80\x1b\x9a\xcf"
+	"\x89\x01\x12\x50\x17\x01\x00\x32\xca\x99\x1a\xfa\x8b\xa0\x09\xd0"
+	"\x30\x84\x18\x13\x7b\xd3\x3a\x10\xa8\x0a\x00\xd2\x1d\xd3\x22\xaa"
+	"\x82\x04\x1b\x50\x9b\xa0\xec\x89\x20\x20\x35\x25\x02\x00\x90\xc9"
+	"\xc9\x0b\xda\x9a\x08\x18\x98\x48\x04\xc9\x21\x84\x31\x78\xa1\x01"
+	"\xba\x13\x1f\x18\xa9\xe3\x1b\x80\x10\xa0\x37\xd1\x28\x90\xfb\xaf"
+	"\x28\x12\x20\x27\x82\x88\x81\xb9\x9c\x99\x8a\x08\x98\x22\x91\xba"
+	"\x19\x42\x22\x9a\xea\xba\x55\x32\x32\x15\xc8\x8c\x28\x89\x90\xa1"
+	"\x14\xdf\x29\x01\x88\x02\x90\xf9\xff\x0a\x12\x32\x54\x11\x89\x88"
+	"\xb9\xcc\x08\x00\x88\x11\x11\x18\xa8\xbc\x29\x03\xba\x0a\xa9\x58"
+	"\x59\xff\x28\x00\x22\x00\x11\xb0\x9c\x21\x82\xa9\xb9\x52\xe9\x8b"
+	"\x21\x21\x88\xfe\xef\x9a\x31\x33\x45\x13\xa8\x9a\x98\xbd\x8a\x21"
+	"\x12\x11\x80\x88\xb8\xbf\x8b\x42\x02\x88\x98\x09\x42\x02\x20\x34"
+	"\x81\x1a\x11\x03\xfb\xa9\xa9\xba\x0a\x81\x28\x77\xf9\xff\x1b\x22"
+	"\x32\x45\x91\xa9\x89\xb9\xac\x20\x23\x33\x82\xca\xaa\xcc\xab\x30"
+	"\x25\x12\x98\xbd\x19\x14\x88\x51\x12\x88\x11\x90\xaa\xba\xac\x08"
+	"\x82\x89\x62\x13\xff\xdf\x19\x31\x42\x43\x81\xbb\xaa\xba\x9a\x42"
+	"\x44\x23\xa0\xcc\xaa\x9a\x0a\x52\x34\x33\xb0\xcf\x9a\x10\x21\x43"
+	"\x03\x99\xba\xbb\x19\x32\x23\x92\xbb\x72\x02\xc9\xfc\xdf\x19\x33"
+	"\x33\x24\xa0\xbc\xaa\xab\x28\x44\x34\x12\xc9\xad\xaa\x8a\x31\x34"
+	"\x25\x02\xca\xcc\x8a\x20\x23\x33\x01\xba\xab\xbb\x09\x23\x12\x53"
+	"\x91\x31\x96\xff\x9f\x00\x42\x33\x02\xaa\xbc\xab\x89\x20\x73\x24"
+	"\x80\xba\xcc\xaa\x10\x33\x35\x23\x98\xcc\xbc\x99\x18\x54\x23\x01"
+	"\xb8\xbe\x8a\x30\x43\x03\xa9\x9a\x99\x08\xa0\xae\xca\xbd\x61\x25"
+	"\x32\x02\xda\xab\xab\x18\x32\x44\x25\xa0\xdb\xbc\x0b\x41\x32\x24"
+	"\x01\x99\xbc\xae\x88\x10\x63\x23\x80\xb9\xbd\x8a\x21\x53\x03\x99"
+	"\x3d\x03\x20\x00\xee\x8b\x02\xda\xa9\xdf\x1a\x44\x43\x23\xa9\xbc"
+	"\xbb\x8a\x21\x63\x35\x81\xba\xce\x9a\x10\x32\x43\x12\x80\xda\xac"
+	"\x9a\x28\x33\x33\x24\x91\xca\xbd\x8c\x31\x44\x12\xa8\x9a\xab\x9b"
+	"\x80\x0a\x54\xf9\x9f\x11\x32\x25\x81\x99\xcb\x8c\x80\x28\x36\x12"
+	"\x99\xdc\x9b\x88\x10\x44\x22\x12\xd8\xbc\xaa\x19\x34\x23\x21\x90"
+	"\xbb\xcb\x8a\x21\x42\x35\x12\x88\xdb\xcc\xaa\x89\x52\x22\x01\xfe"
+	"\x8a\x11\x42\x34\x00\xa8\xcc\x8a\x98\x51\x24\x01\xa8\xbd\xaa\x99"
+	"\x30\x45\x32\x82\xcc\xbb\x9b\x31\x34\x34\x03\xb9\xcd\xaa\x20\x34"
+	"\x23\x80\xba\x99\x9a\xa9\xcc\x9b\x30\x46\x13\xb8\xde\xbb\x20\x53"
+	"\x45\x02\x90\xba\x9c\x89\x18\x43\x23\x81\xdc\xcb\x9a\x18\x43\x43"
+	"\x01\xb9\xbb\x9a\x41\x33\x33\x13\x00\xfa\xac\x88\x89\x13\x12\xf4"
+	"\xff\x18\x11\x32\x03\x88\xe9\x9c\x80\x18\x44\x02\x80\xda\x9b\x99"
+	"\x19\x53\x43\x13\xb9\xae\xab\x18\x21\x43\x23\x01\xeb\xbb\x89\x00"
+	"\x52\x34\x13\xba\xab\xaa\x89\xdc\x09\x88\x39\x24\x72\x24\xa9\xab"
+	"\x8c\x21\x80\x72\x24\x80\xcb\xab\x9a\x9b\x41\x45\x23\xb9\xbb\xbb"
+	"\xac\x09\x48\x57\x02\x00\x98\xcb\xbc\x30\x26\x01\x88\x99\xcb\x9b"
+	"\xc4\xfb\x2c\x00\x81\x2a\xb2\x4c\x27\x08\x23\xa8\x80\xcd\x18\xa8"
+	"\x38\x26\x10\xa0\xad\xc9\x9b\x41\x43\x03\x98\x98\xdc\x9a\x28\x35"
+	"\x01\x10\x91\xbb\xad\x20\x01\x19\x24\x00\xe0\xcf\x99\x09\x73\x32"
+	"\x33\xa0\xcb\xcc\x8b\x10\x44\x13\x88\xa8\xbd\xbb\x1a\x44\x33\x34"
+	"\x91\xea\xac\x8a\x08\x10\x54\x03\x08\x80\xdb\xab\x28\x35\x11\x23"
+	"\xc9\xbd\x9a\x80\xdc\x28\xa3\x29\x47\x22\xa8\x09\xa1\xbf\x28\x22"
+	"\x81\x40\x03\xdd\x99\xb8\x8a\x63\x23\x88\x21\xd8\xac\x10\x80\x21"
+	"\x44\x91\x89\xd9\xbc\x08\x10\x21\x52\x92\xfd\x29\x91\x5b\x26\x88"
+	"\x80\x88\xda\x8b\x12\x88\x42\x12\xb9\x9c\xb8\x9e\x43\x12\x21\x13"
+	"\xc9\xad\x89\xaa\x48\x24\x10\x01\xa8\xce\x19\x90\x48\x35\x11\x88"
+	"\xb8\xdc\x89\x00\x21\x23\x81\xbc\xab\xb9\x9f\x18\x8a\x42\x45\x34"
+	"\x21\x01\xda\xbb\xab\x9a\x20\x44\x23\x81\xda\xcc\x9a\x10\x53\x53"
+	"\x82\x98\xca\xbb\xab\x9a\x10\x30\x36\x34\x23\x22\xa1\x9b\x01\x9a"
+	"\x44\xa8\xaa\xdf\xab\x9a\x9a\x21\x12\x43\x42\x23\x49\x04\xff\x10"
+	"\xba\x62\x02\x12\x81\xb8\xad\xba\x0a\x02\x32\x04\x08\xbc\x99\x8a"
+	"\x75\x21\xe8\x3d\xc1\x2c\x15\x88\x22\x90\xcb\x09\xca\x38\x82\x38"
+	"\xa2\x02\x22\x00\x97\x9a\xc8\xbd\x0a\x91\x40\x25\x01\x10\xb3\xcf"
+	"\x00\xba\x62\x12\x10\x01\xc9\x0b\xa0\x1a\x25\x9a\x10\xfb\x8a\xb8"
+	"\x9f\x10\x08\x53\x53\x22\x22\x91\xbb\xc9\xad\x89\x88\x00\x89\x90"
+	"\x9a\x08\x41\x14\x51\x04\x1a\x01\xde\xa9\xbb\x9a\x51\x43\x54\x22"
+	"\x01\x80\xaa\x9b\xb9\x8c\x98\xac\xa9\x9a\x9a\x42\x44\x12\x42\x92"
+	"\x88\x08\xa8\xff\x8f\x80\x2b\x36\x11\x23\x92\xaa\xba\xbd\x88\xb9"
+	"\x29\xc1\x9e\x01\x9b\x53\x12\x32\x25\x88\x02\xa8\x08\xa8\x9d\x00"
+	"\xbf\x28\xca\x2a\x33\x20\x45\x82\x88\xa8\xec\xa8\xb8\x92\x01\x07"
+	"\xa1\xd2\x2f\xc1\x3c\x14\x18\x31\x83\xa9\x85\xbc\x80\xdb\xb9\x81"
+	"\xbb\x43\x80\x53\x32\x21\x41\x98\x8b\xa8\xae\x88\x89\x29\x04\x00"
+	"\x03\xcb\x88\x80\x1a\x46\xa8\x11\xe8\x8a\x88\xab\x61\x91\x41\x92"
+	"\x01\x8c\x98\x01\x32\x23\x12\xa3\x0a\xb1\x78\x16\x38\x88\xeb\xad"
+	"\x9d\xaa\x99\x88\x28\x02\x54\x05\x22\x13\x12\xa1\x99\xcc\xbe\xab"
+	"\xbc\x1b\x91\x40\x33\x63\x31\x23\x43\x33\x33\x36\x80\x08\xf9\xcb"
+	"\xbb\xda\xab\xa8\x8a\x08\x00\x01\x46\x01\x60\x81\x18\x10\x80\x32"
+	"\x83\x24\x10\xb2\x01\xa7\x29\xb2\x11\xcf\xa8\xce\x9a\xab\xab\x89"
+	"\xe8\xfd\x14\x00\x8b\x00\x35\x45\x37\x32\x34\x13\x02\x01\xba\xac"
+	"\xcb\xbb\xcb\xcb\xaa\xea\xaa\xaa\xaa\x28\x12\x63\x25\x22\x63\x02"
+	"\x10\x00\x88\x89\x23\x18\x36\x11\x12\x81\xec\xab\xce\xab\xbb\xac"
+	"\x8a\x89\x18\x44\x32\x26\x32\x31\x11\x92\x0a\x00\x00\x53\x26\x21"
+	"\x03\x99\xfb\xcb\xdb\xaa\xba\xaa\xb9\x09\xc2\x11\x15\x44\x43\x35"
+	"\x12\x22\x1a\x3f\xbc\xe2\xb0\xd2\x6f\x89\x11\xb1\xa7\x88\xa8\x21"
+	"\x1b\x38\x10\xb1\x1a\x99\x4d\xb8\x22\xa0\x97\x2a\xb0\x50\x0a\x13"
+	"\x08\xb7\x10\x8b\x80\x8d\xb1\x49\x0b\x30\x3c\xe9\x94\x01\x21\x22"
+	"\x5c\x9b\xb9\x8a\xf0\x10\x80\x88\xa5\x4b\x85\x49\x13\x01\x31\xd0"
+	"\x1c\xd8\x8a\x99\xa9\x28\x91\x59\x03\x09\x04\xa8\x11\xb0\x4b\x93"
+	"\x0d\x81\x88\x4b\x83\x10\x85\x91\x2b\xf8\x0b\xba\x08\x7b\x01\x61"
+	"\x01\x22\x02\x90\x99\xe9\x0c\xb1\x1b\xa8\x08\x3b\xbb\x44\xc0\x26"
+	"\xa9\x09\xe8\x9b\x08\x9a\x33\x90\x21\x27\x9f\x03\x1d\x01\x37\x29"
+	"\x26\x8a\x91\xd0\x8a\xb0\x8d\x81\x9a\x12\x03\x39\x07\x0a\x91\x90"
+	"\x0a\x84\x0c\x84\x09\x9b\x90\xbf\x80\x90\x4a\x17\x1b\x86\x8a\x02"
+	"\xa9\x10\x89\x98\x35\x40\x04\x22\x99\x82\xbc\x0a\xf1\x2a\xd9\x01"
+	"\xc6\xff\x0f\x00\x71\xca\x02\x8d\xa9\x10\xa0\x73\x91\x31\x08\x01"
+	"\x20\xd3\x20\x0a\xca\x22\xaf\x01\x2c\xa0\x42\xb1\x34\x8d\x01\x8a"
+	"\x98\x14\x9f\x04\x0a\x83\x53\x00\x71\x90\x28\xe8\x09\xaa\xb9\x3d"
+	"\xd2\x3b\xa5\x1b\x02\x99\x60\xa2\x5b\x94\x1a\x03\x99\x21\xc8\x1d"
+	"\x92\x8d\x04\xaa\x41\xa8\x3a\x83\x9f\x21\xca\x30\xa1\x1a\x14\xab"
+	"\x35\xa9\x31\xa1\x1d\x81\x09\x30\x02\x8c\x84\xa9\x33\xe1\x50\xba"
+	"\x80\x09\x9a\xb9\x82\xa9\x65\x20\x38\x21\xdb\xb2\x8d\x09\xab\x8a"
+	"\xf3\xba\x39\xaa\x79\xb2\x21\x03\x1c\x45\x90\x34\x18\x28\x10\x98"
+	"\x10\xbd\x25\xeb\x11\xd0\xaa\xa2\x9e\x30\x9a\x32\xb4\x38\x33\x9b"
+	"\x63\xda\x00\x91\x0a\x42\x8c\x12\xa0\x5a\x85\x1c\x02\xc9\x08\xc8"
+	"\x29\xa3\x0b\x05\x9c\x23\x10\x19\x25\x9b\x35\xb9\x70\x9a\xb9\x98"
+	"\xaa\x5b\xe1\x89\xb2\x20\x84\x02\x3b\xa2\x5b\x93\x35\x09\xa9\x49"
+	"\xb1\xc2\x72\xaa\x41\x98\x18\xa0\xd9\x1b\xb9\xb0\xb1\x1d\x95\x20"
+	"\x90\x25\x39\x13\x49\xda\x9a\xda\x2b\x7a\x82\x80\x80\x80\x80\x90"
+	"\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+	"\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2010 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * Lock-free single producer / single consumer queue of chunk indices, for
+ * handing audio chunks between an OpenSL ES callback and a thread of ours
+ * without either one ever blocking.
+ */
+#ifndef NATIVE_AUDIO_CHUNK_QUEUE_H
+#define NATIVE_AUDIO_CHUNK_QUEUE_H
+
+#include <stdint.h>
+
+/*
+ * CHUNK_QUEUE_MAX: slots per queue, a power of 2; also the most chunks a
+ *                  pool handed around through these queues may have
+ */
+#define CHUNK_QUEUE_MAX  64
+
+typedef struct {
+    uint32_t head;      // next slot to pop, written by the consumer only
+    uint32_t tail;      // next slot to push, written by the producer only
+    int      slots[CHUNK_QUEUE_MAX];
+} ChunkQueue;
+
+static inline void chunkQueueInit(ChunkQueue *q) {
+    __atomic_store_n(&q->head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&q->tail, 0, __ATOMIC_RELAXED);
+}
+
+// producer side; 0 when the queue is full
+static inline int chunkQueuePush(ChunkQueue *q, int chunk) {
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    if (tail - __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) >= CHUNK_QUEUE_MAX) {
+        return 0;
+    }
+    q->slots[tail & (CHUNK_QUEUE_MAX - 1)] = chunk;
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// consumer side; 0 when the queue is empty
+static inline int chunkQueuePop(ChunkQueue *q, int *chunk) {
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    if (head == __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    *chunk = q->slots[head & (CHUNK_QUEUE_MAX - 1)];
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+#endif //NATIVE_AUDIO_CHUNK_QUEUE_H
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2010 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include "clip_cache.h"
+
+void clipCacheInit(ClipCache *cache, uint32_t budget) {
+    for (int i = 0; i < CLIP_CACHE_SLOTS; i++) {
+        ClipCacheEntry *e = &cache->entries[i];
+        e->key = 0;
+        e->pins = 0;
+        e->lastUse = 0;
+        e->data = NULL;
+        e->frames = 0;
+    }
+    cache->budget = budget;
+    cache->used = 0;
+    cache->clock = 0;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+int clipCacheAcquire(ClipCache *cache, uint32_t key) {
+    for (int i = 0; i < CLIP_CACHE_SLOTS; i++) {
+        ClipCacheEntry *e = &cache->entries[i];
+        if (key != __atomic_load_n(&e->key, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        int pins = __atomic_load_n(&e->pins, __ATOMIC_RELAXED);
+        while (pins >= 0 &&
+               !__atomic_compare_exchange_n(&e->pins, &pins, pins + 1, 0,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        }
+        if (pins < 0) {
+            continue;       // being evicted
+        }
+        // pinned: the key can no longer change under us, but may have
+        // before the pin went in
+        if (key != __atomic_load_n(&e->key, __ATOMIC_ACQUIRE)) {
+            clipCacheRelease(cache, i);
+            continue;
+        }
+        __atomic_store_n(&e->lastUse, __atomic_add_fetch(&cache->clock, 1, __ATOMIC_RELAXED),
+                         __ATOMIC_RELAXED);
+        return i;
+    }
+    return -1;
+}
+
+void clipCacheRelease(ClipCache *cache, int slot) {
+    __atomic_sub_fetch(&cache->entries[slot].pins, 1, __ATOMIC_RELEASE);
+}
+
+int clipCacheContains(ClipCache *cache, uint32_t key) {
+    for (int i = 0; i < CLIP_CACHE_SLOTS; i++) {
+        if (key == __atomic_load_n(&cache->entries[i].key, __ATOMIC_RELAXED)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// takes the entry away from readers; 0 when it is pinned
+static int lockEntry(ClipCacheEntry *e) {
+    int unpinned = 0;
+    return __atomic_compare_exchange_n(&e->pins, &unpinned, -1, 0,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static void unlockEntry(ClipCacheEntry *e) {
+    __atomic_store_n(&e->pins, 0, __ATOMIC_RELEASE);
+}
+
+// frees a locked entry
+static void dropEntry(ClipCache *cache, ClipCacheEntry *e) {
+    if (e->key) {
+        __atomic_store_n(&e->key, 0, __ATOMIC_RELAXED);
+        cache->used -= e->frames * sizeof(short);
+        free(e->data);
+        e->data = NULL;
+        e->frames = 0;
+    }
+}
+
+int clipCacheInsert(ClipCache *cache, uint32_t key, short *data, uint32_t frames) {
+    uint32_t bytes = frames * sizeof(short);
+    if (!key || bytes > cache->budget) {
+        return 0;
+    }
+    // an empty slot for it, else the least recently used one; then evict
+    // least recently used entries until it fits
+    ClipCacheEntry *slot = NULL;
+    for (int i = 0; i < CLIP_CACHE_SLOTS && !slot; i++) {
+        ClipCacheEntry *e = &cache->entries[i];
+        if (!e->key && lockEntry(e)) {
+            slot = e;
+        }
+    }
+    while (!slot || cache->used + bytes > cache->budget) {
+        ClipCacheEntry *victim = NULL;
+        for (int i = 0; i < CLIP_CACHE_SLOTS; i++) {
+            ClipCacheEntry *e = &cache->entries[i];
+            if (e == slot || !e->key || __atomic_load_n(&e->pins, __ATOMIC_RELAXED)) {
+                continue;
+            }
+            if (!victim || (int32_t)(e->lastUse - victim->lastUse) < 0) {
+                victim = e;
+            }
+        }
+        if (!victim) {
+            // the rest is pinned
+            if (slot) {
+                unlockEntry(slot);
+            }
+            return 0;
+        }
+        if (!lockEntry(victim)) {
+            continue;       // pinned since we looked
+        }
+        dropEntry(cache, victim);
+        if (slot) {
+            unlockEntry(victim);
+        } else {
+            slot = victim;
+        }
+    }
+    slot->data = data;
+    slot->frames = frames;
+    slot->lastUse = __atomic_add_fetch(&cache->clock, 1, __ATOMIC_RELAXED);
+    cache->used += bytes;
+    __atomic_store_n(&slot->key, key, __ATOMIC_RELEASE);
+    unlockEntry(slot);
+    return 1;
+}
+
+void clipCacheClear(ClipCache *cache) {
+    for (int i = 0; i < CLIP_CACHE_SLOTS; i++) {
+        ClipCacheEntry *e = &cache->entries[i];
+        assert(0 == e->pins);
+        dropEntry(cache, e);
+    }
+}
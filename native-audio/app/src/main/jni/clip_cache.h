@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2010 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * Memory budgeted LRU cache of clips already converted to the player rate,
+ * so replaying a clip is a copy instead of a decode and a resample. Lookups
+ * are lock-free and never allocate; entries are added and evicted by one
+ * thread only ( the clip warmer in native-audio-jni.c ).
+ */
+#ifndef NATIVE_AUDIO_CLIP_CACHE_H
+#define NATIVE_AUDIO_CLIP_CACHE_H
+
+#include <stdint.h>
+
+/*
+ * clip cache controls:
+ *   CLIP_CACHE_SLOTS:  most entries held at a time
+ *   CLIP_CACHE_BUDGET: default bytes of PCM held at a time, all entries
+ *                      together
+ */
+#define CLIP_CACHE_SLOTS   8
+#define CLIP_CACHE_BUDGET  (512 * 1024)
+
+/*
+ * entry keys are non zero: CLIP_CACHE_KEY() packs the clip and the rate
+ * ( Hz ) it was converted to; the format is always mono 16-bit
+ */
+#define CLIP_CACHE_KEY(clip, rateHz)  ((uint32_t)(clip) << 24 | (uint32_t)(rateHz))
+
+typedef struct {
+    uint32_t key;       // 0: empty
+    int      pins;      // readers using data; -1 while the writer owns the slot
+    uint32_t lastUse;
+    short    *data;
+    uint32_t frames;
+} ClipCacheEntry;
+
+typedef struct {
+    ClipCacheEntry entries[CLIP_CACHE_SLOTS];
+    uint32_t       budget;      // bytes
+    uint32_t       used;        // bytes, written by the writer only
+    uint32_t       clock;       // LRU stamps
+} ClipCache;
+
+void clipCacheInit(ClipCache *cache, uint32_t budget);
+
+/*
+ * clipCacheAcquire(): pins the entry for key and returns its slot, or -1
+ * when it is not cached; a pinned entry is never evicted, and stays valid
+ * until clipCacheRelease(). Any thread, the audio callback included.
+ */
+int  clipCacheAcquire(ClipCache *cache, uint32_t key);
+void clipCacheRelease(ClipCache *cache, int slot);
+
+static inline const short *clipCacheData(const ClipCache *cache, int slot, uint32_t *frames) {
+    *frames = cache->entries[slot].frames;
+    return cache->entries[slot].data;
+}
+
+/*
+ * writer side, one thread only:
+ *   clipCacheContains(): whether key is cached
+ *   clipCacheInsert():   takes ownership of data ( malloc'ed ), evicting
+ *                        least recently used entries that are not pinned
+ *                        to stay in budget; 0 when it does not fit, and
+ *                        data stays with the caller
+ *   clipCacheClear():    frees every entry; nothing may be pinned
+ */
+int  clipCacheContains(ClipCache *cache, uint32_t key);
+int  clipCacheInsert(ClipCache *cache, uint32_t key, short *data, uint32_t frames);
+void clipCacheClear(ClipCache *cache);
+
+#endif //NATIVE_AUDIO_CLIP_CACHE_H
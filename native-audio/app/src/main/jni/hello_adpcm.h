@@ -0,0 +1,177 @@
+#define HELLO_ADPCM_FRAMES 5480
+	"\x00\x00\x00\x00\x3a\xd0\x21\xa1\x22\x03\xb9\x19\xb1\x3a\xb3\x0b"
+	"\x13\xcb\x32\x2c\xa0\x9b\x90\xb5\x29\x32\xdb\x30\xc1\x19\xb2\x00"
+	"\x09\x10\x91\x3b\x31\xab\x29\x12\x99\x15\xc2\x90\x1a\x8f\x23\x0b"
+	"\x02\xb8\xbb\x1a\x43\x09\x85\xa0\x3a\x15\x8b\xb8\xa9\xcd\x52\xa1"
+	"\x11\x09\x0d\x32\x2d\x12\x98\x8b\x86\xa9\x12\xb1\xbc\x11\x99\x15"
+	"\xb1\x70\xa8\x3b\x0b\x05\x2c\xa1\x10\x1f\xa1\x30\xd9\x13\x98\xb1"
+	"\x34\xba\x25\x1d\x98\x3b\x19\xb2\x6b\xa0\x0a\x93\xf1\x11\xb2\x29"
+	"\x22\xba\x1f\x08\x21\x0d\x04\x19\xb9\x43\xf9\x8a\x13\x9b\x12\xb5"
+	"\x89\x3c\x22\xbb\x73\x90\x8c\x50\xb1\xb8\x03\x80\x2f\x43\x09\xd9"
+	"\x11\xbb\x07\x09\x01\x19\xca\x41\x0a\xd1\x30\xba\x14\x5d\xb2\x09"
+	"\xa9\x94\x2d\x01\x13\x9f\x81\x19\xa9\x14\x01\xe8\x21\x81\x80\x2a"
+	"\x38\x30\x79\xa3\xc0\x8e\x82\x30\xa9\x94\x9e\xc8\x33\x11\x94\x0a"
+	"\xcf\x20\x29\x81\x12\xaf\xe8\x8a\xc8\xa9\x1a\x11\x73\x34\x34\x32"
+	"\x02\x12\x88\xb0\x08\xbd\xe9\xbb\xdd\x99\x0a\x01\x31\x10\xa0\x8d"
+	"\x19\x14\x40\x12\x12\xbb\xa9\xf1\xef\xba\xba\xba\x71\x37\x24\x02"
+	"\x98\xac\x9b\x41\x33\x82\xda\xdb\xba\x8a\x20\x33\x23\x12\x90\xbd"
+	"\x2f\xff\x25\x00\x98\x11\x33\x14\x82\xbc\xbd\xac\x9a\x00\x41\x32"
+	"\x53\x41\x31\x32\x01\xc1\xd8\xa8\xa2\xc0\xea\xba\xab\x09\x70\x42"
+	"\x21\x08\x89\x18\x20\x02\xa0\xda\xaa\xab\xf9\xab\xdc\xaa\xc9\xd8"
+	"\x98\x53\x47\x23\x02\xa8\xac\x8a\x40\x33\x81\xdb\xcc\xbb\x09\x32"
+	"\x16\x01\x88\x88\x98\x00\x31\x34\x82\xca\xbc\xcb\x9c\x19\x41\x20"
+	"\x59\x4c\x39\x5a\x1a\xaf\xfd\x99\x34\x16\x03\xa8\xbc\x9c\x29\x52"
+	"\x32\x11\xba\xaf\x9b\x28\x43\x23\x02\xc8\xfb\xaa\x08\x34\x24\x81"
+	"\xaa\xcb\x99\x30\x42\x11\x90\x9a\x99\x89\x0a\x18\x16\x00\xfb\xa9"
+	"\xaa\xc2\x26\x44\x02\x88\x9b\xab\x0b\x58\x33\x23\xb9\xdd\xbc\xaa"
+	"\x20\x36\x23\x90\xdb\xab\x09\x53\x33\x13\xa0\xbb\xac\x89\x19\x18"
+	"\x43\x40\x80\x98\x8d\x88\xe2\xce\xad\x1a\x64\x34\x12\xb8\xcc\xab"
+	"\x19\x32\x45\x12\x98\xcc\xbb\x8a\x21\x35\x24\x01\xca\xcc\x8a\x20"
+	"\x53\x23\x91\xba\xac\x0a\x18\x31\x30\x40\x18\x89\xaa\xfb\xff\x99"
+	"\x22\x35\x23\x80\xbc\xac\x8a\x18\x61\x32\x12\xa9\xbd\xac\x0a\x21"
+	"\x25\x14\x82\xb8\xcc\xba\x88\x42\x53\x12\x80\xaa\xad\x9a\x28\x43"
+	"\x23\x00\xb9\xaa\xc0\xf0\xae\x89\x32\x55\x31\x80\xa9\x9c\x9a\x88"
+	"\x0a\xfa\x31\x00\x12\x44\x22\x80\xcb\xad\x9a\x28\x32\x24\x01\xaa"
+	"\xba\x88\x10\x80\x30\x72\x33\x03\xda\xcd\x9a\x10\x03\x84\x82\x05"
+	"\x94\xf2\xaf\x8b\x19\x72\x32\x12\x80\xaa\xa9\xaa\x9c\x98\x11\x14"
+	"\x03\x91\xa9\xaa\x80\x08\xdc\xca\x39\x73\x34\x01\xb9\xcb\x09\x30"
+	"\x13\xa9\x9f\x89\x32\x41\x10\x21\xf0\xfc\xba\x98\x41\x54\x22\x01"
+	"\x08\x9a\x9a\x9b\xbb\xcb\x99\x10\x43\x33\x34\x32\x80\xcd\xcc\xab"
+	"\x18\x45\x43\x01\xb9\xba\x90\x00\x9a\xac\x3a\x71\x34\xe1\xdb\x9b"
+	"\x88\x53\x53\x12\x02\x08\x98\xb9\xbc\xac\xa9\x08\x10\x00\x80\x38"
+	"\x54\x26\x12\xc8\xdb\x8a\x18\x12\x22\x10\x81\x92\xf8\xc9\x1a\x79"
+	"\x20\x90\xa8\x92\xc5\xbd\x9f\x89\x30\x54\x22\x11\x80\x91\x80\xaa"
+	"\xdc\xaa\xaa\x98\x01\x20\x12\x34\x53\x02\x98\xad\xac\x18\x52\x12"
+	"\x01\x10\x00\x91\xea\xbc\x0b\x58\x30\x19\xab\xff\xca\x99\x10\x35"
+	"\x44\x22\x01\x00\x88\xb9\xac\xad\xaa\x9a\x8a\x08\x32\x53\x34\x23"
+	"\x90\xc8\xb9\x9a\x80\x22\x41\x23\x26\x00\xda\xba\x1c\x2c\x99\x08"
+	"\xaa\xff\xdb\x99\x20\x35\x35\x22\x11\x11\x88\xc9\xbb\xad\xbc\xaa"
+	"\x8b\x81\x43\x51\x22\x23\x09\xc9\x98\x28\x32\x04\x8a\xab\x00\x09"
+	"\x36\x00\x32\x00\x88\x88\x00\x01\xb0\xbd\x9d\x09\x31\x63\x23\x24"
+	"\x22\x82\x98\xac\xdb\xb9\xbb\xcb\x8a\x19\x32\x45\x43\x13\x01\xab"
+	"\xdb\x98\x88\xa0\x12\x48\x03\x03\x1c\x8b\x70\x79\x09\x89\x89\xfa"
+	"\xfd\xa9\x80\x23\x63\x21\x22\x30\x18\x98\xab\xaf\xaa\xaa\xab\x99"
+	"\x28\x33\x27\x24\x11\xa1\xbb\xad\x88\x31\x28\x33\x33\x33\xf2\xb9"
+	"\xa9\x94\x12\xc9\x9d\x19\xff\x9d\x0a\x38\x34\x25\x11\x02\x02\x88"
+	"\xc9\xba\xac\xca\xa9\x9b\x09\x32\x73\x22\x13\x01\xae\xba\x29\x51"
+	"\x04\x21\x08\x98\x88\x9d\xc8\x81\x12\xb1\xaa\xff\x9e\x0a\x29\x73"
+	"\x32\x12\x01\x80\xa8\xca\xab\xba\xaa\xaa\x89\x31\x32\x36\x43\x32"
+	"\x90\xbf\x8e\x29\x69\x05\xa2\x80\xb9\xb8\x98\x28\x01\x62\x38\x8d"
+	"\xdf\x8c\x18\x32\x35\x04\x81\xa9\xb9\xba\x9a\x12\x25\x01\xa9\x9b"
+	"\x9d\xbb\x1a\x71\x43\x02\x89\x9a\x01\x21\x18\x99\x2c\x3a\x39\x1c"
+	"\x0c\x1b\x1b\xc1\xff\xff\x08\x22\x33\x43\x88\xca\x9c\x8a\x19\x63"
+	"\x32\x01\xba\xbe\xba\x99\x41\x44\x14\x81\xc9\xbc\x9a\x20\x44\x23"
+	"\x02\xba\xbc\xaa\x08\x32\x34\x04\x08\xfa\xbf\x89\x21\x34\x24\x02"
+	"\xc9\xbb\xab\x08\x63\x34\x02\xb9\xbd\xab\x8a\x30\x45\x33\x91\xdb"
+	"\xfa\xfa\x41\x00\x99\x00\x21\x22\x02\x90\xca\xba\x89\x01\x32\x16"
+	"\x94\xaf\x8d\x38\x41\x31\x81\xa8\xea\xb8\x90\x23\x26\x02\xa8\xbc"
+	"\xac\x8a\x40\x63\x32\x80\xbc\xbd\x99\x22\x26\x12\x91\xca\xbb\x88"
+	"\x13\x05\x02\x12\xa0\x8a\xff\x8f\x20\x21\x23\x82\xc9\xdb\x99\x00"
+	"\x33\x25\x83\xb9\xbd\x9c\x09\x31\x54\x22\x90\xbc\xad\x89\x21\x25"
+	"\x23\x90\xca\xac\x09\x21\x23\x12\x03\xc8\xbd\xca\x8f\x19\x42\x43"
+	"\x22\x98\xeb\xab\x98\x22\x35\x24\x90\xeb\xba\x89\x28\x52\x43\x01"
+	"\xaa\xaf\x8a\x10\x43\x23\x80\xba\xbc\x89\x12\x03\x04\x04\xd2\xf2"
+	"\x9d\x09\x42\x31\x21\x19\xbc\xac\x0a\x21\x26\x03\xb1\xe9\xb9\xa9"
+	"\x10\x34\x25\x02\xb9\xae\x8c\x19\x33\x25\x01\xa9\xbc\x9a\x28\x42"
+	"\x31\x30\x08\xda\x8d\xdd\x90\x21\x15\x14\x81\xb9\xad\x8a\x28\x52"
+	"\x42\x01\xb9\xbd\xaa\x08\x33\x35\x24\xa0\xcd\xab\x08\x24\x24\x81"
+	"\xa8\xba\xab\x18\x42\x22\x41\x38\x3c\xff\x8b\x30\x04\x84\x92\xc1"
+	"\xb9\xb9\x11\x43\x43\x00\xaa\x9d\x9c\x0a\x50\x42\x12\x90\xdb\xbb"
+	"\x9a\x43\x26\x11\x98\xca\xaa\x18\x21\x22\x13\x83\xe9\xf8\x8f\x08"
+	"\x41\x20\x12\x88\xea\xa9\x90\x03\x14\x13\x91\xdb\xcb\x8a\x20\x61"
+	"\x13\x05\x41\x00\x13\x91\xea\xbb\x1a\x53\x32\x01\x99\xac\x9b\x18"
+	"\x21\x23\x13\x14\xfa\xcf\x88\x23\x24\x12\x89\x9e\x8b\x2b\x40\x43"
+	"\x02\xa9\xdb\xa9\x99\x10\x35\x34\x82\xcb\xbd\x9b\x31\x35\x23\xa1"
+	"\xca\xcb\x89\x11\x22\x21\x62\x49\xbf\x9a\x19\x15\x23\x84\xb2\xdb"
+	"\xab\x1a\x52\x52\x10\x89\xab\xcb\x9a\x20\x36\x14\x81\xd9\xbb\x9b"
+	"\x51\x52\x11\x88\x9b\x9b\x89\x80\x22\x15\x04\xf2\xac\x89\x32\x61"
+	"\x21\x28\xbb\xad\x9b\x02\x26\x03\x91\xba\xcb\xaa\x0a\x71\x53\x12"
+	"\xa8\xbc\x9d\x08\x33\x15\x81\xb9\xb9\x99\x91\x81\x32\x26\x93\xcf"
+	"\x0c\x59\x20\x12\x82\xd1\xc9\xb9\x10\x42\x32\x10\x9b\xad\xab\xa9"
+	"\x31\x37\x24\x82\xdb\xbc\x89\x32\x24\x03\xa8\xbb\x9b\x09\x09\x59"
+	"\x61\x71\x9d\x99\x18\x85\x84\x82\xa1\xab\x9b\x2d\x40\x42\x81\xb8"
+	"\xc9\xb9\x99\x28\x64\x42\x01\xba\xad\x9a\x20\x34\x32\x90\xbb\xac"
+	"\x89\x88\x00\x72\x43\xf0\xba\x99\x24\x52\x21\x10\xac\xbb\xac\x11"
+	"\x35\x04\x00\xaa\xab\xad\x8a\x40\x35\x24\x98\xda\xba\x88\x22\x24"
+	"\x03\x98\xba\xbb\x9a\x09\x58\x73\x72\x0e\x8b\x19\x94\x05\x92\xa2"
+	"\x9a\x9b\x1c\x28\x53\x02\xa1\xc8\xaa\x9c\x1b\x78\x32\x13\xb0\xda"
+	"\xac\xfc\x37\x00\x8b\x28\x32\x14\x03\x98\xac\x9c\x8c\x08\x63\xe7"
+	"\x90\x98\x32\x79\x10\x19\xaa\xb8\xb8\x01\x52\x33\x28\x9c\xbb\xdb"
+	"\xb8\x01\x26\x34\x01\xa9\xad\x99\x09\x11\x15\x03\x90\xab\x9c\x0d"
+	"\x2a\x79\x8b\xc0\x92\x87\x15\x80\x88\x8c\x89\x8b\x81\x26\x83\x81"
+	"\x8c\x8c\x8b\x9a\x40\x24\x15\x91\xa8\xbb\x9a\x2b\x69\x41\x02\xa0"
+	"\xb9\xca\x8a\x29\xf1\xdb\x01\x37\x60\x00\x89\xba\x99\xb9\x00\x72"
+	"\x32\x10\xba\xca\xc9\xb8\x18\x44\x53\x02\x98\xbb\xaa\x8c\x19\x43"
+	"\x24\x81\xa9\xcb\xaa\x09\xf0\xae\x10\x55\x50\x10\x89\xba\xa9\xa9"
+	"\x88\x61\x42\x11\xa8\xca\xc9\xa8\x08\x32\x55\x12\x90\xba\xba\x9b"
+	"\x8a\x52\x34\x12\xa9\xcb\x9b\x1b\xfb\xad\x10\x47\x31\x11\x98\xcb"
+	"\xb9\xba\x09\x60\x33\x22\xb0\xc9\xdb\xaa\x1a\x31\x46\x23\x82\xb9"
+	"\xdb\x9c\x8a\x21\x24\x14\x98\xb9\xab\xa8\xef\x0b\x50\x14\x15\x81"
+	"\xa8\x9a\xba\xaa\xa8\x25\x24\x02\x09\xab\xac\xac\x09\x51\x25\x23"
+	"\x91\xa8\xdb\xcb\x8a\x30\x53\x12\xa0\xca\xa9\xf2\xad\x2a\x71\x41"
+	"\x12\x90\xb8\xa9\xab\x9a\x2a\x34\x24\xa2\x91\xba\xcc\xbb\x80\x55"
+	"\x33\x33\x19\xba\xcd\xcb\x98\x21\x33\x32\x89\x9d\x0a\xef\xaa\x00"
+	"\xf3\xf5\x3b\x00\x71\x12\x80\xb8\x99\x9a\xaa\x1b\x32\x35\x92\x91"
+	"\xa9\xdb\xab\xaa\x45\x44\x22\x18\xaa\xbb\xcd\xa8\x10\x33\x41\x98"
+	"\xa9\xb0\xef\xab\x20\x25\x27\x12\x98\x9a\xba\xaa\xab\x11\x61\x22"
+	"\x20\x99\xaa\xad\xba\x38\x36\x27\x11\x98\xba\xcb\x8a\x8a\x11\x22"
+	"\x05\x90\x09\xff\xb9\x00\x14\x36\x21\x81\xaa\xba\xab\xac\x18\x38"
+	"\x24\x21\x91\x98\xbd\xdb\x09\x44\x35\x12\x80\xca\xba\x9c\x99\x08"
+	"\x01\x33\x02\xf7\x8c\x9b\x48\x22\x27\x11\x91\x89\xca\xaa\xaa\x01"
+	"\x21\x02\x21\x00\x88\xbd\x9d\x29\x45\x53\x11\x80\xb9\xda\xaa\x99"
+	"\x89\x80\x10\x22\xf6\xbb\x0c\x40\x71\x13\x13\x98\x99\xab\xcb\x9b"
+	"\x98\x13\x02\x03\x1a\xa0\x9c\xca\x51\x45\x25\x11\x99\xaa\xba\xca"
+	"\xab\x8a\x1a\x88\x41\xff\xbb\x11\x16\x35\x22\x81\xa9\xc9\xaa\xab"
+	"\x09\x28\x31\x18\x88\x09\xbc\xb9\x31\x77\x24\x11\x88\x98\xa9\x9c"
+	"\xac\xaa\x88\x09\x4a\xff\xc9\x00\x33\x64\x21\x01\x98\xa9\xbb\xac"
+	"\x89\x18\x13\x13\x90\xa0\xbb\xda\x18\x37\x35\x12\x88\x98\x98\xbb"
+	"\xbe\xaa\x0a\x19\x18\xff\xaf\x80\x33\x35\x32\x01\x98\xa9\xbc\xad"
+	"\x8a\x19\x31\x22\x02\x98\x99\xa9\x88\x54\x34\x23\x82\x00\x88\xb9"
+	"\x3d\x03\x35\x00\x99\x99\x88\x00\xf9\xc9\x8a\x41\x54\x22\x02\x88"
+	"\x98\xaa\xbc\xac\x89\x10\x22\x12\x81\x81\x00\x10\x20\x52\x23\x24"
+	"\x10\x80\x00\xfa\xcd\xbc\xb9\xa8\xdf\xba\x10\x44\x27\x22\x81\x88"
+	"\xa9\xba\xdb\x9a\x0a\x20\x22\x01\x00\x28\x23\x23\x01\x30\x41\x17"
+	"\x02\xa8\x0a\x9e\xbb\xaf\xab\xef\xb9\x09\x42\x45\x23\x12\x80\x99"
+	"\xab\xbd\xab\xab\x00\x42\x12\x11\x00\x23\x23\x92\xaa\x0c\x72\x24"
+	"\x22\x99\xcb\xab\xdc\xcb\xdf\xaa\x88\x43\x45\x22\x02\x80\x90\xaa"
+	"\xbc\xbc\xaa\x88\x21\x22\x21\x31\x44\x23\x82\xcb\xcb\x08\x53\x23"
+	"\x83\xa9\xb9\xca\xfc\xcf\xac\x08\x32\x36\x32\x01\x00\x88\xa9\xbd"
+	"\xcb\xaa\x08\x20\x11\x11\x21\x34\x34\x82\xb9\xac\x0a\x52\x14\x81"
+	"\x9b\x8a\x10\xfa\xff\x9d\x08\x31\x24\x23\x11\x00\x81\xb9\xcd\xbc"
+	"\x9a\x08\x12\x11\x01\x22\x44\x22\x90\xbb\x9b\x31\x26\x02\xb8\xa9"
+	"\x09\xf0\xff\xbb\xaa\x31\x37\x24\x02\x80\x80\x80\xb8\xdc\xac\x9a"
+	"\x10\x11\x01\x10\x52\x43\x12\xba\xbc\x8a\x32\x34\x81\xb9\x9a\x10"
+	"\xa0\xff\xbf\x89\x20\x44\x23\x12\x00\x00\x90\xda\xcb\xac\x99\x00"
+	"\x01\x00\x21\x45\x23\x91\xba\xad\x18\x32\x04\x10\x8a\x19\xff\xda"
+	"\xf4\xf8\x34\x00\x89\x10\x34\x33\x12\x08\x08\x00\xb9\xde\xbb\x9b"
+	"\x10\x32\x12\x08\x21\x36\x14\xa0\xbd\x9b\x20\x34\x12\x98\x99\x10"
+	"\xc2\xff\xad\x8a\x21\x36\x32\x01\x08\x08\x80\xba\xdd\xbb\x8a\x20"
+	"\x31\x11\x21\x43\x34\x81\xdb\xad\x8a\x32\x24\x12\x09\x08\x21\xfd"
+	"\xcd\xac\x08\x52\x33\x23\x00\x00\x11\x90\xec\xbc\xaa\x08\x12\x11"
+	"\x08\x31\x54\x23\xa0\xcc\xbb\x19\x33\x24\x90\x90\x21\x94\xbf\xcf"
+	"\x9a\x28\x35\x33\x81\x00\x20\x12\xb9\xcf\xab\x8a\x11\x01\x98\x08"
+	"\x63\x24\x02\xca\xbb\x0a\x41\x23\x01\x00\x31\x15\xfb\xcf\x9c\x09"
+	"\x42\x43\x11\x00\x18\x11\x91\xda\xbd\x9a\x18\x11\x80\x99\x20\x45"
+	"\x33\x90\xeb\xaa\x18\x31\x12\x98\x18\x63\x83\xed\xcd\x9a\x20\x34"
+	"\x24\x00\x00\x11\x02\xa9\xcd\xbb\x99\x80\x88\x88\x10\x45\x24\x02"
+	"\xa9\xbb\x8a\x33\x24\x90\xdb\x09\x43\xf9\xcd\xac\x19\x44\x33\x02"
+	"\x88\x18\x32\x82\xea\xbc\xaa\x09\x88\xa9\x8a\x42\x36\x23\x91\xbb"
+	"\x9c\x20\x34\x03\x99\xab\xb0\xef\xcd\xab\x28\x45\x33\x13\x08\x08"
+	"\x12\x80\xdb\xbd\xab\x9a\x08\x08\x18\x30\x73\x33\x02\xc9\xcb\x09"
+	"\x32\x15\x98\x89\x40\xa8\xfd\xbb\x0a\x52\x34\x22\x00\x11\x31\x01"
+	"\xb6\x01\x18\x00\xdb\xbc\xbb\xab\x88\x88\x00\x32\x65\x23\x13\xc8"
+	"\xac\x88\x21\x12\xaa\x89\x9d\xba\xdb\x9a\x73\x35\x13\x01\x20\x12"
+	"\x02\xb8\xbe\xbd\xbc\x9b\x09\x08\x98\x81\x43\x47\x22\x91\x99\x8b"
+	"\x08\xb9\xaa\x9a\xfb\xba\x99\x73\x45\x24\x01\x00\x08\x00\xaa\xb9"
+	"\xcb\xdc\xcb\x9b\x09\x10\x02\x31\x31\x36\x23\x81\x9a\x99\xd9\xfa"
+	"\x19\x18\x34\x02\x11\x18\x31\x30\xb9\xab\x45\x16\xb9\x0b\x31\x05"
+	"\xd8\xec\x9a\x88\x18\x09\x19\x12\x63\x43\x02\xa9\xbc\x9c\x8b\x11"
+	"\x83\x1c\x90\x33\x77\x02\x00\x09\x01\x11\x19\xb9\x19\x3b\xd1\xf9"
+	"\xbb\xad\xab\x0b\x32\x45\x02\xc9\x83\x22\x10\x90\xad\x29\x13\x06"
+	"\xb9\x8d\x28\x09\x24\x32\x32\x60\x12\xc0\x81\x9c\xaa\x8b\xdd\xaa"
+	"\x01\x33\x47\x32\x02\x88\xeb\xbb\xc9\xab\x0a\xa8\x33\x46\x30\x12"
+	"\x92\x95\x99\xaa\xbc\xac\x19\x45\x10\xa0\x11\x90\x12\xfa\xac\x2b"
+	"\x42\x26\x32\x11\x08\x99\x9b\xce\xc9\xba\x89\x30\x02\x22\x30\x65"
+	"\x92\x12\x08\xcb\xba\xab\x90\xbb\x1d\xb9\x78\x87\x80\x80\x80\x80"
+	"\x00\x08\x08\x08\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+	"\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2010 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ima_adpcm.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define IMA_NEON  1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define IMA_SSE2  1
+#endif
+
+const int16_t imaStepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190,
+    209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724,
+    796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272,
+    2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132,
+    7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500,
+    20350, 22385, 24623, 27086, 29794, 32767
+};
+
+const int8_t imaIndexTable[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static inline int clampIndex(int index) {
+    return index < 0 ? 0 : (index > 88 ? 88 : index);
+}
+
+// the reference decoder, one block
+static void decodeBlock(const uint8_t *block, int16_t *out) {
+    int pred = (int16_t)(block[0] | (block[1] << 8));
+    int index = clampIndex(block[2]);
+    *out++ = (int16_t)pred;
+    for (int n = 0; n < IMA_BLOCK_FRAMES - 1; n++) {
+        int code = (block[4 + (n >> 1)] >> ((n & 1) << 2)) & 0x0F;
+        int step = imaStepTable[index];
+        int diff = step >> 3;
+        if (code & 4) diff += step;
+        if (code & 2) diff += step >> 1;
+        if (code & 1) diff += step >> 2;
+        pred += (code & 8) ? -diff : diff;
+        pred = pred < -32768 ? -32768 : (pred > 32767 ? 32767 : pred);
+        index = clampIndex(index + imaIndexTable[code]);
+        *out++ = (int16_t)pred;
+    }
+}
+
+#if defined(IMA_NEON) || defined(IMA_SSE2)
+/*
+ * decodeBlockSimd(): the step index only depends on the codes, so a scalar
+ * pass walks the index chain alone and tabulates each sample's step; the
+ * signed differences are then made 4 at a time and summed up into the
+ * predictor with a vector prefix sum. That sum matches the reference only
+ * while the predictor never clips: a block that would clip is decoded
+ * again the reference way.
+ */
+static void decodeBlockSimd(const uint8_t *block, int16_t *out) {
+    int32_t step[IMA_BLOCK_FRAMES - 1] __attribute__((aligned(16)));
+    int32_t code[IMA_BLOCK_FRAMES - 1] __attribute__((aligned(16)));
+    int32_t pred = (int16_t)(block[0] | (block[1] << 8));
+    int index = clampIndex(block[2]);
+    for (int n = 0; n < IMA_BLOCK_FRAMES - 1; n += 2) {
+        uint8_t byte = block[4 + (n >> 1)];
+        code[n] = byte & 0x0F;
+        code[n + 1] = byte >> 4;
+        step[n] = imaStepTable[index];
+        index = clampIndex(index + imaIndexTable[code[n]]);
+        step[n + 1] = imaStepTable[index];
+        index = clampIndex(index + imaIndexTable[code[n + 1]]);
+    }
+
+    out[0] = (int16_t)pred;
+    int16_t *dst = out + 1;
+#if defined(IMA_NEON)
+    const int32x4_t bit1 = vdupq_n_s32(1), bit2 = vdupq_n_s32(2);
+    const int32x4_t bit4 = vdupq_n_s32(4), bit8 = vdupq_n_s32(8);
+    const int32x4_t zero = vdupq_n_s32(0);
+    int32x4_t carry = vdupq_n_s32(pred);
+    int32x4_t lo = carry, hi = carry;
+    for (int n = 0; n < IMA_BLOCK_FRAMES - 1; n += 4) {
+        int32x4_t vstep = vld1q_s32(step + n), vcode = vld1q_s32(code + n);
+        int32x4_t diff = vshrq_n_s32(vstep, 3);
+        diff = vaddq_s32(diff, vandq_s32(vstep, vreinterpretq_s32_u32(vtstq_s32(vcode, bit4))));
+        diff = vaddq_s32(diff, vandq_s32(vshrq_n_s32(vstep, 1),
+                                         vreinterpretq_s32_u32(vtstq_s32(vcode, bit2))));
+        diff = vaddq_s32(diff, vandq_s32(vshrq_n_s32(vstep, 2),
+                                         vreinterpretq_s32_u32(vtstq_s32(vcode, bit1))));
+        // ( diff ^ neg ) - neg: negate where the sign bit is set
+        int32x4_t neg = vreinterpretq_s32_u32(vtstq_s32(vcode, bit8));
+        diff = vsubq_s32(veorq_s32(diff, neg), neg);
+        // prefix sum across the lanes, on top of the last predictor
+        diff = vaddq_s32(diff, vextq_s32(zero, diff, 3));
+        diff = vaddq_s32(diff, vextq_s32(zero, diff, 2));
+        int32x4_t vpred = vaddq_s32(diff, carry);
+        carry = vdupq_n_s32(vgetq_lane_s32(vpred, 3));
+        lo = vminq_s32(lo, vpred);
+        hi = vmaxq_s32(hi, vpred);
+        vst1_s16(dst + n, vmovn_s32(vpred));
+    }
+    int32x2_t lo2 = vpmin_s32(vget_low_s32(lo), vget_high_s32(lo));
+    int32x2_t hi2 = vpmax_s32(vget_low_s32(hi), vget_high_s32(hi));
+    lo2 = vpmin_s32(lo2, lo2);
+    hi2 = vpmax_s32(hi2, hi2);
+    int clipped = vget_lane_s32(lo2, 0) < -32768 || vget_lane_s32(hi2, 0) > 32767;
+#else
+    const __m128i bit1 = _mm_set1_epi32(1), bit2 = _mm_set1_epi32(2);
+    const __m128i bit4 = _mm_set1_epi32(4), bit8 = _mm_set1_epi32(8);
+    __m128i carry = _mm_set1_epi32(pred);
+    __m128i mismatch = _mm_setzero_si128();
+    for (int n = 0; n < IMA_BLOCK_FRAMES - 1; n += 4) {
+        __m128i vstep = _mm_load_si128((const __m128i*)(step + n));
+        __m128i vcode = _mm_load_si128((const __m128i*)(code + n));
+        __m128i diff = _mm_srai_epi32(vstep, 3);
+        diff = _mm_add_epi32(diff, _mm_and_si128(vstep,
+                _mm_cmpeq_epi32(_mm_and_si128(vcode, bit4), bit4)));
+        diff = _mm_add_epi32(diff, _mm_and_si128(_mm_srai_epi32(vstep, 1),
+                _mm_cmpeq_epi32(_mm_and_si128(vcode, bit2), bit2)));
+        diff = _mm_add_epi32(diff, _mm_and_si128(_mm_srai_epi32(vstep, 2),
+                _mm_cmpeq_epi32(_mm_and_si128(vcode, bit1), bit1)));
+        __m128i neg = _mm_cmpeq_epi32(_mm_and_si128(vcode, bit8), bit8);
+        diff = _mm_sub_epi32(_mm_xor_si128(diff, neg), neg);
+        diff = _mm_add_epi32(diff, _mm_slli_si128(diff, 4));
+        diff = _mm_add_epi32(diff, _mm_slli_si128(diff, 8));
+        __m128i vpred = _mm_add_epi32(diff, carry);
+        carry = _mm_shuffle_epi32(vpred, _MM_SHUFFLE(3, 3, 3, 3));
+        // no 32-bit min / max in SSE2: a predictor out of the int16 range
+        // does not survive the saturating pack and sign extending back
+        __m128i packed = _mm_packs_epi32(vpred, vpred);
+        __m128i back = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        mismatch = _mm_or_si128(mismatch, _mm_xor_si128(back, vpred));
+        _mm_storel_epi64((__m128i*)(dst + n), packed);
+    }
+    int clipped = _mm_movemask_epi8(_mm_cmpeq_epi32(mismatch, _mm_setzero_si128())) != 0xFFFF;
+#endif
+    if (clipped) {
+        decodeBlock(block, out);
+    }
+}
+#endif
+
+void imaDecodeBlocks(const uint8_t *blocks, uint32_t count, int16_t *out) {
+    for (; count; count--) {
+#if defined(IMA_NEON) || defined(IMA_SSE2)
+        decodeBlockSimd(blocks, out);
+#else
+        decodeBlock(blocks, out);
+#endif
+        blocks += IMA_BLOCK_BYTES;
+        out += IMA_BLOCK_FRAMES;
+    }
+}
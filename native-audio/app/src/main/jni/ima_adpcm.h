@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2010 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * IMA ADPCM clips: 4 bits a sample instead of 16, decoded a few blocks at a
+ * time while the clip plays. tools/clip2adpcm.c makes them out of PCM.
+ */
+#ifndef NATIVE_AUDIO_IMA_ADPCM_H
+#define NATIVE_AUDIO_IMA_ADPCM_H
+
+#include <stdint.h>
+
+/*
+ * block layout, as in mono IMA ADPCM WAV files: int16 first sample, uint8
+ * step index, one pad byte, then 2 samples a byte, low nibble first
+ *   IMA_BLOCK_BYTES:  bytes per block
+ *   IMA_BLOCK_FRAMES: samples per block, the header one included
+ */
+#define IMA_BLOCK_BYTES   256
+#define IMA_BLOCK_FRAMES  ((IMA_BLOCK_BYTES - 4) * 2 + 1)
+
+extern const int16_t imaStepTable[89];
+extern const int8_t  imaIndexTable[16];
+
+/*
+ * imaDecodeBlocks(): decodes count whole blocks into
+ * count * IMA_BLOCK_FRAMES samples. The step index chain is walked
+ * serially; the sample prefix sum runs on NEON / SSE2 where available.
+ */
+void imaDecodeBlocks(const uint8_t *blocks, uint32_t count, int16_t *out);
+
+#endif //NATIVE_AUDIO_IMA_ADPCM_H
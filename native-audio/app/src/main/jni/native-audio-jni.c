@@ -23,6 +23,9 @@
 
 #include <assert.h>
 #include <jni.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -38,7 +41,17 @@
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
 
-// pre-recorded sound clips, both are 8 kHz mono 16-bit signed little endian
+#include "resampler.h"
+#include "chunk_queue.h"
+#include "ima_adpcm.h"
+#include "clip_cache.h"
+
+/*
+ * pre-recorded sound clips, both are 8 kHz mono: IMA ADPCM blocks made by
+ * tools/clip2adpcm.c out of the 16-bit signed little endian PCM in
+ * hello_clip.h / android_clip.h, unless built with NATIVE_AUDIO_PCM_CLIPS
+ */
+#ifdef NATIVE_AUDIO_PCM_CLIPS
 static const char hello[] =
 #include "hello_clip.h"
 ;
@@ -46,6 +59,21 @@ static const char hello[] =
 static const char android[] =
 #include "android_clip.h"
 ;
+#define CLIP_ADPCM      0
+#define HELLO_FRAMES    (sizeof(hello) >> 1)
+#define ANDROID_FRAMES  (sizeof(android) >> 1)
+#else
+static const char hello[] =
+#include "hello_adpcm.h"
+;
+
+static const char android[] =
+#include "android_adpcm.h"
+;
+#define CLIP_ADPCM      1
+#define HELLO_FRAMES    HELLO_ADPCM_FRAMES
+#define ANDROID_FRAMES  ANDROID_ADPCM_FRAMES
+#endif
 
 // engine interfaces
 static SLObjectItf engineObject = NULL;
@@ -64,7 +92,6 @@ static SLMuteSoloItf bqPlayerMuteSolo;
 static SLVolumeItf bqPlayerVolume;
 static SLmilliHertz bqPlayerSampleRate = 0;
 static jint   bqPlayerBufSize = 0;
-static short *resampleBuf = NULL;
 static volatile int  bqPlayerRecorderBusy = 0;
 
 // aux effect on the output mix, used by the buffer queue player
@@ -94,15 +121,91 @@ static SLAndroidSimpleBufferQueueItf recorderBufferQueue;
 #define SAWTOOTH_FRAMES 8000
 static short sawtoothBuffer[SAWTOOTH_FRAMES];
 
-// 5 seconds of recorded audio at 16 kHz mono, 16-bit signed little endian
+// the last 5 seconds of recorded audio at 16 kHz mono, 16-bit signed little endian
 #define RECORDER_FRAMES (16000 * 5)
 static short recorderBuffer[RECORDER_FRAMES];
 static unsigned recorderSize = 0;
 
-// pointer and size of the next player buffer to enqueue, and number of remaining buffers
-static short *nextBuffer;
-static unsigned nextSize;
-static int nextCount;
+/*
+ * continuous recording: the recorder buffer queue is kept fed from a fixed
+ * pool of chunks, and filled chunks go to a consumer thread through a
+ * lock-free queue, so recording runs for as long as it is left on
+ *   RECORDER_CHUNK_FRAMES:  default chunk size, 100 ms at 16 kHz
+ *   RECORDER_CHUNK_COUNT:   default chunks in the pool; what the consumer
+ *                           may fall behind by is the pool minus the device
+ *   RECORDER_DEVICE_CHUNKS: chunks queued with the recorder at any time
+ */
+#define RECORDER_CHUNK_FRAMES   1600
+#define RECORDER_CHUNK_COUNT    8
+#define RECORDER_DEVICE_CHUNKS  2
+static short *recorderChunks = NULL;    // the pool
+static unsigned recorderChunkFrames = RECORDER_CHUNK_FRAMES;
+static unsigned recorderChunkCount = RECORDER_CHUNK_COUNT;
+static ChunkQueue recorderFreeQueue;    // consumer -> callback
+static ChunkQueue recorderFilledQueue;  // callback -> consumer
+static int recorderDevChunks[RECORDER_DEVICE_CHUNKS];  // with the recorder, in order
+static unsigned recorderDevHead;
+static sem_t recorderFilledSem;
+static pthread_t recorderConsumer;
+static volatile int recorderRunning = 0;
+static volatile unsigned recorderOverruns = 0;
+// consumer: recorderBuffer as a ring of the newest RECORDER_FRAMES
+static unsigned recorderKeepPos;
+static unsigned recorderKeepFrames;
+
+/*
+ * streaming playback: the clip is decoded and converted to the player rate
+ * a buffer at a time in bqPlayerCallback(), into a ping-pong pair of buffers
+ *   STREAM_MIN_FRAMES / STREAM_MAX_FRAMES: bounds of the ping-pong buffer
+ *       size, a whole number of device buffers when it fits
+ *   STREAM_DECODE_BLOCKS: ADPCM blocks decoded at a time
+ *   STREAM_NO_REQUEST: no selectClip() waiting for the callback
+ */
+#define STREAM_MIN_FRAMES     256
+#define STREAM_MAX_FRAMES     2048
+#define STREAM_DECODE_BLOCKS  4
+#define STREAM_NO_REQUEST     (-1)
+static short streamBuf[2][STREAM_MAX_FRAMES];
+static unsigned streamFrames;           // per ping-pong buffer
+static unsigned streamNext;             // buffer to fill next
+static unsigned streamQueued;           // buffers with the device
+static Resampler resampler8k;           // clips, unless the player runs at 8 kHz
+static Resampler resampler16k;          // recorded audio
+static Resampler *clipResampler;        // &resampler8k or NULL
+static Resampler *streamResampler;      // NULL: copy straight through
+static const void *streamClip;          // PCM samples or ADPCM blocks
+static uint32_t streamClipFrames;
+static uint32_t streamClipPos;          // frames taken into the stream
+static int streamClipAdpcm;
+static const short *streamPiece;        // part of the clip at hand, as PCM
+static uint32_t streamPieceFrames;
+static uint32_t streamPiecePos;
+static short streamDecoded[STREAM_DECODE_BLOCKS * IMA_BLOCK_FRAMES];
+static int streamLoops;                 // plays left, the current one included
+static uint32_t streamTail;             // zeros still to push through the filter
+static const short streamZeros[RESAMPLER_TAPS];
+static int streamCacheSlot = -1;        // clipCache entry pinned by the stream
+// selectClip() to callback hand-off: ( cache slot + 1 ) << 24 | clip << 16 | count
+static volatile int streamRequest = STREAM_NO_REQUEST;
+static volatile int streamActive = 0;   // the callback owns the stream state
+
+/*
+ * clip cache: the built-in clips converted to the player rate by the clip
+ * warmer thread, so replaying one is a straight copy in the callback
+ *   CLIP_CACHE_PREWARM: convert every built-in clip as soon as the player
+ *                       rate is known, instead of on its first play
+ */
+#define CLIP_CACHE_PREWARM  1
+static ClipCache clipCache;
+static uint32_t clipCacheBudget = CLIP_CACHE_BUDGET;
+static int clipCachePrewarm = CLIP_CACHE_PREWARM;
+static uint32_t clipRate;               // Hz, of the player
+static ChunkQueue clipWarmQueue;        // keys to convert, from the UI thread
+static sem_t clipWarmSem;
+static pthread_t clipWarmer;
+static volatile int clipWarmerRunning = 0;
+static Resampler clipWarmResampler;
+static short clipWarmDecoded[STREAM_DECODE_BLOCKS * IMA_BLOCK_FRAMES];
 
 
 // synthesize a mono sawtooth wave and place it into a buffer (called automatically on load)
@@ -114,75 +217,179 @@ __attribute__((constructor)) static void onDlOpen(void)
     }
 }
 
-void releaseResampleBuf(void) {
-    if( 0 == bqPlayerSampleRate) {
-        /*
-         * we are not using fast path, so we were not creating buffers, nothing to do
-         */
-        return;
+/*
+ * clipSource(): the data of a built-in clip, all of them 8 kHz; 0 for the
+ * others
+ */
+static int clipSource(int which, const void **data, uint32_t *frames, int *adpcm) {
+    switch (which) {
+        case 1:     // CLIP_HELLO
+            *data = hello;
+            *frames = HELLO_FRAMES;
+            *adpcm = CLIP_ADPCM;
+            return 1;
+        case 2:     // CLIP_ANDROID
+            *data = android;
+            *frames = ANDROID_FRAMES;
+            *adpcm = CLIP_ADPCM;
+            return 1;
+        case 3:     // CLIP_SAWTOOTH
+            *data = sawtoothBuffer;
+            *frames = SAWTOOTH_FRAMES;
+            *adpcm = 0;
+            return 1;
+        default:
+            return 0;
     }
-
-    free(resampleBuf);
-    resampleBuf = NULL;
 }
 
 /*
- * Only support up-sampling
+ * streamTake(): switches the stream to the clip selectClip() asked for;
+ * called by whoever owns the stream ( streamActive )
  */
-short* createResampledBuf(uint32_t idx, uint32_t srcRate, unsigned *size) {
-    short  *src = NULL;
-    short  *workBuf;
-    int    upSampleRate;
-    int32_t srcSampleCount = 0;
+static void streamTake(void) {
+    int request = __sync_lock_test_and_set(&streamRequest, STREAM_NO_REQUEST);
+    if (STREAM_NO_REQUEST == request) {
+        return;
+    }
+    if (streamCacheSlot >= 0) {
+        clipCacheRelease(&clipCache, streamCacheSlot);
+        streamCacheSlot = -1;
+    }
+    int which = (request >> 16) & 0xFF;
+    streamClip = NULL;
+    streamClipFrames = 0;
+    streamClipAdpcm = 0;
+    streamResampler = clipResampler;
+    if (request >> 24) {
+        // converted already: copy straight through
+        streamCacheSlot = (request >> 24) - 1;
+        streamClip = clipCacheData(&clipCache, streamCacheSlot, &streamClipFrames);
+        streamResampler = NULL;
+    } else if (4 == which) {
+        // CLIP_PLAYBACK, recorded at 16 kHz
+        streamClip = recorderBuffer;
+        streamClipFrames = recorderSize / sizeof(short);
+        streamResampler = &resampler16k;
+    } else if (!clipSource(which, &streamClip, &streamClipFrames, &streamClipAdpcm)) {
+        streamClip = NULL;      // CLIP_NONE
+    }
+    streamClipPos = 0;
+    streamPieceFrames = streamPiecePos = 0;
+    streamLoops = streamClipFrames ? (request & 0xFFFF) : 0;
+    streamTail = (streamLoops && streamResampler) ? RESAMPLER_TAPS / 2 : 0;
+    if (streamResampler) {
+        resamplerReset(streamResampler);
+    }
+}
 
-    if(0 == bqPlayerSampleRate) {
-        return NULL;
+/*
+ * streamNextPiece(): the next part of the clip as PCM: straight out of a
+ * PCM clip, or STREAM_DECODE_BLOCKS decoded into streamDecoded
+ */
+static int streamNextPiece(void) {
+    if (streamClipPos >= streamClipFrames) {
+        return 0;
     }
-    if(bqPlayerSampleRate % srcRate) {
-        /*
-         * simple up-sampling, must be divisible
-         */
-        return NULL;
+    uint32_t frames = streamClipFrames - streamClipPos;
+    if (streamClipAdpcm) {
+        // ADPCM pieces are whole blocks: streamClipPos stays block aligned
+        uint32_t block = streamClipPos / IMA_BLOCK_FRAMES;
+        uint32_t count = (frames + IMA_BLOCK_FRAMES - 1) / IMA_BLOCK_FRAMES;
+        if (count > STREAM_DECODE_BLOCKS) {
+            count = STREAM_DECODE_BLOCKS;
+        }
+        imaDecodeBlocks((const uint8_t*)streamClip + block * IMA_BLOCK_BYTES, count,
+                        streamDecoded);
+        if (frames > count * IMA_BLOCK_FRAMES) {
+            frames = count * IMA_BLOCK_FRAMES;
+        }
+        streamPiece = streamDecoded;
+    } else {
+        streamPiece = (const short*)streamClip + streamClipPos;
     }
-    upSampleRate = bqPlayerSampleRate / srcRate;
+    streamPieceFrames = frames;
+    streamPiecePos = 0;
+    streamClipPos += frames;
+    return 1;
+}
 
-    switch (idx) {
-        case 0:
-            return NULL;
-        case 1: // HELLO_CLIP
-            srcSampleCount = sizeof(hello) >> 1;
-            src = (short*)hello;
-            break;
-        case 2: // ANDROID_CLIP
-            srcSampleCount = sizeof(android) >> 1;
-            src = (short*) android;
-            break;
-        case 3: // SAWTOOTH_CLIP
-            srcSampleCount = SAWTOOTH_FRAMES;
-            src = sawtoothBuffer;
-            break;
-        case 4: // captured frames
-            srcSampleCount = recorderSize / sizeof(short);
-            src =  recorderBuffer;
+/*
+ * streamFill(): converts the next piece of the clip into buf, looping it
+ * streamLoops times; returns the frames written, 0 once the clip is over
+ */
+static unsigned streamFill(short *buf) {
+    unsigned produced = 0;
+    while (produced < streamFrames) {
+        const short *in;
+        uint32_t inFrames;
+        if (streamPiecePos < streamPieceFrames) {
+            in = streamPiece + streamPiecePos;
+            inFrames = streamPieceFrames - streamPiecePos;
+        } else if (streamNextPiece()) {
+            continue;
+        } else if (streamLoops > 1) {
+            // filter state carries over: the loop point is seamless
+            --streamLoops;
+            streamClipPos = 0;
+            continue;
+        } else if (streamTail) {
+            in = streamZeros;
+            inFrames = streamTail;
+        } else {
             break;
-        default:
-            assert(0);
-            return NULL;
+        }
+        uint32_t used = inFrames;
+        if (streamResampler) {
+            produced += resamplerProcess(streamResampler, in, &used,
+                                         buf + produced, streamFrames - produced);
+        } else {
+            if (used > streamFrames - produced) {
+                used = streamFrames - produced;
+            }
+            memcpy(buf + produced, in, used * sizeof(short));
+            produced += used;
+        }
+        if (in == streamZeros) {
+            streamTail -= used;
+        } else {
+            streamPiecePos += used;
+        }
     }
+    return produced;
+}
 
-    resampleBuf = (short*) malloc((srcSampleCount * upSampleRate) << 1);
-    if(resampleBuf == NULL) {
-        return resampleBuf;
-    }
-    workBuf = resampleBuf;
-    for(int sample=0; sample < srcSampleCount; sample++) {
-        for(int dup = 0; dup  < upSampleRate; dup++) {
-            *workBuf++ = src[sample];
+/*
+ * streamPump(): keeps both ping-pong buffers with the device until the clip
+ * runs out; gives the stream up once the last one came back
+ */
+static void streamPump(void) {
+    streamTake();
+    while (streamQueued < 2) {
+        short *buf = streamBuf[streamNext];
+        unsigned frames = streamFill(buf);
+        if (!frames) {
+            break;
         }
+        SLresult result;
+        result = (*bqPlayerBufferQueue)->Enqueue(bqPlayerBufferQueue, buf, frames * sizeof(short));
+        assert(SL_RESULT_SUCCESS == result);
+        (void)result;
+        streamNext ^= 1;
+        ++streamQueued;
+    }
+    if (streamQueued) {
+        return;
+    }
+    bqPlayerRecorderBusy = 0;
+    streamActive = 0;
+    __sync_synchronize();
+    // a selectClip() that found the stream still active is ours to start
+    if (STREAM_NO_REQUEST != streamRequest &&
+        __sync_bool_compare_and_swap(&streamActive, 0, 1)) {
+        bqPlayerRecorderBusy = 1;
+        streamPump();
     }
-
-    *size = (srcSampleCount * upSampleRate) << 1;     // sample format is 16 bit
-    return resampleBuf;
 }
 
 // this callback handler is called every time a buffer finishes playing
@@ -190,19 +397,8 @@ void bqPlayerCallback(SLAndroidSimpleBufferQueueItf bq, void *context)
 {
     assert(bq == bqPlayerBufferQueue);
     assert(NULL == context);
-    // for streaming playback, replace this test by logic to find and fill the next buffer
-    if (--nextCount > 0 && NULL != nextBuffer && 0 != nextSize) {
-        SLresult result;
-        // enqueue another buffer
-        result = (*bqPlayerBufferQueue)->Enqueue(bqPlayerBufferQueue, nextBuffer, nextSize);
-        // the most likely other result is SL_RESULT_BUFFER_INSUFFICIENT,
-        // which for this code example would indicate a programming error
-        assert(SL_RESULT_SUCCESS == result);
-        (void)result;
-    } else {
-        releaseResampleBuf();
-        bqPlayerRecorderBusy = 0;
-    }
+    --streamQueued;
+    streamPump();
 }
 
 
@@ -211,14 +407,180 @@ void bqRecorderCallback(SLAndroidSimpleBufferQueueItf bq, void *context)
 {
     assert(bq == recorderBufferQueue);
     assert(NULL == context);
-    // for streaming recording, here we would call Enqueue to give recorder the next buffer to fill
-    // but instead, this is a one-time buffer so we stop recording
+    // chunks complete in the order they were enqueued: the oldest one is done
+    int filled = recorderDevChunks[recorderDevHead];
+    int next;
+    if (recorderRunning && chunkQueuePop(&recorderFreeQueue, &next)) {
+        chunkQueuePush(&recorderFilledQueue, filled);
+        sem_post(&recorderFilledSem);
+    } else {
+        // the consumer is a whole pool behind: record over this chunk again
+        ++recorderOverruns;
+        next = filled;
+    }
+    recorderDevChunks[recorderDevHead] = next;
+    recorderDevHead = (recorderDevHead + 1) % RECORDER_DEVICE_CHUNKS;
+
     SLresult result;
-    result = (*recorderRecord)->SetRecordState(recorderRecord, SL_RECORDSTATE_STOPPED);
-    if (SL_RESULT_SUCCESS == result) {
-        recorderSize = RECORDER_FRAMES * sizeof(short);
+    result = (*recorderBufferQueue)->Enqueue(recorderBufferQueue,
+            recorderChunks + next * recorderChunkFrames, recorderChunkFrames * sizeof(short));
+    (void)result;
+}
+
+// keep the newest RECORDER_FRAMES of what was recorded, for CLIP_PLAYBACK
+static void recorderKeep(const short *chunk, unsigned frames)
+{
+    while (frames) {
+        unsigned count = RECORDER_FRAMES - recorderKeepPos;
+        if (count > frames) {
+            count = frames;
+        }
+        memcpy(recorderBuffer + recorderKeepPos, chunk, count * sizeof(short));
+        chunk += count;
+        frames -= count;
+        recorderKeepPos = (recorderKeepPos + count) % RECORDER_FRAMES;
+        recorderKeepFrames += count;
+        if (recorderKeepFrames > RECORDER_FRAMES) {
+            recorderKeepFrames = RECORDER_FRAMES;
+        }
     }
-    bqPlayerRecorderBusy = 0;
+}
+
+// consumer thread: takes filled chunks until recording stops, then drains the queue
+static void *recorderConsume(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        sem_wait(&recorderFilledSem);
+        int chunk;
+        while (chunkQueuePop(&recorderFilledQueue, &chunk)) {
+            recorderKeep(recorderChunks + chunk * recorderChunkFrames, recorderChunkFrames);
+            chunkQueuePush(&recorderFreeQueue, chunk);
+        }
+        if (!recorderRunning) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// reverse frames [begin, end) of recorderBuffer
+static void recorderReverse(unsigned begin, unsigned end)
+{
+    while (begin + 1 < end) {
+        short tmp = recorderBuffer[begin];
+        recorderBuffer[begin++] = recorderBuffer[--end];
+        recorderBuffer[end] = tmp;
+    }
+}
+
+/*
+ * clipCacheKey(): the clip cache key of a built-in clip at the player rate;
+ * 0 for clips that are not worth caching
+ */
+static uint32_t clipCacheKey(int which) {
+    const void *data;
+    uint32_t frames;
+    int adpcm;
+    if (!clipRate || !clipSource(which, &data, &frames, &adpcm) ||
+        (!adpcm && 8000 == clipRate)) {
+        return 0;
+    }
+    return CLIP_CACHE_KEY(which, clipRate);
+}
+
+// asks the clip warmer for a clip; UI thread only
+static void clipWarm(uint32_t key)
+{
+    if (clipWarmerRunning && chunkQueuePush(&clipWarmQueue, (int)key)) {
+        sem_post(&clipWarmSem);
+    }
+}
+
+// decodes and converts a whole built-in clip from 8 kHz to rateHz, into a malloc'ed buffer
+static short *clipConvert(int which, uint32_t rateHz, uint32_t *outFrames)
+{
+    const void *src;
+    uint32_t srcFrames;
+    int adpcm;
+    if (!clipSource(which, &src, &srcFrames, &adpcm)) {
+        return NULL;
+    }
+    int resample = (8000 != rateHz);
+    if (resample && !resamplerInit(&clipWarmResampler, 8000, rateHz)) {
+        return NULL;
+    }
+    // exactly the clip's duration, so that it loops without a gap
+    uint32_t frames = (uint32_t)((uint64_t)srcFrames * rateHz / 8000);
+    short *out = (short*)malloc(frames * sizeof(short));
+    if (NULL == out) {
+        return NULL;
+    }
+    uint32_t produced = 0, pos = 0;
+    while (produced < frames) {
+        const short *in;
+        uint32_t inFrames;
+        if (pos >= srcFrames) {
+            // clip is in, flush the filter
+            in = streamZeros;
+            inFrames = RESAMPLER_TAPS;
+        } else if (adpcm) {
+            uint32_t count = (srcFrames - pos + IMA_BLOCK_FRAMES - 1) / IMA_BLOCK_FRAMES;
+            if (count > STREAM_DECODE_BLOCKS) {
+                count = STREAM_DECODE_BLOCKS;
+            }
+            imaDecodeBlocks((const uint8_t*)src + pos / IMA_BLOCK_FRAMES * IMA_BLOCK_BYTES,
+                            count, clipWarmDecoded);
+            in = clipWarmDecoded;
+            inFrames = srcFrames - pos;
+            if (inFrames > count * IMA_BLOCK_FRAMES) {
+                inFrames = count * IMA_BLOCK_FRAMES;
+            }
+        } else {
+            in = (const short*)src + pos;
+            inFrames = srcFrames - pos;
+        }
+        pos += inFrames;
+        if (!resample) {
+            memcpy(out + produced, in, inFrames * sizeof(short));
+            produced += inFrames;
+            continue;
+        }
+        while (inFrames && produced < frames) {
+            uint32_t used = inFrames;
+            produced += resamplerProcess(&clipWarmResampler, in, &used,
+                                         out + produced, frames - produced);
+            in += used;
+            inFrames -= used;
+        }
+    }
+    *outFrames = frames;
+    return out;
+}
+
+// clip warmer thread: converts the clips asked for into the cache, until shutdown
+static void *clipWarmerRun(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        sem_wait(&clipWarmSem);
+        if (!clipWarmerRunning) {
+            break;
+        }
+        int key;
+        while (chunkQueuePop(&clipWarmQueue, &key)) {
+            uint32_t frames;
+            short *pcm;
+            if (clipCacheContains(&clipCache, (uint32_t)key)) {
+                continue;
+            }
+            pcm = clipConvert(key >> 24, key & 0xFFFFFF, &frames);
+            if (NULL != pcm && !clipCacheInsert(&clipCache, (uint32_t)key, pcm, frames)) {
+                free(pcm);
+            }
+        }
+    }
+    return NULL;
 }
 
 
@@ -267,6 +629,15 @@ void Java_com_example_nativeaudio_NativeAudio_createEngine(JNIEnv* env, jclass c
     }
     // ignore unsuccessful result codes for environmental reverb, as it is optional for this example
 
+    // start the clip warmer; without it clips are converted as they play
+    clipCacheInit(&clipCache, clipCacheBudget);
+    chunkQueueInit(&clipWarmQueue);
+    sem_init(&clipWarmSem, 0, 0);
+    clipWarmerRunning = 1;
+    if (pthread_create(&clipWarmer, NULL, clipWarmerRun, NULL)) {
+        clipWarmerRunning = 0;
+        sem_destroy(&clipWarmSem);
+    }
 }
 
 
@@ -283,6 +654,37 @@ void Java_com_example_nativeaudio_NativeAudio_createBufferQueueAudioPlayer(JNIEn
          */
         bqPlayerBufSize = bufSize;
     }
+    if (bqPlayerSampleRate) {
+        streamFrames = bqPlayerBufSize ? bqPlayerBufSize : STREAM_MIN_FRAMES;
+        while (streamFrames < STREAM_MIN_FRAMES) {
+            streamFrames += bqPlayerBufSize;
+        }
+        if (streamFrames > STREAM_MAX_FRAMES) {
+            streamFrames = STREAM_MAX_FRAMES;
+        }
+        resamplerInit(&resampler8k, SL_SAMPLINGRATE_8, bqPlayerSampleRate);
+        resamplerInit(&resampler16k, SL_SAMPLINGRATE_16, bqPlayerSampleRate);
+        clipResampler = &resampler8k;
+    } else {
+        // slow path plays at 8 kHz: clips go straight through, only the
+        // 16 kHz recording is converted
+        streamFrames = STREAM_MAX_FRAMES;
+        resamplerInit(&resampler16k, SL_SAMPLINGRATE_16, SL_SAMPLINGRATE_8);
+        clipResampler = NULL;
+    }
+    streamNext = 0;
+    streamQueued = 0;
+    streamActive = 0;
+    clipRate = bqPlayerSampleRate ? bqPlayerSampleRate / 1000 : 8000;
+    if (clipCachePrewarm) {
+        int which;
+        for (which = 1; which <= 3; ++which) {
+            uint32_t key = clipCacheKey(which);
+            if (key) {
+                clipWarm(key);
+            }
+        }
+    }
 
     // configure audio source
     SLDataLocator_AndroidSimpleBufferQueue loc_bufq = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, 2};
@@ -617,62 +1019,29 @@ jboolean Java_com_example_nativeaudio_NativeAudio_enableReverb(JNIEnv* env, jcla
 jboolean Java_com_example_nativeaudio_NativeAudio_selectClip(JNIEnv* env, jclass clazz, jint which,
         jint count)
 {
-    switch (which) {
-    case 0:     // CLIP_NONE
-        nextBuffer = (short *) NULL;
-        nextSize = 0;
-        break;
-    case 1:     // CLIP_HELLO
-        nextBuffer = createResampledBuf(1, SL_SAMPLINGRATE_8, &nextSize);
-        if(!nextBuffer) {
-            nextBuffer = (short*)hello;
-            nextSize  = sizeof(hello);
-        }
-        break;
-    case 2:     // CLIP_ANDROID
-        nextBuffer = createResampledBuf(2, SL_SAMPLINGRATE_8, &nextSize);
-        if(!nextBuffer) {
-            nextBuffer = (short*)android;
-            nextSize  = sizeof(android);
-        }
-        break;
-    case 3:     // CLIP_SAWTOOTH
-        nextBuffer = createResampledBuf(3, SL_SAMPLINGRATE_8, &nextSize);
-        if(!nextBuffer) {
-            nextBuffer = (short*)sawtoothBuffer;
-            nextSize  = sizeof(sawtoothBuffer);
-        }
-        break;
-    case 4:     // CLIP_PLAYBACK
-        nextBuffer = createResampledBuf(4, SL_SAMPLINGRATE_16, &nextSize);
-        // we recorded at 16 kHz, but are playing buffers at 8 Khz, so do a primitive down-sample
-        if(!nextBuffer) {
-            unsigned i;
-            for (i = 0; i < recorderSize; i += 2 * sizeof(short)) {
-                recorderBuffer[i >> 2] = recorderBuffer[i >> 1];
-            }
-            recorderSize >>= 1;
-            nextBuffer = recorderBuffer;
-            nextSize = recorderSize;
-        }
-        break;
-    default:
-        nextBuffer = NULL;
-        nextSize = 0;
-        break;
-    }
-    nextCount = count;
-    if (nextSize > 0) {
-        // here we only enqueue one buffer because it is a long clip,
-        // but for streaming playback we would typically enqueue at least 2 buffers to start
-        SLresult result;
-        result = (*bqPlayerBufferQueue)->Enqueue(bqPlayerBufferQueue, nextBuffer, nextSize);
-        if (SL_RESULT_SUCCESS != result) {
-            bqPlayerRecorderBusy = 1;
-            return JNI_FALSE;
+    // a cached clip is pinned here, so the callback only has to copy it;
+    // a miss plays converting on the fly and gets the clip cached for next time
+    int slot = -1;
+    uint32_t key = clipCacheKey(which);
+    if (key) {
+        slot = clipCacheAcquire(&clipCache, key);
+        if (slot < 0) {
+            clipWarm(key);
         }
     }
 
+    // the callback picks the clip up at its next buffer; if the stream is
+    // idle, start it here
+    int request = __sync_lock_test_and_set(&streamRequest,
+            ((slot + 1) << 24) | ((which & 0xFF) << 16) | (count & 0xFFFF));
+    if (STREAM_NO_REQUEST != request && (request >> 24)) {
+        // replaced before the callback took it
+        clipCacheRelease(&clipCache, (request >> 24) - 1);
+    }
+    if (__sync_bool_compare_and_swap(&streamActive, 0, 1)) {
+        bqPlayerRecorderBusy = 1;
+        streamPump();
+    }
     return JNI_TRUE;
 }
 
@@ -784,8 +1153,16 @@ jboolean Java_com_example_nativeaudio_NativeAudio_createAudioRecorder(JNIEnv* en
             SL_DEFAULTDEVICEID_AUDIOINPUT, NULL};
     SLDataSource audioSrc = {&loc_dev, NULL};
 
+    if (NULL == recorderChunks) {
+        recorderChunks = (short*)malloc(recorderChunkCount * recorderChunkFrames * sizeof(short));
+        if (NULL == recorderChunks) {
+            return JNI_FALSE;
+        }
+    }
+
     // configure audio sink
-    SLDataLocator_AndroidSimpleBufferQueue loc_bq = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, 2};
+    SLDataLocator_AndroidSimpleBufferQueue loc_bq = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE,
+            RECORDER_DEVICE_CHUNKS};
     SLDataFormat_PCM format_pcm = {SL_DATAFORMAT_PCM, 1, SL_SAMPLINGRATE_16,
         SL_PCMSAMPLEFORMAT_FIXED_16, SL_PCMSAMPLEFORMAT_FIXED_16,
         SL_SPEAKER_FRONT_CENTER, SL_BYTEORDER_LITTLEENDIAN};
@@ -828,12 +1205,42 @@ jboolean Java_com_example_nativeaudio_NativeAudio_createAudioRecorder(JNIEnv* en
 }
 
 
-// set the recording state for the audio recorder
+// chunk size and count for continuous recording; before createAudioRecorder()
+jboolean Java_com_example_nativeaudio_NativeAudio_setRecorderChunks(JNIEnv* env, jclass clazz,
+        jint frames, jint count)
+{
+    if (recorderRunning || NULL != recorderObject || frames <= 0 ||
+        count <= RECORDER_DEVICE_CHUNKS || count > CHUNK_QUEUE_MAX) {
+        return JNI_FALSE;
+    }
+    free(recorderChunks);
+    recorderChunks = NULL;
+
+    recorderChunkFrames = frames;
+    recorderChunkCount = count;
+    return JNI_TRUE;
+}
+
+
+// set the clip cache budget in bytes, and whether to pre-warm it; before createEngine() only
+jboolean Java_com_example_nativeaudio_NativeAudio_setClipCache(JNIEnv* env, jclass clazz,
+        jint budget, jboolean prewarm)
+{
+    if (clipWarmerRunning || budget < 0) {
+        return JNI_FALSE;
+    }
+    clipCacheBudget = (uint32_t)budget;
+    clipCachePrewarm = prewarm ? 1 : 0;
+    return JNI_TRUE;
+}
+
+
+// start recording, until stopRecording()
 void Java_com_example_nativeaudio_NativeAudio_startRecording(JNIEnv* env, jclass clazz)
 {
     SLresult result;
 
-    if( bqPlayerRecorderBusy) {
+    if( bqPlayerRecorderBusy || recorderRunning) {
         return;
     }
     // in case already recording, stop recording and clear buffer queue
@@ -846,15 +1253,34 @@ void Java_com_example_nativeaudio_NativeAudio_startRecording(JNIEnv* env, jclass
 
     // the buffer is not valid for playback yet
     recorderSize = 0;
+    recorderKeepPos = 0;
+    recorderKeepFrames = 0;
+    recorderOverruns = 0;
+
+    // the first chunks go to the recorder, the rest wait in the free queue
+    chunkQueueInit(&recorderFreeQueue);
+    chunkQueueInit(&recorderFilledQueue);
+    for (unsigned i = RECORDER_DEVICE_CHUNKS; i < recorderChunkCount; i++) {
+        chunkQueuePush(&recorderFreeQueue, i);
+    }
+    recorderDevHead = 0;
+    for (unsigned i = 0; i < RECORDER_DEVICE_CHUNKS; i++) {
+        recorderDevChunks[i] = i;
+        result = (*recorderBufferQueue)->Enqueue(recorderBufferQueue,
+                recorderChunks + i * recorderChunkFrames, recorderChunkFrames * sizeof(short));
+        // the most likely other result is SL_RESULT_BUFFER_INSUFFICIENT,
+        // which for this code example would indicate a programming error
+        assert(SL_RESULT_SUCCESS == result);
+        (void)result;
+    }
 
-    // enqueue an empty buffer to be filled by the recorder
-    // (for streaming recording, we would enqueue at least 2 empty buffers to start things off)
-    result = (*recorderBufferQueue)->Enqueue(recorderBufferQueue, recorderBuffer,
-            RECORDER_FRAMES * sizeof(short));
-    // the most likely other result is SL_RESULT_BUFFER_INSUFFICIENT,
-    // which for this code example would indicate a programming error
-    assert(SL_RESULT_SUCCESS == result);
-    (void)result;
+    sem_init(&recorderFilledSem, 0, 0);
+    recorderRunning = 1;
+    if (pthread_create(&recorderConsumer, NULL, recorderConsume, NULL)) {
+        recorderRunning = 0;
+        sem_destroy(&recorderFilledSem);
+        return;
+    }
 
     // start recording
     result = (*recorderRecord)->SetRecordState(recorderRecord, SL_RECORDSTATE_RECORDING);
@@ -864,6 +1290,40 @@ void Java_com_example_nativeaudio_NativeAudio_startRecording(JNIEnv* env, jclass
 }
 
 
+// stop recording; the last RECORDER_FRAMES become CLIP_PLAYBACK. Returns the
+// chunks lost because the consumer fell behind
+jint Java_com_example_nativeaudio_NativeAudio_stopRecording(JNIEnv* env, jclass clazz)
+{
+    SLresult result;
+
+    if (!recorderRunning) {
+        return 0;
+    }
+    result = (*recorderRecord)->SetRecordState(recorderRecord, SL_RECORDSTATE_STOPPED);
+    assert(SL_RESULT_SUCCESS == result);
+    (void)result;
+    result = (*recorderBufferQueue)->Clear(recorderBufferQueue);
+    assert(SL_RESULT_SUCCESS == result);
+    (void)result;
+
+    // the consumer drains what is left and exits
+    recorderRunning = 0;
+    sem_post(&recorderFilledSem);
+    pthread_join(recorderConsumer, NULL);
+    sem_destroy(&recorderFilledSem);
+
+    // oldest frame first: rotate the ring left by its write position
+    if (recorderKeepFrames == RECORDER_FRAMES && recorderKeepPos) {
+        recorderReverse(0, recorderKeepPos);
+        recorderReverse(recorderKeepPos, RECORDER_FRAMES);
+        recorderReverse(0, RECORDER_FRAMES);
+    }
+    recorderSize = recorderKeepFrames * sizeof(short);
+    bqPlayerRecorderBusy = 0;
+    return recorderOverruns;
+}
+
+
 // shut down the native audio system
 void Java_com_example_nativeaudio_NativeAudio_shutdown(JNIEnv* env, jclass clazz)
 {
@@ -877,7 +1337,30 @@ void Java_com_example_nativeaudio_NativeAudio_shutdown(JNIEnv* env, jclass clazz
         bqPlayerEffectSend = NULL;
         bqPlayerMuteSolo = NULL;
         bqPlayerVolume = NULL;
+        // no more callbacks: a stream that was playing is over
+        if (streamActive) {
+            bqPlayerRecorderBusy = 0;
+        }
+        streamActive = 0;
+        streamQueued = 0;
+    }
+
+    // unpin what the stream held, stop the clip warmer and free the clip cache
+    int request = __sync_lock_test_and_set(&streamRequest, STREAM_NO_REQUEST);
+    if (STREAM_NO_REQUEST != request && (request >> 24)) {
+        clipCacheRelease(&clipCache, (request >> 24) - 1);
+    }
+    if (streamCacheSlot >= 0) {
+        clipCacheRelease(&clipCache, streamCacheSlot);
+        streamCacheSlot = -1;
+    }
+    if (clipWarmerRunning) {
+        clipWarmerRunning = 0;
+        sem_post(&clipWarmSem);
+        pthread_join(clipWarmer, NULL);
+        sem_destroy(&clipWarmSem);
     }
+    clipCacheClear(&clipCache);
 
     // destroy file descriptor audio player object, and invalidate all associated interfaces
     if (fdPlayerObject != NULL) {
@@ -901,11 +1384,14 @@ void Java_com_example_nativeaudio_NativeAudio_shutdown(JNIEnv* env, jclass clazz
 
     // destroy audio recorder object, and invalidate all associated interfaces
     if (recorderObject != NULL) {
+        Java_com_example_nativeaudio_NativeAudio_stopRecording(env, clazz);
         (*recorderObject)->Destroy(recorderObject);
         recorderObject = NULL;
         recorderRecord = NULL;
         recorderBufferQueue = NULL;
     }
+    free(recorderChunks);
+    recorderChunks = NULL;
 
     // destroy output mix object, and invalidate all associated interfaces
     if (outputMixObject != NULL) {
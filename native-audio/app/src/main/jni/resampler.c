@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2010 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include "resampler.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define RESAMPLER_NEON  1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define RESAMPLER_SSE2  1
+#endif
+
+#ifndef M_PI
+#define M_PI        3.14159265358979323846
+#endif
+
+#define FRAC_BITS   (32 - RESAMPLER_PHASE_BITS)
+
+// zeroth order modified Bessel function of the first kind, for the window
+static double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+/*
+ * dot2(): x against two neighbouring filter phases in one pass over x;
+ * RESAMPLER_TAPS is a multiple of 4, h0 / h1 are 16 byte aligned, x is not
+ */
+static inline void dot2(const float *x, const float *h0, const float *h1,
+                        float *y0, float *y1) {
+#if defined(RESAMPLER_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+    for (int k = 0; k < RESAMPLER_TAPS; k += 4) {
+        float32x4_t v = vld1q_f32(x + k);
+        acc0 = vmlaq_f32(acc0, v, vld1q_f32(h0 + k));
+        acc1 = vmlaq_f32(acc1, v, vld1q_f32(h1 + k));
+    }
+    float32x2_t s0 = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+    float32x2_t s1 = vadd_f32(vget_low_f32(acc1), vget_high_f32(acc1));
+    float32x2_t s = vpadd_f32(s0, s1);
+    *y0 = vget_lane_f32(s, 0);
+    *y1 = vget_lane_f32(s, 1);
+#elif defined(RESAMPLER_SSE2)
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    for (int k = 0; k < RESAMPLER_TAPS; k += 4) {
+        __m128 v = _mm_loadu_ps(x + k);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(v, _mm_load_ps(h0 + k)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(v, _mm_load_ps(h1 + k)));
+    }
+    // transpose-add: lanes 0,1 become the two sums
+    __m128 lo = _mm_unpacklo_ps(acc0, acc1);    // a0 b0 a1 b1
+    __m128 hi = _mm_unpackhi_ps(acc0, acc1);    // a2 b2 a3 b3
+    __m128 s = _mm_add_ps(lo, hi);
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    float out[4];
+    _mm_storeu_ps(out, s);
+    *y0 = out[0];
+    *y1 = out[1];
+#else
+    float acc0 = 0.0f, acc1 = 0.0f;
+    for (int k = 0; k < RESAMPLER_TAPS; k++) {
+        acc0 += x[k] * h0[k];
+        acc1 += x[k] * h1[k];
+    }
+    *y0 = acc0;
+    *y1 = acc1;
+#endif
+}
+
+static inline short toPcm16(float v) {
+    if (v >= 32767.0f) {
+        return 32767;
+    }
+    if (v <= -32768.0f) {
+        return -32768;
+    }
+    return (short)lrintf(v);
+}
+
+int resamplerInit(Resampler *rs, uint32_t inRate, uint32_t outRate) {
+    if (!inRate || !outRate) {
+        return 0;
+    }
+    rs->inRate  = inRate;
+    rs->outRate = outRate;
+    rs->step = ((uint64_t)inRate << 32) / outRate;
+
+    // low pass at the lower of the two Nyquist rates, in input samples
+    double cutoff = RESAMPLER_CUTOFF;
+    if (outRate < inRate) {
+        cutoff *= (double)outRate / inRate;
+    }
+    const int half = RESAMPLER_TAPS / 2;
+    double norm = besselI0(RESAMPLER_BETA);
+    for (int p = 0; p <= RESAMPLER_PHASES; p++) {
+        float *row = &rs->coefs[p * RESAMPLER_TAPS];
+        double frac = (double)p / RESAMPLER_PHASES, sum = 0.0;
+        for (int k = 0; k < RESAMPLER_TAPS; k++) {
+            // distance of tap k from the output instant, in input samples
+            double t = k - (half - 1) - frac;
+            double x = M_PI * cutoff * t;
+            double sinc = (fabs(x) < 1e-9) ? 1.0 : sin(x) / x;
+            double w = t / half;
+            w = (w >= 1.0 || w <= -1.0) ? 0.0 :
+                besselI0(RESAMPLER_BETA * sqrt(1.0 - w * w)) / norm;
+            row[k] = (float)(sinc * w);
+            sum += row[k];
+        }
+        // unity gain at DC for every phase: no ripple from the phase steps
+        for (int k = 0; k < RESAMPLER_TAPS; k++) {
+            row[k] = (float)(row[k] / sum);
+        }
+    }
+    resamplerReset(rs);
+    return 1;
+}
+
+void resamplerReset(Resampler *rs) {
+    memset(rs->hist, 0, sizeof(rs->hist));
+    // the output instant sits between taps half - 1 and half: pre-fill the
+    // past so the first output lines up with the first input sample
+    rs->histLen = RESAMPLER_TAPS / 2 - 1;
+    rs->pos = 0;
+}
+
+uint32_t resamplerProcess(Resampler *rs, const short *in, uint32_t *inFrames,
+                          short *out, uint32_t outFrames) {
+    const uint32_t histCap = RESAMPLER_TAPS + RESAMPLER_BLOCK;
+    uint32_t produced = 0, consumed = 0, avail = *inFrames;
+
+    for (;;) {
+        while (produced < outFrames) {
+            uint32_t i = (uint32_t)(rs->pos >> 32);
+            if (i + RESAMPLER_TAPS > rs->histLen) {
+                break;
+            }
+            uint32_t frac = (uint32_t)rs->pos;
+            const float *h0 = &rs->coefs[(frac >> FRAC_BITS) * RESAMPLER_TAPS];
+            float f = (float)(frac & ((1u << FRAC_BITS) - 1)) * (1.0f / (1u << FRAC_BITS));
+            float y0, y1;
+            dot2(&rs->hist[i], h0, h0 + RESAMPLER_TAPS, &y0, &y1);
+            out[produced++] = toPcm16(y0 + f * (y1 - y0));
+            rs->pos += rs->step;
+        }
+        if (produced == outFrames || consumed == avail) {
+            break;
+        }
+
+        // drop the samples the filter has moved past, then take in more
+        uint32_t drop = (uint32_t)(rs->pos >> 32);
+        if (drop > rs->histLen) {
+            drop = rs->histLen;
+        }
+        memmove(rs->hist, &rs->hist[drop], (rs->histLen - drop) * sizeof(float));
+        rs->histLen -= drop;
+        rs->pos -= (uint64_t)drop << 32;
+
+        uint32_t count = histCap - rs->histLen;
+        if (count > avail - consumed) {
+            count = avail - consumed;
+        }
+        assert(count);
+        for (uint32_t k = 0; k < count; k++) {
+            rs->hist[rs->histLen + k] = (float)in[consumed + k];
+        }
+        rs->histLen += count;
+        consumed += count;
+    }
+    *inFrames = consumed;
+    return produced;
+}
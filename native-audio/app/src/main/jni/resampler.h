@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2010 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * Streaming sample rate converter for the buffer queue player: clips are
+ * converted a device buffer at a time inside bqPlayerCallback instead of
+ * being copied, whole, at the device rate.
+ */
+#ifndef NATIVE_AUDIO_RESAMPLER_H
+#define NATIVE_AUDIO_RESAMPLER_H
+
+#include <stdint.h>
+
+/*
+ * resampler controls:
+ *   RESAMPLER_TAPS:       windowed-sinc taps per output sample, multiple of 4
+ *   RESAMPLER_PHASE_BITS: log2 of the filter phases tabulated per input
+ *                         sample; the phases in between are interpolated
+ *   RESAMPLER_BLOCK:      input samples taken in per refill
+ *   RESAMPLER_CUTOFF:     pass band edge, in fraction of the lower Nyquist
+ *   RESAMPLER_BETA:       Kaiser window shape
+ * Down-sampling by more than ~2x gets a shorter filter than it needs with
+ * the fixed tap count; the clips here are all up-sampled.
+ */
+#define RESAMPLER_TAPS        16
+#define RESAMPLER_PHASE_BITS  7
+#define RESAMPLER_PHASES      (1 << RESAMPLER_PHASE_BITS)
+#define RESAMPLER_BLOCK       256
+#define RESAMPLER_CUTOFF      0.9
+#define RESAMPLER_BETA        8.0
+
+typedef struct {
+    // (RESAMPLER_PHASES + 1) rows of RESAMPLER_TAPS, the last one for
+    // interpolating past the last phase
+    float    coefs[(RESAMPLER_PHASES + 1) * RESAMPLER_TAPS] __attribute__((aligned(16)));
+    // filter history followed by the samples not consumed yet
+    float    hist[RESAMPLER_TAPS + RESAMPLER_BLOCK] __attribute__((aligned(16)));
+    uint32_t histLen;
+    uint64_t pos;       // 32.32 input position of the next output, from hist[0]
+    uint64_t step;      // 32.32 input samples per output sample
+    uint32_t inRate;
+    uint32_t outRate;
+} Resampler;
+
+/*
+ * resamplerInit(): tabulates the filter for inRate -> outRate ( any unit,
+ * the same for both ) and resets the stream. Not for the audio callback:
+ * nothing is allocated, but it computes ~2000 window values.
+ */
+int      resamplerInit(Resampler *rs, uint32_t inRate, uint32_t outRate);
+
+/*
+ * resamplerReset(): forgets the filter history, for a new stream
+ */
+void     resamplerReset(Resampler *rs);
+
+/*
+ * resamplerProcess(): converts up to *inFrames of in into at most
+ * outFrames of out; *inFrames comes back as the frames consumed, the
+ * return value is the frames produced. The filter state carries over to
+ * the next call, so a stream may be fed in pieces of any size.
+ */
+uint32_t resamplerProcess(Resampler *rs, const short *in, uint32_t *inFrames,
+                          short *out, uint32_t outFrames);
+
+#endif //NATIVE_AUDIO_RESAMPLER_H
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2010 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * clip2adpcm: turns a 16-bit mono clip ( WAV or raw little endian ) into a
+ * C header of IMA ADPCM blocks for native-audio-jni.c, in the same string
+ * literal layout as hello_clip.h, and checks the result: it decodes the
+ * clip back with the player's decoder and reports the SNR and how long
+ * the decode takes.
+ *
+ * Build, from native-audio/:
+ *     cc -std=c99 -O2 -Iapp/src/main/jni -o clip2adpcm \
+ *         tools/clip2adpcm.c app/src/main/jni/ima_adpcm.c -lm
+ * Run:
+ *     ./clip2adpcm -n HELLO hello.raw app/src/main/jni/hello_adpcm.h
+ * The header starts with a #define of NAME_ADPCM_FRAMES, the clip length;
+ * the last block is padded with silence.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ima_adpcm.h"
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [-n NAME] input.{wav,raw} output.h\n", name);
+}
+
+static int16_t *readClip(const char *path, uint32_t *frames) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *data = (uint8_t*)malloc(size > 0 ? size : 1);
+    if (!data || fread(data, 1, size, file) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", path);
+        fclose(file);
+        free(data);
+        return NULL;
+    }
+    fclose(file);
+
+    // WAV: walk the chunks to "data"; anything else is raw samples
+    uint8_t *pcm = data;
+    long bytes = size;
+    if (size >= 12 && !memcmp(data, "RIFF", 4) && !memcmp(data + 8, "WAVE", 4)) {
+        long pos = 12;
+        bytes = 0;
+        while (pos + 8 <= size) {
+            uint32_t len = data[pos + 4] | (data[pos + 5] << 8) |
+                           (data[pos + 6] << 16) | ((uint32_t)data[pos + 7] << 24);
+            if (!memcmp(data + pos, "fmt ", 4) &&
+                (data[pos + 8] != 1 || data[pos + 10] != 1 || data[pos + 22] != 16)) {
+                fprintf(stderr, "%s: not 16-bit mono PCM\n", path);
+                free(data);
+                return NULL;
+            }
+            if (!memcmp(data + pos, "data", 4)) {
+                pcm = data + pos + 8;
+                bytes = (pos + 8 + (long)len <= size) ? (long)len : size - pos - 8;
+                break;
+            }
+            pos += 8 + len + (len & 1);
+        }
+    }
+    *frames = (uint32_t)(bytes / 2);
+    int16_t *samples = (int16_t*)malloc((*frames ? *frames : 1) * sizeof(int16_t));
+    for (uint32_t i = 0; i < *frames; i++) {
+        samples[i] = (int16_t)(pcm[2 * i] | (pcm[2 * i + 1] << 8));
+    }
+    free(data);
+    return samples;
+}
+
+/*
+ * encodeBlock(): greedy IMA encoder starting at step index *index; tracks
+ * the decoder's predictor so the error does not build up. Returns the
+ * squared error, *index ends up where the block left it.
+ */
+static double encodeBlock(const int16_t *in, uint8_t *block, int *index) {
+    double error = 0.0;
+    int pred = in[0];
+    block[0] = (uint8_t)(pred & 0xFF);
+    block[1] = (uint8_t)((pred >> 8) & 0xFF);
+    block[2] = (uint8_t)*index;
+    block[3] = 0;
+    memset(block + 4, 0, IMA_BLOCK_BYTES - 4);
+    for (int n = 0; n < IMA_BLOCK_FRAMES - 1; n++) {
+        int step = imaStepTable[*index];
+        int delta = in[n + 1] - pred;
+        int code = 0;
+        if (delta < 0) {
+            code = 8;
+            delta = -delta;
+        }
+        int diff = step >> 3;
+        if (delta >= step)        { code |= 4; delta -= step;        diff += step; }
+        if (delta >= (step >> 1)) { code |= 2; delta -= step >> 1;   diff += step >> 1; }
+        if (delta >= (step >> 2)) { code |= 1;                       diff += step >> 2; }
+        pred += (code & 8) ? -diff : diff;
+        pred = pred < -32768 ? -32768 : (pred > 32767 ? 32767 : pred);
+        *index += imaIndexTable[code];
+        *index = *index < 0 ? 0 : (*index > 88 ? 88 : *index);
+        block[4 + (n >> 1)] |= (uint8_t)(code << ((n & 1) << 2));
+        error += (double)(in[n + 1] - pred) * (in[n + 1] - pred);
+    }
+    return error;
+}
+
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+    const char *name = "CLIP";
+    int arg = 1;
+    if (arg + 1 < argc && !strcmp(argv[arg], "-n")) {
+        name = argv[arg + 1];
+        arg += 2;
+    }
+    if (argc - arg != 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    uint32_t frames;
+    int16_t *samples = readClip(argv[arg], &frames);
+    if (!samples) {
+        return 1;
+    }
+    uint32_t blocks = (frames + IMA_BLOCK_FRAMES - 1) / IMA_BLOCK_FRAMES;
+    uint32_t padded = blocks * IMA_BLOCK_FRAMES;
+    int16_t *in = (int16_t*)calloc(padded ? padded : 1, sizeof(int16_t));
+    uint8_t *adpcm = (uint8_t*)malloc((blocks ? blocks : 1) * IMA_BLOCK_BYTES);
+    int16_t *decoded = (int16_t*)malloc((padded ? padded : 1) * sizeof(int16_t));
+    memcpy(in, samples, frames * sizeof(int16_t));
+    // every block may start at any step index: keep the best one
+    for (uint32_t b = 0; b < blocks; b++) {
+        int best = 0;
+        double bestError = -1.0;
+        for (int start = 0; start <= 88; start++) {
+            int index = start;
+            double error = encodeBlock(in + b * IMA_BLOCK_FRAMES,
+                                       adpcm + b * IMA_BLOCK_BYTES, &index);
+            if (bestError < 0.0 || error < bestError) {
+                bestError = error;
+                best = start;
+            }
+        }
+        encodeBlock(in + b * IMA_BLOCK_FRAMES, adpcm + b * IMA_BLOCK_BYTES, &best);
+    }
+
+    // round trip through the player's decoder, timed
+    int runs = 0;
+    double start = nowSec(), elapsed;
+    do {
+        imaDecodeBlocks(adpcm, blocks, decoded);
+        runs++;
+        elapsed = nowSec() - start;
+    } while (elapsed < 0.2);
+    double signal = 0.0, noise = 0.0;
+    for (uint32_t i = 0; i < frames; i++) {
+        double err = (double)decoded[i] - samples[i];
+        signal += (double)samples[i] * samples[i];
+        noise += err * err;
+    }
+
+    FILE *out = fopen(argv[arg + 1], "w");
+    if (!out) {
+        perror(argv[arg + 1]);
+        return 1;
+    }
+    fprintf(out, "#define %s_ADPCM_FRAMES %u\n", name, frames);
+    for (uint32_t i = 0; i < blocks * IMA_BLOCK_BYTES; i += 16) {
+        fputc('\t', out);
+        fputc('"', out);
+        for (uint32_t k = i; k < i + 16 && k < blocks * IMA_BLOCK_BYTES; k++) {
+            fprintf(out, "\\x%02x", adpcm[k]);
+        }
+        fputs("\"\n", out);
+    }
+    fclose(out);
+
+    printf("%u frames -> %u blocks: %u bytes instead of %u ( %.2fx )\n",
+           frames, blocks, blocks * IMA_BLOCK_BYTES, frames * 2,
+           frames ? (double)frames * 2 / (blocks * IMA_BLOCK_BYTES) : 0.0);
+    printf("SNR %.1f dB, decode %.2f ns per sample\n",
+           noise > 0.0 ? 10.0 * log10(signal / noise) : 99.0,
+           elapsed * 1e9 / ((double)runs * (padded ? padded : 1)));
+    free(samples);
+    free(in);
+    free(adpcm);
+    free(decoded);
+    return 0;
+}